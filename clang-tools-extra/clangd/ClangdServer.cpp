@@ -133,6 +133,7 @@ ClangdServer::Options::operator TUScheduler::Options() const {
   Opts.StorePreamblesInMemory = StorePreamblesInMemory;
   Opts.UpdateDebounce = UpdateDebounce;
   Opts.AsyncPreambleBuilds = AsyncPreambleBuilds;
+  Opts.SharePreambles = SharePreambles;
   Opts.ContextProvider = ContextProvider;
   return Opts;
 }
@@ -101,6 +101,9 @@ public:
     /// Reuse even stale preambles, and rebuild them in the background.
     /// This improves latency at the cost of accuracy.
     bool AsyncPreambleBuilds = true;
+    /// Share a single preamble between files with identical preamble sections
+    /// and compile commands.
+    bool SharePreambles = false;
 
     /// If true, ClangdServer builds a dynamic in-memory index for symbols in
     /// opened files and uses the index to augment code completion results.
@@ -164,6 +164,11 @@ void IncludeStructure::recordInclude(llvm::StringRef IncludingName,
   IncludeChildren[Parent].push_back(Child);
 }
 
+void IncludeStructure::addAlias(llvm::StringRef Name, llvm::StringRef Alias) {
+  unsigned Index = fileIndex(Name);
+  NameToIndex[Alias] = Index;
+}
+
 unsigned IncludeStructure::fileIndex(llvm::StringRef Name) {
   auto R = NameToIndex.try_emplace(Name, RealPathNames.size());
   if (R.second)
@@ -126,6 +126,10 @@ public:
                      llvm::StringRef IncludedName,
                      llvm::StringRef IncludedRealName);
 
+  // Makes \p Alias another name for the file \p Name, so that includes recorded
+  // for either are found from both.
+  void addAlias(llvm::StringRef Name, llvm::StringRef Alias);
+
 private:
   // Identifying files in a way that persists from preamble build to subsequent
   // builds is surprisingly hard. FileID is unavailable in InclusionDirective(),
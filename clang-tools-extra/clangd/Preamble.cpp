@@ -302,7 +302,7 @@ bool isMainFile(llvm::StringRef FileName, const SourceManager &SM) {
 } // namespace
 
 PreambleData::PreambleData(const ParseInputs &Inputs,
-                           PrecompiledPreamble Preamble,
+                           std::shared_ptr<const PrecompiledPreamble> Preamble,
                            std::vector<Diag> Diags, IncludeStructure Includes,
                            MainFileMacros Macros,
                            std::unique_ptr<PreambleFileStatusCache> StatCache,
@@ -358,7 +358,9 @@ buildPreamble(PathRef FileName, CompilerInvocation CI,
          BuiltPreamble->getSize(), FileName, Inputs.Version);
     std::vector<Diag> Diags = PreambleDiagnostics.take();
     return std::make_shared<PreambleData>(
-        Inputs, std::move(*BuiltPreamble), std::move(Diags),
+        Inputs,
+        std::make_shared<PrecompiledPreamble>(std::move(*BuiltPreamble)),
+        std::move(Diags),
         SerializedDeclsCollector.takeIncludes(),
         SerializedDeclsCollector.takeMacros(), std::move(StatCache),
         SerializedDeclsCollector.takeCanonicalIncludes());
@@ -378,7 +380,64 @@ bool isPreambleCompatible(const PreambleData &Preamble,
   auto VFS = Inputs.TFS->view(Inputs.CompileCommand.Directory);
   return compileCommandsAreEqual(Inputs.CompileCommand,
                                  Preamble.CompileCommand) &&
-         Preamble.Preamble.CanReuse(CI, *ContentsBuffer, Bounds, *VFS);
+         Preamble.Preamble->CanReuse(CI, *ContentsBuffer, Bounds, *VFS);
+}
+
+std::string preambleSharingKey(PathRef FileName, const ParseInputs &Inputs,
+                               const CompilerInvocation &CI) {
+  auto ContentsBuffer =
+      llvm::MemoryBuffer::getMemBuffer(Inputs.Contents, FileName);
+  auto Bounds = ComputePreambleBounds(*CI.getLangOpts(), *ContentsBuffer, 0);
+  const tooling::CompileCommand &Cmd = Inputs.CompileCommand;
+  llvm::StringRef BaseName = llvm::sys::path::filename(FileName);
+
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  // Quoted includes are resolved relative to the directory of the file.
+  OS << llvm::sys::path::parent_path(FileName) << '\0' << Cmd.Directory << '\0';
+  for (size_t I = 0; I < Cmd.CommandLine.size(); ++I) {
+    llvm::StringRef Arg = Cmd.CommandLine[I];
+    // The output file doesn't affect the preamble.
+    if (Arg == "-o") {
+      ++I;
+      continue;
+    }
+    if (Arg.startswith("-o"))
+      continue;
+    if (Arg == Cmd.Filename || (!Arg.startswith("-") && Arg.endswith(BaseName)))
+      Arg = "<file>";
+    OS << Arg << '\0';
+  }
+  OS << Inputs.Contents.substr(0, Bounds.Size);
+  return llvm::toHex(digest(OS.str()));
+}
+
+std::shared_ptr<const PreambleData>
+sharePreamble(const PreambleData &Donor, llvm::StringRef DonorMainFile,
+              PathRef FileName, const ParseInputs &Inputs,
+              const CompilerInvocation &CI) {
+  // Entities in the preamble section are attributed to the donor's main file.
+  // That's only invisible if the section has nothing but includes: no macro
+  // definitions, pragmas, references to the file name or diagnostics.
+  llvm::StringRef Contents = Donor.Preamble->getContents();
+  if (!Donor.Diags.empty() || !Donor.Macros.Names.empty() ||
+      Contents.contains("pragma") || Contents.contains("FILE__"))
+    return nullptr;
+  auto ContentsBuffer =
+      llvm::MemoryBuffer::getMemBuffer(Inputs.Contents, FileName);
+  auto Bounds = ComputePreambleBounds(*CI.getLangOpts(), *ContentsBuffer, 0);
+  auto VFS = Inputs.TFS->view(Inputs.CompileCommand.Directory);
+  if (!Donor.Preamble->CanReuse(CI, *ContentsBuffer, Bounds, *VFS))
+    return nullptr;
+
+  // Includes of the preamble section were recorded for the donor's main file.
+  IncludeStructure Includes = Donor.Includes;
+  Includes.addAlias(DonorMainFile, CI.getFrontendOpts().Inputs[0].getFile());
+  auto Result = std::make_shared<PreambleData>(
+      Inputs, Donor.Preamble, std::vector<Diag>(), std::move(Includes),
+      Donor.Macros, /*StatCache=*/nullptr, Donor.CanonIncludes);
+  Result->Borrowed = true;
+  return Result;
 }
 
 void escapeBackslashAndQuotes(llvm::StringRef Text, llvm::raw_ostream &OS) {
@@ -411,7 +470,7 @@ PreamblePatch PreamblePatch::create(llvm::StringRef FileName,
   //   there's nothing to do but generate an empty patch.
   auto BaselineScan = scanPreamble(
       // Contents needs to be null-terminated.
-      Baseline.Preamble.getContents().str(), Modified.CompileCommand);
+      Baseline.Preamble->getContents().str(), Modified.CompileCommand);
   if (!BaselineScan) {
     elog("Failed to scan baseline of {0}: {1}", FileName,
          BaselineScan.takeError());
@@ -522,7 +581,7 @@ std::vector<Inclusion> PreamblePatch::preambleIncludes() const {
 PreamblePatch PreamblePatch::unmodified(const PreambleData &Preamble) {
   PreamblePatch PP;
   PP.PreambleIncludes = Preamble.Includes.MainFileIncludes;
-  PP.ModifiedBounds = Preamble.Preamble.getBounds();
+  PP.ModifiedBounds = Preamble.Preamble->getBounds();
   return PP;
 }
 
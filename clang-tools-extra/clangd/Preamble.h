@@ -47,7 +47,8 @@ namespace clangd {
 /// As we must avoid re-parsing the preamble, any information that can only
 /// be obtained during parsing must be eagerly captured and stored here.
 struct PreambleData {
-  PreambleData(const ParseInputs &Inputs, PrecompiledPreamble Preamble,
+  PreambleData(const ParseInputs &Inputs,
+               std::shared_ptr<const PrecompiledPreamble> Preamble,
                std::vector<Diag> Diags, IncludeStructure Includes,
                MainFileMacros Macros,
                std::unique_ptr<PreambleFileStatusCache> StatCache,
@@ -56,7 +57,10 @@ struct PreambleData {
   // Version of the ParseInputs this preamble was built from.
   std::string Version;
   tooling::CompileCommand CompileCommand;
-  PrecompiledPreamble Preamble;
+  // May be shared with preambles of other files, see sharePreamble().
+  std::shared_ptr<const PrecompiledPreamble> Preamble;
+  // Whether Preamble was built for another file.
+  bool Borrowed = false;
   std::vector<Diag> Diags;
   // Processes like code completions and go-to-definitions will need #include
   // information, and their compile action skips preamble range.
@@ -91,6 +95,22 @@ bool isPreambleCompatible(const PreambleData &Preamble,
                           const ParseInputs &Inputs, PathRef FileName,
                           const CompilerInvocation &CI);
 
+/// Returns a key that is equal for files which may share a preamble: files in
+/// the same directory, with identical preamble sections and compile commands
+/// that only differ in the name of the file.
+std::string preambleSharingKey(PathRef FileName, const ParseInputs &Inputs,
+                               const CompilerInvocation &CI);
+
+/// Returns a preamble for \p Inputs that reuses the precompiled preamble of
+/// \p Donor, which was built for another file with the same sharing key.
+/// \p DonorMainFile and \p MainFile are the names of the main files in the
+/// compiler invocations. Returns null if \p Donor can't be reused, e.g. because
+/// it depends on the identity of its main file by defining macros.
+std::shared_ptr<const PreambleData>
+sharePreamble(const PreambleData &Donor, llvm::StringRef DonorMainFile,
+              PathRef FileName, const ParseInputs &Inputs,
+              const CompilerInvocation &CI);
+
 /// Stores information required to parse a TU using a (possibly stale) Baseline
 /// preamble. Later on this information can be injected into the main file by
 /// updating compiler invocation with \c apply. This injected section
@@ -179,6 +179,98 @@ private:
   std::vector<KVPair> LRU; /* GUARDED_BY(Mut) */
 };
 
+/// Shares preambles between files whose preamble sections and compile commands
+/// are identical, see preambleSharingKey(). Preambles are found as long as any
+/// file uses them. The most recently built ones are also retained within a
+/// memory budget, so that they can be reused after their files are closed.
+class TUScheduler::PreambleCache {
+public:
+  PreambleCache(std::size_t MaxRetainedBytes)
+      : MaxRetainedBytes(MaxRetainedBytes) {}
+
+  /// Returns a preamble for \p Inputs that reuses a preamble built for another
+  /// file with the same \p Key, or null if there is none.
+  std::shared_ptr<const PreambleData> get(llvm::StringRef Key,
+                                          PathRef FileName,
+                                          const ParseInputs &Inputs,
+                                          const CompilerInvocation &CI) {
+    static constexpr trace::Metric PreambleSharing(
+        "preamble_sharing", trace::Metric::Counter, "result");
+    std::shared_ptr<const PreambleData> Donor;
+    std::string DonorMainFile;
+    {
+      std::lock_guard<std::mutex> Lock(Mut);
+      auto It = Entries.find(Key);
+      if (It != Entries.end()) {
+        Donor = It->second.Preamble.lock();
+        DonorMainFile = It->second.MainFile;
+        if (!Donor)
+          Entries.erase(It);
+      }
+    }
+    // Checking the donor stats files, don't hold the lock.
+    std::shared_ptr<const PreambleData> Result =
+        Donor ? sharePreamble(*Donor, DonorMainFile, FileName, Inputs, CI)
+              : nullptr;
+    PreambleSharing.record(1, Result ? "hit" : "miss");
+    return Result;
+  }
+
+  /// Makes \p Preamble, built for \p MainFile, available to other files.
+  void put(std::string Key, llvm::StringRef MainFile,
+           std::shared_ptr<const PreambleData> Preamble) {
+    std::vector<std::shared_ptr<const PreambleData>> ForCleanup;
+    std::unique_lock<std::mutex> Lock(Mut);
+    // Forget preambles that are no longer used by any file.
+    for (auto It = Entries.begin(); It != Entries.end();) {
+      auto Next = std::next(It);
+      if (It->second.Preamble.expired())
+        Entries.erase(It);
+      It = Next;
+    }
+    Entries[Key] = {Preamble, MainFile.str()};
+    auto Existing = llvm::find_if(
+        LRU, [&](const KVPair &P) { return P.first == Key; });
+    if (Existing != LRU.end()) {
+      RetainedBytes -= Existing->second->Preamble->getSize();
+      ForCleanup.push_back(std::move(Existing->second));
+      LRU.erase(Existing);
+    }
+    RetainedBytes += Preamble->Preamble->getSize();
+    LRU.insert(LRU.begin(), {std::move(Key), std::move(Preamble)});
+    while (RetainedBytes > MaxRetainedBytes) {
+      RetainedBytes -= LRU.back().second->Preamble->getSize();
+      ForCleanup.push_back(std::move(LRU.back().second));
+      LRU.pop_back();
+    }
+    // Run the expensive destructors outside the lock.
+    Lock.unlock();
+    ForCleanup.clear();
+  }
+
+  /// Returns the size of preambles retained for sharing.
+  std::size_t getUsedBytes() {
+    std::lock_guard<std::mutex> Lock(Mut);
+    return RetainedBytes;
+  }
+
+private:
+  struct Entry {
+    std::weak_ptr<const PreambleData> Preamble;
+    /// Name of the main file in the invocation that built Preamble.
+    std::string MainFile;
+  };
+  using KVPair = std::pair<std::string, std::shared_ptr<const PreambleData>>;
+
+  std::mutex Mut;
+  const std::size_t MaxRetainedBytes;
+  llvm::StringMap<Entry> Entries; /* GUARDED_BY(Mut) */
+  /// Retained preambles sorted in LRU order, i.e. first item is the most
+  /// recently built one.
+  std::vector<KVPair> LRU;        /* GUARDED_BY(Mut) */
+  std::size_t RetainedBytes = 0; /* GUARDED_BY(Mut) */
+};
+
 namespace {
 /// Threadsafe manager for updating a TUStatus and emitting it after each
 /// update.
@@ -221,10 +313,11 @@ class PreambleThread {
 public:
   PreambleThread(llvm::StringRef FileName, ParsingCallbacks &Callbacks,
                  bool StorePreambleInMemory, bool RunSync,
+                 TUScheduler::PreambleCache *SharedPreambles,
                  SynchronizedTUStatus &Status, ASTWorker &AW)
       : FileName(FileName), Callbacks(Callbacks),
-        StoreInMemory(StorePreambleInMemory), RunSync(RunSync), Status(Status),
-        ASTPeer(AW) {}
+        StoreInMemory(StorePreambleInMemory), RunSync(RunSync),
+        SharedPreambles(SharedPreambles), Status(Status), ASTPeer(AW) {}
 
   /// It isn't guaranteed that each requested version will be built. If there
   /// are multiple update requests while building a preamble, only the last one
@@ -348,6 +441,8 @@ private:
   ParsingCallbacks &Callbacks;
   const bool StoreInMemory;
   const bool RunSync;
+  // Null if preambles aren't shared between files.
+  TUScheduler::PreambleCache *const SharedPreambles;
 
   SynchronizedTUStatus &Status;
   ASTWorker &ASTPeer;
@@ -368,8 +463,10 @@ class ASTWorkerHandle;
 class ASTWorker {
   friend class ASTWorkerHandle;
   ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-            TUScheduler::ASTCache &LRUCache, Semaphore &Barrier, bool RunSync,
-            const TUScheduler::Options &Opts, ParsingCallbacks &Callbacks);
+            TUScheduler::ASTCache &LRUCache,
+            TUScheduler::PreambleCache *SharedPreambles, Semaphore &Barrier,
+            bool RunSync, const TUScheduler::Options &Opts,
+            ParsingCallbacks &Callbacks);
 
 public:
   /// Create a new ASTWorker and return a handle to it.
@@ -380,6 +477,7 @@ public:
   static ASTWorkerHandle create(PathRef FileName,
                                 const GlobalCompilationDatabase &CDB,
                                 TUScheduler::ASTCache &IdleASTs,
+                                TUScheduler::PreambleCache *SharedPreambles,
                                 AsyncTaskRunner *Tasks, Semaphore &Barrier,
                                 const TUScheduler::Options &Opts,
                                 ParsingCallbacks &Callbacks);
@@ -523,6 +621,7 @@ private:
   bool CanPublishResults = true; /* GUARDED_BY(PublishMu) */
   std::atomic<unsigned> ASTBuildCount = {0};
   std::atomic<unsigned> PreambleBuildCount = {0};
+  std::atomic<unsigned> SharedPreambleCount = {0};
 
   SynchronizedTUStatus Status;
   PreambleThread PreamblePeer;
@@ -573,11 +672,13 @@ private:
 ASTWorkerHandle ASTWorker::create(PathRef FileName,
                                   const GlobalCompilationDatabase &CDB,
                                   TUScheduler::ASTCache &IdleASTs,
+                                  TUScheduler::PreambleCache *SharedPreambles,
                                   AsyncTaskRunner *Tasks, Semaphore &Barrier,
                                   const TUScheduler::Options &Opts,
                                   ParsingCallbacks &Callbacks) {
-  std::shared_ptr<ASTWorker> Worker(new ASTWorker(
-      FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks, Opts, Callbacks));
+  std::shared_ptr<ASTWorker> Worker(
+      new ASTWorker(FileName, CDB, IdleASTs, SharedPreambles, Barrier,
+                    /*RunSync=*/!Tasks, Opts, Callbacks));
   if (Tasks) {
     Tasks->runAsync("ASTWorker:" + llvm::sys::path::filename(FileName),
                     [Worker]() { Worker->run(); });
@@ -589,15 +690,18 @@ ASTWorkerHandle ASTWorker::create(PathRef FileName,
 }
 
 ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-                     TUScheduler::ASTCache &LRUCache, Semaphore &Barrier,
-                     bool RunSync, const TUScheduler::Options &Opts,
+                     TUScheduler::ASTCache &LRUCache,
+                     TUScheduler::PreambleCache *SharedPreambles,
+                     Semaphore &Barrier, bool RunSync,
+                     const TUScheduler::Options &Opts,
                      ParsingCallbacks &Callbacks)
     : IdleASTs(LRUCache), RunSync(RunSync), UpdateDebounce(Opts.UpdateDebounce),
       FileName(FileName), ContextProvider(Opts.ContextProvider), CDB(CDB),
       Callbacks(Callbacks), Barrier(Barrier), Done(false),
       Status(FileName, Callbacks),
       PreamblePeer(FileName, Callbacks, Opts.StorePreamblesInMemory,
-                   RunSync || !Opts.AsyncPreambleBuilds, Status, *this) {
+                   RunSync || !Opts.AsyncPreambleBuilds, SharedPreambles,
+                   Status, *this) {
   // Set a fallback command because compile command can be accessed before
   // `Inputs` is initialized. Other fields are only used after initialization
   // from client inputs.
@@ -771,6 +875,20 @@ void PreambleThread::build(Request Req) {
          FileName, Inputs.Version, LatestBuild->Version);
   }
 
+  std::string SharingKey;
+  if (SharedPreambles) {
+    SharingKey = preambleSharingKey(FileName, Inputs, *Req.CI);
+    if (!Inputs.ForceRebuild) {
+      if (auto Shared =
+              SharedPreambles->get(SharingKey, FileName, Inputs, *Req.CI)) {
+        vlog("Sharing preamble of another file for {0} version {1}", FileName,
+             Inputs.Version);
+        LatestBuild = std::move(Shared);
+        return;
+      }
+    }
+  }
+
   LatestBuild = clang::clangd::buildPreamble(
       FileName, *Req.CI, Inputs, StoreInMemory,
       [this, Version(Inputs.Version)](ASTContext &Ctx,
@@ -779,6 +897,10 @@ void PreambleThread::build(Request Req) {
         Callbacks.onPreambleAST(FileName, Version, Ctx, std::move(PP),
                                 CanonIncludes);
       });
+  if (SharedPreambles && LatestBuild)
+    SharedPreambles->put(std::move(SharingKey),
+                         Req.CI->getFrontendOpts().Inputs[0].getFile(),
+                         LatestBuild);
 }
 
 void ASTWorker::updatePreamble(std::unique_ptr<CompilerInvocation> CI,
@@ -796,6 +918,8 @@ void ASTWorker::updatePreamble(std::unique_ptr<CompilerInvocation> CI,
     // finishes.
     if (!LatestPreamble || Preamble != *LatestPreamble) {
       ++PreambleBuildCount;
+      if (Preamble && Preamble->Borrowed)
+        ++SharedPreambleCount;
       // Cached AST is no longer valid.
       IdleASTs.take(this);
       RanASTCallback = false;
@@ -962,12 +1086,15 @@ TUScheduler::FileStats ASTWorker::stats() const {
   TUScheduler::FileStats Result;
   Result.ASTBuilds = ASTBuildCount;
   Result.PreambleBuilds = PreambleBuildCount;
+  Result.SharedPreambles = SharedPreambleCount;
   // Note that we don't report the size of ASTs currently used for processing
   // the in-flight requests. We used this information for debugging purposes
   // only, so this should be fine.
   Result.UsedBytesAST = IdleASTs.getUsedBytes(this);
-  if (auto Preamble = getPossiblyStalePreamble())
-    Result.UsedBytesPreamble = Preamble->Preamble.getSize();
+  // Shared preambles are accounted to the file that built them.
+  auto Preamble = getPossiblyStalePreamble();
+  if (Preamble && !Preamble->Borrowed)
+    Result.UsedBytesPreamble = Preamble->Preamble->getSize();
   return Result;
 }
 
@@ -1268,6 +1395,9 @@ TUScheduler::TUScheduler(const GlobalCompilationDatabase &CDB,
       Barrier(Opts.AsyncThreadsCount), QuickRunBarrier(Opts.AsyncThreadsCount),
       IdleASTs(
           std::make_unique<ASTCache>(Opts.RetentionPolicy.MaxRetainedASTs)) {
+  if (Opts.SharePreambles)
+    SharedPreambles =
+        std::make_unique<PreambleCache>(Opts.MaxRetainedSharedPreambleBytes);
   // Avoid null checks everywhere.
   if (!Opts.ContextProvider) {
     this->Opts.ContextProvider = [](llvm::StringRef) {
@@ -1309,7 +1439,7 @@ bool TUScheduler::update(PathRef File, ParseInputs Inputs,
   if (!FD) {
     // Create a new worker to process the AST-related tasks.
     ASTWorkerHandle Worker =
-        ASTWorker::create(File, CDB, *IdleASTs,
+        ASTWorker::create(File, CDB, *IdleASTs, SharedPreambles.get(),
                           WorkerThreads ? WorkerThreads.getPointer() : nullptr,
                           Barrier, Opts, *Callbacks);
     FD = std::unique_ptr<FileData>(
@@ -1487,6 +1617,10 @@ void TUScheduler::profile(MemoryTree &MT) const {
                                               : 0);
     MT.detail(Elem.first()).child("ast").addUsage(Elem.second.UsedBytesAST);
   }
+  if (SharedPreambles)
+    MT.child("shared_preambles")
+        .addUsage(Opts.StorePreamblesInMemory ? SharedPreambles->getUsedBytes()
+                                              : 0);
 }
 } // namespace clangd
 } // namespace clang
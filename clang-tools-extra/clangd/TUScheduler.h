@@ -200,6 +200,14 @@ public:
     /// No-op if AsyncThreadsCount is 0.
     bool AsyncPreambleBuilds = true;
 
+    /// Whether files in the same directory, with identical preamble sections
+    /// and compile commands, share a single preamble. Only preambles that
+    /// consist of includes are shared.
+    bool SharePreambles = false;
+    /// Memory budget for preambles retained for sharing after their files are
+    /// closed. The least recently built ones are dropped first.
+    std::size_t MaxRetainedSharedPreambleBytes = 256 * 1024 * 1024;
+
     /// Used to create a context that wraps each single operation.
     /// Typically to inject per-file configuration.
     /// If the path is empty, context sholud be "generic".
@@ -214,6 +222,8 @@ public:
     std::size_t UsedBytesAST = 0;
     std::size_t UsedBytesPreamble = 0;
     unsigned PreambleBuilds = 0;
+    /// How many of PreambleBuilds reused a preamble built for another file.
+    unsigned SharedPreambles = 0;
     unsigned ASTBuilds = 0;
   };
   /// Returns resources used for each of the currently open files.
@@ -314,6 +324,8 @@ public:
   /// Responsible for retaining and rebuilding idle ASTs. An implementation is
   /// an LRU cache.
   class ASTCache;
+  /// Shares preambles between files, see Options::SharePreambles.
+  class PreambleCache;
 
   // The file being built/processed in the current thread. This is a hack in
   // order to get the file name into the index implementations. Do not depend on
@@ -336,6 +348,8 @@ private:
   Semaphore QuickRunBarrier;
   llvm::StringMap<std::unique_ptr<FileData>> Files;
   std::unique_ptr<ASTCache> IdleASTs;
+  // Null unless Opts.SharePreambles is set.
+  std::unique_ptr<PreambleCache> SharedPreambles;
   // None when running tasks synchronously and non-None when running tasks
   // asynchronously.
   llvm::Optional<AsyncTaskRunner> PreambleTasks;
@@ -8,6 +8,8 @@
 
 #include "../index/Serialization.h"
 #include "../index/dex/Dex.h"
+#include "../index/dex/Iterator.h"
+#include "../index/dex/PostingList.h"
 #include "benchmark/benchmark.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -91,13 +93,45 @@ static void DexBuild(benchmark::State &State) {
 }
 BENCHMARK(DexBuild);
 
+static void DexMemoryUsage(benchmark::State &State) {
+  const auto Dex = buildDex();
+  for (auto _ : State)
+    benchmark::DoNotOptimize(Dex->estimateMemoryUsage());
+  State.counters["Bytes"] = Dex->estimateMemoryUsage();
+}
+BENCHMARK(DexMemoryUsage);
+
+// Builds a posting list of every Step-th DocID below Size.
+dex::PostingList buildPostingList(dex::DocID Size, dex::DocID Step) {
+  std::vector<dex::DocID> Docs;
+  for (dex::DocID ID = 0; ID < Size; ID += Step)
+    Docs.push_back(ID);
+  return dex::PostingList(Docs);
+}
+
+// Intersects a dense posting list with a sparse one, which spends its time in
+// advanceTo() skipping over the dense list.
+static void PostingListIntersection(benchmark::State &State) {
+  constexpr dex::DocID Size = 1 << 20;
+  const dex::PostingList Dense = buildPostingList(Size, 3);
+  const dex::PostingList Sparse = buildPostingList(Size, State.range(0));
+  const dex::Corpus Corpus(Size);
+  for (auto _ : State) {
+    std::vector<std::unique_ptr<dex::Iterator>> Children;
+    Children.push_back(Dense.iterator());
+    Children.push_back(Sparse.iterator());
+    auto And = Corpus.intersect(std::move(Children));
+    benchmark::DoNotOptimize(dex::consume(*And));
+  }
+  State.counters["Bytes"] = Dense.bytes() + Sparse.bytes();
+}
+BENCHMARK(PostingListIntersection)->Arg(2)->Arg(97)->Arg(4099);
+
 } // namespace
 } // namespace clangd
 } // namespace clang
 
 // FIXME(kbobyrev): Add index building time benchmarks.
-// FIXME(kbobyrev): Add memory consumption "benchmarks" by manually measuring
-// in-memory index size and reporting it as time.
 // FIXME(kbobyrev): Create a logger wrapper to suppress debugging info printer.
 int main(int argc, char *argv[]) {
   if (argc < 3) {
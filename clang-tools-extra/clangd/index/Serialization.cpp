@@ -20,6 +20,7 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdint>
 #include <vector>
@@ -178,7 +179,7 @@ public:
   // Add a string to the table. Overwrites S if an identical string exists.
   void intern(llvm::StringRef &S) { S = *Unique.insert(S).first; };
   // Finalize the table and write it to OS. No more strings may be added.
-  void finalize(llvm::raw_ostream &OS) {
+  void finalize(llvm::raw_ostream &OS, bool Compress) {
     Sorted = {Unique.begin(), Unique.end()};
     llvm::sort(Sorted);
     for (unsigned I = 0; I < Sorted.size(); ++I)
@@ -189,7 +190,7 @@ public:
       RawTable.append(std::string(S));
       RawTable.push_back(0);
     }
-    if (llvm::zlib::isAvailable()) {
+    if (Compress && llvm::zlib::isAvailable()) {
       llvm::SmallString<1> Compressed;
       llvm::cantFail(llvm::zlib::compress(RawTable, Compressed));
       write32(RawTable.size(), OS);
@@ -207,8 +208,11 @@ public:
   }
 };
 
+// The strings of a table that was read. Strings point into the uncompressed
+// table, which is either part of the input data or owned by Storage, and are
+// null-terminated.
 struct StringTableIn {
-  llvm::BumpPtrAllocator Arena;
+  std::vector<char> Storage;
   std::vector<llvm::StringRef> Strings;
 };
 
@@ -218,8 +222,8 @@ llvm::Expected<StringTableIn> readStringTable(llvm::StringRef Data) {
   if (R.err())
     return error("Truncated string table");
 
+  StringTableIn Table;
   llvm::StringRef Uncompressed;
-  llvm::SmallString<1> UncompressedStorage;
   if (UncompressedSize == 0) // No compression
     Uncompressed = R.rest();
   else if (llvm::zlib::isAvailable()) {
@@ -232,25 +236,25 @@ llvm::Expected<StringTableIn> readStringTable(llvm::StringRef Data) {
       return error("Bad stri table: uncompress {0} -> {1} bytes is implausible",
                    R.rest().size(), UncompressedSize);
 
-    if (llvm::Error E = llvm::zlib::uncompress(R.rest(), UncompressedStorage,
-                                               UncompressedSize))
+    Table.Storage.resize(UncompressedSize);
+    size_t Size = UncompressedSize;
+    if (llvm::Error E =
+            llvm::zlib::uncompress(R.rest(), Table.Storage.data(), Size))
       return std::move(E);
-    Uncompressed = UncompressedStorage;
+    Table.Storage.resize(Size);
+    Uncompressed = llvm::StringRef(Table.Storage.data(), Size);
   } else
     return error("Compressed string table, but zlib is unavailable");
 
-  StringTableIn Table;
-  llvm::StringSaver Saver(Table.Arena);
-  R = Reader(Uncompressed);
+  // Strings are referenced in place rather than copied, so that tables in
+  // mapped files need no memory of their own.
   for (Reader R(Uncompressed); !R.eof();) {
     auto Len = R.rest().find(0);
     if (Len == llvm::StringRef::npos)
       return error("Bad string table: not null terminated");
-    Table.Strings.push_back(Saver.save(R.consume(Len)));
+    Table.Strings.push_back(R.consume(Len));
     R.consume8();
   }
-  if (R.err())
-    return error("Truncated string table");
   return std::move(Table);
 }
 
@@ -454,7 +458,9 @@ readCompileCommand(Reader CmdReader, llvm::ArrayRef<llvm::StringRef> Strings) {
 // data. Later we may want to support some backward compatibility.
 constexpr static uint32_t Version = 16;
 
-llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
+// Checks the file type and version, and returns the chunks keyed by their IDs.
+llvm::Expected<llvm::StringMap<llvm::StringRef>>
+readChunks(llvm::StringRef Data) {
   auto RIFF = riff::readFile(Data);
   if (!RIFF)
     return RIFF.takeError();
@@ -476,6 +482,14 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
   for (llvm::StringRef RequiredChunk : {"stri"})
     if (!Chunks.count(RequiredChunk))
       return error("missing required chunk {0}", RequiredChunk);
+  return std::move(Chunks);
+}
+
+llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
+  auto ChunksOrErr = readChunks(Data);
+  if (!ChunksOrErr)
+    return ChunksOrErr.takeError();
+  const llvm::StringMap<llvm::StringRef> &Chunks = *ChunksOrErr;
 
   auto Strings = readStringTable(Chunks.lookup("stri"));
   if (!Strings)
@@ -544,6 +558,84 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
   return std::move(Result);
 }
 
+// The contents of an index file loaded for serving queries. Unlike readRIFF(),
+// which builds slabs owning copies of all strings, symbols and refs are decoded
+// into flat arrays whose strings point into the string table in place. Unless
+// the table is compressed, it is part of the file contents, which are mapped
+// into memory and can be shared by several processes.
+struct LoadedIndexData {
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  StringTableIn Strings;
+  std::vector<Symbol> Symbols;
+  std::vector<Ref> Refs;
+  // Slices of Refs, grouped by symbol.
+  std::vector<std::pair<SymbolID, llvm::ArrayRef<Ref>>> RefsBySymbol;
+  std::vector<Relation> Relations;
+
+  size_t bytes() const {
+    return Buffer->getBufferSize() + Strings.Storage.capacity() +
+           Strings.Strings.capacity() * sizeof(llvm::StringRef) +
+           Symbols.capacity() * sizeof(Symbol) + Refs.capacity() * sizeof(Ref) +
+           RefsBySymbol.capacity() * sizeof(RefsBySymbol.front()) +
+           Relations.capacity() * sizeof(Relation);
+  }
+};
+
+llvm::Expected<std::unique_ptr<LoadedIndexData>>
+readRIFFInPlace(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  auto Result = std::make_unique<LoadedIndexData>();
+  Result->Buffer = std::move(Buffer);
+  auto ChunksOrErr = readChunks(Result->Buffer->getBuffer());
+  if (!ChunksOrErr)
+    return ChunksOrErr.takeError();
+  const llvm::StringMap<llvm::StringRef> &Chunks = *ChunksOrErr;
+
+  auto Strings = readStringTable(Chunks.lookup("stri"));
+  if (!Strings)
+    return Strings.takeError();
+  Result->Strings = std::move(*Strings);
+  llvm::ArrayRef<llvm::StringRef> StringTable = Result->Strings.Strings;
+
+  // Files are written from slabs, so symbols and refs are already unique.
+  if (Chunks.count("symb")) {
+    Reader SymbolReader(Chunks.lookup("symb"));
+    while (!SymbolReader.eof())
+      Result->Symbols.push_back(readSymbol(SymbolReader, StringTable));
+    if (SymbolReader.err())
+      return error("malformed or truncated symbol");
+    Result->Symbols.shrink_to_fit();
+  }
+  if (Chunks.count("refs")) {
+    Reader RefsReader(Chunks.lookup("refs"));
+    std::vector<std::pair<SymbolID, size_t>> NumRefs;
+    while (!RefsReader.eof()) {
+      auto RefsBundle = readRefs(RefsReader, StringTable);
+      NumRefs.emplace_back(RefsBundle.first, RefsBundle.second.size());
+      Result->Refs.insert(Result->Refs.end(), RefsBundle.second.begin(),
+                          RefsBundle.second.end());
+    }
+    if (RefsReader.err())
+      return error("malformed or truncated refs");
+    // Refs don't move any more, so the slices can be formed.
+    Result->Refs.shrink_to_fit();
+    llvm::ArrayRef<Ref> Refs = Result->Refs;
+    Result->RefsBySymbol.reserve(NumRefs.size());
+    for (const auto &Entry : NumRefs) {
+      Result->RefsBySymbol.emplace_back(Entry.first,
+                                        Refs.take_front(Entry.second));
+      Refs = Refs.drop_front(Entry.second);
+    }
+  }
+  if (Chunks.count("rela")) {
+    Reader RelationsReader(Chunks.lookup("rela"));
+    while (!RelationsReader.eof())
+      Result->Relations.push_back(readRelation(RelationsReader));
+    if (RelationsReader.err())
+      return error("malformed or truncated relations");
+  }
+  return std::move(Result);
+}
+
 template <class Callback>
 void visitStrings(IncludeGraphNode &IGN, const Callback &CB) {
   CB(IGN.URI);
@@ -612,7 +704,7 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
   std::string StringSection;
   {
     llvm::raw_string_ostream StringOS(StringSection);
-    Strings.finalize(StringOS);
+    Strings.finalize(StringOS, Data.CompressStrings);
   }
   RIFF.Chunks.push_back({riff::fourCC("stri"), StringSection});
 
@@ -695,15 +787,63 @@ llvm::Expected<IndexFileIn> readIndexFile(llvm::StringRef Data) {
   }
 }
 
+static void logLoadedIndex(const SymbolIndex &Index, bool UseDex,
+                           llvm::StringRef SymbolFilename, size_t NumSym,
+                           size_t NumRefs, size_t NumRelations) {
+  vlog("Loaded {0} from {1} with estimated memory usage {2} bytes\n"
+       "  - number of symbols: {3}\n"
+       "  - number of refs: {4}\n"
+       "  - number of relations: {5}",
+       UseDex ? "Dex" : "MemIndex", SymbolFilename,
+       Index.estimateMemoryUsage(), NumSym, NumRefs, NumRelations);
+}
+
 std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
                                        bool UseDex) {
   trace::Span OverallTracer("LoadIndex");
-  auto Buffer = llvm::MemoryBuffer::getFile(SymbolFilename);
+  // No null terminator is needed, which allows mapping files of any size.
+  auto Buffer = llvm::MemoryBuffer::getFile(SymbolFilename, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!Buffer) {
     elog("Can't open {0}: {1}", SymbolFilename, Buffer.getError().message());
     return nullptr;
   }
 
+  // Binary files are used in place. Other formats are read into slabs.
+  if (Buffer->get()->getBuffer().startswith("RIFF")) {
+    std::unique_ptr<LoadedIndexData> Data;
+    {
+      trace::Span Tracer("ParseIndex");
+      auto DataOrErr = readRIFFInPlace(std::move(*Buffer));
+      if (!DataOrErr) {
+        elog("Bad index file: {0}", DataOrErr.takeError());
+        return nullptr;
+      }
+      Data = std::move(*DataOrErr);
+    }
+
+    size_t NumSym = Data->Symbols.size();
+    size_t NumRefs = Data->Refs.size();
+    size_t NumRelations = Data->Relations.size();
+    size_t Size = Data->bytes();
+    // The vectors are owned by Data, which is kept alive by the index.
+    const auto &Symbols = Data->Symbols;
+    const auto &Refs = Data->RefsBySymbol;
+    const auto &Relations = Data->Relations;
+
+    trace::Span Tracer("BuildIndex");
+    std::unique_ptr<SymbolIndex> Index;
+    if (UseDex)
+      Index = std::make_unique<dex::Dex>(Symbols, Refs, Relations,
+                                         std::move(Data), Size);
+    else
+      Index = std::make_unique<MemIndex>(Symbols, Refs, Relations,
+                                         std::move(Data), Size);
+    logLoadedIndex(*Index, UseDex, SymbolFilename, NumSym, NumRefs,
+                   NumRelations);
+    return Index;
+  }
+
   SymbolSlab Symbols;
   RefSlab Refs;
   RelationSlab Relations;
@@ -731,12 +871,8 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
                                         std::move(Relations))
                       : MemIndex::build(std::move(Symbols), std::move(Refs),
                                         std::move(Relations));
-  vlog("Loaded {0} from {1} with estimated memory usage {2} bytes\n"
-       "  - number of symbols: {3}\n"
-       "  - number of refs: {4}\n"
-       "  - number of relations: {5}",
-       UseDex ? "Dex" : "MemIndex", SymbolFilename,
-       Index->estimateMemoryUsage(), NumSym, NumRefs, NumRelations);
+  logLoadedIndex(*Index, UseDex, SymbolFilename, NumSym, NumRefs,
+                 NumRelations);
   return Index;
 }
 
@@ -61,6 +61,9 @@ struct IndexFileOut {
   // TODO: Support serializing Dex posting lists.
   IndexFileFormat Format = IndexFileFormat::RIFF;
   const tooling::CompileCommand *Cmd = nullptr;
+  // Whether the RIFF string table is compressed. Uncompressed files are larger,
+  // but loadIndex() uses their strings in place instead of copying them.
+  bool CompressStrings = true;
 
   IndexFileOut() = default;
   IndexFileOut(const IndexFileIn &I)
@@ -86,7 +89,9 @@ llvm::Expected<clangd::Ref> refFromYAML(StringRef YAML,
                                         llvm::UniqueStringSaver *Strings);
 
 // Build an in-memory static index from an index file.
-// The size should be relatively small, so data can be managed in memory.
+// Binary files are mapped into memory, and the index refers to their strings
+// in place if the string table is not compressed. Other formats are read into
+// slabs, so their size should be relatively small.
 std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef Filename,
                                        bool UseDex = true);
 
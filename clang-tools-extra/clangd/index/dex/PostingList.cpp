@@ -10,54 +10,138 @@
 #include "Iterator.h"
 #include "Token.h"
 #include "llvm/ADT/STLExtras.h"
-#include "llvm/Support/Error.h"
 #include "llvm/Support/MathExtras.h"
+#include <array>
 
 namespace clang {
 namespace clangd {
 namespace dex {
 namespace {
 
-/// Implements iterator of PostingList chunks. This requires iterating over two
-/// levels: the first level iterator iterates over the chunks and decompresses
-/// them on-the-fly when the contents of chunk are to be seen.
-class ChunkIterator : public Iterator {
-public:
-  explicit ChunkIterator(const Token *Tok, llvm::ArrayRef<Chunk> Chunks)
-      : Tok(Tok), Chunks(Chunks), CurrentChunk(Chunks.begin()) {
-    if (!Chunks.empty()) {
-      DecompressedChunk = CurrentChunk->decompress();
-      CurrentID = DecompressedChunk.begin();
+/// Maximum number of DocIDs in a single block.
+constexpr unsigned BlockSize = 128;
+/// Words of PostingList data preceding the per-block arrays.
+constexpr size_t HeaderSize = 2;
+/// Descriptor layout: number of DocIDs in the block minus one in the low byte,
+/// packing width (or BitmapWidth) in the next one.
+constexpr unsigned BitmapWidth = 0xff;
+
+/// View over the encoded representation of a PostingList.
+///
+/// Data[0]                   number of blocks N
+/// Data[1]                   total number of DocIDs
+/// Data[2, 2 + N)            first DocID of every block (skip pointers)
+/// Data[2 + N, 2 + 2N)       block descriptors
+/// Data[2 + 2N, 2 + 3N)      offset of every block payload in Payload
+/// Data[2 + 3N, ...)         Payload
+///
+/// A block with width W stores Count - 1 values (Doc[I] - Doc[I - 1] - 1)
+/// packed into W bits each, so a run of consecutive DocIDs has W = 0 and takes
+/// no payload at all. A bitmap block instead stores a bit for each of the
+/// DocIDs following its first one, which is smaller when the gaps are short
+/// but irregular. Payload is followed by a padding word if it is not empty so
+/// that unpacking can always read two adjacent words.
+struct Layout {
+  explicit Layout(llvm::ArrayRef<uint32_t> Data) {
+    const size_t NumBlocks = Data[0];
+    Size = Data[1];
+    Data = Data.drop_front(HeaderSize);
+    Heads = Data.take_front(NumBlocks);
+    Descriptors = Data.slice(NumBlocks, NumBlocks);
+    Offsets = Data.slice(2 * NumBlocks, NumBlocks);
+    Payload = Data.drop_front(3 * NumBlocks);
+  }
+
+  size_t Size;
+  llvm::ArrayRef<DocID> Heads;
+  llvm::ArrayRef<uint32_t> Descriptors;
+  llvm::ArrayRef<uint32_t> Offsets;
+  llvm::ArrayRef<uint32_t> Payload;
+
+  /// Decompresses block B into Out and returns the number of DocIDs in it.
+  unsigned decode(size_t B, std::array<DocID, BlockSize> &Out) const {
+    const unsigned Count = (Descriptors[B] & 0xff) + 1;
+    const unsigned Width = (Descriptors[B] >> 8) & 0xff;
+    const uint32_t *Words = Payload.data() + Offsets[B];
+    const DocID Head = Heads[B];
+    Out[0] = Head;
+    if (Width == 0) {
+      // Consecutive DocIDs, written so that the loop can be vectorized.
+      for (unsigned I = 1; I < Count; ++I)
+        Out[I] = Head + I;
+    } else if (Width == BitmapWidth) {
+      unsigned I = 1;
+      for (size_t W = 0; I < Count; ++W)
+        for (uint32_t Bits = Words[W]; Bits != 0; Bits &= Bits - 1)
+          Out[I++] = Head + 1 + W * 32 + llvm::countTrailingZeros(Bits);
+    } else {
+      const uint64_t Mask = (uint64_t(1) << Width) - 1;
+      DocID Current = Head;
+      for (unsigned I = 1, Bit = 0; I < Count; ++I, Bit += Width) {
+        const uint32_t *W = Words + Bit / 32;
+        uint64_t Pair = W[0] | (uint64_t(W[1]) << 32);
+        Current += ((Pair >> (Bit % 32)) & Mask) + 1;
+        Out[I] = Current;
+      }
     }
+    return Count;
+  }
+};
+
+/// Implements iterator of PostingList blocks. The blocks are only decompressed
+/// when their contents are to be seen: advanceTo() uses first DocIDs of blocks
+/// as skip pointers to find the only block which can contain the target.
+class BlockIterator : public Iterator {
+public:
+  explicit BlockIterator(const Token *Tok, llvm::ArrayRef<uint32_t> Data)
+      : Tok(Tok), L(Data) {
+    if (!reachedEnd())
+      load(0);
   }
 
-  bool reachedEnd() const override { return CurrentChunk == Chunks.end(); }
+  bool reachedEnd() const override { return Block == L.Heads.size(); }
 
   /// Advances cursor to the next item.
   void advance() override {
     assert(!reachedEnd() &&
            "Posting List iterator can't advance() at the end.");
-    ++CurrentID;
-    normalizeCursor();
+    if (++Position == Count)
+      nextBlock();
   }
 
-  /// Applies binary search to advance cursor to the next item with DocID
-  /// equal or higher than the given one.
+  /// Skips to the block which might contain ID and advances cursor to the next
+  /// item with DocID equal or higher than the given one.
   void advanceTo(DocID ID) override {
     assert(!reachedEnd() &&
            "Posting List iterator can't advance() at the end.");
     if (ID <= peek())
       return;
-    advanceToChunk(ID);
-    // Try to find ID within current chunk.
-    CurrentID = std::partition_point(CurrentID, DecompressedChunk.end(),
-                                     [&](const DocID D) { return D < ID; });
-    normalizeCursor();
+    if (ID > Decoded[Count - 1]) {
+      // The last block with Head <= ID, which is at least the current one.
+      auto Next = std::partition_point(L.Heads.begin() + Block + 1,
+                                       L.Heads.end(),
+                                       [&](DocID Head) { return Head <= ID; });
+      size_t Target = Next - L.Heads.begin() - 1;
+      if (Target == Block) {
+        // ID falls between this block and the next one.
+        nextBlock();
+        return;
+      }
+      load(Target);
+    }
+    // A branch-free count instead of a binary search: blocks are small and
+    // this loop is vectorized by the compiler.
+    unsigned Smaller = 0;
+    for (unsigned I = Position; I < Count; ++I)
+      Smaller += Decoded[I] < ID;
+    Position += Smaller;
+    if (Position == Count)
+      nextBlock();
   }
 
   DocID peek() const override {
     assert(!reachedEnd() && "Posting List iterator can't peek() at the end.");
-    return *CurrentID;
+    return Decoded[Position];
   }
 
   float consume() override {
@@ -66,9 +150,7 @@ public:
     return 1;
   }
 
-  size_t estimateSize() const override {
-    return Chunks.size() * ApproxEntriesPerChunk;
-  }
+  size_t estimateSize() const override { return L.Size; }
 
 private:
   llvm::raw_ostream &dump(llvm::raw_ostream &OS) const override {
@@ -76,151 +158,118 @@ private:
       return OS << *Tok;
     OS << '[';
     const char *Sep = "";
-    for (const Chunk &C : Chunks)
-      for (const DocID Doc : C.decompress()) {
-        OS << Sep << Doc;
+    std::array<DocID, BlockSize> Docs;
+    for (size_t B = 0; B < L.Heads.size(); ++B) {
+      unsigned N = L.decode(B, Docs);
+      for (unsigned I = 0; I < N; ++I) {
+        OS << Sep << Docs[I];
         Sep = " ";
       }
+    }
     return OS << ']';
   }
 
-  /// If the cursor is at the end of a chunk, place it at the start of the next
-  /// chunk.
-  void normalizeCursor() {
-    // Invariant is already established if examined chunk is not exhausted.
-    if (CurrentID != std::end(DecompressedChunk))
-      return;
-    // Advance to next chunk if current one is exhausted.
-    ++CurrentChunk;
-    if (CurrentChunk == Chunks.end()) // Reached the end of PostingList.
-      return;
-    DecompressedChunk = CurrentChunk->decompress();
-    CurrentID = DecompressedChunk.begin();
+  void load(size_t B) {
+    Block = B;
+    Count = L.decode(Block, Decoded);
+    Position = 0;
   }
 
-  /// Advances CurrentChunk to the chunk which might contain ID.
-  void advanceToChunk(DocID ID) {
-    if ((CurrentChunk != Chunks.end() - 1) &&
-        ((CurrentChunk + 1)->Head <= ID)) {
-      CurrentChunk =
-          std::partition_point(CurrentChunk + 1, Chunks.end(),
-                               [&](const Chunk &C) { return C.Head < ID; });
-      --CurrentChunk;
-      DecompressedChunk = CurrentChunk->decompress();
-      CurrentID = DecompressedChunk.begin();
-    }
+  void nextBlock() {
+    if (++Block != L.Heads.size())
+      load(Block);
   }
 
   const Token *Tok;
-  llvm::ArrayRef<Chunk> Chunks;
-  /// Iterator over chunks.
-  /// If CurrentChunk is valid, then DecompressedChunk is
-  /// CurrentChunk->decompress() and CurrentID is a valid (non-end) iterator
-  /// into it.
-  decltype(Chunks)::const_iterator CurrentChunk;
-  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> DecompressedChunk;
-  /// Iterator over DecompressedChunk.
-  decltype(DecompressedChunk)::iterator CurrentID;
-
-  static constexpr size_t ApproxEntriesPerChunk = 15;
+  Layout L;
+  /// Index of the current block.
+  /// If Block is valid, then Decoded holds its first Count DocIDs and Position
+  /// is less than Count.
+  size_t Block = 0;
+  unsigned Position = 0;
+  unsigned Count = 0;
+  std::array<DocID, BlockSize> Decoded;
 };
 
-static constexpr size_t BitsPerEncodingByte = 7;
-
-/// Writes a variable length DocID into the buffer and updates the buffer size.
-/// If it doesn't fit, returns false and doesn't write to the buffer.
-bool encodeVByte(DocID Delta, llvm::MutableArrayRef<uint8_t> &Payload) {
-  assert(Delta != 0 && "0 is not a valid PostingList delta.");
-  // Calculate number of bytes Delta encoding would take by examining the
-  // meaningful bits.
-  unsigned Width = 1 + llvm::findLastSet(Delta) / BitsPerEncodingByte;
-  if (Width > Payload.size())
-    return false;
-
-  do {
-    uint8_t Encoding = Delta & 0x7f;
-    Delta >>= 7;
-    Payload.front() = Delta ? Encoding | 0x80 : Encoding;
-    Payload = Payload.drop_front();
-  } while (Delta != 0);
-  return true;
+/// Appends the block of Docs to the encoding and returns its descriptor.
+uint32_t encodeBlock(llvm::ArrayRef<DocID> Docs,
+                     std::vector<uint32_t> &Payload) {
+  DocID MaxGap = 0;
+  for (size_t I = 1; I < Docs.size(); ++I) {
+    assert(Docs[I] > Docs[I - 1] && "DocIDs must be sorted and unique.");
+    MaxGap = std::max(MaxGap, Docs[I] - Docs[I - 1] - 1);
+  }
+  const uint32_t Descriptor = Docs.size() - 1;
+  if (MaxGap == 0)
+    return Descriptor;
+
+  const unsigned Width = 32 - llvm::countLeadingZeros(MaxGap);
+  const uint64_t PackedWords = ((Docs.size() - 1) * Width + 31) / 32;
+  const uint64_t BitmapWords = (uint64_t(Docs.back()) - Docs.front() + 31) / 32;
+  if (BitmapWords < PackedWords) {
+    size_t Start = Payload.size();
+    Payload.resize(Start + BitmapWords);
+    for (DocID Doc : Docs.drop_front()) {
+      DocID Bit = Doc - Docs.front() - 1;
+      Payload[Start + Bit / 32] |= uint32_t(1) << (Bit % 32);
+    }
+    return Descriptor | (BitmapWidth << 8);
+  }
+
+  size_t Start = Payload.size();
+  Payload.resize(Start + PackedWords);
+  uint64_t Bit = 0;
+  for (size_t I = 1; I < Docs.size(); ++I, Bit += Width) {
+    uint64_t Value = uint64_t(Docs[I] - Docs[I - 1] - 1) << (Bit % 32);
+    Payload[Start + Bit / 32] |= uint32_t(Value);
+    if (Value >> 32)
+      Payload[Start + Bit / 32 + 1] |= uint32_t(Value >> 32);
+  }
+  return Descriptor | (Width << 8);
 }
 
-/// Use Variable-length Byte (VByte) delta encoding to compress sorted list of
-/// DocIDs. The compression stores deltas (differences) between subsequent
-/// DocIDs and encodes these deltas utilizing the least possible number of
-/// bytes.
-///
-/// Each encoding byte consists of two parts: the first bit (continuation bit)
-/// indicates whether this is the last byte (0 if this byte is the last) of
-/// current encoding and seven bytes a piece of DocID (payload). DocID contains
-/// 32 bits and therefore it takes up to 5 bytes to encode it (4 full 7-bit
-/// payloads and one 4-bit payload), but in practice it is expected that gaps
-/// (deltas) between subsequent DocIDs are not large enough to require 5 bytes.
-/// In very dense posting lists (with average gaps less than 128) this
-/// representation would be 4 times more efficient than raw DocID array.
+/// Splits sorted list of DocIDs into blocks of BlockSize and compresses each of
+/// them with whichever of bit-packed gaps (frame of reference) or bitmap is
+/// smaller. Both representations allow decoding the whole block with a simple
+/// loop, which is much faster than decoding variable length integers one byte
+/// at a time.
 ///
 /// PostingList encoding example:
 ///
-/// DocIDs    42            47        7000
-/// gaps                    5         6958
-/// Encoding  (raw number)  00000101  10110110 00101110
-std::vector<Chunk> encodeStream(llvm::ArrayRef<DocID> Documents) {
-  assert(!Documents.empty() && "Can't encode empty sequence.");
-  std::vector<Chunk> Result;
-  Result.emplace_back();
-  DocID Last = Result.back().Head = Documents.front();
-  llvm::MutableArrayRef<uint8_t> RemainingPayload = Result.back().Payload;
-  for (DocID Doc : Documents.drop_front()) {
-    if (!encodeVByte(Doc - Last, RemainingPayload)) { // didn't fit, flush chunk
-      Result.emplace_back();
-      Result.back().Head = Doc;
-      RemainingPayload = Result.back().Payload;
-    }
-    Last = Doc;
+/// DocIDs         42 43 44 45 50 52
+/// stored values     0  0  0  4  1
+/// Encoding       Head = 42, Width = 3, 5 values of 3 bits in one word
+std::vector<uint32_t> encodeStream(llvm::ArrayRef<DocID> Documents) {
+  const size_t NumBlocks = (Documents.size() + BlockSize - 1) / BlockSize;
+  std::vector<uint32_t> Heads, Descriptors, Offsets, Payload;
+  for (size_t Start = 0; Start < Documents.size(); Start += BlockSize) {
+    llvm::ArrayRef<DocID> Docs = Documents.slice(
+        Start, std::min<size_t>(BlockSize, Documents.size() - Start));
+    Heads.push_back(Docs.front());
+    Offsets.push_back(Payload.size());
+    Descriptors.push_back(encodeBlock(Docs, Payload));
   }
-  return std::vector<Chunk>(Result); // no move, shrink-to-fit
-}
+  if (!Payload.empty())
+    Payload.push_back(0); // Padding for reading adjacent words.
 
-/// Reads variable length DocID from the buffer and updates the buffer size. If
-/// the stream is terminated, return None.
-llvm::Optional<DocID> readVByte(llvm::ArrayRef<uint8_t> &Bytes) {
-  if (Bytes.front() == 0 || Bytes.empty())
-    return None;
-  DocID Result = 0;
-  bool HasNextByte = true;
-  for (size_t Length = 0; HasNextByte && !Bytes.empty(); ++Length) {
-    assert(Length <= 5 && "Malformed VByte encoding sequence.");
-    // Write meaningful bits to the correct place in the document decoding.
-    Result |= (Bytes.front() & 0x7f) << (BitsPerEncodingByte * Length);
-    if ((Bytes.front() & 0x80) == 0)
-      HasNextByte = false;
-    Bytes = Bytes.drop_front();
-  }
+  std::vector<uint32_t> Result;
+  Result.reserve(HeaderSize + 3 * NumBlocks + Payload.size());
+  Result.push_back(NumBlocks);
+  Result.push_back(Documents.size());
+  Result.insert(Result.end(), Heads.begin(), Heads.end());
+  Result.insert(Result.end(), Descriptors.begin(), Descriptors.end());
+  Result.insert(Result.end(), Offsets.begin(), Offsets.end());
+  Result.insert(Result.end(), Payload.begin(), Payload.end());
   return Result;
 }
 
 } // namespace
 
-llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Chunk::decompress() const {
-  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result{Head};
-  llvm::ArrayRef<uint8_t> Bytes(Payload);
-  DocID Delta;
-  for (DocID Current = Head; !Bytes.empty(); Current += Delta) {
-    auto MaybeDelta = readVByte(Bytes);
-    if (!MaybeDelta)
-      break;
-    Delta = *MaybeDelta;
-    Result.push_back(Current + Delta);
-  }
-  return llvm::SmallVector<DocID, Chunk::PayloadSize + 1>{Result};
-}
-
 PostingList::PostingList(llvm::ArrayRef<DocID> Documents)
-    : Chunks(encodeStream(Documents)) {}
+    : Data(encodeStream(Documents)) {}
 
 std::unique_ptr<Iterator> PostingList::iterator(const Token *Tok) const {
-  return std::make_unique<ChunkIterator>(Tok, Chunks);
+  return std::make_unique<BlockIterator>(Tok, Data);
 }
 
 } // namespace dex
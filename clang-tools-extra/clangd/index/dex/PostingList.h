@@ -13,10 +13,14 @@
 /// traversed in order using an iterator and are values for inverted index,
 /// which maps search tokens to corresponding posting lists.
 ///
-/// In order to decrease size of Index in-memory representation, Variable Byte
-/// Encoding (VByte) is used for PostingLists compression. An overview of VByte
-/// algorithm can be found in "Introduction to Information Retrieval" book:
-/// https://nlp.stanford.edu/IR-book/html/htmledition/variable-byte-codes-1.html
+/// In order to decrease size of Index in-memory representation, DocIDs are
+/// split into blocks of up to 128 entries which are compressed independently.
+/// Each block stores the gaps between its DocIDs either bit-packed with the
+/// smallest width that fits the largest gap (frame-of-reference encoding, as
+/// in PForDelta) or, for dense blocks, as a bitmap relative to the first DocID
+/// (as in roaring bitmap containers). The first DocID of every block is kept
+/// uncompressed in a separate array which serves as skip pointers: advancing
+/// to a far away DocID only decodes the single block which can contain it.
 ///
 //===----------------------------------------------------------------------===//
 
@@ -25,7 +29,6 @@
 
 #include "Iterator.h"
 #include "llvm/ADT/ArrayRef.h"
-#include "llvm/ADT/SmallVector.h"
 #include <cstdint>
 #include <vector>
 
@@ -34,42 +37,28 @@ namespace clangd {
 namespace dex {
 class Token;
 
-/// NOTE: This is an implementation detail.
-///
-/// Chunk is a fixed-width piece of PostingList which contains the first DocID
-/// in uncompressed format (Head) and delta-encoded Payload. It can be
-/// decompressed upon request.
-struct Chunk {
-  /// Keep sizeof(Chunk) == 32.
-  static constexpr size_t PayloadSize = 32 - sizeof(DocID);
-
-  llvm::SmallVector<DocID, PayloadSize + 1> decompress() const;
-
-  /// The first element of decompressed Chunk.
-  DocID Head;
-  /// VByte-encoded deltas.
-  std::array<uint8_t, PayloadSize> Payload;
-};
-static_assert(sizeof(Chunk) == 32, "Chunk should take 32 bytes of memory.");
-
 /// PostingList is the storage of DocIDs which can be inserted to the Query
 /// Tree as a leaf by constructing Iterator over the PostingList object. DocIDs
-/// are stored in underlying chunks. Compression saves memory at a small cost
+/// are stored in compressed blocks. Compression saves memory at a small cost
 /// in access time, which is still fast enough in practice.
 class PostingList {
 public:
   explicit PostingList(llvm::ArrayRef<DocID> Documents);
 
   /// Constructs DocumentIterator over given posting list. DocumentIterator will
-  /// go through the chunks and decompress them on-the-fly when necessary.
+  /// skip over blocks using their first DocIDs and decompress only the blocks
+  /// whose contents are to be seen.
   /// If given, Tok is only used for the string representation.
   std::unique_ptr<Iterator> iterator(const Token *Tok = nullptr) const;
 
   /// Returns in-memory size of external storage.
-  size_t bytes() const { return Chunks.capacity() * sizeof(Chunk); }
+  size_t bytes() const { return Data.capacity() * sizeof(uint32_t); }
 
 private:
-  const std::vector<Chunk> Chunks;
+  /// Number of blocks, number of DocIDs, then for every block its first
+  /// DocID, its descriptor and the offset of its payload, followed by the
+  /// payloads of all blocks. See PostingList.cpp for details.
+  const std::vector<uint32_t> Data;
 };
 
 } // namespace dex
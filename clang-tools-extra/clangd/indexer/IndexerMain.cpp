@@ -36,6 +36,13 @@ static llvm::cl::opt<IndexFileFormat>
                                        "binary RIFF format")),
            llvm::cl::init(IndexFileFormat::RIFF));
 
+static llvm::cl::opt<bool> CompressStrings(
+    "compress-strings",
+    llvm::cl::desc("Compress the string table of binary indexes. Uncompressed "
+                   "indexes are larger, but clangd uses their strings in place "
+                   "from the mapped file instead of loading them into memory"),
+    llvm::cl::init(true));
+
 class IndexActionFactory : public tooling::FrontendActionFactory {
 public:
   IndexActionFactory(IndexFileIn &Result) : Result(Result) {}
@@ -143,6 +150,7 @@ int main(int argc, const char **argv) {
   // Emit collected data.
   clang::clangd::IndexFileOut Out(Data);
   Out.Format = clang::clangd::Format;
+  Out.CompressStrings = clang::clangd::CompressStrings;
   llvm::outs() << Out;
   return 0;
 }
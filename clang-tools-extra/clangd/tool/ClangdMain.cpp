@@ -460,6 +460,15 @@ opt<bool> AsyncPreamble{
     Hidden,
 };
 
+opt<bool> SharePreambles{
+    "share-preambles",
+    cat(Misc),
+    desc("Share a single preamble between files in the same directory whose "
+         "preamble sections and compile commands are identical"),
+    init(ClangdServer::Options().SharePreambles),
+    Hidden,
+};
+
 opt<bool> EnableConfig{
     "enable-config",
     cat(Misc),
@@ -861,6 +870,7 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
     Opts.ClangTidyProvider = ClangTidyOptProvider;
   }
   Opts.AsyncPreambleBuilds = AsyncPreamble;
+  Opts.SharePreambles = SharePreambles;
   Opts.QueryDriverGlobs = std::move(QueryDriverGlobs);
   Opts.TweakFilter = [&](const Tweak &T) {
     if (T.hidden() && !HiddenFeatures)
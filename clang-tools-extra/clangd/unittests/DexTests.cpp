@@ -20,6 +20,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -68,6 +69,46 @@ TEST(DexIterators, DocumentIterator) {
   EXPECT_TRUE(DocIterator->reachedEnd());
 }
 
+TEST(DexIterators, DocumentIteratorMultipleBlocks) {
+  // Consecutive runs, dense irregular gaps, and large gaps use different
+  // block encodings.
+  std::vector<DocID> Docs;
+  for (DocID I = 0; I < 300; ++I)
+    Docs.push_back(I);
+  for (DocID I = 400; I < 1000; I += 1 + I % 3)
+    Docs.push_back(I);
+  for (DocID I = 1000; I < 2000000; I += 7919)
+    Docs.push_back(I);
+  Docs.push_back(std::numeric_limits<DocID>::max());
+  const PostingList L(Docs);
+
+  auto DocIterator = L.iterator();
+  EXPECT_EQ(DocIterator->estimateSize(), Docs.size());
+  EXPECT_EQ(consumeIDs(*DocIterator), Docs);
+
+  DocIterator = L.iterator();
+  DocIterator->advanceTo(299);
+  EXPECT_EQ(DocIterator->peek(), 299U);
+  DocIterator->advanceTo(300);
+  EXPECT_EQ(DocIterator->peek(), 400U);
+  DocIterator->advance();
+  EXPECT_EQ(DocIterator->peek(), 402U);
+  DocIterator->advanceTo(1000 + 7919 * 100 + 1);
+  EXPECT_EQ(DocIterator->peek(), 1000U + 7919 * 101);
+  DocIterator->advanceTo(2000000);
+  EXPECT_EQ(DocIterator->peek(), std::numeric_limits<DocID>::max());
+  DocIterator->advance();
+  EXPECT_TRUE(DocIterator->reachedEnd());
+
+  // Every DocID can be found by advanceTo() from the start.
+  for (DocID Doc : Docs) {
+    DocIterator = L.iterator();
+    DocIterator->advanceTo(Doc);
+    ASSERT_FALSE(DocIterator->reachedEnd());
+    EXPECT_EQ(DocIterator->peek(), Doc);
+  }
+}
+
 TEST(DexIterators, AndTwoLists) {
   Corpus C{10000};
   const PostingList L0({0, 5, 7, 10, 42, 320, 9000});
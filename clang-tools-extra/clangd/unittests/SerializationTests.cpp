@@ -16,6 +16,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -235,6 +236,48 @@ TEST(SerializationTest, BinaryConversions) {
               UnorderedElementsAreArray(YAMLFromRelations(*In->Relations)));
 }
 
+TEST(SerializationTest, LoadIndex) {
+  auto In = readIndexFile(YAML);
+  ASSERT_TRUE(bool(In)) << In.takeError();
+
+  for (bool Compress : {false, true}) {
+    // Write to a binary file, and load it as an index.
+    int FD;
+    llvm::SmallString<128> Path;
+    ASSERT_FALSE(
+        llvm::sys::fs::createTemporaryFile("clangd-index", "idx", FD, Path));
+    auto Cleanup = llvm::make_scope_exit([&] { llvm::sys::fs::remove(Path); });
+    {
+      IndexFileOut Out(*In);
+      Out.Format = IndexFileFormat::RIFF;
+      Out.CompressStrings = Compress;
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      OS << Out;
+    }
+    auto Index = loadIndex(Path, /*UseDex=*/true);
+    ASSERT_TRUE(Index) << Compress;
+
+    LookupRequest Lookup;
+    std::vector<std::string> Expected;
+    for (const Symbol &Sym : *In->Symbols) {
+      Lookup.IDs.insert(Sym.ID);
+      Expected.push_back(toYAML(Sym));
+    }
+    std::vector<std::string> Loaded;
+    Index->lookup(Lookup,
+                  [&](const Symbol &Sym) { Loaded.push_back(toYAML(Sym)); });
+    EXPECT_THAT(Loaded, UnorderedElementsAreArray(Expected));
+
+    RefsRequest Refs;
+    Refs.IDs.insert(cantFail(SymbolID::fromStr("057557CEBF6E6B2D")));
+    std::vector<std::string> LoadedRefs;
+    Index->refs(Refs, [&](const Ref &R) {
+      LoadedRefs.push_back(R.Location.FileURI);
+    });
+    EXPECT_THAT(LoadedRefs, ElementsAre("file:///path/foo.cc"));
+  }
+}
+
 TEST(SerializationTest, SrcsTest) {
   auto In = readIndexFile(YAML);
   EXPECT_TRUE(bool(In)) << In.takeError();
@@ -678,7 +678,7 @@ TEST_F(TUSchedulerTests, EmptyPreamble) {
       [&](Expected<InputsAndPreamble> Preamble) {
         // We expect to get a non-empty preamble.
         EXPECT_GT(
-            cantFail(std::move(Preamble)).Preamble->Preamble.getBounds().Size,
+            cantFail(std::move(Preamble)).Preamble->Preamble->getBounds().Size,
             0u);
       });
   // Wait while the preamble is being built.
@@ -693,7 +693,7 @@ TEST_F(TUSchedulerTests, EmptyPreamble) {
       [&](Expected<InputsAndPreamble> Preamble) {
         // We expect to get an empty preamble.
         EXPECT_EQ(
-            cantFail(std::move(Preamble)).Preamble->Preamble.getBounds().Size,
+            cantFail(std::move(Preamble)).Preamble->Preamble->getBounds().Size,
             0u);
       });
 }
@@ -825,6 +825,48 @@ TEST_F(TUSchedulerTests, NoopOnEmptyChanges) {
   ASSERT_EQ(S.fileStats().lookup(Source).PreambleBuilds, 3u);
 }
 
+TEST_F(TUSchedulerTests, SharesPreambles) {
+  auto Opts = optsForTest();
+  Opts.SharePreambles = true;
+  TUScheduler S(CDB, Opts);
+
+  auto Header = testPath("foo.h");
+  FS.Files[Header] = "int a;";
+  FS.Timestamps[Header] = time_t(0);
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  S.update(Foo, getInputs(Foo, "#include \"foo.h\"\nint b = a;"),
+           WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  S.update(Bar, getInputs(Bar, "#include \"foo.h\"\nint c = a;"),
+           WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+
+  auto Stats = S.fileStats();
+  EXPECT_EQ(Stats.lookup(Foo).SharedPreambles, 0u);
+  EXPECT_NE(Stats.lookup(Foo).UsedBytesPreamble, 0u);
+  EXPECT_EQ(Stats.lookup(Bar).PreambleBuilds, 1u);
+  EXPECT_EQ(Stats.lookup(Bar).SharedPreambles, 1u);
+  EXPECT_EQ(Stats.lookup(Bar).UsedBytesPreamble, 0u);
+  S.runWithAST("", Bar, [&](llvm::Expected<InputsAndAST> AST) {
+    ASSERT_TRUE(bool(AST));
+    EXPECT_THAT(AST->AST.getDiagnostics(), IsEmpty());
+  });
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+
+  // Macros defined in the preamble belong to the main file, so preambles that
+  // define any aren't shared.
+  auto Baz = testPath("baz.cpp");
+  auto Qux = testPath("qux.cpp");
+  S.update(Baz, getInputs(Baz, "#define X\n#include \"foo.h\"\nint d = a;"),
+           WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  S.update(Qux, getInputs(Qux, "#define X\n#include \"foo.h\"\nint e = a;"),
+           WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_EQ(S.fileStats().lookup(Qux).SharedPreambles, 0u);
+}
+
 // We rebuild if a completely missing header exists, but not if one is added
 // on a higher-priority include path entry (for performance).
 // (Previously we wouldn't automatically rebuild when files were added).
@@ -0,0 +1,132 @@
+//===--- ConstexprBenchmark.cpp - Constant evaluator benchmarks -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "benchmark/benchmark.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <string>
+
+using namespace clang;
+
+const char *InputFilename;
+
+namespace {
+
+// Loops, calls, arrays and pointers, which both evaluators support.
+const char *DefaultInput = R"cpp(
+constexpr int fib(int N) { return N < 2 ? N : fib(N - 1) + fib(N - 2); }
+
+constexpr int collatzSteps(int Limit) {
+  int Steps = 0;
+  for (int I = 1; I <= Limit; ++I) {
+    int N = I;
+    while (N != 1) {
+      N = N % 2 == 0 ? N / 2 : 3 * N + 1;
+      ++Steps;
+    }
+  }
+  return Steps;
+}
+
+constexpr int sum(const int *Begin, const int *End) {
+  int Sum = 0;
+  while (Begin != End)
+    Sum += *Begin++;
+  return Sum;
+}
+
+constexpr int prefixSums(int Rounds) {
+  int Values[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  int Total = 0;
+  for (int R = 0; R < Rounds; ++R)
+    for (int I = 0; I < 8; ++I)
+      Total += sum(Values, Values + I) % 97;
+  return Total;
+}
+
+int Bench = fib(15) + collatzSteps(200) + prefixSums(50);
+)cpp";
+
+std::string readInput() {
+  if (!InputFilename)
+    return DefaultInput;
+  auto Buffer = llvm::MemoryBuffer::getFile(InputFilename);
+  if (!Buffer) {
+    llvm::errs() << "Error reading " << InputFilename << ": "
+                 << Buffer.getError().message() << "\n";
+    exit(1);
+  }
+  return (*Buffer)->getBuffer().str();
+}
+
+// Parses the input, with the bytecode interpreter enabled if requested.
+std::unique_ptr<ASTUnit> buildAST(bool UseInterpreter) {
+  std::vector<std::string> Args = {"-std=c++14"};
+  if (UseInterpreter)
+    Args.push_back("-fexperimental-new-constant-interpreter");
+  std::unique_ptr<ASTUnit> AST =
+      tooling::buildASTFromCodeWithArgs(readInput(), Args);
+  if (!AST || AST->getDiagnostics().hasErrorOccurred()) {
+    llvm::errs() << "Error parsing the input\n";
+    exit(1);
+  }
+  return AST;
+}
+
+// Returns the initializer of the variable named 'Bench'.
+const Expr *findInit(ASTContext &Ctx) {
+  for (const Decl *D : Ctx.getTranslationUnitDecl()->decls())
+    if (const auto *VD = dyn_cast<VarDecl>(D))
+      if (VD->getName() == "Bench" && VD->getInit())
+        return VD->getInit();
+  llvm::errs() << "The input doesn't initialize a variable named 'Bench'\n";
+  exit(1);
+}
+
+// Evaluates the initializer of 'Bench' repeatedly. The interpreter compiles
+// each function to bytecode on its first call only, so this measures the
+// evaluation of the cached bytecode against walking the AST.
+void evaluate(benchmark::State &State, bool UseInterpreter) {
+  std::unique_ptr<ASTUnit> AST = buildAST(UseInterpreter);
+  ASTContext &Ctx = AST->getASTContext();
+  const Expr *Init = findInit(Ctx);
+  Expr::EvalResult Result;
+  for (auto _ : State) {
+    if (!Init->EvaluateAsInt(Result, Ctx)) {
+      State.SkipWithError("The initializer of 'Bench' is not a constant");
+      break;
+    }
+    benchmark::DoNotOptimize(Result);
+  }
+}
+
+static void EvaluateTree(benchmark::State &State) { evaluate(State, false); }
+BENCHMARK(EvaluateTree);
+
+static void EvaluateInterp(benchmark::State &State) { evaluate(State, true); }
+BENCHMARK(EvaluateInterp);
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // An optional first argument names a C++14 file which initializes a
+  // variable named 'Bench', to evaluate instead of the default input.
+  if (argc > 1 && argv[1][0] != '-') {
+    InputFilename = argv[1];
+    argv[1] = argv[0];
+    ++argv;
+    --argc;
+  }
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,102 @@
+//===--- LexerBenchmark.cpp - Lexer throughput benchmarks -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/LangOptions.h"
+#include "clang/Lex/Lexer.h"
+#include "benchmark/benchmark.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+
+using namespace clang;
+
+const char *InputFilename;
+
+namespace {
+
+// Builds about 4MB of code which looks like preprocessed C++: indented lines
+// of long identifiers, line comments and string literals.
+std::string buildInput() {
+  std::string Input;
+  llvm::raw_string_ostream OS(Input);
+  for (unsigned I = 0; Input.size() < (4u << 20); ++I) {
+    OS << "# " << I << " \"/usr/include/some/long/path/to/a_header.h\" 3\n"
+       << "namespace std_namespace_" << I << " {\n"
+       << "  // Returns the element of the container at the given position, "
+          "which is checked.\n"
+       << "  template <typename ContainerType_" << I << ">\n"
+       << "  inline const typename ContainerType_" << I
+       << "::value_type &checked_element_at(const ContainerType_" << I
+       << " &container, unsigned long position) {\n"
+       << "    if (position >= container.size())\n"
+       << "      throw_out_of_range_exception(\"checked_element_at: position "
+          "is out of range\", __LINE__);\n"
+       << "    return container[position]; // " << I << "\n"
+       << "  }\n"
+       << "}\n";
+    OS.flush();
+  }
+  return Input;
+}
+
+std::string readInput() {
+  if (!InputFilename)
+    return buildInput();
+  auto Buffer = llvm::MemoryBuffer::getFile(InputFilename);
+  if (!Buffer) {
+    llvm::errs() << "Error reading " << InputFilename << ": "
+                 << Buffer.getError().message() << "\n";
+    exit(1);
+  }
+  return (*Buffer)->getBuffer().str();
+}
+
+const std::string &getInput() {
+  static const std::string Input = readInput();
+  return Input;
+}
+
+// Lexes the whole input in raw mode, which exercises the identifier,
+// whitespace, comment and literal scanning without a preprocessor.
+static void RawLex(benchmark::State &State) {
+  const std::string &Input = getInput();
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = true;
+  LangOpts.CPlusPlus11 = true;
+  LangOpts.LineComment = true;
+  size_t NumTokens = 0;
+  for (auto _ : State) {
+    Lexer L(SourceLocation(), LangOpts, Input.data(), Input.data(),
+            Input.data() + Input.size());
+    Token Tok;
+    NumTokens = 0;
+    do {
+      L.LexFromRawLexer(Tok);
+      ++NumTokens;
+    } while (Tok.isNot(tok::eof));
+    benchmark::DoNotOptimize(NumTokens);
+  }
+  State.SetBytesProcessed(int64_t(State.iterations()) * Input.size());
+  State.counters["Tokens"] = NumTokens;
+}
+BENCHMARK(RawLex);
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // An optional first argument names a preprocessed file to lex instead of
+  // the generated input.
+  if (argc > 1 && argv[1][0] != '-') {
+    InputFilename = argv[1];
+    argv[1] = argv[0];
+    ++argv;
+    --argc;
+  }
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -1023,6 +1023,8 @@ public:
   static void add(Kind k);
   static void EnableStatistics();
   static void PrintStats();
+  /// Returns the number of declarations created since statistics were enabled.
+  static unsigned getNumCreated();
 
   /// isTemplateParameter - Determines whether this declaration is a
   /// template parameter.
@@ -1228,6 +1228,8 @@ public:
   static void addStmtClass(const StmtClass s);
   static void EnableStatistics();
   static void PrintStats();
+  /// Returns the number of statements created since statistics were enabled.
+  static unsigned getNumCreated();
 
   /// \returns the likelihood of a set of attributes.
   static Likelihood getLikelihood(ArrayRef<const Attr *> Attrs);
@@ -17,12 +17,15 @@
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <cstdint>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -83,6 +86,71 @@ public:
                           llvm::vfs::FileSystem &FS) override;
 };
 
+/// The paths which several FileManagers, such as the ones of the cc1 jobs run
+/// in the same process, found to be missing.
+///
+/// Header search looks up every header in many directories where it doesn't
+/// exist. A missing path is assumed to stay missing as long as the
+/// modification time of its parent directory doesn't change, so that each
+/// FileManager only needs to 'stat' the directory once instead of looking up
+/// each of the missing paths again. Only absolute paths are remembered, and
+/// all the FileManagers must use the same file system.
+///
+/// The missing paths can be saved to a file and loaded by later processes.
+/// The directories of the loaded paths are checked for modifications before
+/// the paths are relied upon, like the ones found in the current process.
+///
+/// This class is thread-safe.
+class MissingFileCache {
+public:
+  /// Creates a stat cache for a new FileManager. Each directory is checked for
+  /// modifications at most once through a given stat cache, consistently with
+  /// FileManager which doesn't look up a path again anyway.
+  std::unique_ptr<FileSystemStatCache> createStatCache();
+
+  /// Returns true if Path is known to be missing. Called by the stat caches of
+  /// the given generation.
+  bool isMissing(StringRef Path, unsigned Generation,
+                 llvm::vfs::FileSystem &FS);
+  /// Remembers that Path is missing.
+  void addMissing(StringRef Path, unsigned Generation,
+                  llvm::vfs::FileSystem &FS);
+
+  /// Adds the missing paths saved in the file Path. A directory which was
+  /// already checked keeps its own entries if its modification time differs
+  /// from the saved one.
+  std::error_code load(StringRef Path);
+
+  /// Saves the missing paths to the file Path, merged with the ones saved to
+  /// it by other processes in the meantime. The file is replaced atomically.
+  std::error_code save(StringRef Path);
+
+private:
+  struct DirectoryInfo {
+    /// The modification time of the directory when it was last checked.
+    llvm::sys::TimePoint<> ModTime;
+    /// The generation of the stat cache which last checked the directory.
+    unsigned Generation = 0;
+    /// Whether the missing entries can be remembered, i.e. the directory
+    /// exists and its modification time is reliable.
+    bool Valid = false;
+    /// The names of the missing entries of the directory.
+    llvm::StringSet<> Missing;
+  };
+
+  /// Adds the entries of the contents of a file written by save().
+  std::error_code loadFrom(StringRef Contents);
+
+  /// Returns the parent directory of Path, after checking it for changes once
+  /// per generation, or nullptr if it can't be relied upon.
+  DirectoryInfo *getDirectory(StringRef Path, unsigned Generation,
+                              llvm::vfs::FileSystem &FS);
+
+  std::mutex Mutex;
+  llvm::StringMap<DirectoryInfo> Directories;
+  unsigned LastGeneration = 0;
+};
+
 } // namespace clang
 
 #endif // LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
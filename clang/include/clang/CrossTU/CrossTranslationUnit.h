@@ -16,6 +16,7 @@
 
 #include "clang/AST/ASTImporterSharedState.h"
 #include "clang/Basic/LLVM.h"
+#include "clang/Serialization/ASTBitCodes.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -23,6 +24,11 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Path.h"
 
+namespace llvm {
+class Timer;
+class TimerGroup;
+} // namespace llvm
+
 namespace clang {
 class CompilerInstance;
 class ASTContext;
@@ -199,14 +205,14 @@ private:
 
   void lazyInitImporterSharedSt(TranslationUnitDecl *ToTU);
   ASTImporter &getOrCreateASTImporter(ASTUnit *Unit);
+  const llvm::StringMap<const NamedDecl *> &getDefinitions(ASTUnit *Unit);
   template <typename T>
   llvm::Expected<const T *> getCrossTUDefinitionImpl(const T *D,
                                                      StringRef CrossTUDir,
                                                      StringRef IndexName,
                                                      bool DisplayCTUProgress);
   template <typename T>
-  const T *findDefInDeclContext(const DeclContext *DC,
-                                StringRef LookupName);
+  const T *findDefinition(ASTUnit *Unit, StringRef LookupName);
   template <typename T>
   llvm::Expected<const T *> importDefinitionImpl(const T *D, ASTUnit *Unit);
 
@@ -226,13 +232,26 @@ private:
   /// imported the FileID.
   ImportedFileIDMap ImportedFileIDs;
 
+  /// The definitions of every loaded ASTUnit by their lookup name, built the
+  /// first time a definition is looked up in the unit.
+  llvm::DenseMap<ASTUnit *, llvm::StringMap<const NamedDecl *>> Definitions;
+  /// The results of the previous imports by lookup name, or nullptr if the
+  /// import failed, so that a definition is only imported once.
+  llvm::StringMap<const Decl *> ImportedDefinitions;
+
+  /// Time spent loading ASTs and importing definitions, if -analyzer-stats is
+  /// specified.
+  std::unique_ptr<llvm::TimerGroup> CTUTimers;
+  std::unique_ptr<llvm::Timer> LoadTimer;
+  std::unique_ptr<llvm::Timer> ImportTimer;
+
   using LoadResultTy = llvm::Expected<std::unique_ptr<ASTUnit>>;
 
   /// Loads ASTUnits from AST-dumps or source-files.
   class ASTLoader {
   public:
     ASTLoader(CompilerInstance &CI, StringRef CTUDir,
-              StringRef InvocationListFilePath);
+              StringRef InvocationListFilePath, StringRef CacheDir);
 
     /// Load the ASTUnit by its identifier found in the index file. If the
     /// indentifier is suffixed with '.ast' it is considered a dump. Otherwise
@@ -244,6 +263,12 @@ private:
     /// on-demand parsing.
     llvm::Error lazyInitInvocationList();
 
+    /// Returns the IDs of the function and variable definitions of an AST
+    /// loaded from CacheDir by their lookup name, or nullptr if the AST was
+    /// loaded otherwise.
+    const llvm::StringMap<serialization::DeclID> *
+    getDefinitionTable(const ASTUnit *Unit) const;
+
   private:
     /// The style used for storage and lookup of filesystem paths.
     /// Defaults to posix.
@@ -253,6 +278,9 @@ private:
     LoadResultTy loadFromDump(StringRef Identifier);
     /// Loads an AST from a source-file.
     LoadResultTy loadFromSource(StringRef Identifier);
+    /// Loads an AST previously parsed from a source-file and saved to
+    /// CacheDir, or returns nullptr if it is missing or out of date.
+    std::unique_ptr<ASTUnit> loadFromCache(StringRef CachePath);
 
     CompilerInstance &CI;
     StringRef CTUDir;
@@ -263,6 +291,11 @@ private:
     /// In case of on-demand parsing, the invocations for parsing the source
     /// files is stored.
     llvm::Optional<InvocationListTy> InvocationList;
+    /// The directory where ASTs parsed on-demand are cached, if not empty.
+    StringRef CacheDir;
+    /// The tables of definitions saved with the ASTs loaded from CacheDir.
+    llvm::DenseMap<const ASTUnit *, llvm::StringMap<serialization::DeclID>>
+        DefinitionTables;
   };
 
   /// Maintain number of AST loads and check for reaching the load limit.
@@ -318,6 +351,13 @@ private:
                                                    StringRef CrossTUDir,
                                                    StringRef IndexName);
 
+    /// Returns the IDs of the definitions of \p Unit by their lookup name, if
+    /// it was loaded from the CTU AST cache.
+    const llvm::StringMap<serialization::DeclID> *
+    getDefinitionTable(const ASTUnit *Unit) const {
+      return Loader.getDefinitionTable(Unit);
+    }
+
   private:
     llvm::Error ensureCTUIndexLoaded(StringRef CrossTUDir, StringRef IndexName);
     llvm::Expected<ASTUnit *> getASTUnitForFile(StringRef FileName,
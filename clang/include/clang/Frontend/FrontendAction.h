@@ -31,12 +31,14 @@
 namespace clang {
 class ASTMergeAction;
 class CompilerInstance;
+class HeaderMemoryReport;
 
 /// Abstract base class for actions which can be performed by the frontend.
 class FrontendAction {
   FrontendInputFile CurrentInput;
   std::unique_ptr<ASTUnit> CurrentASTUnit;
   CompilerInstance *Instance;
+  std::unique_ptr<HeaderMemoryReport> MemoryReport;
   friend class ASTMergeAction;
   friend class WrapperFrontendAction;
 
@@ -245,6 +245,13 @@ public:
   /// Output time trace profile.
   unsigned TimeTrace : 1;
 
+  /// Share the missing files found with the other jobs run in the same
+  /// process. Use FileCachePath to keep them across processes.
+  unsigned ShareFileCaches : 1;
+
+  /// Output a report of the memory used while parsing each file.
+  unsigned MemoryReport : 1;
+
   /// Show the -version text.
   unsigned ShowVersion : 1;
 
@@ -444,13 +451,18 @@ public:
   /// Filename to write statistics to.
   std::string StatsFile;
 
+  /// The file in which the missing files found are saved for later
+  /// compilations, if not empty.
+  std::string FileCachePath;
+
   /// Minimum time granularity (in microseconds) traced by time profiler.
   unsigned TimeTraceGranularity;
 
 public:
   FrontendOptions()
       : DisableFree(false), RelocatablePCH(false), ShowHelp(false),
-        ShowStats(false), TimeTrace(false), ShowVersion(false),
+        ShowStats(false), TimeTrace(false), ShareFileCaches(false),
+        MemoryReport(false), ShowVersion(false),
         FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
         FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
         SkipFunctionBodies(false), UseGlobalModuleIndex(true),
@@ -0,0 +1,76 @@
+//===--- HeaderMemoryReport.h - Per-header memory usage ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_HEADERMEMORYREPORT_H
+#define LLVM_CLANG_FRONTEND_HEADERMEMORYREPORT_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace clang {
+
+class CompilerInstance;
+class PPCallbacks;
+
+/// Attributes the memory allocated by the ASTContext, the SourceManager and
+/// the Preprocessor, the AST nodes created and the time spent to the file
+/// which was being lexed at the time (-fmemory-report).
+///
+/// The attribution only changes when the preprocessor enters or leaves a
+/// file, so it is approximate: the parser lags behind the lexer by a few
+/// tokens, and what is done at the end of the translation unit, such as
+/// instantiating templates, is reported separately.
+class HeaderMemoryReport {
+public:
+  /// Starts tracking the compilation of \p CI, which must have a
+  /// preprocessor. Enables the collection of Decl and Stmt statistics.
+  explicit HeaderMemoryReport(CompilerInstance &CI);
+  ~HeaderMemoryReport();
+
+  /// Returns the callbacks to add to the preprocessor to track the file being
+  /// lexed.
+  std::unique_ptr<PPCallbacks> createPPCallbacks();
+
+  /// Starts attributing the usage to the given file.
+  void switchTo(StringRef File, bool Entered);
+
+  /// Writes the usage of each file as JSON, sorted by decreasing ASTContext
+  /// memory.
+  void write(raw_ostream &OS);
+
+private:
+  struct Usage {
+    int64_t TimeUs = 0;
+    int64_t ASTContextBytes = 0;
+    int64_t SourceManagerBytes = 0;
+    int64_t PreprocessorBytes = 0;
+    int64_t Decls = 0;
+    int64_t Types = 0;
+    int64_t Stmts = 0;
+    unsigned Inclusions = 0;
+
+    void add(const Usage &Now, const Usage &Before);
+  };
+
+  Usage sample() const;
+
+  CompilerInstance &CI;
+  std::chrono::steady_clock::time_point Start;
+  llvm::StringMap<Usage> Files;
+  /// The file the usage is currently attributed to.
+  Usage *Current;
+  /// The usage when Current was last changed.
+  Usage Last;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_FRONTEND_HEADERMEMORYREPORT_H
@@ -0,0 +1,88 @@
+//===- DependencyScanningCache.h - clang-scan-deps disk cache ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_CACHE_H
+#define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_CACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/Support/Chrono.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clang {
+namespace tooling {
+namespace dependencies {
+
+/// The minimized contents of a source file and the ranges of its excluded
+/// conditional blocks that are worth skipping.
+struct MinimizedSource {
+  std::string Contents;
+  /// Pairs of offset and length, as in \c PreprocessorSkippedRangeMapping.
+  std::vector<std::pair<unsigned, unsigned>> SkippedRanges;
+};
+
+/// A cache stored on disk which persists the work of the dependency scanner
+/// across its runs.
+///
+/// It holds two kinds of entries:
+/// - the minimized sources, keyed by a hash of the original contents, so that
+///   an unmodified file is not minimized again.
+/// - the dependency file printed for a translation unit, keyed by its command
+///   line. It is only reused if none of the files it lists has changed, which
+///   is checked with their size, modification time and, when only the latter
+///   differs, their contents. The directories of the files which were looked
+///   up without success must not have been modified either, so that a header
+///   added earlier in the search path than the one previously found causes a
+///   new scan. Any other change to these directories does too.
+///
+/// Failures to access the cache are ignored and only cause a cache miss. This
+/// class is thread-safe, and so is sharing the directory between processes:
+/// entries are replaced atomically.
+class DependencyScanningPersistentCache {
+public:
+  explicit DependencyScanningPersistentCache(StringRef Directory);
+
+  /// Returns the key of a source file with the given contents. It depends on
+  /// the compiler version as well, since the minimizer may change.
+  static std::string getSourceKey(StringRef Contents);
+
+  /// Returns the key of the dependency file of a translation unit.
+  static std::string getCommandKey(const CompileCommand &Command,
+                                   StringRef WorkingDirectory);
+
+  llvm::Optional<MinimizedSource> getMinimizedSource(StringRef Key);
+  void addMinimizedSource(StringRef Key, const MinimizedSource &Source);
+
+  /// Returns the cached dependency file if the inputs it was computed from
+  /// are unchanged.
+  llvm::Optional<std::string> getDependencyFile(StringRef Key);
+
+  /// Stores the dependency file computed from the given inputs and files
+  /// that were not found, unless one of the inputs or of the directories of
+  /// the missing files was modified after this cache was created. The scanning
+  /// service keeps the contents it read for its whole lifetime, so the
+  /// contents seen by the scan of a modified file are unknown.
+  void addDependencyFile(StringRef Key, ArrayRef<std::string> Inputs,
+                         ArrayRef<std::string> MissingFiles,
+                         StringRef WorkingDirectory, StringRef DependencyFile);
+
+private:
+  std::string MinimizedDirectory;
+  std::string DependencyDirectory;
+  /// The time this cache, and the scanning service owning it, was created.
+  const llvm::sys::TimePoint<> CreationTime;
+};
+
+} // end namespace dependencies
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_CACHE_H
@@ -48,7 +48,8 @@ class DependencyScanningService {
 public:
   DependencyScanningService(ScanningMode Mode, ScanningOutputFormat Format,
                             bool ReuseFileManager = true,
-                            bool SkipExcludedPPRanges = true);
+                            bool SkipExcludedPPRanges = true,
+                            StringRef CacheDirectory = "");
 
   ScanningMode getMode() const { return Mode; }
 
@@ -62,6 +63,11 @@ public:
     return SharedCache;
   }
 
+  /// \returns The cache persisted across runs, or null if there is none.
+  DependencyScanningPersistentCache *getPersistentCache() {
+    return PersistentCache.get();
+  }
+
 private:
   const ScanningMode Mode;
   const ScanningOutputFormat Format;
@@ -72,6 +78,8 @@ private:
   const bool SkipExcludedPPRanges;
   /// The global file system cache.
   DependencyScanningFilesystemSharedCache SharedCache;
+  /// The cache of minimized sources and dependency files stored on disk.
+  std::unique_ptr<DependencyScanningPersistentCache> PersistentCache;
 };
 
 } // end namespace dependencies
@@ -85,6 +85,9 @@ public:
   /// file format that is specified in the options (-MD is the default) and
   /// return it.
   ///
+  /// If the service has a persistent cache, the dependency file is reused
+  /// from a previous run when none of the files it lists has changed.
+  ///
   /// \returns A \c StringError with the diagnostic output if clang errors
   /// occurred, dependency file contents otherwise.
   llvm::Expected<std::string>
@@ -109,6 +112,7 @@ public:
 
 private:
   DependencyScanningWorker Worker;
+  DependencyScanningPersistentCache *PersistentCache;
 };
 
 } // end namespace dependencies
@@ -40,6 +40,10 @@ public:
   virtual void handleModuleDependency(ModuleDeps MD) = 0;
 
   virtual void handleContextHash(std::string Hash) = 0;
+
+  /// Called with the absolute path of each file that was looked up but not
+  /// found, when the service has a persistent cache.
+  virtual void handleMissingFile(StringRef Path) {}
 };
 
 /// An individual dependency scanning worker that is able to run on its own
@@ -77,6 +81,8 @@ private:
   /// worker. If null, the file manager will not be reused.
   llvm::IntrusiveRefCntPtr<FileManager> Files;
   ScanningOutputFormat Format;
+  /// Whether the files that were not found are reported to the consumer.
+  bool RecordMissingFiles;
 };
 
 } // end namespace dependencies
@@ -190,7 +190,12 @@ void Decl::PrintStats() {
   llvm::errs() << "Total bytes = " << totalBytes << "\n";
 }
 
+static unsigned NumDeclsCreated = 0;
+
+unsigned Decl::getNumCreated() { return NumDeclsCreated; }
+
 void Decl::add(Kind k) {
+  ++NumDeclsCreated;
   switch (k) {
 #define DECL(DERIVED, BASE) case DERIVED: ++n##DERIVED##s; break;
 #define ABSTRACT_DECL(DECL)
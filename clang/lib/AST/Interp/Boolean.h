@@ -134,6 +134,16 @@ class Boolean {
     *R = Boolean(A.V && B.V);
     return false;
   }
+
+  static bool div(Boolean A, Boolean B, unsigned OpBits, Boolean *R) {
+    *R = A;
+    return false;
+  }
+
+  static bool rem(Boolean A, Boolean B, unsigned OpBits, Boolean *R) {
+    *R = Boolean(false);
+    return false;
+  }
 };
 
 inline llvm::raw_ostream &operator<<(llvm::raw_ostream &OS, const Boolean &B) {
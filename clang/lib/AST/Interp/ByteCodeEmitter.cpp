@@ -59,10 +59,12 @@ Expected<Function *> ByteCodeEmitter::compileFunc(const FunctionDecl *F) {
   // Compile the function body.
   if (!F->isConstexpr() || !visitFunc(F)) {
     // Return a dummy function if compilation failed.
-    if (BailLocation)
+    if (BailLocation) {
+      P.setFunctionError(F, *BailLocation);
       return llvm::make_error<ByteCodeGenError>(*BailLocation);
-    else
+    } else {
       return Func;
+    }
   } else {
     // Create scopes from descriptors.
     llvm::SmallVector<Scope, 2> Scopes;
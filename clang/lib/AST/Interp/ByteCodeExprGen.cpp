@@ -118,6 +118,28 @@ bool ByteCodeExprGen<Emitter>::VisitCastExpr(const CastExpr *CE) {
   case CK_ToVoid:
     return discard(SubExpr);
 
+  case CK_IntegralCast:
+  case CK_IntegralToBoolean: {
+    Optional<PrimType> From = classify(SubExpr->getType());
+    Optional<PrimType> To = classify(CE->getType());
+    if (!From || !To)
+      return this->bail(CE);
+    if (!this->Visit(SubExpr))
+      return false;
+    return DiscardResult ? true : emitPrimCast(*From, *To, CE);
+  }
+
+  case CK_NullToPointer:
+    return DiscardResult ? true : this->emitNullPtr(CE);
+
+  case CK_PointerToBoolean: {
+    if (!this->Visit(SubExpr))
+      return false;
+    if (DiscardResult)
+      return true;
+    return this->emitNullPtr(CE) && this->emitNEPtr(CE);
+  }
+
   default: {
     // TODO: implement other casts.
     return this->bail(CE);
@@ -137,11 +159,32 @@ bool ByteCodeExprGen<Emitter>::VisitIntegerLiteral(const IntegerLiteral *LE) {
   return this->bail(LE);
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCharacterLiteral(
+    const CharacterLiteral *E) {
+  if (DiscardResult)
+    return true;
+  return emitConst(E, E->getValue());
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCXXBoolLiteralExpr(
+    const CXXBoolLiteralExpr *E) {
+  if (DiscardResult)
+    return true;
+  return this->emitConstBool(E->getValue(), E);
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::VisitParenExpr(const ParenExpr *PE) {
   return this->Visit(PE->getSubExpr());
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitConstantExpr(const ConstantExpr *E) {
+  return this->Visit(E->getSubExpr());
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
   const Expr *LHS = BO->getLHS();
@@ -155,10 +198,47 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
     if (!this->Visit(RHS))
       return false;
     return true;
+  case BO_Assign:
+    if (!classify(LHS->getType()))
+      return this->bail(BO);
+    return visitUpdate(BO, LHS, DerefKind::Write,
+                       [this, RHS](PrimType) { return visit(RHS); });
+  case BO_LAnd:
+  case BO_LOr:
+    return visitLogicalOp(BO);
   default:
     break;
   }
 
+  // Pointer arithmetic offsets the pointer operand by the integer one.
+  if (BO->getType()->isPointerType()) {
+    const Expr *PtrE = LHS;
+    const Expr *OffE = RHS;
+    if (!PtrE->getType()->isPointerType())
+      std::swap(PtrE, OffE);
+    Optional<PrimType> OffT = classify(OffE->getType());
+    if (!OffT || *OffT == PT_Ptr)
+      return this->bail(BO);
+
+    if (!visit(PtrE))
+      return false;
+    if (!visit(OffE))
+      return false;
+    switch (BO->getOpcode()) {
+    case BO_Add:
+      if (!this->emitAddOffset(*OffT, BO))
+        return false;
+      break;
+    case BO_Sub:
+      if (!this->emitSubOffset(*OffT, BO))
+        return false;
+      break;
+    default:
+      return this->bail(BO);
+    }
+    return DiscardResult ? this->emitPopPtr(BO) : true;
+  }
+
   // Typecheck the args.
   Optional<PrimType> LT = classify(LHS->getType());
   Optional<PrimType> RT = classify(RHS->getType());
@@ -192,11 +272,14 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
     case BO_GE:
       return Discard(this->emitGE(*LT, BO));
     case BO_Sub:
-      return Discard(this->emitSub(*T, BO));
     case BO_Add:
-      return Discard(this->emitAdd(*T, BO));
     case BO_Mul:
-      return Discard(this->emitMul(*T, BO));
+    case BO_Div:
+    case BO_Rem:
+      // The difference of pointers is not supported yet.
+      if (*LT == PT_Ptr)
+        return this->bail(BO);
+      return Discard(emitArith(BO->getOpcode(), *T, BO));
     default:
       return this->bail(BO);
     }
@@ -205,6 +288,338 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
   return this->bail(BO);
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCompoundAssignOperator(
+    const CompoundAssignOperator *E) {
+  const Expr *LHS = E->getLHS();
+  const Expr *RHS = E->getRHS();
+  Optional<PrimType> LT = classify(LHS->getType());
+  Optional<PrimType> RT = classify(RHS->getType());
+  Optional<PrimType> CT = classify(E->getComputationLHSType());
+  if (!LT || !RT || !CT)
+    return this->bail(E);
+
+  BinaryOperatorKind Op =
+      BinaryOperator::getOpForCompoundAssignment(E->getOpcode());
+
+  // Pointers are offset by the integer on the RHS.
+  if (*LT == PT_Ptr) {
+    if (Op != BO_Add && Op != BO_Sub)
+      return this->bail(E);
+    auto Offset = [this, Op, RHS, RT, E](PrimType) {
+      if (!visit(RHS))
+        return false;
+      if (Op == BO_Add)
+        return this->emitAddOffset(*RT, E);
+      return this->emitSubOffset(*RT, E);
+    };
+    return visitUpdate(E, LHS, DerefKind::ReadWrite, Offset);
+  }
+
+  // The LHS is converted to the type of the computation and back.
+  auto Compute = [this, Op, RHS, LT, RT, CT, E](PrimType) {
+    if (!emitPrimCast(*LT, *CT, E))
+      return false;
+    if (!visit(RHS))
+      return false;
+    if (!emitPrimCast(*RT, *CT, E))
+      return false;
+    if (!emitArith(Op, *CT, E))
+      return false;
+    return emitPrimCast(*CT, *LT, E);
+  };
+  return visitUpdate(E, LHS, DerefKind::ReadWrite, Compute);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitUnaryOperator(const UnaryOperator *E) {
+  const Expr *SubExpr = E->getSubExpr();
+  switch (E->getOpcode()) {
+  case UO_PreInc:
+  case UO_PreDec:
+  case UO_PostInc:
+  case UO_PostDec:
+    return visitIncDec(E);
+
+  case UO_AddrOf:
+  case UO_Deref:
+  case UO_Plus:
+    // Lvalues are represented by pointers, so taking the address of one or
+    // dereferencing a pointer is a no-op.
+    return this->Visit(SubExpr);
+
+  case UO_Minus: {
+    Optional<PrimType> T = classify(E->getType());
+    if (!T || *T == PT_Ptr)
+      return this->bail(E);
+    // Negation is a subtraction from zero, which checks for overflow.
+    if (!visitZeroInitializer(*T, E))
+      return false;
+    if (!visit(SubExpr))
+      return false;
+    if (!this->emitSub(*T, E))
+      return false;
+    return DiscardResult ? this->emitPop(*T, E) : true;
+  }
+
+  case UO_LNot: {
+    Optional<PrimType> T = classify(E->getType());
+    if (!T)
+      return this->bail(E);
+    if (!visitBool(SubExpr))
+      return false;
+    if (!this->emitConstBool(false, E))
+      return false;
+    if (!this->emitEQ(PT_Bool, E))
+      return false;
+    // In C, the result is an int.
+    if (!emitPrimCast(PT_Bool, *T, E))
+      return false;
+    return DiscardResult ? this->emitPop(*T, E) : true;
+  }
+
+  default:
+    return this->bail(E);
+  }
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitConditionalOperator(
+    const ConditionalOperator *E) {
+  LabelTy LabelFalse = this->getLabel();
+  LabelTy LabelEnd = this->getLabel();
+
+  if (!visitBool(E->getCond()))
+    return false;
+  if (!this->jumpFalse(LabelFalse))
+    return false;
+  if (!this->Visit(E->getTrueExpr()))
+    return false;
+  if (!this->jump(LabelEnd))
+    return false;
+  this->emitLabel(LabelFalse);
+  if (!this->Visit(E->getFalseExpr()))
+    return false;
+  return this->fallthrough(LabelEnd);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitDeclRefExpr(const DeclRefExpr *E) {
+  if (DiscardResult)
+    return true;
+
+  const ValueDecl *D = E->getDecl();
+  if (auto *ECD = dyn_cast<EnumConstantDecl>(D)) {
+    QualType Ty = E->getType();
+    if (Optional<PrimType> T = classify(Ty))
+      return emitConst(*T, getIntWidth(Ty), ECD->getInitVal(), E);
+    return this->bail(E);
+  }
+
+  // References and composite parameters hold a pointer to the object.
+  bool IsReference = D->getType()->isReferenceType();
+  if (auto *PD = dyn_cast<ParmVarDecl>(D)) {
+    auto It = this->Params.find(PD);
+    if (It == this->Params.end())
+      return this->bail(E);
+    if (IsReference || !classify(PD->getType()))
+      return this->emitGetParamPtr(It->second, E);
+    return this->emitGetPtrParam(It->second, E);
+  }
+
+  if (auto *VD = dyn_cast<VarDecl>(D)) {
+    auto It = Locals.find(VD);
+    if (It == Locals.end())
+      return getPtrVarDecl(VD, E);
+    if (IsReference)
+      return this->emitGetLocalPtr(It->second.Offset, E);
+    return this->emitGetPtrLocal(It->second.Offset, E);
+  }
+
+  return this->bail(E);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitMemberExpr(const MemberExpr *E) {
+  auto *FD = dyn_cast<FieldDecl>(E->getMemberDecl());
+  if (!FD || FD->isBitField())
+    return this->bail(E);
+
+  // Accessing union members requires tracking the active one.
+  const Expr *Base = E->getBase();
+  QualType BaseTy = Base->getType();
+  if (E->isArrow())
+    BaseTy = BaseTy->getPointeeType();
+  Record *R = getRecord(BaseTy);
+  if (!R || R->isUnion())
+    return this->bail(E);
+  const Record::Field *F = R->getField(FD);
+  if (!F)
+    return this->bail(E);
+
+  if (!visit(Base))
+    return false;
+  if (!this->emitGetPtrField(F->Offset, E))
+    return false;
+  return DiscardResult ? this->emitPopPtr(E) : true;
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitArraySubscriptExpr(
+    const ArraySubscriptExpr *E) {
+  const Expr *Index = E->getIdx();
+  Optional<PrimType> IndexT = classify(Index->getType());
+  if (!IndexT || *IndexT == PT_Ptr)
+    return this->bail(E);
+
+  if (!visit(E->getBase()))
+    return false;
+  if (!visit(Index))
+    return false;
+  if (!this->emitAddOffset(*IndexT, E))
+    return false;
+  // Composite elements are narrowed to give access to their fields.
+  if (!classify(E->getType()) && !this->emitNarrowPtr(E))
+    return false;
+  return DiscardResult ? this->emitPopPtr(E) : true;
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCallExpr(const CallExpr *E) {
+  // Only direct calls to functions which are not methods are supported.
+  const FunctionDecl *FD = E->getDirectCallee();
+  if (!FD || isa<CXXMethodDecl>(FD) || FD->getBuiltinID() || FD->isVariadic())
+    return this->bail(E);
+
+  // Composites are passed and returned through pointers to temporaries,
+  // which are not yet supported.
+  Optional<PrimType> T = classify(E);
+  if (!T && !E->getType()->isVoidType())
+    return this->bail(E);
+  for (const Expr *Arg : E->arguments())
+    if (!classify(Arg))
+      return this->bail(Arg);
+
+  Expected<Function *> Func = P.getOrCreateFunction(FD);
+  if (!Func) {
+    handleAllErrors(Func.takeError(), [this](ByteCodeGenError &Err) {
+      this->bail(Err.getLoc());
+    });
+    return false;
+  }
+  // A callee defined after the caller is resolved when the call executes,
+  // so that the caller still compiles and no failure is cached for it.
+  Function *Callee = *Func ? *Func : P.getOrCreateStub(FD);
+
+  for (const Expr *Arg : E->arguments())
+    if (!visit(Arg))
+      return false;
+  if (!this->emitCall(Callee, E))
+    return false;
+  return DiscardResult && T ? this->emitPop(*T, E) : true;
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCXXDefaultArgExpr(
+    const CXXDefaultArgExpr *E) {
+  return this->Visit(E->getExpr());
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitInitListExpr(const InitListExpr *E) {
+  QualType Ty = E->getType();
+
+  // Braced initializers of primitives hold at most one value.
+  if (Optional<PrimType> T = classify(Ty)) {
+    if (E->getNumInits() > 1)
+      return this->bail(E);
+    if (E->getNumInits() == 1)
+      return this->Visit(E->getInit(0));
+    return DiscardResult ? true : visitZeroInitializer(*T, E);
+  }
+
+  // Composites are initialized in place, through the pointer to the object.
+  if (!InitFn || E->isStringLiteralInit())
+    return this->bail(E);
+
+  if (auto *AT = Ctx.getASTContext().getAsConstantArrayType(Ty)) {
+    Optional<PrimType> ElemT = classify(AT->getElementType());
+    const unsigned NumElems = AT->getSize().getZExtValue();
+    for (unsigned I = 0; I < NumElems; ++I) {
+      const Expr *Init =
+          I < E->getNumInits() ? E->getInit(I) : E->getArrayFiller();
+      if (!Init)
+        return this->bail(E);
+
+      if (ElemT) {
+        if (!emitInitFn())
+          return false;
+        if (!visit(Init))
+          return false;
+        if (!this->emitInitElemPop(*ElemT, I, Init))
+          return false;
+      } else {
+        OptionScope<Emitter> Scope(this, [this, I, Init](InitFnRef Base) {
+          if (!Base())
+            return false;
+          if (!this->emitConstUint32(I, Init))
+            return false;
+          if (!this->emitAddOffsetUint32(Init))
+            return false;
+          return this->emitNarrowPtr(Init);
+        });
+        if (!this->Visit(Init))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  if (Record *R = getRecord(Ty)) {
+    if (R->isUnion() || R->getNumBases() || R->getNumVirtualBases())
+      return this->bail(E);
+    if (R->getNumFields() != E->getNumInits())
+      return this->bail(E);
+
+    unsigned I = 0;
+    for (const Record::Field &F : R->fields()) {
+      if (F.Decl->isBitField())
+        return this->bail(E);
+      const Expr *Init = E->getInit(I++);
+
+      if (Optional<PrimType> T = classify(F.Decl->getType())) {
+        if (!emitInitFn())
+          return false;
+        if (!visit(Init))
+          return false;
+        if (!this->emitInitField(*T, F.Offset, Init))
+          return false;
+      } else {
+        const unsigned Offset = F.Offset;
+        OptionScope<Emitter> Scope(this, [this, Offset, Init](InitFnRef Base) {
+          if (!Base())
+            return false;
+          return this->emitGetPtrField(Offset, Init);
+        });
+        if (!this->Visit(Init))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  return this->bail(E);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitImplicitValueInitExpr(
+    const ImplicitValueInitExpr *E) {
+  Optional<PrimType> T = classify(E->getType());
+  if (!T)
+    return this->bail(E);
+  return DiscardResult ? true : visitZeroInitializer(*T, E);
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::discard(const Expr *E) {
   OptionScope<Emitter> Scope(this, /*discardResult=*/true);
@@ -220,7 +635,14 @@ bool ByteCodeExprGen<Emitter>::visit(const Expr *E) {
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::visitBool(const Expr *E) {
   if (Optional<PrimType> T = classify(E->getType())) {
-    return visit(E);
+    if (!visit(E))
+      return false;
+    if (*T == PT_Bool)
+      return true;
+    // Scalars other than booleans are compared against zero, as in C.
+    if (!visitZeroInitializer(*T, E))
+      return false;
+    return this->emitNE(*T, E);
   } else {
     return this->bail(E);
   }
@@ -253,6 +675,67 @@ bool ByteCodeExprGen<Emitter>::visitZeroInitializer(PrimType T, const Expr *E) {
   llvm_unreachable("unknown primitive type");
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::visitLogicalOp(const BinaryOperator *E) {
+  Optional<PrimType> T = classify(E->getType());
+  if (!T)
+    return this->bail(E);
+
+  // The RHS is only evaluated if the LHS does not determine the result.
+  const bool IsAnd = E->getOpcode() == BO_LAnd;
+  LabelTy LabelShort = this->getLabel();
+  LabelTy LabelEnd = this->getLabel();
+  if (!visitBool(E->getLHS()))
+    return false;
+  if (!(IsAnd ? this->jumpFalse(LabelShort) : this->jumpTrue(LabelShort)))
+    return false;
+  if (!visitBool(E->getRHS()))
+    return false;
+  if (!this->jump(LabelEnd))
+    return false;
+  this->emitLabel(LabelShort);
+  if (!this->emitConstBool(!IsAnd, E))
+    return false;
+  if (!this->fallthrough(LabelEnd))
+    return false;
+
+  // In C, the result is an int.
+  if (!emitPrimCast(PT_Bool, *T, E))
+    return false;
+  return DiscardResult ? this->emitPop(*T, E) : true;
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::visitIncDec(const UnaryOperator *E) {
+  const Expr *SubExpr = E->getSubExpr();
+  Optional<PrimType> T = classify(SubExpr->getType());
+  if (!T || *T == PT_Bool)
+    return this->bail(E);
+
+  // Adds or subtracts one from the value on top of the stack.
+  auto Step = [this, T, SubExpr, E](bool Inc) {
+    if (*T == PT_Ptr) {
+      if (!this->emitConstSint32(1, E))
+        return false;
+      return Inc ? this->emitAddOffsetSint32(E) : this->emitSubOffsetSint32(E);
+    }
+    const unsigned Bits = getIntWidth(SubExpr->getType());
+    if (!emitConst(*T, Bits, APInt(Bits, 1), E))
+      return false;
+    return Inc ? this->emitAdd(*T, E) : this->emitSub(*T, E);
+  };
+
+  const bool IsInc = E->isIncrementOp();
+  if (!visitUpdate(E, SubExpr, DerefKind::ReadWrite,
+                   [&Step, IsInc](PrimType) { return Step(IsInc); }))
+    return false;
+
+  // Postfix operators yield the old value, recomputed from the new one.
+  if (DiscardResult || E->isPrefix())
+    return true;
+  return Step(!IsInc);
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::dereference(
     const Expr *LV, DerefKind AK, llvm::function_ref<bool(PrimType)> Direct,
@@ -390,6 +873,67 @@ bool ByteCodeExprGen<Emitter>::dereferenceVar(
   return visit(LV) && Indirect(T);
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::visitUpdate(
+    const Expr *E, const Expr *LV, DerefKind AK,
+    llvm::function_ref<bool(PrimType)> Update) {
+  Optional<PrimType> LT = classify(LV->getType());
+  if (!LT)
+    return this->bail(E);
+
+  auto Indirect = [this, AK, Update, E](PrimType T) {
+    // Pointer on stack - load the old value if needed and store the new one.
+    if (AK == DerefKind::ReadWrite && !this->emitLoad(T, E))
+      return false;
+    if (!Update(T))
+      return false;
+    return DiscardResult ? this->emitStorePop(T, E) : this->emitStore(T, E);
+  };
+
+  if (DiscardResult || E->isGLValue())
+    return dereference(LV, AK, Update, Indirect);
+
+  // The result is the new value, which is loaded through the pointer.
+  {
+    OptionScope<Emitter> Scope(this, /*discardResult=*/false);
+    if (!dereference(LV, AK, Update, Indirect))
+      return false;
+  }
+  return this->emitLoadPop(*LT, E);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::emitArith(BinaryOperatorKind Op, PrimType T,
+                                         const Expr *E) {
+  if (T == PT_Ptr)
+    return this->bail(E);
+
+  switch (Op) {
+  case BO_Add:
+    return this->emitAdd(T, E);
+  case BO_Sub:
+    return this->emitSub(T, E);
+  case BO_Mul:
+    return this->emitMul(T, E);
+  case BO_Div:
+    return this->emitDiv(T, E);
+  case BO_Rem:
+    return this->emitRem(T, E);
+  default:
+    return this->bail(E);
+  }
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::emitPrimCast(PrimType From, PrimType To,
+                                            const Expr *E) {
+  if (From == To)
+    return true;
+  if (From == PT_Ptr || To == PT_Ptr)
+    return this->bail(E);
+  return this->emitCast(From, To, E);
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::emitConst(PrimType T, unsigned NumBits,
                                          const APInt &Value, const Expr *E) {
@@ -20,6 +20,7 @@
 #include "Record.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/Optional.h"
@@ -69,8 +70,21 @@ public:
   // Expression visitors - result returned on stack.
   bool VisitCastExpr(const CastExpr *E);
   bool VisitIntegerLiteral(const IntegerLiteral *E);
+  bool VisitCharacterLiteral(const CharacterLiteral *E);
+  bool VisitCXXBoolLiteralExpr(const CXXBoolLiteralExpr *E);
   bool VisitParenExpr(const ParenExpr *E);
+  bool VisitConstantExpr(const ConstantExpr *E);
   bool VisitBinaryOperator(const BinaryOperator *E);
+  bool VisitCompoundAssignOperator(const CompoundAssignOperator *E);
+  bool VisitUnaryOperator(const UnaryOperator *E);
+  bool VisitConditionalOperator(const ConditionalOperator *E);
+  bool VisitDeclRefExpr(const DeclRefExpr *E);
+  bool VisitMemberExpr(const MemberExpr *E);
+  bool VisitArraySubscriptExpr(const ArraySubscriptExpr *E);
+  bool VisitCallExpr(const CallExpr *E);
+  bool VisitCXXDefaultArgExpr(const CXXDefaultArgExpr *E);
+  bool VisitInitListExpr(const InitListExpr *E);
+  bool VisitImplicitValueInitExpr(const ImplicitValueInitExpr *E);
 
 protected:
   bool visitExpr(const Expr *E) override;
@@ -130,6 +144,9 @@ protected:
   /// Visits an expression and converts it to a boolean.
   bool visitBool(const Expr *E);
 
+  /// Converts the value on top of the stack between primitive types.
+  bool emitPrimCast(PrimType From, PrimType To, const Expr *E);
+
   /// Visits an initializer for a local.
   bool visitLocalInitializer(const Expr *Init, unsigned I) {
     return visitInitializer(Init, [this, I, Init] {
@@ -167,6 +184,11 @@ private:
   /// Emits a zero initializer.
   bool visitZeroInitializer(PrimType T, const Expr *E);
 
+  /// Compiles a logical and/or, evaluating the RHS only if required.
+  bool visitLogicalOp(const BinaryOperator *E);
+  /// Compiles a pre/post increment or decrement.
+  bool visitIncDec(const UnaryOperator *E);
+
   enum class DerefKind {
     /// Value is read and pushed to stack.
     Read,
@@ -190,6 +212,15 @@ private:
                       DerefKind AK, llvm::function_ref<bool(PrimType)> Direct,
                       llvm::function_ref<bool(PrimType)> Indirect);
 
+  /// Updates an lvalue in place. The update receives the old value if it is
+  /// read and pushes the new one. The result is a pointer to the lvalue if
+  /// E is a glvalue, or the new value otherwise, as in C.
+  bool visitUpdate(const Expr *E, const Expr *LV, DerefKind AK,
+                   llvm::function_ref<bool(PrimType)> Update);
+
+  /// Emits an arithmetic operation on two values of the same type.
+  bool emitArith(BinaryOperatorKind Op, PrimType T, const Expr *E);
+
   /// Emits an APInt constant.
   bool emitConst(PrimType T, unsigned NumBits, const llvm::APInt &Value,
                  const Expr *E);
@@ -42,19 +42,27 @@ public:
   LoopScope(ByteCodeStmtGen<Emitter> *Ctx, LabelTy BreakLabel,
             LabelTy ContinueLabel)
       : LabelScope<Emitter>(Ctx), OldBreakLabel(Ctx->BreakLabel),
-        OldContinueLabel(Ctx->ContinueLabel) {
+        OldContinueLabel(Ctx->ContinueLabel),
+        OldBreakVarScope(Ctx->BreakVarScope),
+        OldContinueVarScope(Ctx->ContinueVarScope) {
     this->Ctx->BreakLabel = BreakLabel;
     this->Ctx->ContinueLabel = ContinueLabel;
+    this->Ctx->BreakVarScope = Ctx->VarScope;
+    this->Ctx->ContinueVarScope = Ctx->VarScope;
   }
 
   ~LoopScope() {
     this->Ctx->BreakLabel = OldBreakLabel;
     this->Ctx->ContinueLabel = OldContinueLabel;
+    this->Ctx->BreakVarScope = OldBreakVarScope;
+    this->Ctx->ContinueVarScope = OldContinueVarScope;
   }
 
 private:
   OptLabelTy OldBreakLabel;
   OptLabelTy OldContinueLabel;
+  VariableScope<Emitter> *OldBreakVarScope;
+  VariableScope<Emitter> *OldContinueVarScope;
 };
 
 // Sets the context for a switch scope, mapping labels.
@@ -68,22 +76,28 @@ public:
               LabelTy BreakLabel, OptLabelTy DefaultLabel)
       : LabelScope<Emitter>(Ctx), OldBreakLabel(Ctx->BreakLabel),
         OldDefaultLabel(this->Ctx->DefaultLabel),
-        OldCaseLabels(std::move(this->Ctx->CaseLabels)) {
+        OldCaseLabels(std::move(this->Ctx->CaseLabels)),
+        OldBreakVarScope(Ctx->BreakVarScope) {
     this->Ctx->BreakLabel = BreakLabel;
     this->Ctx->DefaultLabel = DefaultLabel;
     this->Ctx->CaseLabels = std::move(CaseLabels);
+    // A continue in the switch still continues the enclosing loop, so it
+    // must leave the scopes up to the loop's, not the switch's.
+    this->Ctx->BreakVarScope = Ctx->VarScope;
   }
 
   ~SwitchScope() {
     this->Ctx->BreakLabel = OldBreakLabel;
     this->Ctx->DefaultLabel = OldDefaultLabel;
     this->Ctx->CaseLabels = std::move(OldCaseLabels);
+    this->Ctx->BreakVarScope = OldBreakVarScope;
   }
 
 private:
   OptLabelTy OldBreakLabel;
   OptLabelTy OldDefaultLabel;
   CaseMap OldCaseLabels;
+  VariableScope<Emitter> *OldBreakVarScope;
 };
 
 } // namespace interp
@@ -120,6 +134,22 @@ bool ByteCodeStmtGen<Emitter>::visitStmt(const Stmt *S) {
     return visitReturnStmt(cast<ReturnStmt>(S));
   case Stmt::IfStmtClass:
     return visitIfStmt(cast<IfStmt>(S));
+  case Stmt::WhileStmtClass:
+    return visitWhileStmt(cast<WhileStmt>(S));
+  case Stmt::DoStmtClass:
+    return visitDoStmt(cast<DoStmt>(S));
+  case Stmt::ForStmtClass:
+    return visitForStmt(cast<ForStmt>(S));
+  case Stmt::BreakStmtClass:
+    return visitBreakStmt(cast<BreakStmt>(S));
+  case Stmt::ContinueStmtClass:
+    return visitContinueStmt(cast<ContinueStmt>(S));
+  case Stmt::SwitchStmtClass:
+    return visitSwitchStmt(cast<SwitchStmt>(S));
+  case Stmt::CaseStmtClass:
+    return visitCaseStmt(cast<CaseStmt>(S));
+  case Stmt::DefaultStmtClass:
+    return visitDefaultStmt(cast<DefaultStmt>(S));
   case Stmt::NullStmtClass:
     return true;
   default: {
@@ -224,6 +254,208 @@ bool ByteCodeStmtGen<Emitter>::visitIfStmt(const IfStmt *IS) {
   return true;
 }
 
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitWhileStmt(const WhileStmt *S) {
+  LabelTy LabelCond = this->getLabel();
+  LabelTy LabelEnd = this->getLabel();
+  LoopScope<Emitter> LS(this, LabelEnd, LabelCond);
+
+  this->emitLabel(LabelCond);
+  if (!this->emitStep(S->getBody()))
+    return false;
+  {
+    BlockScope<Emitter> CondScope(this);
+    if (const DeclStmt *CondDecl = S->getConditionVariableDeclStmt())
+      if (!visitDeclStmt(CondDecl))
+        return false;
+    if (!this->visitBool(S->getCond()))
+      return false;
+    if (!this->jumpFalse(LabelEnd))
+      return false;
+    if (!visitStmt(S->getBody()))
+      return false;
+  }
+  if (!this->jump(LabelCond))
+    return false;
+  this->emitLabel(LabelEnd);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitDoStmt(const DoStmt *S) {
+  LabelTy LabelStart = this->getLabel();
+  LabelTy LabelCond = this->getLabel();
+  LabelTy LabelEnd = this->getLabel();
+  LoopScope<Emitter> LS(this, LabelEnd, LabelCond);
+
+  this->emitLabel(LabelStart);
+  if (!this->emitStep(S->getBody()))
+    return false;
+  {
+    // Destroy the locals of the body on every iteration, even if the body
+    // is not a compound statement.
+    BlockScope<Emitter> BodyScope(this);
+    if (!visitStmt(S->getBody()))
+      return false;
+  }
+  this->emitLabel(LabelCond);
+  if (!this->visitBool(S->getCond()))
+    return false;
+  if (!this->jumpTrue(LabelStart))
+    return false;
+  this->emitLabel(LabelEnd);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitForStmt(const ForStmt *S) {
+  // The variables declared in the init statement outlive the loop body.
+  BlockScope<Emitter> ForScope(this);
+  if (const Stmt *Init = S->getInit())
+    if (!visitStmt(Init))
+      return false;
+
+  LabelTy LabelCond = this->getLabel();
+  LabelTy LabelInc = this->getLabel();
+  LabelTy LabelEnd = this->getLabel();
+  LoopScope<Emitter> LS(this, LabelEnd, LabelInc);
+
+  this->emitLabel(LabelCond);
+  if (!this->emitStep(S->getBody()))
+    return false;
+  {
+    BlockScope<Emitter> CondScope(this);
+    if (const DeclStmt *CondDecl = S->getConditionVariableDeclStmt())
+      if (!visitDeclStmt(CondDecl))
+        return false;
+    if (const Expr *Cond = S->getCond()) {
+      if (!this->visitBool(Cond))
+        return false;
+      if (!this->jumpFalse(LabelEnd))
+        return false;
+    }
+    if (!visitStmt(S->getBody()))
+      return false;
+  }
+  this->emitLabel(LabelInc);
+  if (const Expr *Inc = S->getInc()) {
+    ExprScope<Emitter> IncScope(this);
+    if (!this->discard(Inc))
+      return false;
+  }
+  if (!this->jump(LabelCond))
+    return false;
+  this->emitLabel(LabelEnd);
+  return true;
+}
+
+template <class Emitter>
+void ByteCodeStmtGen<Emitter>::emitScopeCleanup(
+    VariableScope<Emitter> *Target) {
+  for (VariableScope<Emitter> *C = this->VarScope; C != Target;
+       C = C->getParent())
+    C->emitDestruction();
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitBreakStmt(const BreakStmt *S) {
+  if (!BreakLabel)
+    return this->bail(S);
+  emitScopeCleanup(BreakVarScope);
+  return this->jump(*BreakLabel);
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitContinueStmt(const ContinueStmt *S) {
+  if (!ContinueLabel)
+    return this->bail(S);
+  emitScopeCleanup(ContinueVarScope);
+  return this->jump(*ContinueLabel);
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitSwitchStmt(const SwitchStmt *S) {
+  const Expr *Cond = S->getCond();
+  Optional<PrimType> T = this->classify(Cond->getType());
+  if (!T)
+    return this->bail(S);
+
+  BlockScope<Emitter> SwitchBlock(this);
+  if (const Stmt *Init = S->getInit())
+    if (!visitStmt(Init))
+      return false;
+  if (const DeclStmt *CondDecl = S->getConditionVariableDeclStmt())
+    if (!visitDeclStmt(CondDecl))
+      return false;
+
+  // Save the condition in a local to compare it against all cases.
+  unsigned CondVar = this->allocateLocalPrimitive(Cond, *T, true);
+  if (!this->visit(Cond))
+    return false;
+  if (!this->emitSetLocal(*T, CondVar, S))
+    return false;
+
+  LabelTy LabelEnd = this->getLabel();
+  OptLabelTy LabelDefault;
+  CaseMap CaseLabels;
+  for (const SwitchCase *SC = S->getSwitchCaseList(); SC;
+       SC = SC->getNextSwitchCase()) {
+    if (isa<DefaultStmt>(SC)) {
+      LabelDefault = CaseLabels[SC] = this->getLabel();
+      continue;
+    }
+
+    // Case ranges are a GNU extension which is not supported yet.
+    const auto *CS = cast<CaseStmt>(SC);
+    if (CS->caseStmtIsGNURange())
+      return this->bail(CS);
+    const Expr *Value = CS->getLHS();
+    Optional<PrimType> ValueT = this->classify(Value->getType());
+    if (!ValueT)
+      return this->bail(CS);
+
+    CaseLabels[SC] = this->getLabel();
+    if (!this->emitGetLocal(*T, CondVar, CS))
+      return false;
+    if (!this->visit(Value))
+      return false;
+    if (!this->emitPrimCast(*ValueT, *T, Value))
+      return false;
+    if (!this->emitEQ(*T, CS))
+      return false;
+    if (!this->jumpTrue(CaseLabels[SC]))
+      return false;
+  }
+  if (!this->jump(LabelDefault ? *LabelDefault : LabelEnd))
+    return false;
+
+  {
+    SwitchScope<Emitter> SS(this, std::move(CaseLabels), LabelEnd,
+                            LabelDefault);
+    if (!visitStmt(S->getBody()))
+      return false;
+  }
+  this->emitLabel(LabelEnd);
+  return true;
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitCaseStmt(const CaseStmt *S) {
+  auto It = CaseLabels.find(S);
+  if (It == CaseLabels.end())
+    return this->bail(S);
+  this->emitLabel(It->second);
+  return visitStmt(S->getSubStmt());
+}
+
+template <class Emitter>
+bool ByteCodeStmtGen<Emitter>::visitDefaultStmt(const DefaultStmt *S) {
+  if (!DefaultLabel)
+    return this->bail(S);
+  this->emitLabel(*DefaultLabel);
+  return visitStmt(S->getSubStmt());
+}
+
 template <class Emitter>
 bool ByteCodeStmtGen<Emitter>::visitVarDecl(const VarDecl *VD) {
   auto DT = VD->getType();
@@ -236,6 +468,9 @@ bool ByteCodeStmtGen<Emitter>::visitVarDecl(const VarDecl *VD) {
   // Integers, pointers, primitives.
   if (Optional<PrimType> T = this->classify(DT)) {
     auto Off = this->allocateLocalPrimitive(VD, *T, DT.isConstQualified());
+    // Uninitialized locals are diagnosed when read.
+    if (!VD->getInit())
+      return this->emitUninitLocal(Off, VD);
     // Compile the initialiser in its own scope.
     {
       ExprScope<Emitter> Scope(this);
@@ -247,6 +482,12 @@ bool ByteCodeStmtGen<Emitter>::visitVarDecl(const VarDecl *VD) {
   } else {
     // Composite types - allocate storage and initialize it.
     if (auto Off = this->allocateLocal(VD)) {
+      // Reset the fields and elements, which a previous iteration of an
+      // enclosing loop might have initialized.
+      if (!this->emitUninitLocal(*Off, VD))
+        return false;
+      if (!VD->getInit())
+        return true;
       return this->visitLocalInitializer(VD->getInit(), *Off);
     } else {
       return this->bail(VD);
@@ -62,6 +62,17 @@ private:
   bool visitDeclStmt(const DeclStmt *DS);
   bool visitReturnStmt(const ReturnStmt *RS);
   bool visitIfStmt(const IfStmt *IS);
+  bool visitWhileStmt(const WhileStmt *S);
+  bool visitDoStmt(const DoStmt *S);
+  bool visitForStmt(const ForStmt *S);
+  bool visitBreakStmt(const BreakStmt *S);
+  bool visitContinueStmt(const ContinueStmt *S);
+  bool visitSwitchStmt(const SwitchStmt *S);
+  bool visitCaseStmt(const CaseStmt *S);
+  bool visitDefaultStmt(const DefaultStmt *S);
+
+  /// Destroys the locals of the scopes left by jumping out to \p Target.
+  void emitScopeCleanup(VariableScope<Emitter> *Target);
 
   /// Compiles a variable declaration.
   bool visitVarDecl(const VarDecl *VD);
@@ -79,6 +90,10 @@ private:
   OptLabelTy ContinueLabel;
   /// Default case label.
   OptLabelTy DefaultLabel;
+  /// Scope enclosing the innermost loop or switch, left by a break.
+  VariableScope<Emitter> *BreakVarScope = nullptr;
+  /// Scope enclosing the innermost loop, left by a continue.
+  VariableScope<Emitter> *ContinueVarScope = nullptr;
 };
 
 extern template class ByteCodeExprGen<EvalEmitter>;
@@ -120,8 +120,13 @@ bool Context::Run(State &Parent, Function *Func, APValue &Result) {
 }
 
 bool Context::Check(State &Parent, llvm::Expected<bool> &&Flag) {
+  if (Flag && *Flag)
+    return true;
+
+  // Discard the values left on the stack by the failed evaluation.
+  Stk.clear();
   if (Flag)
-    return *Flag;
+    return false;
   handleAllErrors(Flag.takeError(), [&Parent](ByteCodeGenError &Err) {
     Parent.FFDiag(Err.getLoc(), diag::err_experimental_clang_interp_failed);
   });
@@ -193,6 +193,27 @@ bool EvalEmitter::emitRetValue(const SourceInfo &Info) {
   return Composite(Ptr.getType(), Ptr, Result);
 }
 
+bool EvalEmitter::emitCall(Function *Func, const SourceInfo &Info) {
+  if (!isActive())
+    return true;
+  CurrentSource = Info;
+  return ExecuteCall(Func, Pointer(), Info);
+}
+
+bool EvalEmitter::ExecuteCall(Function *F, Pointer &&This,
+                              const SourceInfo &Info) {
+  if (!ResolveCallee(S, F))
+    return false;
+  if (!CheckCall(S, OpPC, F))
+    return false;
+
+  // Run the callee until it returns to the dummy frame, leaving the returned
+  // value on the stack.
+  S.CallStackDepth++;
+  S.Current = new InterpFrame(S, F, S.Current, OpPC, std::move(This));
+  return Interpret(S, Result);
+}
+
 bool EvalEmitter::emitGetPtrLocal(uint32_t I, const SourceInfo &Info) {
   if (!isActive())
     return true;
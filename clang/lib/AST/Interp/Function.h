@@ -105,6 +105,9 @@ public:
   /// Checks if the function is virtual.
   bool isVirtual() const;
 
+  /// Checks if the function stands in for a callee which was not defined.
+  bool isStub() const { return IsStub; }
+
   /// Checks if the function is a constructor.
   bool isConstructor() const { return isa<CXXConstructorDecl>(F); }
 
@@ -150,6 +153,8 @@ private:
   llvm::DenseMap<unsigned, ParamDescriptor> Params;
   /// Flag to indicate if the function is valid.
   bool IsValid = false;
+  /// Flag to indicate if the function is a placeholder without a definition.
+  bool IsStub = false;
 
 public:
   /// Dumps the disassembled bytecode to \c llvm::errs().
@@ -203,6 +203,24 @@ public:
     return CheckMulUB(A.V, B.V, R->V);
   }
 
+  static bool div(Integral A, Integral B, unsigned OpBits, Integral *R) {
+    if (A.isMin() && B.isMinusOne()) {
+      *R = A;
+      return true;
+    }
+    *R = Integral(A.V / B.V);
+    return false;
+  }
+
+  static bool rem(Integral A, Integral B, unsigned OpBits, Integral *R) {
+    if (A.isMin() && B.isMinusOne()) {
+      *R = Integral(T(0));
+      return true;
+    }
+    *R = Integral(A.V % B.V);
+    return false;
+  }
+
 private:
   template <typename T>
   static std::enable_if_t<std::is_signed<T>::value, bool> CheckAddUB(T A, T B,
@@ -9,6 +9,7 @@
 #include "Interp.h"
 #include <limits>
 #include <vector>
+#include "ByteCodeGenError.h"
 #include "Function.h"
 #include "InterpFrame.h"
 #include "InterpStack.h"
@@ -98,13 +99,32 @@ static bool Jf(InterpState &S, CodePtr &PC, int32_t Offset) {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Call
+//===----------------------------------------------------------------------===//
+
+static bool Call(InterpState &S, CodePtr &PC, Function *Func) {
+  if (!ResolveCallee(S, Func))
+    return false;
+
+  // The source of the call is attached to the address of the argument.
+  if (!CheckCall(S, PC - sizeof(uintptr_t), Func))
+    return false;
+
+  // The arguments on the stack become the parameters of the new frame.
+  S.CallStackDepth++;
+  S.Current = new InterpFrame(S, Func, S.Current, PC, {});
+  PC = Func->getCodeBegin();
+  return true;
+}
+
 static bool CheckInitialized(InterpState &S, CodePtr OpPC, const Pointer &Ptr,
                              AccessKinds AK) {
   if (Ptr.isInitialized())
     return true;
   if (!S.checkingPotentialConstantExpression()) {
     const SourceInfo &Loc = S.Current->getSource(OpPC);
-    S.FFDiag(Loc, diag::note_constexpr_access_uninit) << AK << false;
+    S.FFDiag(Loc, diag::note_constexpr_access_uninit) << AK << true;
   }
   return false;
 }
@@ -372,6 +392,52 @@ bool CheckCallable(InterpState &S, CodePtr OpPC, Function *F) {
   return true;
 }
 
+bool ResolveCallee(InterpState &S, Function *&F) {
+  if (!F->isStub())
+    return true;
+
+  llvm::Expected<Function *> Def = S.P.getOrCreateFunction(F->getDecl());
+  if (!Def) {
+    handleAllErrors(Def.takeError(), [&S](ByteCodeGenError &Err) {
+      S.FFDiag(Err.getLoc(), diag::err_experimental_clang_interp_failed);
+    });
+    return false;
+  }
+
+  // A callee which is still undefined is diagnosed by CheckCallable.
+  if (*Def)
+    F = *Def;
+  return true;
+}
+
+bool CheckCall(InterpState &S, CodePtr OpPC, Function *F) {
+  // The arguments of calls are not known in this mode.
+  if (S.checkingPotentialConstantExpression())
+    return false;
+
+  if (!CheckCallable(S, OpPC, F))
+    return false;
+
+  const unsigned Limit = S.getLangOpts().ConstexprCallDepth;
+  if (S.getCallStackDepth() > Limit) {
+    const SourceInfo &Loc = S.Current->getSource(OpPC);
+    S.FFDiag(Loc, diag::note_constexpr_depth_limit_exceeded) << Limit;
+    return false;
+  }
+
+  return CheckStep(S, OpPC);
+}
+
+bool CheckStep(InterpState &S, CodePtr OpPC) {
+  if (!S.StepsLeft) {
+    const SourceInfo &Loc = S.Current->getSource(OpPC);
+    S.FFDiag(Loc, diag::note_constexpr_step_limit_exceeded);
+    return false;
+  }
+  --S.StepsLeft;
+  return true;
+}
+
 bool CheckThis(InterpState &S, CodePtr OpPC, const Pointer &This) {
   if (!This.isZero())
     return true;
@@ -85,6 +85,15 @@ bool CheckInit(InterpState &S, CodePtr OpPC, const Pointer &Ptr);
 /// Checks if a method can be called.
 bool CheckCallable(InterpState &S, CodePtr OpPC, Function *F);
 
+/// Replaces the stub of a callee with its definition, if it now has one.
+bool ResolveCallee(InterpState &S, Function *&F);
+
+/// Checks if a function can be called from the current frame.
+bool CheckCall(InterpState &S, CodePtr OpPC, Function *F);
+
+/// Charges one step against the evaluation step budget.
+bool CheckStep(InterpState &S, CodePtr OpPC);
+
 /// Checks the 'this' pointer.
 bool CheckThis(InterpState &S, CodePtr OpPC, const Pointer &This);
 
@@ -152,6 +161,47 @@ bool Mul(InterpState &S, CodePtr OpPC) {
   return AddSubMulHelper<T, T::mul, std::multiplies>(S, OpPC, Bits, LHS, RHS);
 }
 
+//===----------------------------------------------------------------------===//
+// Div, Rem
+//===----------------------------------------------------------------------===//
+
+template <typename T, bool (*OpFW)(T, T, unsigned, T *)>
+bool DivRemHelper(InterpState &S, CodePtr OpPC, const T &LHS, const T &RHS) {
+  if (RHS.isZero()) {
+    const SourceInfo &Loc = S.Current->getSource(OpPC);
+    S.FFDiag(Loc, diag::note_expr_divide_by_zero);
+    return false;
+  }
+
+  // Fast path - only the smallest value divided by -1 overflows.
+  T Result;
+  if (!OpFW(LHS, RHS, RHS.bitWidth(), &Result)) {
+    S.Stk.push<T>(Result);
+    return true;
+  }
+
+  // If for some reason evaluation continues, use the truncated results.
+  S.Stk.push<T>(Result);
+
+  const unsigned Bits = RHS.bitWidth() + 1;
+  const Expr *E = S.Current->getExpr(OpPC);
+  return S.reportOverflow(E, -LHS.toAPSInt(Bits));
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool Div(InterpState &S, CodePtr OpPC) {
+  const T &RHS = S.Stk.pop<T>();
+  const T &LHS = S.Stk.pop<T>();
+  return DivRemHelper<T, T::div>(S, OpPC, LHS, RHS);
+}
+
+template <PrimType Name, class T = typename PrimConv<Name>::T>
+bool Rem(InterpState &S, CodePtr OpPC) {
+  const T &RHS = S.Stk.pop<T>();
+  const T &LHS = S.Stk.pop<T>();
+  return DivRemHelper<T, T::rem>(S, OpPC, LHS, RHS);
+}
+
 //===----------------------------------------------------------------------===//
 // EQ, NE, GT, GE, LT, LE
 //===----------------------------------------------------------------------===//
@@ -302,7 +352,10 @@ bool Const(InterpState &S, CodePtr OpPC, const T &Arg) {
 
 template <PrimType Name, class T = typename PrimConv<Name>::T>
 bool GetLocal(InterpState &S, CodePtr OpPC, uint32_t I) {
-  S.Stk.push<T>(S.Current->getLocal<T>(I));
+  const Pointer &Ptr = S.Current->getLocalPointer(I);
+  if (!CheckLoad(S, OpPC, Ptr))
+    return false;
+  S.Stk.push<T>(Ptr.deref<T>());
   return true;
 }
 
@@ -312,6 +365,11 @@ bool SetLocal(InterpState &S, CodePtr OpPC, uint32_t I) {
   return true;
 }
 
+inline bool UninitLocal(InterpState &S, CodePtr OpPC, uint32_t I) {
+  S.Current->uninitLocal(I);
+  return true;
+}
+
 template <PrimType Name, class T = typename PrimConv<Name>::T>
 bool GetParam(InterpState &S, CodePtr OpPC, uint32_t I) {
   if (S.checkingPotentialConstantExpression()) {
@@ -636,6 +694,7 @@ bool Store(InterpState &S, CodePtr OpPC) {
   const Pointer &Ptr = S.Stk.peek<Pointer>();
   if (!CheckStore(S, OpPC, Ptr))
     return false;
+  Ptr.initialize();
   Ptr.deref<T>() = Value;
   return true;
 }
@@ -646,6 +705,7 @@ bool StorePop(InterpState &S, CodePtr OpPC) {
   const Pointer &Ptr = S.Stk.pop<Pointer>();
   if (!CheckStore(S, OpPC, Ptr))
     return false;
+  Ptr.initialize();
   Ptr.deref<T>() = Value;
   return true;
 }
@@ -800,7 +860,9 @@ inline bool Destroy(InterpState &S, CodePtr OpPC, uint32_t I) {
 template <PrimType TIn, PrimType TOut> bool Cast(InterpState &S, CodePtr OpPC) {
   using T = typename PrimConv<TIn>::T;
   using U = typename PrimConv<TOut>::T;
-  S.Stk.push<U>(U::from(S.Stk.pop<T>()));
+  // Values are extended to 64 bits based on the signedness of the source,
+  // then truncated to the destination type.
+  S.Stk.push<U>(U::from(static_cast<int64_t>(S.Stk.pop<T>())));
   return true;
 }
 
@@ -932,6 +994,14 @@ inline bool NoRet(InterpState &S, CodePtr OpPC) {
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// Step
+//===----------------------------------------------------------------------===//
+
+/// Emitted at the head of every loop, so each backward jump is charged. Its
+/// location is the loop body, where the tree evaluator runs out of steps.
+inline bool Step(InterpState &S, CodePtr OpPC) { return CheckStep(S, OpPC); }
+
 //===----------------------------------------------------------------------===//
 // NarrowPtr, ExpandPtr
 //===----------------------------------------------------------------------===//
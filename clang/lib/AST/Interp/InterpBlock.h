@@ -79,6 +79,7 @@ protected:
   friend class Pointer;
   friend class DeadBlock;
   friend class InterpState;
+  friend class InterpFrame;
 
   Block(Descriptor *Desc, bool IsExtern, bool IsStatic, bool IsDead)
     : IsStatic(IsStatic), IsExtern(IsExtern), IsDead(true), Desc(Desc) {}
@@ -101,6 +102,9 @@ protected:
   bool IsExtern = false;
   /// Flag indicating if the pointer is dead.
   bool IsDead = false;
+  /// Flag indicating if a primitive stored in the block was initialized.
+  /// Only locals declared without an initializer are ever uninitialized.
+  bool IsInitialized = true;
   /// Pointer to the stack slot descriptor.
   Descriptor *Desc;
 };
@@ -70,6 +70,16 @@ public:
   /// Mutates a local variable.
   template <typename T> void setLocal(unsigned Offset, const T &Value) {
     localRef<T>(Offset) = Value;
+    reinterpret_cast<Block *>(localBlock(Offset))->IsInitialized = true;
+  }
+
+  /// Marks a local variable as holding an indeterminate value. The block is
+  /// constructed again, which also clears the initialization state of the
+  /// fields and elements a previous loop iteration left in it.
+  void uninitLocal(unsigned Offset) {
+    Block *B = reinterpret_cast<Block *>(localBlock(Offset));
+    B->invokeCtor();
+    B->IsInitialized = false;
   }
 
   /// Returns a pointer to a local variables.
@@ -24,7 +24,8 @@ using APSInt = llvm::APSInt;
 InterpState::InterpState(State &Parent, Program &P, InterpStack &Stk,
                          Context &Ctx, SourceMapper *M)
     : Parent(Parent), M(M), P(P), Stk(Stk), Ctx(Ctx), Current(nullptr),
-      CallStackDepth(Parent.getCallStackDepth() + 1) {}
+      CallStackDepth(Parent.getCallStackDepth() + 1),
+      StepsLeft(Parent.getLangOpts().ConstexprStepLimit) {}
 
 InterpState::~InterpState() {
   while (Current) {
@@ -104,6 +104,8 @@ public:
   InterpFrame *Current = nullptr;
   /// Call stack depth.
   unsigned CallStackDepth;
+  /// Remaining number of steps (loop iterations and calls) permitted.
+  unsigned StepsLeft;
 };
 
 } // namespace interp
@@ -145,9 +145,12 @@ bool Pointer::isInitialized() const {
     if (Map == (InitMap *)-1)
       return true;
     return Map->isInitialized(getIndex());
+  } else if (Base == 0) {
+    // Primitives stored directly in a block have their bit in the block.
+    return Pointee->IsInitialized;
   } else {
     // Field has its bit in an inline descriptor.
-    return Base == 0 || getInlineDesc()->IsInitialized;
+    return getInlineDesc()->IsInitialized;
   }
 }
 
@@ -167,9 +170,11 @@ void Pointer::initialize() const {
         Map = (InitMap *)-1;
       }
     }
+  } else if (Base == 0) {
+    // Primitives stored directly in a block have their bit in the block.
+    Pointee->IsInitialized = true;
   } else {
     // Field has its bit in an inline descriptor.
-    assert(Base != 0 && "Only composite fields can be initialised");
     getInlineDesc()->IsInitialized = true;
   }
 }
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Program.h"
+#include "ByteCodeGenError.h"
 #include "ByteCodeStmtGen.h"
 #include "Context.h"
 #include "Function.h"
@@ -193,6 +194,10 @@ Function *Program::getFunction(const FunctionDecl *F) {
 
 llvm::Expected<Function *> Program::getOrCreateFunction(const FunctionDecl *F) {
   if (Function *Func = getFunction(F)) {
+    // Report the original error if the function could not be compiled.
+    auto It = FuncErrors.find(Func->getDecl());
+    if (It != FuncErrors.end())
+      return llvm::make_error<ByteCodeGenError>(It->second);
     return Func;
   }
 
@@ -204,6 +209,21 @@ llvm::Expected<Function *> Program::getOrCreateFunction(const FunctionDecl *F) {
   return nullptr;
 }
 
+Function *Program::getOrCreateStub(const FunctionDecl *F) {
+  F = F->getCanonicalDecl();
+  auto It = Stubs.find(F);
+  if (It != Stubs.end())
+    return It->second.get();
+
+  llvm::SmallVector<PrimType, 8> ParamTypes;
+  llvm::DenseMap<unsigned, Function::ParamDescriptor> ParamDescriptors;
+  auto *Func = new Function(*this, F, 0, std::move(ParamTypes),
+                            std::move(ParamDescriptors));
+  Func->IsStub = true;
+  Stubs.insert({F, std::unique_ptr<Function>(Func)});
+  return Func;
+}
+
 Record *Program::getOrCreateRecord(const RecordDecl *RD) {
   // Use the actual definition as a key.
   RD = RD->getDefinition();
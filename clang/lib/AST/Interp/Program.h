@@ -94,6 +94,15 @@ public:
   /// If a function was not yet defined, a null pointer is returned.
   llvm::Expected<Function *> getOrCreateFunction(const FunctionDecl *F);
 
+  /// Returns a placeholder for a function which is declared, but not yet
+  /// defined. Calls to it are resolved to the definition when executed.
+  Function *getOrCreateStub(const FunctionDecl *F);
+
+  /// Records the location at which the compilation of a function failed.
+  void setFunctionError(const FunctionDecl *F, SourceLocation Loc) {
+    FuncErrors.insert({F, Loc});
+  }
+
   /// Returns a record or creates one if it does not exist.
   Record *getOrCreateRecord(const RecordDecl *RD);
 
@@ -139,9 +148,12 @@ private:
   llvm::DenseMap<const FunctionDecl *, std::unique_ptr<Function>> Funcs;
   /// List of anonymous functions.
   std::vector<std::unique_ptr<Function>> AnonFuncs;
+  /// Locations at which functions failed to compile, so that the error is
+  /// reported again instead of compiling the function once more.
+  llvm::DenseMap<const FunctionDecl *, SourceLocation> FuncErrors;
 
-  /// Function relocation locations.
-  llvm::DenseMap<const FunctionDecl *, std::vector<unsigned>> Relocs;
+  /// Placeholders for callees which were not defined when called.
+  llvm::DenseMap<const FunctionDecl *, std::unique_ptr<Function>> Stubs;
 
   /// Custom allocator for global storage.
   using PoolAllocTy = llvm::BumpPtrAllocatorImpl<llvm::MallocAllocator>;
@@ -121,7 +121,12 @@ void Stmt::PrintStats() {
   llvm::errs() << "Total bytes = " << sum << "\n";
 }
 
+static unsigned NumStmtsCreated = 0;
+
+unsigned Stmt::getNumCreated() { return NumStmtsCreated; }
+
 void Stmt::addStmtClass(StmtClass s) {
+  ++NumStmtsCreated;
   ++getStmtInfoTableEntry(s).Counter;
 }
 
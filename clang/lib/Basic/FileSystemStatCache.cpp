@@ -11,14 +11,28 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Chrono.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <tuple>
 #include <utility>
 
 using namespace clang;
 
+#define DEBUG_TYPE "file-cache"
+
+ALWAYS_ENABLED_STATISTIC(NumMissingFileHits,
+                         "Number of lookups of missing files answered by the "
+                         "shared file cache.");
+ALWAYS_ENABLED_STATISTIC(NumMissingFileDirectoryChecks,
+                         "Number of directories checked for modifications by "
+                         "the shared file cache.");
+
 void FileSystemStatCache::anchor() {}
 
 /// FileSystemStatCache::get - Get the 'stat' information for the specified
@@ -118,3 +132,172 @@ MemorizeStatCalls::getStat(StringRef Path, llvm::vfs::Status &Status,
 
   return std::error_code();
 }
+
+namespace {
+
+/// The stat cache of a single FileManager sharing a MissingFileCache.
+class MissingFileStatCache : public FileSystemStatCache {
+public:
+  MissingFileStatCache(MissingFileCache &Cache, unsigned Generation)
+      : Cache(Cache), Generation(Generation) {}
+
+  std::error_code getStat(StringRef Path, llvm::vfs::Status &Status,
+                          bool isFile, std::unique_ptr<llvm::vfs::File> *F,
+                          llvm::vfs::FileSystem &FS) override {
+    if (Cache.isMissing(Path, Generation, FS)) {
+      ++NumMissingFileHits;
+      return std::make_error_code(std::errc::no_such_file_or_directory);
+    }
+    std::error_code EC = get(Path, Status, isFile, F, nullptr, FS);
+    if (EC == std::errc::no_such_file_or_directory)
+      Cache.addMissing(Path, Generation, FS);
+    return EC;
+  }
+
+private:
+  MissingFileCache &Cache;
+  const unsigned Generation;
+};
+
+} // namespace
+
+std::unique_ptr<FileSystemStatCache> MissingFileCache::createStatCache() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return std::make_unique<MissingFileStatCache>(*this, ++LastGeneration);
+}
+
+MissingFileCache::DirectoryInfo *
+MissingFileCache::getDirectory(StringRef Path, unsigned Generation,
+                               llvm::vfs::FileSystem &FS) {
+  if (!llvm::sys::path::is_absolute(Path))
+    return nullptr;
+  StringRef Parent = llvm::sys::path::parent_path(Path);
+  if (Parent.empty())
+    return nullptr;
+
+  DirectoryInfo &Dir = Directories[Parent];
+  if (Dir.Generation != Generation) {
+    Dir.Generation = Generation;
+    ++NumMissingFileDirectoryChecks;
+    llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(Parent);
+    if (!Status || Status->getLastModificationTime() != Dir.ModTime)
+      Dir.Missing.clear();
+    Dir.ModTime = Status ? Status->getLastModificationTime()
+                         : llvm::sys::TimePoint<>();
+    // An entry could be added to a directory modified very recently without
+    // changing its modification time, depending on the resolution of the
+    // file system's timestamps.
+    Dir.Valid = Status && std::chrono::system_clock::now() - Dir.ModTime >
+                              std::chrono::seconds(2);
+  }
+  return Dir.Valid ? &Dir : nullptr;
+}
+
+bool MissingFileCache::isMissing(StringRef Path, unsigned Generation,
+                                 llvm::vfs::FileSystem &FS) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  DirectoryInfo *Dir = getDirectory(Path, Generation, FS);
+  return Dir && Dir->Missing.count(llvm::sys::path::filename(Path));
+}
+
+void MissingFileCache::addMissing(StringRef Path, unsigned Generation,
+                                  llvm::vfs::FileSystem &FS) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (DirectoryInfo *Dir = getDirectory(Path, Generation, FS))
+    Dir->Missing.insert(llvm::sys::path::filename(Path));
+}
+
+/// The first line of the files written by MissingFileCache::save(). It is
+/// followed by a "dir <modification time> <path>" line for each directory,
+/// and a "missing <name>" line for each of its missing entries.
+static const char MissingFileCacheMagic[] = "clang-missing-files-v1";
+
+std::error_code MissingFileCache::loadFrom(StringRef Contents) {
+  SmallVector<StringRef, 0> Lines;
+  Contents.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  if (Lines.empty() || Lines.front() != MissingFileCacheMagic)
+    return std::make_error_code(std::errc::illegal_byte_sequence);
+
+  DirectoryInfo *Dir = nullptr;
+  for (StringRef Line : llvm::makeArrayRef(Lines).drop_front()) {
+    StringRef Kind, Value;
+    std::tie(Kind, Value) = Line.split(' ');
+    if (Kind == "missing") {
+      if (Dir)
+        Dir->Missing.insert(Value);
+      continue;
+    }
+
+    StringRef Time, Name;
+    std::tie(Time, Name) = Value.split(' ');
+    int64_t Nanoseconds;
+    if (Kind != "dir" || Time.getAsInteger(10, Nanoseconds) || Name.empty())
+      return std::make_error_code(std::errc::illegal_byte_sequence);
+    llvm::sys::TimePoint<> ModTime{std::chrono::nanoseconds(Nanoseconds)};
+    Dir = &Directories[Name];
+    if (Dir->ModTime == ModTime)
+      continue;
+    // The entries of a directory which this process didn't check yet are
+    // replaced by the saved ones, which may be more recent. A checked
+    // directory keeps its own.
+    if (Dir->Generation != 0) {
+      Dir = nullptr;
+      continue;
+    }
+    Dir->ModTime = ModTime;
+    Dir->Missing.clear();
+  }
+  return std::error_code();
+}
+
+std::error_code MissingFileCache::load(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return Buffer.getError();
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return loadFrom((*Buffer)->getBuffer());
+}
+
+std::error_code MissingFileCache::save(StringRef Path) {
+  // Merge the entries saved by other processes since the file was loaded. A
+  // missing or unreadable file is simply replaced.
+  (void)load(Path);
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  SmallString<128> TempPath;
+  int FD;
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+          Path + "-%%%%%%%%", FD, TempPath))
+    return EC;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << MissingFileCacheMagic << '\n';
+    for (const auto &Entry : Directories) {
+      const DirectoryInfo &Dir = Entry.second;
+      // Keep the loaded directories which weren't checked by this process,
+      // and the checked ones which can be relied upon.
+      if ((Dir.Generation != 0 && !Dir.Valid) || Dir.Missing.empty() ||
+          Entry.first().contains('\n'))
+        continue;
+      OS << "dir " << Dir.ModTime.time_since_epoch().count() << ' '
+         << Entry.first() << '\n';
+      for (const auto &Name : Dir.Missing)
+        if (!Name.first().contains('\n'))
+          OS << "missing " << Name.first() << '\n';
+    }
+    OS.close();
+    if (OS.has_error()) {
+      std::error_code EC = OS.error();
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return EC;
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return EC;
+  }
+  return std::error_code();
+}
@@ -14,18 +14,26 @@
 #include "clang/AST/Decl.h"
 #include "clang/AST/ParentMapContext.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/Version.h"
 #include "clang/CrossTU/CrossTUDiagnostic.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Index/USRGeneration.h"
+#include "clang/Serialization/ASTReader.h"
+#include "clang/Serialization/ASTWriter.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -55,6 +63,13 @@ STATISTIC(NumLangMismatch, "The # of language mismatches");
 STATISTIC(NumLangDialectMismatch, "The # of language dialect mismatches");
 STATISTIC(NumASTLoadThresholdReached,
           "The # of ASTs not loaded because of threshold");
+STATISTIC(NumASTLoaded, "The # of ASTs loaded");
+STATISTIC(NumASTCacheHits, "The # of ASTs loaded from the CTU AST cache");
+STATISTIC(NumASTCacheWrites, "The # of ASTs saved to the CTU AST cache");
+STATISTIC(NumDefinitionTableLookups,
+          "The # of definitions looked up in the table of a cached AST");
+STATISTIC(NumImportsReused,
+          "The # of getCTUDefinition calls answered by a previous import");
 
 // Same as Triple's equality operator, but we check a field only if that is
 // known in both instances.
@@ -209,7 +224,15 @@ template <typename T> static bool hasBodyOrInit(const T *D) {
 }
 
 CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI)
-    : Context(CI.getASTContext()), ASTStorage(CI) {}
+    : Context(CI.getASTContext()), ASTStorage(CI) {
+  if (CI.getAnalyzerOpts()->PrintStats) {
+    CTUTimers = std::make_unique<llvm::TimerGroup>("ctu", "CTU timers");
+    LoadTimer = std::make_unique<llvm::Timer>("ctuload", "CTU AST load time",
+                                              *CTUTimers);
+    ImportTimer = std::make_unique<llvm::Timer>(
+        "ctuimport", "CTU definition import time", *CTUTimers);
+  }
+}
 
 CrossTranslationUnitContext::~CrossTranslationUnitContext() {}
 
@@ -222,29 +245,59 @@ CrossTranslationUnitContext::getLookupName(const NamedDecl *ND) {
   return std::string(DeclUSR.str());
 }
 
-/// Recursively visits the decls of a DeclContext, and returns one with the
-/// given USR.
+/// Adds D to Defs by its USR if it is a T with a body or init.
 template <typename T>
-const T *
-CrossTranslationUnitContext::findDefInDeclContext(const DeclContext *DC,
-                                                  StringRef LookupName) {
+static void addDefinition(const Decl *D,
+                          llvm::StringMap<const NamedDecl *> &Defs) {
+  const auto *ND = dyn_cast<T>(D);
+  const T *ResultDecl;
+  if (!ND || !hasBodyOrInit(ND, ResultDecl))
+    return;
+  if (llvm::Optional<std::string> LookupName =
+          CrossTranslationUnitContext::getLookupName(ResultDecl))
+    Defs.try_emplace(*LookupName, ResultDecl);
+}
+
+/// Recursively visits the decls of a DeclContext, and collects the function
+/// and variable definitions by their USR. If several definitions have the same
+/// USR, the first one visited is kept.
+static void collectDefinitions(const DeclContext *DC,
+                               llvm::StringMap<const NamedDecl *> &Defs) {
   assert(DC && "Declaration Context must not be null");
   for (const Decl *D : DC->decls()) {
-    const auto *SubDC = dyn_cast<DeclContext>(D);
-    if (SubDC)
-      if (const auto *ND = findDefInDeclContext<T>(SubDC, LookupName))
-        return ND;
-
-    const auto *ND = dyn_cast<T>(D);
-    const T *ResultDecl;
-    if (!ND || !hasBodyOrInit(ND, ResultDecl))
-      continue;
-    llvm::Optional<std::string> ResultLookupName = getLookupName(ResultDecl);
-    if (!ResultLookupName || *ResultLookupName != LookupName)
-      continue;
-    return ResultDecl;
+    if (const auto *SubDC = dyn_cast<DeclContext>(D))
+      collectDefinitions(SubDC, Defs);
+
+    addDefinition<FunctionDecl>(D, Defs);
+    // Local variables can't be referenced from other translation units.
+    const auto *VD = dyn_cast<VarDecl>(D);
+    if (VD && VD->hasGlobalStorage())
+      addDefinition<VarDecl>(VD, Defs);
   }
-  return nullptr;
+}
+
+const llvm::StringMap<const NamedDecl *> &
+CrossTranslationUnitContext::getDefinitions(ASTUnit *Unit) {
+  auto Inserted = Definitions.try_emplace(Unit);
+  if (Inserted.second)
+    collectDefinitions(Unit->getASTContext().getTranslationUnitDecl(),
+                       Inserted.first->second);
+  return Inserted.first->second;
+}
+
+template <typename T>
+const T *CrossTranslationUnitContext::findDefinition(ASTUnit *Unit,
+                                                     StringRef LookupName) {
+  // ASTs loaded from the cache come with a table of their definitions, so that
+  // finding one doesn't deserialize all the declarations of the unit.
+  if (const auto *Table = ASTStorage.getDefinitionTable(Unit)) {
+    ++NumDefinitionTableLookups;
+    auto ID = Table->find(LookupName);
+    if (ID == Table->end())
+      return nullptr;
+    return dyn_cast_or_null<T>(Unit->getASTReader()->GetDecl(ID->second));
+  }
+  return dyn_cast_or_null<T>(getDefinitions(Unit).lookup(LookupName));
 }
 
 template <typename T>
@@ -259,6 +312,16 @@ llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
   if (!LookupName)
     return llvm::make_error<IndexError>(
         index_error_code::failed_to_generate_usr);
+
+  // Reuse the result of a previous attempt to import the same definition.
+  auto Imported = ImportedDefinitions.find(*LookupName);
+  if (Imported != ImportedDefinitions.end()) {
+    ++NumImportsReused;
+    if (const auto *ToDecl = dyn_cast_or_null<T>(Imported->second))
+      return ToDecl;
+    return llvm::make_error<IndexError>(index_error_code::failed_import);
+  }
+
   llvm::Expected<ASTUnit *> ASTUnitOrError =
       loadExternalAST(*LookupName, CrossTUDir, IndexName, DisplayCTUProgress);
   if (!ASTUnitOrError)
@@ -315,10 +378,14 @@ llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
         index_error_code::lang_dialect_mismatch);
   }
 
-  TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
-  if (const T *ResultDecl = findDefInDeclContext<T>(TU, *LookupName))
-    return importDefinition(ResultDecl, Unit);
-  return llvm::make_error<IndexError>(index_error_code::failed_import);
+  const T *ResultDecl = findDefinition<T>(Unit, *LookupName);
+  if (!ResultDecl) {
+    ImportedDefinitions[*LookupName] = nullptr;
+    return llvm::make_error<IndexError>(index_error_code::failed_import);
+  }
+  llvm::Expected<const T *> ToDeclOrError = importDefinition(ResultDecl, Unit);
+  ImportedDefinitions[*LookupName] = ToDeclOrError ? *ToDeclOrError : nullptr;
+  return ToDeclOrError;
 }
 
 llvm::Expected<const FunctionDecl *>
@@ -365,7 +432,8 @@ void CrossTranslationUnitContext::emitCrossTUDiagnostics(const IndexError &IE) {
 CrossTranslationUnitContext::ASTUnitStorage::ASTUnitStorage(
     CompilerInstance &CI)
     : Loader(CI, CI.getAnalyzerOpts()->CTUDir,
-             CI.getAnalyzerOpts()->CTUInvocationList),
+             CI.getAnalyzerOpts()->CTUInvocationList,
+             CI.getAnalyzerOpts()->CTUASTCacheDir),
       LoadGuard(CI.getASTContext().getLangOpts().CPlusPlus
                     ? CI.getAnalyzerOpts()->CTUImportCppThreshold
                     : CI.getAnalyzerOpts()->CTUImportThreshold) {}
@@ -398,6 +466,7 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
     FileASTUnitMap[FileName] = std::move(LoadedUnit);
 
     LoadGuard.indicateLoadSuccess();
+    ++NumASTLoaded;
 
     if (DisplayCTUProgress)
       llvm::errs() << "CTU loaded AST file: " << FileName << "\n";
@@ -488,6 +557,7 @@ llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
   //        error will be returned.
 
   // Try to get the value from the heavily cached storage.
+  llvm::TimeRegion LoadTimeRegion(LoadTimer.get());
   llvm::Expected<ASTUnit *> Unit = ASTStorage.getASTUnitForFunction(
       LookupName, CrossTUDir, IndexName, DisplayCTUProgress);
 
@@ -503,8 +573,10 @@ llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
 }
 
 CrossTranslationUnitContext::ASTLoader::ASTLoader(
-    CompilerInstance &CI, StringRef CTUDir, StringRef InvocationListFilePath)
-    : CI(CI), CTUDir(CTUDir), InvocationListFilePath(InvocationListFilePath) {}
+    CompilerInstance &CI, StringRef CTUDir, StringRef InvocationListFilePath,
+    StringRef CacheDir)
+    : CI(CI), CTUDir(CTUDir), InvocationListFilePath(InvocationListFilePath),
+      CacheDir(CacheDir) {}
 
 CrossTranslationUnitContext::LoadResultTy
 CrossTranslationUnitContext::ASTLoader::load(StringRef Identifier) {
@@ -543,6 +615,113 @@ CrossTranslationUnitContext::ASTLoader::loadFromDump(StringRef ASTDumpPath) {
       Diags, CI.getFileSystemOpts());
 }
 
+/// Returns the path of the AST of \p SourceFilePath parsed with \p Invocation
+/// in the CTU AST cache. It depends on the compiler version as well, because
+/// AST files can only be read by the compiler which wrote them.
+static SmallString<256> getCachePath(StringRef CacheDir,
+                                     StringRef SourceFilePath,
+                                     ArrayRef<std::string> Invocation) {
+  llvm::MD5 Hash;
+  Hash.update(getClangFullRepositoryVersion());
+  Hash.update(SourceFilePath);
+  for (const std::string &Arg : Invocation) {
+    Hash.update(Arg);
+    Hash.update(StringRef("\0", 1));
+  }
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+
+  SmallString<256> CachePath = CacheDir;
+  llvm::sys::path::append(CachePath, llvm::sys::path::filename(SourceFilePath) +
+                                         "-" + Result.digest() + ".ast");
+  return CachePath;
+}
+
+/// Returns the path of the table of definitions saved next to the cached AST
+/// at \p CachePath.
+static std::string getDefinitionTablePath(StringRef CachePath) {
+  return (CachePath + ".defs").str();
+}
+
+/// Returns a hash of the contents of an AST file, which ties a table of
+/// definitions to the AST file it was written with.
+static std::string hashASTContents(StringRef Contents) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return std::string(Result.digest().str());
+}
+
+/// Writes \p Contents to \p Path atomically. Returns true on error.
+static bool writeCacheFile(StringRef Path, StringRef Contents) {
+  SmallString<256> TempPath = Path;
+  TempPath += "-%%%%%%%%";
+  if (llvm::Error Err = llvm::writeFileAtomically(TempPath, Path, Contents)) {
+    consumeError(std::move(Err));
+    return true;
+  }
+  return false;
+}
+
+/// Saves the AST of \p Unit to \p CachePath. Next to it, writes a table of
+/// the IDs of its function and variable definitions in the AST file by their
+/// lookup name, which is a line with the hash of the AST file followed by a
+/// line with the ID and the lookup name of every definition. Returns true on
+/// error.
+static bool saveToCache(ASTUnit &Unit, StringRef CachePath) {
+  SmallString<128> Buffer;
+  llvm::BitstreamWriter Stream(Buffer);
+  InMemoryModuleCache ModuleCache;
+  ASTWriter Writer(Stream, Buffer, ModuleCache, {});
+  Writer.WriteAST(Unit.getSema(), std::string(), nullptr, "");
+
+  llvm::StringMap<const NamedDecl *> Defs;
+  collectDefinitions(Unit.getASTContext().getTranslationUnitDecl(), Defs);
+  std::string Table;
+  llvm::raw_string_ostream OS(Table);
+  OS << hashASTContents(Buffer) << '\n';
+  for (const auto &Def : Defs)
+    OS << Writer.getDeclID(Def.second) << ' ' << Def.first() << '\n';
+  OS.flush();
+
+  // The table is written last, so it never refers to an AST file which isn't
+  // there. Its hash rejects it if the AST file was replaced in the meantime.
+  return writeCacheFile(CachePath, Buffer) ||
+         writeCacheFile(getDefinitionTablePath(CachePath), Table);
+}
+
+/// Reads the table of definitions saved next to the cached AST at \p CachePath,
+/// which was loaded into \p Unit, and maps the IDs to the IDs of \p Unit's
+/// ASTReader. Returns None if the table is missing, malformed or belongs to
+/// another AST file.
+static llvm::Optional<llvm::StringMap<serialization::DeclID>>
+loadDefinitionTable(ASTUnit &Unit, StringRef CachePath) {
+  IntrusiveRefCntPtr<ASTReader> Reader = Unit.getASTReader();
+  auto TableBuffer =
+      llvm::MemoryBuffer::getFile(getDefinitionTablePath(CachePath));
+  if (!Reader || !TableBuffer)
+    return llvm::None;
+
+  serialization::ModuleFile &MF = Reader->getModuleManager().getPrimaryModule();
+  StringRef Hash, Table;
+  std::tie(Hash, Table) = (*TableBuffer)->getBuffer().split('\n');
+  if (Hash != hashASTContents(MF.Buffer->getBuffer()))
+    return llvm::None;
+
+  llvm::StringMap<serialization::DeclID> IDs;
+  while (!Table.empty()) {
+    StringRef Line, ID, LookupName;
+    std::tie(Line, Table) = Table.split('\n');
+    std::tie(ID, LookupName) = Line.split(' ');
+    serialization::LocalDeclID LocalID;
+    if (ID.getAsInteger(10, LocalID) || LookupName.empty())
+      return llvm::None;
+    IDs[LookupName] = Reader->getGlobalDeclID(MF, LocalID);
+  }
+  return std::move(IDs);
+}
+
 /// Load the AST from a source-file, which is supposed to be located inside the
 /// YAML formatted invocation list file under the filesystem path specified by
 /// \p InvocationList. The invocation list should contain absolute paths.
@@ -574,6 +753,18 @@ CrossTranslationUnitContext::ASTLoader::loadFromSource(
                  CommandLineArgs.begin(),
                  [](auto &&CmdPart) { return CmdPart.c_str(); });
 
+  SmallString<256> CachePath;
+  if (!CacheDir.empty()) {
+    CachePath = getCachePath(CacheDir, SourceFilePath, InvocationCommand);
+    if (std::unique_ptr<ASTUnit> Unit = loadFromCache(CachePath)) {
+      ++NumASTCacheHits;
+      if (llvm::Optional<llvm::StringMap<serialization::DeclID>> Table =
+              loadDefinitionTable(*Unit, CachePath))
+        DefinitionTables[Unit.get()] = std::move(*Table);
+      return std::move(Unit);
+    }
+  }
+
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts{&CI.getDiagnosticOpts()};
   auto *DiagClient = new ForwardingDiagnosticConsumer{CI.getDiagnosticClient()};
   IntrusiveRefCntPtr<DiagnosticIDs> DiagID{
@@ -581,10 +772,43 @@ CrossTranslationUnitContext::ASTLoader::loadFromSource(
   IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
       new DiagnosticsEngine{DiagID, &*DiagOpts, DiagClient});
 
-  return std::unique_ptr<ASTUnit>(ASTUnit::LoadFromCommandLine(
+  std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCommandLine(
       CommandLineArgs.begin(), (CommandLineArgs.end()),
       CI.getPCHContainerOperations(), Diags,
       CI.getHeaderSearchOpts().ResourceDir));
+
+  // Save the AST for the other analyzer invocations. The files are written
+  // atomically, so concurrent invocations at worst parse the file twice.
+  if (Unit && !CachePath.empty() &&
+      !Unit->getDiagnostics().hasUncompilableErrorOccurred() &&
+      !saveToCache(*Unit, CachePath))
+    ++NumASTCacheWrites;
+
+  return std::move(Unit);
+}
+
+const llvm::StringMap<serialization::DeclID> *
+CrossTranslationUnitContext::ASTLoader::getDefinitionTable(
+    const ASTUnit *Unit) const {
+  auto Table = DefinitionTables.find(Unit);
+  if (Table == DefinitionTables.end())
+    return nullptr;
+  return &Table->second;
+}
+
+std::unique_ptr<ASTUnit>
+CrossTranslationUnitContext::ASTLoader::loadFromCache(StringRef CachePath) {
+  if (!llvm::sys::fs::exists(CachePath))
+    return nullptr;
+  // The AST is validated against its input files while loading it. If any of
+  // them changed, the source file is parsed again, so the diagnostics about
+  // the stale AST are not interesting.
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
+      new DiagnosticsEngine(new DiagnosticIDs(), new DiagnosticOptions(),
+                            new IgnoringDiagConsumer()));
+  return ASTUnit::LoadFromASTFile(
+      std::string(CachePath), CI.getPCHContainerOperations()->getRawReader(),
+      ASTUnit::LoadEverything, Diags, CI.getFileSystemOpts());
 }
 
 llvm::Expected<InvocationListTy>
@@ -697,6 +921,7 @@ CrossTranslationUnitContext::importDefinitionImpl(const T *D, ASTUnit *Unit) {
          "ASTContext of Decl and the unit should match.");
   ASTImporter &Importer = getOrCreateASTImporter(Unit);
 
+  llvm::TimeRegion ImportTimeRegion(ImportTimer.get());
   auto ToDeclOrError = Importer.Import(D);
   if (!ToDeclOrError) {
     handleAllErrors(ToDeclOrError.takeError(),
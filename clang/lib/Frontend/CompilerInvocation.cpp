@@ -833,10 +833,22 @@ static void parseAnalyzerConfigs(AnalyzerOptions &AnOpts,
     Diags->Report(diag::err_analyzer_config_invalid_input)
         << "track-conditions-debug" << "'track-conditions' to also be enabled";
 
+  if (AnOpts.ShardCount == 0)
+    Diags->Report(diag::err_analyzer_config_invalid_input) << "shard-count"
+                                                           << "a positive";
+  else if (AnOpts.ShardIndex >= AnOpts.ShardCount)
+    Diags->Report(diag::err_analyzer_config_invalid_input)
+        << "shard-index" << "an index smaller than the 'shard-count'";
+
   if (!AnOpts.CTUDir.empty() && !llvm::sys::fs::is_directory(AnOpts.CTUDir))
     Diags->Report(diag::err_analyzer_config_invalid_input) << "ctu-dir"
                                                            << "a filename";
 
+  if (!AnOpts.CTUASTCacheDir.empty() &&
+      !llvm::sys::fs::is_directory(AnOpts.CTUASTCacheDir))
+    Diags->Report(diag::err_analyzer_config_invalid_input)
+        << "ctu-ast-cache-dir" << "a directory";
+
   if (!AnOpts.ModelPath.empty() &&
       !llvm::sys::fs::is_directory(AnOpts.ModelPath))
     Diags->Report(diag::err_analyzer_config_invalid_input) << "model-path"
@@ -16,6 +16,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendPluginRegistry.h"
+#include "clang/Frontend/HeaderMemoryReport.h"
 #include "clang/Frontend/LayoutOverrideSource.h"
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
@@ -925,6 +926,11 @@ bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
     CI.getASTContext().setExternalSource(Override);
   }
 
+  if (CI.getFrontendOpts().MemoryReport) {
+    MemoryReport = std::make_unique<HeaderMemoryReport>(CI);
+    CI.getPreprocessor().addPPCallbacks(MemoryReport->createPPCallbacks());
+  }
+
   return true;
 
   // If we failed, reset state since the client will not end up calling the
@@ -981,6 +987,22 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  // Write the memory report next to the output file, like -ftime-trace.
+  if (MemoryReport) {
+    SmallString<128> Path(CI.getFrontendOpts().OutputFile);
+    if (Path.empty() || Path == "-")
+      Path = llvm::sys::path::filename(getCurrentFile());
+    llvm::sys::path::replace_extension(Path, "memory.json");
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_Text);
+    if (EC)
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << Path << EC.message();
+    else
+      MemoryReport->write(OS);
+    MemoryReport.reset();
+  }
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
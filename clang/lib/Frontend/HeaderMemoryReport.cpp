@@ -0,0 +1,152 @@
+//===--- HeaderMemoryReport.cpp - Per-header memory usage -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/HeaderMemoryReport.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/Stmt.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/JSON.h"
+#include <vector>
+
+using namespace clang;
+
+namespace {
+
+class MemoryReportCallbacks : public PPCallbacks {
+public:
+  MemoryReportCallbacks(HeaderMemoryReport &Report, SourceManager &SM)
+      : Report(Report), SM(SM) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason != EnterFile && Reason != ExitFile)
+      return;
+    FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+    if (const FileEntry *FE = SM.getFileEntryForID(FID))
+      Report.switchTo(FE->getName(), Reason == EnterFile);
+    else
+      Report.switchTo(SM.getBufferName(SM.getLocForStartOfFile(FID)),
+                      Reason == EnterFile);
+  }
+
+  void EndOfMainFile() override {
+    Report.switchTo("<end of translation unit>", /*Entered=*/true);
+  }
+
+private:
+  HeaderMemoryReport &Report;
+  SourceManager &SM;
+};
+
+} // end anonymous namespace
+
+HeaderMemoryReport::HeaderMemoryReport(CompilerInstance &CI)
+    : CI(CI), Start(std::chrono::steady_clock::now()) {
+  Decl::EnableStatistics();
+  Stmt::EnableStatistics();
+  // What was allocated before parsing, such as the builtin types, is reported
+  // separately. Last is zero so that the report adds up to the total usage.
+  Current = &Files["<setup>"];
+  Current->Inclusions = 1;
+}
+
+HeaderMemoryReport::~HeaderMemoryReport() = default;
+
+std::unique_ptr<PPCallbacks> HeaderMemoryReport::createPPCallbacks() {
+  return std::make_unique<MemoryReportCallbacks>(*this,
+                                                 CI.getSourceManager());
+}
+
+HeaderMemoryReport::Usage HeaderMemoryReport::sample() const {
+  Usage U;
+  U.TimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now() - Start)
+                 .count();
+  if (CI.hasASTContext()) {
+    ASTContext &Ctx = CI.getASTContext();
+    // Count the bytes handed out by the allocator rather than the size of its
+    // slabs, which grow in large steps that would be charged to whichever
+    // file happened to need a new one.
+    U.ASTContextBytes = Ctx.getAllocator().getBytesAllocated() +
+                        Ctx.getSideTableAllocatedMemory();
+    U.Types = Ctx.getTypes().size();
+  }
+  SourceManager &SM = CI.getSourceManager();
+  U.SourceManagerBytes = SM.getContentCacheSize() + SM.getDataStructureSizes();
+  U.PreprocessorBytes = CI.getPreprocessor().getTotalMemory();
+  U.Decls = Decl::getNumCreated();
+  U.Stmts = Stmt::getNumCreated();
+  return U;
+}
+
+void HeaderMemoryReport::Usage::add(const Usage &Now, const Usage &Before) {
+  TimeUs += Now.TimeUs - Before.TimeUs;
+  ASTContextBytes += Now.ASTContextBytes - Before.ASTContextBytes;
+  SourceManagerBytes += Now.SourceManagerBytes - Before.SourceManagerBytes;
+  PreprocessorBytes += Now.PreprocessorBytes - Before.PreprocessorBytes;
+  Decls += Now.Decls - Before.Decls;
+  Types += Now.Types - Before.Types;
+  Stmts += Now.Stmts - Before.Stmts;
+}
+
+void HeaderMemoryReport::switchTo(StringRef File, bool Entered) {
+  Usage Now = sample();
+  Current->add(Now, Last);
+  Last = Now;
+  Current = &Files[File];
+  if (Entered)
+    ++Current->Inclusions;
+}
+
+void HeaderMemoryReport::write(raw_ostream &OS) {
+  // Charge the remaining usage to the last file.
+  switchTo("<end of translation unit>", /*Entered=*/false);
+
+  std::vector<const llvm::StringMapEntry<Usage> *> Sorted;
+  Usage Total;
+  for (const auto &File : Files) {
+    Sorted.push_back(&File);
+    Total.add(File.second, Usage());
+  }
+  llvm::sort(Sorted, [](const llvm::StringMapEntry<Usage> *LHS,
+                        const llvm::StringMapEntry<Usage> *RHS) {
+    if (LHS->second.ASTContextBytes != RHS->second.ASTContextBytes)
+      return LHS->second.ASTContextBytes > RHS->second.ASTContextBytes;
+    return LHS->first() < RHS->first();
+  });
+
+  auto WriteUsage = [](llvm::json::OStream &J, const Usage &U) {
+    J.attribute("timeUs", U.TimeUs);
+    J.attribute("astContextBytes", U.ASTContextBytes);
+    J.attribute("sourceManagerBytes", U.SourceManagerBytes);
+    J.attribute("preprocessorBytes", U.PreprocessorBytes);
+    J.attribute("decls", U.Decls);
+    J.attribute("types", U.Types);
+    J.attribute("stmts", U.Stmts);
+  };
+
+  llvm::json::OStream J(OS, /*IndentSize=*/2);
+  J.object([&] {
+    J.attributeObject("total", [&] { WriteUsage(J, Total); });
+    J.attributeArray("files", [&] {
+      for (const auto *File : Sorted)
+        J.object([&] {
+          J.attribute("name", File->first());
+          J.attribute("inclusions", File->second.Inclusions);
+          WriteUsage(J, File->second);
+        });
+    });
+  });
+  OS << "\n";
+}
@@ -47,6 +47,13 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -1639,14 +1646,132 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Fast scanning of character runs
+//===----------------------------------------------------------------------===//
+//
+// The functions below skip over the bytes which can't end the current run and
+// don't need any special handling, 16 at a time when SSE2 is available.  They
+// stop at anything that may be a trigraph, an escaped newline, a UCN or a
+// code-completion point, so the slow paths which follow them see exactly the
+// same characters (and emit exactly the same diagnostics) as before.  Vector
+// loads never go past BufferEnd; the remainder is scanned with the CharInfo
+// tables, relying on the buffer being nul-terminated like the loops they
+// replace.
+
+#ifdef __SSE2__
+/// Returns a vector with all bits set in the bytes of Chunk which are in the
+/// range [Lo, Hi].  Only meaningful for ASCII bounds: bytes with the high bit
+/// set compare as negative and are never in range.
+static inline __m128i bytesInRange(__m128i Chunk, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(Chunk, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(Chunk, _mm_set1_epi8(Hi + 1)));
+}
+
+static inline __m128i bytesEqual(__m128i Chunk, char C) {
+  return _mm_cmpeq_epi8(Chunk, _mm_set1_epi8(C));
+}
+#endif
+
+/// Returns a pointer to the first character at or after CurPtr which is not
+/// [_A-Za-z0-9].
+static const char *skipIdentifierBody(const char *CurPtr,
+                                      const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chunk = _mm_loadu_si128((const __m128i *)CurPtr);
+    // Setting bit 5 maps upper case letters to lower case ones, and no other
+    // byte to a lower case letter.
+    __m128i Lower = _mm_or_si128(Chunk, _mm_set1_epi8(0x20));
+    __m128i Body = _mm_or_si128(
+        _mm_or_si128(bytesInRange(Lower, 'a', 'z'),
+                     bytesInRange(Chunk, '0', '9')),
+        bytesEqual(Chunk, '_'));
+    unsigned Mask = ~_mm_movemask_epi8(Body) & 0xFFFF;
+    if (Mask != 0)
+      return CurPtr + llvm::countTrailingZeros(Mask);
+    CurPtr += 16;
+  }
+#endif
+  while (isIdentifierBody(*CurPtr))
+    ++CurPtr;
+  return CurPtr;
+}
+
+/// Returns a pointer to the first character at or after CurPtr which is not
+/// horizontal whitespace.
+static const char *skipHorizontalWhitespace(const char *CurPtr,
+                                            const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chunk = _mm_loadu_si128((const __m128i *)CurPtr);
+    __m128i Space = _mm_or_si128(
+        _mm_or_si128(bytesEqual(Chunk, ' '), bytesEqual(Chunk, '\t')),
+        bytesInRange(Chunk, '\v', '\f'));
+    unsigned Mask = ~_mm_movemask_epi8(Space) & 0xFFFF;
+    if (Mask != 0)
+      return CurPtr + llvm::countTrailingZeros(Mask);
+    CurPtr += 16;
+  }
+#endif
+  while (isHorizontalWhitespace(*CurPtr))
+    ++CurPtr;
+  return CurPtr;
+}
+
+/// Returns a pointer to the first '\n', '\r' or '\0' at or after CurPtr.
+static const char *findLineEnd(const char *CurPtr, const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chunk = _mm_loadu_si128((const __m128i *)CurPtr);
+    __m128i End = _mm_or_si128(
+        _mm_or_si128(bytesEqual(Chunk, '\n'), bytesEqual(Chunk, '\r')),
+        bytesEqual(Chunk, 0));
+    unsigned Mask = _mm_movemask_epi8(End);
+    if (Mask != 0)
+      return CurPtr + llvm::countTrailingZeros(Mask);
+    CurPtr += 16;
+  }
+#endif
+  while (*CurPtr != 0 && *CurPtr != '\n' && *CurPtr != '\r')
+    ++CurPtr;
+  return CurPtr;
+}
+
+/// Returns a pointer to the first character at or after CurPtr in the body of
+/// a string or character literal which getAndAdvanceChar() would not simply
+/// return as is, or which the literal lexers handle specially: Quote, '\\',
+/// '?', '\n', '\r' or '\0'.
+static const char *skipLiteralBody(const char *CurPtr, const char *BufferEnd,
+                                   char Quote) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chunk = _mm_loadu_si128((const __m128i *)CurPtr);
+    __m128i Special = _mm_or_si128(
+        _mm_or_si128(
+            _mm_or_si128(bytesEqual(Chunk, Quote), bytesEqual(Chunk, '\\')),
+            _mm_or_si128(bytesEqual(Chunk, '?'), bytesEqual(Chunk, '\n'))),
+        _mm_or_si128(bytesEqual(Chunk, '\r'), bytesEqual(Chunk, 0)));
+    unsigned Mask = _mm_movemask_epi8(Special);
+    if (Mask != 0)
+      return CurPtr + llvm::countTrailingZeros(Mask);
+    CurPtr += 16;
+  }
+#endif
+  while (true) {
+    char C = *CurPtr;
+    if (C == Quote || C == '\\' || C == '?' || isVerticalWhitespace(C) ||
+        C == 0)
+      return CurPtr;
+    ++CurPtr;
+  }
+}
+
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
-  unsigned char C = *CurPtr++;
-  while (isIdentifierBody(C))
-    C = *CurPtr++;
-
-  --CurPtr;   // Back up over the skipped character.
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
+  unsigned char C = *CurPtr;
 
   // Fast path, no $,\,? in identifier found.  '\' might be an escaped newline
   // or UCN, and ? might be a trigraph for '\', an escaped newline or UCN.
@@ -1920,6 +2045,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
            ? diag::warn_cxx98_compat_unicode_literal
            : diag::warn_c99_compat_unicode_literal);
 
+  CurPtr = skipLiteralBody(CurPtr, BufferEnd, '"');
   char C = getAndAdvanceChar(CurPtr, Result);
   while (C != '"') {
     // Skip escaped characters.  Escaped newlines will already be processed by
@@ -1948,6 +2074,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipLiteralBody(CurPtr, BufferEnd, '"');
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2170,6 +2297,7 @@ bool Lexer::LexCharConstant(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipLiteralBody(CurPtr, BufferEnd, '\'');
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2211,8 +2339,8 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
-    while (isHorizontalWhitespace(Char))
-      Char = *++CurPtr;
+    CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+    Char = *CurPtr;
 
     // Otherwise if we have something other than whitespace, we're done.
     if (!isVerticalWhitespace(Char))
@@ -2288,11 +2416,10 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    // Skip over characters in the fast loop, up to a newline, a DOS-style
+    // newline or potentially EOF.
+    CurPtr = findLineEnd(CurPtr, BufferEnd);
     C = *CurPtr;
-    // Skip over characters in the fast loop.
-    while (C != 0 &&                // Potentially EOF.
-           C != '\n' && C != '\r')  // Newline or DOS-style newline.
-      C = *++CurPtr;
 
     const char *NextLine = CurPtr;
     if (C != 0) {
@@ -2495,13 +2622,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -33,6 +33,7 @@
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
@@ -79,6 +80,9 @@ class AnalysisConsumer : public AnalysisASTConsumer,
   AnalysisMode RecVisitorMode;
   /// Bug Reporter to use while recursively visiting Decls.
   BugReporter *RecVisitorBR;
+  /// The number of functions handed to HandleCode() while recursively visiting
+  /// Decls, used to split them into shards.
+  unsigned RecVisitorPosition = 0;
 
   std::vector<std::function<void(CheckerRegistry &)>> CheckerRegistrationFns;
 
@@ -247,6 +251,24 @@ public:
                               ExprEngine::InliningModes IMode,
                               SetOfConstDecls *VisitedCallees);
 
+  /// Returns true if the path-sensitive analysis of the function, or of the
+  /// call graph component, at the given position in the analysis order belongs
+  /// to the shard analyzed by this invocation (see the 'shard-count' analyzer
+  /// option). The order, and hence the assignment to shards, is the same in
+  /// every shard.
+  bool isInShard(unsigned Position) const {
+    return Opts->ShardCount <= 1 ||
+           Position % Opts->ShardCount == Opts->ShardIndex;
+  }
+
+  /// Returns the analysis mode for the next function or block handled while
+  /// recursively visiting Decls.
+  AnalysisMode getRecVisitorModeForNextDecl() {
+    if (isInShard(RecVisitorPosition++))
+      return RecVisitorMode;
+    return RecVisitorMode & ~AM_Path;
+  }
+
   /// Visitors for the RecursiveASTVisitor.
   bool shouldWalkTypesOfTypeLocs() const { return false; }
 
@@ -301,27 +323,27 @@ public:
     // only determined when they are instantiated.
     if (FD->isThisDeclarationADefinition() &&
         !FD->isDependentContext()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
-      HandleCode(FD, RecVisitorMode);
+      assert(!(RecVisitorMode & AM_Path) || Mgr->shouldInlineCall() == false);
+      HandleCode(FD, getRecVisitorModeForNextDecl());
     }
     return true;
   }
 
   bool VisitObjCMethodDecl(ObjCMethodDecl *MD) {
     if (MD->isThisDeclarationADefinition()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
-      HandleCode(MD, RecVisitorMode);
+      assert(!(RecVisitorMode & AM_Path) || Mgr->shouldInlineCall() == false);
+      HandleCode(MD, getRecVisitorModeForNextDecl());
     }
     return true;
   }
 
   bool VisitBlockDecl(BlockDecl *BD) {
     if (BD->hasBody()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
+      assert(!(RecVisitorMode & AM_Path) || Mgr->shouldInlineCall() == false);
       // Since we skip function template definitions, we should skip blocks
       // declared in those functions as well.
       if (!BD->isDependentContext()) {
-        HandleCode(BD, RecVisitorMode);
+        HandleCode(BD, getRecVisitorModeForNextDecl());
       }
     }
     return true;
@@ -438,9 +460,59 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // inlined functions. The topological order allows the "do not reanalyze
   // previously inlined function" performance heuristic to be triggered more
   // often.
+  //
+  // When the analysis is split into shards, each function is analyzed by the
+  // shard of the first function in this order which may inline it. A function
+  // is then skipped, or analyzed, as top level by the same shard which would
+  // have skipped or analyzed it without sharding.
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+
+  // Functions which may be inlined even though the call graph has no edge to
+  // them: the overriders of the virtual and Objective-C methods called, and
+  // the blocks defined in a function. Calls through function pointers are
+  // not tracked.
+  llvm::DenseMap<const Decl *, SmallVector<const Decl *, 2>> Overriders;
+  llvm::DenseMap<const Decl *, SmallVector<const Decl *, 2>> Blocks;
+  if (Opts->ShardCount > 1) {
+    for (const CallGraphNode *N : RPOT) {
+      const Decl *D = N->getDecl();
+      if (!D)
+        continue;
+      if (const auto *MD = dyn_cast<CXXMethodDecl>(D)) {
+        for (const CXXMethodDecl *Overridden : MD->overridden_methods())
+          Overriders[Overridden->getCanonicalDecl()].push_back(D);
+      } else if (const auto *MD = dyn_cast<ObjCMethodDecl>(D)) {
+        SmallVector<const ObjCMethodDecl *, 4> Overridden;
+        MD->getOverriddenMethods(Overridden);
+        for (const ObjCMethodDecl *OMD : Overridden)
+          Overriders[OMD->getCanonicalDecl()].push_back(D);
+      } else if (isa<BlockDecl>(D)) {
+        if (const DeclContext *Parent = D->getParentFunctionOrMethod())
+          Blocks[cast<Decl>(Parent)->getCanonicalDecl()].push_back(D);
+      }
+    }
+  }
+
+  // The functions which may not be inlined by an earlier function are
+  // numbered in this order. Every other function gets the number of the first
+  // function which may inline it, and functions are assigned to shards by
+  // their number.
+  llvm::DenseMap<const Decl *, unsigned> Owners;
+  auto AssignOwner = [&](const Decl *Callee, unsigned Owner) {
+    SmallVector<const Decl *, 4> Worklist{Callee};
+    while (!Worklist.empty()) {
+      const Decl *D = Worklist.pop_back_val()->getCanonicalDecl();
+      if (!Owners.try_emplace(D, Owner).second)
+        continue;
+      auto It = Overriders.find(D);
+      if (It != Overriders.end())
+        Worklist.append(It->second.begin(), It->second.end());
+    }
+  };
+  unsigned NumOwners = 0;
+
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -452,6 +524,25 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Pass the owner on to the functions this one may inline, unless an
+    // earlier function may inline them too, and skip the functions owned by
+    // other shards.
+    if (Opts->ShardCount > 1) {
+      auto Inserted = Owners.try_emplace(D->getCanonicalDecl(), NumOwners);
+      if (Inserted.second)
+        ++NumOwners;
+      const unsigned Owner = Inserted.first->second;
+      for (const CallGraphNode *Callee : N->callees())
+        if (const Decl *CalleeD = Callee->getDecl())
+          AssignOwner(CalleeD, Owner);
+      auto It = Blocks.find(D->getCanonicalDecl());
+      if (It != Blocks.end())
+        for (const Decl *Block : It->second)
+          AssignOwner(Block, Owner);
+      if (!isInShard(Owner))
+        continue;
+    }
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -485,16 +576,21 @@ static bool isBisonFile(ASTContext &C) {
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->stopTimer();
+  // When the analysis is split into shards, only the first one runs the
+  // AST-only checks, so that their reports are not duplicated.
+  const bool RunSyntaxChecks = Opts->ShardIndex == 0;
+  if (RunSyntaxChecks) {
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->startTimer();
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->stopTimer();
+  }
 
   // Run the AST-only checks using the order in which functions are defined.
   // If inlining is not turned on, use the simplest function order for path
   // sensitive analyzes as well.
-  RecVisitorMode = AM_Syntax;
+  RecVisitorMode = RunSyntaxChecks ? AM_Syntax : AM_None;
   if (!Mgr->shouldInlineCall())
     RecVisitorMode |= AM_Path;
   RecVisitorBR = &BR;
@@ -514,7 +610,8 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
   // After all decls handled, run checkers on the entire TranslationUnit.
-  checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+  if (RunSyntaxChecks)
+    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
   BR.FlushReports();
   RecVisitorBR = nullptr;
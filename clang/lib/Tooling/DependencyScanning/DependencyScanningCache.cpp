@@ -0,0 +1,279 @@
+//===- DependencyScanningCache.cpp - clang-scan-deps disk cache -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanning/DependencyScanningCache.h"
+#include "clang/Basic/Version.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace dependencies;
+
+namespace {
+
+// Bump the version whenever the format of the entries or the output of the
+// minimizer changes.
+constexpr uint32_t CacheVersion = 2;
+constexpr llvm::StringLiteral MinimizedMagic = "CSDM";
+constexpr llvm::StringLiteral DependencyMagic = "CSDD";
+
+class EntryWriter {
+public:
+  EntryWriter(llvm::StringLiteral Magic)
+      : OS(Buffer), W(OS, llvm::support::little) {
+    OS << Magic;
+    W.write<uint32_t>(CacheVersion);
+  }
+
+  void write32(uint32_t Value) { W.write<uint32_t>(Value); }
+  void write64(uint64_t Value) { W.write<uint64_t>(Value); }
+  void writeString(StringRef S) {
+    write32(S.size());
+    OS << S;
+  }
+
+  /// Writes the entry, replacing any existing one atomically.
+  void save(StringRef Path) {
+    llvm::consumeError(llvm::writeFileAtomically(
+        (Path + "-%%%%%%%%.tmp").str(), Path, OS.str()));
+  }
+
+private:
+  std::string Buffer;
+  llvm::raw_string_ostream OS;
+  llvm::support::endian::Writer W;
+};
+
+/// Reads an entry, and stops at the first malformed field.
+class EntryReader {
+public:
+  EntryReader(StringRef Data, llvm::StringLiteral Magic) : Data(Data) {
+    if (!this->Data.consume_front(Magic) || read32() != CacheVersion)
+      Failed = true;
+  }
+
+  bool failed() const { return Failed; }
+
+  uint32_t read32() { return read<uint32_t>(); }
+  uint64_t read64() { return read<uint64_t>(); }
+  StringRef readString() {
+    uint32_t Size = read32();
+    if (Failed || Data.size() < Size) {
+      Failed = true;
+      return "";
+    }
+    StringRef S = Data.take_front(Size);
+    Data = Data.drop_front(Size);
+    return S;
+  }
+
+private:
+  template <typename T> T read() {
+    if (Failed || Data.size() < sizeof(T)) {
+      Failed = true;
+      return 0;
+    }
+    T Value = llvm::support::endian::read<T, llvm::support::little,
+                                          llvm::support::unaligned>(
+        Data.data());
+    Data = Data.drop_front(sizeof(T));
+    return Value;
+  }
+
+  StringRef Data;
+  bool Failed = false;
+};
+
+std::string getEntryDirectory(StringRef Directory, StringRef Kind) {
+  SmallString<256> Path(Directory);
+  llvm::sys::path::append(Path, Kind);
+  llvm::sys::fs::create_directories(Path);
+  return std::string(Path.str());
+}
+
+std::string getEntryPath(StringRef Directory, StringRef Key) {
+  SmallString<256> Path(Directory);
+  llvm::sys::path::append(Path, Key);
+  return std::string(Path.str());
+}
+
+uint64_t getModificationTime(const llvm::sys::fs::file_status &Status) {
+  return Status.getLastModificationTime().time_since_epoch().count();
+}
+
+} // end anonymous namespace
+
+DependencyScanningPersistentCache::DependencyScanningPersistentCache(
+    StringRef Directory)
+    : MinimizedDirectory(getEntryDirectory(Directory, "minimized")),
+      DependencyDirectory(getEntryDirectory(Directory, "deps")),
+      CreationTime(std::chrono::system_clock::now()) {}
+
+std::string
+DependencyScanningPersistentCache::getSourceKey(StringRef Contents) {
+  static const std::string VersionHash =
+      llvm::utohexstr(llvm::xxHash64(getClangFullRepositoryVersion()));
+  return llvm::utohexstr(llvm::xxHash64(Contents)) + "-" +
+         llvm::utostr(Contents.size()) + "-" + VersionHash;
+}
+
+std::string DependencyScanningPersistentCache::getCommandKey(
+    const CompileCommand &Command, StringRef WorkingDirectory) {
+  llvm::MD5 Hash;
+  auto AddString = [&](StringRef S) {
+    Hash.update(S);
+    Hash.update(llvm::ArrayRef<uint8_t>{0});
+  };
+  AddString(getClangFullVersion());
+  AddString(WorkingDirectory);
+  AddString(Command.Directory);
+  AddString(Command.Filename);
+  for (const std::string &Arg : Command.CommandLine)
+    AddString(Arg);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return std::string(Result.digest().str());
+}
+
+llvm::Optional<MinimizedSource>
+DependencyScanningPersistentCache::getMinimizedSource(StringRef Key) {
+  auto Buffer =
+      llvm::MemoryBuffer::getFile(getEntryPath(MinimizedDirectory, Key));
+  if (!Buffer)
+    return llvm::None;
+  EntryReader R((*Buffer)->getBuffer(), MinimizedMagic);
+  MinimizedSource Source;
+  for (uint32_t I = 0, N = R.read32(); I < N && !R.failed(); ++I) {
+    uint32_t Offset = R.read32();
+    Source.SkippedRanges.emplace_back(Offset, R.read32());
+  }
+  Source.Contents = std::string(R.readString());
+  if (R.failed())
+    return llvm::None;
+  return Source;
+}
+
+void DependencyScanningPersistentCache::addMinimizedSource(
+    StringRef Key, const MinimizedSource &Source) {
+  EntryWriter W(MinimizedMagic);
+  W.write32(Source.SkippedRanges.size());
+  for (const auto &Range : Source.SkippedRanges) {
+    W.write32(Range.first);
+    W.write32(Range.second);
+  }
+  W.writeString(Source.Contents);
+  W.save(getEntryPath(MinimizedDirectory, Key));
+}
+
+llvm::Optional<std::string>
+DependencyScanningPersistentCache::getDependencyFile(StringRef Key) {
+  auto Buffer =
+      llvm::MemoryBuffer::getFile(getEntryPath(DependencyDirectory, Key));
+  if (!Buffer)
+    return llvm::None;
+  EntryReader R((*Buffer)->getBuffer(), DependencyMagic);
+  for (uint32_t I = 0, N = R.read32(); I < N; ++I) {
+    StringRef Path = R.readString();
+    uint64_t Size = R.read64();
+    uint64_t ModTime = R.read64();
+    uint64_t ContentHash = R.read64();
+    if (R.failed())
+      return llvm::None;
+
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Path, Status) || Status.getSize() != Size)
+      return llvm::None;
+    if (getModificationTime(Status) == ModTime)
+      continue;
+    // The file was touched, e.g. by a checkout, but might be unchanged.
+    auto Contents = llvm::MemoryBuffer::getFile(Path);
+    if (!Contents || llvm::xxHash64((*Contents)->getBuffer()) != ContentHash)
+      return llvm::None;
+  }
+  for (uint32_t I = 0, N = R.read32(); I < N; ++I) {
+    StringRef Path = R.readString();
+    bool Existed = R.read32();
+    uint64_t ModTime = R.read64();
+    if (R.failed())
+      return llvm::None;
+
+    // A file created in the directory might now be found instead of one
+    // listed in the dependency file.
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Path, Status)) {
+      if (Existed)
+        return llvm::None;
+      continue;
+    }
+    if (!Existed || getModificationTime(Status) != ModTime)
+      return llvm::None;
+  }
+  StringRef DependencyFile = R.readString();
+  if (R.failed())
+    return llvm::None;
+  return std::string(DependencyFile);
+}
+
+void DependencyScanningPersistentCache::addDependencyFile(
+    StringRef Key, ArrayRef<std::string> Inputs,
+    ArrayRef<std::string> MissingFiles, StringRef WorkingDirectory,
+    StringRef DependencyFile) {
+  EntryWriter W(DependencyMagic);
+  W.write32(Inputs.size());
+  for (const std::string &Input : Inputs) {
+    SmallString<256> Path(Input);
+    llvm::sys::fs::make_absolute(WorkingDirectory, Path);
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Path, Status) ||
+        Status.getLastModificationTime() >= CreationTime)
+      return;
+    auto Contents = llvm::MemoryBuffer::getFile(Path);
+    if (!Contents)
+      return;
+    W.writeString(Path);
+    W.write64(Status.getSize());
+    W.write64(getModificationTime(Status));
+    W.write64(llvm::xxHash64((*Contents)->getBuffer()));
+  }
+
+  // Creating a missing file modifies its directory, or creates it. Record the
+  // modification time of each directory, or None if it doesn't exist.
+  llvm::StringMap<llvm::Optional<uint64_t>> Directories;
+  for (const std::string &Missing : MissingFiles) {
+    SmallString<256> Path(Missing);
+    llvm::sys::fs::make_absolute(WorkingDirectory, Path);
+    StringRef Directory = llvm::sys::path::parent_path(Path);
+    if (Directory.empty() || Directories.count(Directory))
+      continue;
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Directory, Status)) {
+      Directories[Directory] = llvm::None;
+      continue;
+    }
+    if (Status.getLastModificationTime() >= CreationTime)
+      return;
+    Directories[Directory] = getModificationTime(Status);
+  }
+  W.write32(Directories.size());
+  for (const auto &Directory : Directories) {
+    W.writeString(Directory.getKey());
+    W.write32(Directory.getValue().hasValue());
+    W.write64(Directory.getValue().getValueOr(0));
+  }
+
+  W.writeString(DependencyFile);
+  W.save(getEntryPath(DependencyDirectory, Key));
+}
@@ -16,7 +16,8 @@ using namespace tooling;
 using namespace dependencies;
 
 CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
-    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize) {
+    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize,
+    DependencyScanningPersistentCache *PersistentCache) {
   // Load the file and its content from the file system.
   llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> MaybeFile =
       FS.openFileForRead(Filename);
@@ -33,11 +34,24 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
     return MaybeBuffer.getError();
 
   llvm::SmallString<1024> MinimizedFileContents;
-  // Minimize the file down to directives that might affect the dependencies.
   const auto &Buffer = *MaybeBuffer;
+  std::string CacheKey;
+  llvm::Optional<MinimizedSource> Cached;
+  if (Minimize && PersistentCache) {
+    CacheKey =
+        DependencyScanningPersistentCache::getSourceKey(Buffer->getBuffer());
+    Cached = PersistentCache->getMinimizedSource(CacheKey);
+  }
+  // Minimize the file down to directives that might affect the dependencies.
   SmallVector<minimize_source_to_dependency_directives::Token, 64> Tokens;
-  if (!Minimize || minimizeSourceToDependencyDirectives(
-                       Buffer->getBuffer(), MinimizedFileContents, Tokens)) {
+  if (Cached) {
+    MinimizedFileContents = Cached->Contents;
+    // Keep the null terminator the minimizer would have produced.
+    MinimizedFileContents.push_back('\0');
+    MinimizedFileContents.pop_back();
+  } else if (!Minimize ||
+             minimizeSourceToDependencyDirectives(
+                 Buffer->getBuffer(), MinimizedFileContents, Tokens)) {
     // Use the original file unless requested otherwise, or
     // if the minimization failed.
     // FIXME: Propage the diagnostic if desired by the client.
@@ -70,13 +84,20 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
   // it right where the buffer ends.
   Result.Contents.pop_back();
 
+  PreprocessorSkippedRangeMapping Mapping;
+  if (Cached) {
+    for (const auto &Range : Cached->SkippedRanges)
+      Mapping[Range.first] = Range.second;
+    Result.PPSkippedRangeMapping = std::move(Mapping);
+    return Result;
+  }
+
   // Compute the skipped PP ranges that speedup skipping over inactive
   // preprocessor blocks.
   llvm::SmallVector<minimize_source_to_dependency_directives::SkippedRange, 32>
       SkippedRanges;
   minimize_source_to_dependency_directives::computeSkippedRanges(Tokens,
                                                                  SkippedRanges);
-  PreprocessorSkippedRangeMapping Mapping;
   for (const auto &Range : SkippedRanges) {
     if (Range.Length < 16) {
       // Ignore small ranges as non-profitable.
@@ -86,6 +107,13 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
     }
     Mapping[Range.Offset] = Range.Length;
   }
+
+  if (PersistentCache) {
+    MinimizedSource Source;
+    Source.Contents = std::string(Result.Contents.str());
+    Source.SkippedRanges.assign(Mapping.begin(), Mapping.end());
+    PersistentCache->addMinimizedSource(CacheKey, Source);
+  }
   Result.PPSkippedRangeMapping = std::move(Mapping);
 
   return Result;
@@ -185,7 +213,7 @@ DependencyScanningWorkerFilesystem::getOrCreateFileSystemEntry(
             std::move(*MaybeStatus));
       else
         CacheEntry = CachedFileSystemEntry::createFileEntry(
-            Filename, FS, !KeepOriginalSource);
+            Filename, FS, !KeepOriginalSource, PersistentCache);
     }
 
     Result = &CacheEntry;
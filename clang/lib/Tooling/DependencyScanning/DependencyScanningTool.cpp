@@ -26,7 +26,7 @@ std::vector<std::string> FullDependencies::getAdditionalCommandLine(
 
 DependencyScanningTool::DependencyScanningTool(
     DependencyScanningService &Service)
-    : Worker(Service) {}
+    : Worker(Service), PersistentCache(Service.getPersistentCache()) {}
 
 llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
     const tooling::CompilationDatabase &Compilations, StringRef CWD) {
@@ -48,6 +48,10 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
 
     void handleContextHash(std::string Hash) override {}
 
+    void handleMissingFile(StringRef Path) override {
+      MissingFiles.push_back(std::string(Path));
+    }
+
     void printDependencies(std::string &S) {
       if (!Opts)
         return;
@@ -71,9 +75,14 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
       Generator.printDependencies(S);
     }
 
+    ArrayRef<std::string> getDependencies() const { return Dependencies; }
+
+    ArrayRef<std::string> getMissingFiles() const { return MissingFiles; }
+
   private:
     std::unique_ptr<DependencyOutputOptions> Opts;
     std::vector<std::string> Dependencies;
+    std::vector<std::string> MissingFiles;
   };
 
   // We expect a single command here because if a source file occurs multiple
@@ -83,7 +92,16 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
   // behavior.
   assert(Compilations.getAllCompileCommands().size() == 1 &&
          "Expected a compilation database with a single command!");
-  std::string Input = Compilations.getAllCompileCommands().front().Filename;
+  CompileCommand Command = Compilations.getAllCompileCommands().front();
+  std::string Input = Command.Filename;
+
+  std::string CacheKey;
+  if (PersistentCache) {
+    CacheKey = DependencyScanningPersistentCache::getCommandKey(Command, CWD);
+    if (llvm::Optional<std::string> Cached =
+            PersistentCache->getDependencyFile(CacheKey))
+      return std::move(*Cached);
+  }
 
   MakeDependencyPrinterConsumer Consumer;
   auto Result = Worker.computeDependencies(Input, CWD, Compilations, Consumer);
@@ -91,6 +109,10 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
     return std::move(Result);
   std::string Output;
   Consumer.printDependencies(Output);
+  if (PersistentCache)
+    PersistentCache->addDependencyFile(CacheKey, Consumer.getDependencies(),
+                                       Consumer.getMissingFiles(), CWD,
+                                       Output);
   return Output;
 }
 
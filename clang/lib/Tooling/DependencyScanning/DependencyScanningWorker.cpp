@@ -16,6 +16,7 @@
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringSet.h"
 
 using namespace clang;
 using namespace tooling;
@@ -44,6 +45,41 @@ private:
   DependencyConsumer &C;
 };
 
+/// Records the paths that were looked up without success, so that a cached
+/// result can be invalidated when one of them is created.
+class MissingFileRecorder : public llvm::vfs::ProxyFileSystem {
+public:
+  MissingFileRecorder(IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override {
+    llvm::ErrorOr<llvm::vfs::Status> Result = ProxyFileSystem::status(Path);
+    if (!Result)
+      record(Path);
+    return Result;
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    auto Result = ProxyFileSystem::openFileForRead(Path);
+    if (!Result)
+      record(Path);
+    return Result;
+  }
+
+  const llvm::StringSet<> &getMissingFiles() const { return MissingFiles; }
+
+private:
+  void record(const Twine &Path) {
+    llvm::SmallString<256> AbsPath;
+    Path.toVector(AbsPath);
+    makeAbsolute(AbsPath);
+    MissingFiles.insert(AbsPath);
+  }
+
+  llvm::StringSet<> MissingFiles;
+};
+
 /// A clang tool that runs the preprocessor in a mode that's optimized for
 /// dependency scanning for the given compiler invocation.
 class DependencyScanningAction : public tooling::ToolAction {
@@ -52,10 +88,10 @@ public:
       StringRef WorkingDirectory, DependencyConsumer &Consumer,
       llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS,
       ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings,
-      ScanningOutputFormat Format)
+      ScanningOutputFormat Format, bool RecordMissingFiles)
       : WorkingDirectory(WorkingDirectory), Consumer(Consumer),
         DepFS(std::move(DepFS)), PPSkipMappings(PPSkipMappings),
-        Format(Format) {}
+        Format(Format), RecordMissingFiles(RecordMissingFiles) {}
 
   bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
                      FileManager *FileMgr,
@@ -96,6 +132,14 @@ public:
             .ExcludedConditionalDirectiveSkipMappings = PPSkipMappings;
     }
 
+    // Record the files that were not found. A header created at one of these
+    // paths could shadow one found later in the search path.
+    IntrusiveRefCntPtr<MissingFileRecorder> Recorder;
+    if (RecordMissingFiles) {
+      Recorder = new MissingFileRecorder(&FileMgr->getVirtualFileSystem());
+      FileMgr->setVirtualFileSystem(Recorder);
+    }
+
     FileMgr->getFileSystemOpts().WorkingDir = std::string(WorkingDirectory);
     Compiler.setFileManager(FileMgr);
     Compiler.createSourceManager(*FileMgr);
@@ -136,6 +180,9 @@ public:
     const bool Result = Compiler.ExecuteAction(*Action);
     if (!DepFS)
       FileMgr->clearStatCache();
+    if (Recorder)
+      for (const auto &Path : Recorder->getMissingFiles())
+        Consumer.handleMissingFile(Path.getKey());
     return Result;
   }
 
@@ -145,13 +192,15 @@ private:
   llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS;
   ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings;
   ScanningOutputFormat Format;
+  bool RecordMissingFiles;
 };
 
 } // end anonymous namespace
 
 DependencyScanningWorker::DependencyScanningWorker(
     DependencyScanningService &Service)
-    : Format(Service.getFormat()) {
+    : Format(Service.getFormat()),
+      RecordMissingFiles(Service.getPersistentCache() != nullptr) {
   DiagOpts = new DiagnosticOptions();
   PCHContainerOps = std::make_shared<PCHContainerOperations>();
   RealFS = llvm::vfs::createPhysicalFileSystem();
@@ -160,8 +209,11 @@ DependencyScanningWorker::DependencyScanningWorker(
         std::make_unique<ExcludedPreprocessorDirectiveSkipMapping>();
   if (Service.getMode() == ScanningMode::MinimizedSourcePreprocessing)
     DepFS = new DependencyScanningWorkerFilesystem(
-        Service.getSharedCache(), RealFS, PPSkipMappings.get());
-  if (Service.canReuseFileManager())
+        Service.getSharedCache(), RealFS, PPSkipMappings.get(),
+        Service.getPersistentCache());
+  // A reused file manager remembers the files it didn't find, which then
+  // wouldn't be recorded for the following translation units.
+  if (Service.canReuseFileManager() && !RecordMissingFiles)
     Files = new FileManager(FileSystemOptions(), RealFS);
 }
 
@@ -194,7 +246,8 @@ llvm::Error DependencyScanningWorker::computeDependencies(
     Tool.setPrintErrorMessage(false);
     Tool.setDiagnosticConsumer(&DC);
     DependencyScanningAction Action(WorkingDirectory, Consumer, DepFS,
-                                    PPSkipMappings.get(), Format);
+                                    PPSkipMappings.get(), Format,
+                                    RecordMissingFiles);
     return !Tool.run(&Action);
   });
 }
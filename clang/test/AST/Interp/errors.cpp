@@ -0,0 +1,69 @@
+// RUN: %clang_cc1 -std=c++20 -fexperimental-new-constant-interpreter -fconstexpr-depth=8 -verify %s
+// RUN: %clang_cc1 -std=c++20 -fconstexpr-depth=8 -verify %s
+
+constexpr int divide(int A, int B) {
+  return A / B; // expected-note {{division by zero}} \
+                // expected-note {{value 2147483648 is outside the range of representable values of type 'int'}}
+}
+static_assert(divide(7, 2) == 3, "");
+static_assert(divide(1, 0) == 0, ""); // expected-error {{constant}} \
+                                      // expected-note {{in call to 'divide(1, 0)'}}
+static_assert(divide(-2147483647 - 1, -1) == 0, ""); // expected-error {{constant}} \
+                                                     // expected-note {{in call to}}
+
+constexpr int recurse(int N) {
+  return N == 0 ? 0 : recurse(N - 1) + 1; // expected-note {{exceeded maximum depth of 8 calls}} \
+                                          // expected-note +{{in call to}}
+}
+static_assert(recurse(4) == 4, "");
+static_assert(recurse(100) == 100, ""); // expected-error {{constant}} \
+                                        // expected-note {{in call to 'recurse(100)'}}
+
+constexpr int pastEnd(int N) {
+  int Arr[3] = {1, 2, 3};
+  const int *P = Arr + N; // expected-note {{cannot refer to element 5 of array of 3 elements}}
+  return *P;
+}
+static_assert(pastEnd(2) == 3, "");
+static_assert(pastEnd(5) == 0, ""); // expected-error {{constant}} \
+                                    // expected-note {{in call to 'pastEnd(5)'}}
+
+constexpr int uninit(bool Set) {
+  int X;
+  if (Set)
+    X = 1;
+  return X; // expected-note {{read of uninitialized object}}
+}
+static_assert(uninit(true) == 1, "");
+static_assert(uninit(false) == 1, ""); // expected-error {{constant}} \
+                                       // expected-note {{in call to 'uninit(false)'}}
+
+constexpr int uninitInLoop(int N) {
+  int Sum = 0;
+  for (int I = 0; I < N; ++I) {
+    int X;
+    if (I == 0)
+      X = 1;
+    Sum += X; // expected-note {{read of uninitialized object}}
+  }
+  return Sum;
+}
+static_assert(uninitInLoop(1) == 1, "");
+static_assert(uninitInLoop(2) == 2, ""); // expected-error {{constant}} \
+                                         // expected-note {{in call to 'uninitInLoop(2)'}}
+
+constexpr int uninitArrayInLoop(int N) {
+  int Sum = 0;
+  for (int I = 0; I < N; ++I) {
+    int A[2];
+    if (I == 0) {
+      A[0] = 1;
+      A[1] = 2;
+    }
+    Sum += A[1]; // expected-note {{read of uninitialized object}}
+  }
+  return Sum;
+}
+static_assert(uninitArrayInLoop(1) == 2, "");
+static_assert(uninitArrayInLoop(2) == 4, ""); // expected-error {{constant}} \
+                                              // expected-note {{in call to 'uninitArrayInLoop(2)'}}
@@ -0,0 +1,51 @@
+// RUN: %clang_cc1 -std=c++14 -fexperimental-new-constant-interpreter -verify %s
+// RUN: %clang_cc1 -std=c++14 -verify %s
+
+// expected-no-diagnostics
+
+constexpr int square(int X) { return X * X; }
+static_assert(square(7) == 49, "");
+
+constexpr int sumOfSquares(int A, int B) { return square(A) + square(B); }
+static_assert(sumOfSquares(3, 4) == 25, "");
+
+constexpr int fib(int N) { return N < 2 ? N : fib(N - 1) + fib(N - 2); }
+static_assert(fib(10) == 55, "");
+
+constexpr int gcd(int A, int B) { return B == 0 ? A : gcd(B, A % B); }
+static_assert(gcd(84, 36) == 12, "");
+
+constexpr bool isPowerOfTwo(unsigned N) {
+  return N != 0 && (N == 1 || (N % 2 == 0 && isPowerOfTwo(N / 2)));
+}
+static_assert(isPowerOfTwo(64), "");
+static_assert(!isPowerOfTwo(96), "");
+static_assert(!isPowerOfTwo(0), "");
+
+constexpr long long widen(int X) { return X; }
+static_assert(widen(-1) == -1LL, "");
+static_assert(widen(100) / 7 == 14, "");
+static_assert(-widen(9) % 4 == -1, "");
+
+constexpr char toUpper(char C) {
+  return C >= 'a' && C <= 'z' ? C - 'a' + 'A' : C;
+}
+static_assert(toUpper('q') == 'Q', "");
+static_assert(toUpper('!') == '!', "");
+
+constexpr int withDefault(int X, int Y = 10) { return X + Y; }
+static_assert(withDefault(1) == 11, "");
+static_assert(withDefault(1, 2) == 3, "");
+
+constexpr void increment(int &X) { X += 1; }
+constexpr int incremented(int X) {
+  increment(X);
+  increment(X);
+  return X;
+}
+static_assert(incremented(5) == 7, "");
+
+constexpr int definedLater(int N);
+constexpr int callsDefinedLater(int N) { return definedLater(N) + 1; }
+constexpr int definedLater(int N) { return N * 2; }
+static_assert(callsDefinedLater(3) == 7, "");
@@ -0,0 +1,117 @@
+// RUN: %clang_cc1 -std=c++14 -fexperimental-new-constant-interpreter -verify %s
+// RUN: %clang_cc1 -std=c++14 -verify %s
+
+// expected-no-diagnostics
+
+constexpr int sumWhile(int N) {
+  int Sum = 0;
+  int I = 0;
+  while (I < N) {
+    Sum += I;
+    ++I;
+  }
+  return Sum;
+}
+static_assert(sumWhile(0) == 0, "");
+static_assert(sumWhile(5) == 10, "");
+
+constexpr int sumDo(int N) {
+  int Sum = 0;
+  int I = 0;
+  do {
+    Sum += I;
+    I++;
+  } while (I < N);
+  return Sum;
+}
+static_assert(sumDo(0) == 0, "");
+static_assert(sumDo(5) == 10, "");
+
+constexpr int sumFor(int N) {
+  int Sum = 0;
+  for (int I = 0; I < N; ++I) {
+    if (I % 2 == 0)
+      continue;
+    Sum += I;
+  }
+  return Sum;
+}
+static_assert(sumFor(6) == 9, "");
+
+constexpr int firstMultiple(int N, int Step) {
+  int I = 1;
+  for (;;) {
+    if (I * Step >= N)
+      break;
+    I += 1;
+  }
+  return I * Step;
+}
+static_assert(firstMultiple(10, 3) == 12, "");
+
+constexpr int nested(int N) {
+  int Count = 0;
+  for (int I = 0; I < N; ++I)
+    for (int J = 0; J < I; ++J)
+      Count += 1;
+  return Count;
+}
+static_assert(nested(5) == 10, "");
+
+constexpr int classify(int N) {
+  switch (N) {
+  case 0:
+    return 10;
+  case 1:
+  case 2:
+    return 20;
+  default:
+    break;
+  }
+  return N > 10 ? 40 : 30;
+}
+static_assert(classify(0) == 10, "");
+static_assert(classify(2) == 20, "");
+static_assert(classify(5) == 30, "");
+static_assert(classify(50) == 40, "");
+
+constexpr int fallthrough(int N) {
+  int Result = 0;
+  switch (N) {
+  case 0:
+    Result += 1;
+  case 1:
+    Result += 2;
+    break;
+  case 2:
+    Result += 4;
+  }
+  return Result;
+}
+static_assert(fallthrough(0) == 3, "");
+static_assert(fallthrough(1) == 2, "");
+static_assert(fallthrough(2) == 4, "");
+static_assert(fallthrough(3) == 0, "");
+
+constexpr int continueInSwitch(int N) {
+  int Sum = 0;
+  for (int I = 0; I < N; ++I) {
+    int Local = I;
+    switch (Local % 3) {
+    case 0: {
+      int Skipped = Local;
+      if (Skipped >= 0)
+        continue;
+      break;
+    }
+    case 1:
+      break;
+    default:
+      Sum += 100;
+      continue;
+    }
+    Sum += Local;
+  }
+  return Sum;
+}
+static_assert(continueInSwitch(6) == 205, "");
@@ -0,0 +1,79 @@
+// RUN: %clang_cc1 -std=c++14 -fexperimental-new-constant-interpreter -verify %s
+// RUN: %clang_cc1 -std=c++14 -verify %s
+
+// expected-no-diagnostics
+
+struct Point {
+  int X;
+  int Y;
+};
+
+struct Segment {
+  Point From;
+  Point To;
+};
+
+constexpr Point Origin = {0, 0};
+static_assert(Origin.X == 0 && Origin.Y == 0, "");
+
+constexpr Segment Diagonal = {{1, 2}, {3, 4}};
+static_assert(Diagonal.From.Y == 2, "");
+static_assert(Diagonal.To.X == 3, "");
+
+constexpr int Primes[] = {2, 3, 5, 7, 11};
+static_assert(Primes[0] == 2, "");
+static_assert(Primes[4] == 11, "");
+
+constexpr int Padded[4] = {1, 2};
+static_assert(Padded[1] == 2, "");
+static_assert(Padded[3] == 0, "");
+
+constexpr Point Path[] = {{1, 1}, {2, 4}, {3, 9}};
+static_assert(Path[2].Y == 9, "");
+
+constexpr int sum(const int *P, int N) {
+  int Sum = 0;
+  for (int I = 0; I < N; ++I)
+    Sum += P[I];
+  return Sum;
+}
+static_assert(sum(Primes, 5) == 28, "");
+static_assert(sum(Primes + 2, 3) == 23, "");
+
+constexpr int sumPtr(const int *Begin, const int *End) {
+  int Sum = 0;
+  while (Begin != End)
+    Sum += *Begin++;
+  return Sum;
+}
+static_assert(sumPtr(Primes, Primes + 3) == 10, "");
+
+constexpr int length(const Segment &S) {
+  int DX = S.To.X - S.From.X;
+  int DY = S.To.Y - S.From.Y;
+  return DX * DX + DY * DY;
+}
+static_assert(length(Diagonal) == 8, "");
+
+constexpr int localArray(int N) {
+  int Values[5] = {0, 0, 0, 0, 0};
+  for (int I = 0; I < 5; ++I)
+    Values[I] = I * N;
+  int *P = &Values[1];
+  *P = 100;
+  return Values[1] + Values[4];
+}
+static_assert(localArray(3) == 112, "");
+
+constexpr int localRecord(int N) {
+  Point P = {N, N + 1};
+  Point *Ptr = &P;
+  Ptr->X *= 2;
+  P.Y += Ptr->X;
+  return P.Y;
+}
+static_assert(localRecord(5) == 16, "");
+
+constexpr bool isNull(const int *P) { return !P; }
+static_assert(isNull(nullptr), "");
+static_assert(!isNull(Primes), "");
@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -std=c++14 -fexperimental-new-constant-interpreter -fconstexpr-steps=100 -verify %s
+// RUN: %clang_cc1 -std=c++14 -fconstexpr-steps=100 -verify %s
+
+constexpr int count(int N) {
+  int I = 0;
+  while (I < N)
+    ++I; // expected-note {{step limit}}
+  return I;
+}
+static_assert(count(10) == 10, "");
+static_assert(count(1000) == 1000, ""); // expected-error {{constant}} \
+                                        // expected-note {{in call to}}
+
+constexpr int spin() { // expected-error {{never produces a constant expression}}
+  for (;;) {} // expected-note {{step limit}}
+}
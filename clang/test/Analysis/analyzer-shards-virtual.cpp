@@ -0,0 +1,47 @@
+// A virtual method is assigned to the shard of the first function which may
+// inline it through a virtual call, even though the call graph only has an
+// edge to the method of the base class. In call graph order, the functions
+// are grouped as {k, Base::get, Derived::get}, {g} and {f}.
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=all %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=shard0 %s \
+// RUN:   -analyzer-config shard-count=2,shard-index=0
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=shard1 %s \
+// RUN:   -analyzer-config shard-count=2,shard-index=1
+
+struct Base {
+  virtual int get();
+};
+
+struct Derived : Base {
+  int get() override;
+};
+
+int Base::get() {
+  return 0;
+}
+
+// This is only reported through the call in k(). Analyzing it as top level
+// in the shard of g() would report it twice.
+int Derived::get() {
+  int *p = nullptr;
+  return *p; // all-warning{{Dereference of null pointer}} \
+             // shard0-warning{{Dereference of null pointer}}
+}
+
+int f() {
+  int y = 0;
+  return 1 / y; // all-warning{{Division by zero}} \
+                // shard0-warning{{Division by zero}}
+}
+
+int g() {
+  int y = 0;
+  return 2 / y; // all-warning{{Division by zero}} \
+                // shard1-warning{{Division by zero}}
+}
+
+int k() {
+  Derived d;
+  Base *b = &d;
+  return b->get();
+}
@@ -0,0 +1,54 @@
+// Without inlining, functions are assigned to shards in the order in which
+// they are defined.
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode -verify=ipa0 %s \
+// RUN:   -analyzer-config ipa=none,shard-count=2,shard-index=0
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode -verify=ipa1 %s \
+// RUN:   -analyzer-config ipa=none,shard-count=2,shard-index=1
+
+// With inlining, a function is assigned to the shard of the first function in
+// call graph order which may inline it. The groups {k, h}, {g, identity} and
+// {f} are assigned to shards in this order: identity() is shared by g() and
+// f(), but doesn't pull f() into the shard of g(). Together, the shards report
+// exactly what the unsharded analysis reports.
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=all %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=inl0 %s \
+// RUN:   -analyzer-config shard-count=2,shard-index=0
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=inl1 %s \
+// RUN:   -analyzer-config shard-count=2,shard-index=1
+
+int identity(int x);
+
+int f(int x) {
+  int y = 0;
+  return identity(x) / y; // ipa0-warning{{Division by zero}} \
+                // all-warning{{Division by zero}} \
+                // inl0-warning{{Division by zero}}
+}
+
+int g(int x) {
+  int z;
+  // AST-only checks are only run by the first shard.
+  z = x; // ipa0-warning{{Value stored to 'z' is never read}}
+  int y = 0;
+  return identity(x) / y; // ipa1-warning{{Division by zero}} \
+                // all-warning{{Division by zero}} \
+                // inl1-warning{{Division by zero}}
+}
+
+// With inlining, this is only reported through the call in k(). Since k() and
+// h() are in the same shard, it is not reported again by analyzing h() as top
+// level in another shard.
+int h(void) {
+  int *p = 0;
+  return *p; // ipa0-warning{{Dereference of null pointer}} \
+             // all-warning{{Dereference of null pointer}} \
+             // inl0-warning{{Dereference of null pointer}}
+}
+
+int k(void) {
+  return h();
+}
+
+int identity(int x) {
+  return x;
+}
@@ -0,0 +1,49 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/cache
+// RUN: cp "%s" "%t/ctu-ast-cache.c"
+// RUN: cp "%S/Inputs/ctu-other.c" "%t/ctu-other.c"
+//
+// RUN: echo '"%t/ctu-other.c": ["gcc", "-std=c89", "-Wno-visibility", "ctu-other.c"]' | sed -e 's/\\/\\\\/g' > %t/invocations.yaml
+//
+// RUN: cd "%t" && %clang_extdef_map "%t/ctu-other.c" > externalDefMap.txt
+//
+// The first analysis parses ctu-other.c and saves its AST to the cache.
+// RUN: cd "%t" && %clang_cc1 -fsyntax-only -std=c89 -analyze \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=. \
+// RUN:   -analyzer-config ctu-invocation-list=invocations.yaml \
+// RUN:   -analyzer-config ctu-ast-cache-dir=cache \
+// RUN:   -analyzer-stats -verify ctu-ast-cache.c 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=FIRST
+// FIRST-NOT: ASTs loaded from the CTU AST cache
+// FIRST: 1 CrossTranslationUnit - The # of ASTs saved to the CTU AST cache
+//
+// The AST is saved with a table of its definitions.
+// RUN: ls %t/cache | FileCheck %s
+// CHECK: ctu-other.c-{{[0-9a-f]+}}.ast
+// CHECK-NEXT: ctu-other.c-{{[0-9a-f]+}}.ast.defs
+//
+// The second one loads it from there, and finds the definition through the
+// table instead of visiting all the declarations of the AST.
+// RUN: cd "%t" && %clang_cc1 -fsyntax-only -std=c89 -analyze \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=. \
+// RUN:   -analyzer-config ctu-invocation-list=invocations.yaml \
+// RUN:   -analyzer-config ctu-ast-cache-dir=cache \
+// RUN:   -analyzer-stats -verify ctu-ast-cache.c 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=SECOND
+// SECOND: 1 CrossTranslationUnit - The # of ASTs loaded from the CTU AST cache
+// SECOND-NOT: ASTs saved to the CTU AST cache
+// SECOND: 1 CrossTranslationUnit - The # of definitions looked up in the table of a cached AST
+//
+// FIXME: Path handling should work on all platforms.
+// REQUIRES: system-linux, asserts
+
+void clang_analyzer_eval(int);
+
+int f(int);
+void testCachedDefinition() {
+  clang_analyzer_eval(f(5) == 1); // expected-warning{{TRUE}}
+}
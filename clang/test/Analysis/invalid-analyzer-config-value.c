@@ -42,6 +42,16 @@
 // RUN:   -analyzer-config ctu-dir=0123012301230123
 
 
+// RUN: not %clang_analyze_cc1 -verify %s \
+// RUN:   -analyzer-checker=core \
+// RUN:   -analyzer-config shard-count=2,shard-index=2 \
+// RUN:   2>&1 | FileCheck %s -check-prefix=CHECK-SHARD-INDEX
+
+// CHECK-SHARD-INDEX: (frontend): invalid input for analyzer-config option
+// CHECK-SHARD-INDEX-SAME:        'shard-index', that expects an index smaller
+// CHECK-SHARD-INDEX-SAME:        than the 'shard-count' value
+
+
 // RUN: not %clang_analyze_cc1 -verify %s \
 // RUN:   -analyzer-checker=core \
 // RUN:   -analyzer-config no-false-positives=true \
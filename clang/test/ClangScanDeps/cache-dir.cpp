@@ -0,0 +1,40 @@
+// RUN: rm -rf %t.dir %t.cache %t.cdb
+// RUN: mkdir -p %t.dir/a %t.dir/b %t.cache
+// RUN: cp %s %t.dir/cache-dir.cpp
+// RUN: echo '#define HEADER_B' > %t.dir/b/header.h
+// RUN: sed -e "s|DIR|%/t.dir|g" %S/Inputs/cache-dir.json > %t.cdb
+//
+// The first scan stores the minimized sources and the dependency file.
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 -cache-dir %t.cache \
+// RUN:   | FileCheck %s --check-prefix=B
+// RUN: ls %t.cache/deps | count 1
+// RUN: ls %t.cache/minimized | count 2
+//
+// The second scan reuses the dependency file, since nothing changed, and
+// doesn't minimize any file again.
+// RUN: rm %t.cache/minimized/*
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 -cache-dir %t.cache \
+// RUN:   | FileCheck %s --check-prefix=B
+// RUN: ls %t.cache/minimized | count 0
+//
+// A header which now shadows one found later in the search path makes the scan
+// run again, since its directory was searched.
+// RUN: echo '#define HEADER_A' > %t.dir/a/header.h
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 -cache-dir %t.cache \
+// RUN:   | FileCheck %s --check-prefix=A
+// RUN: ls %t.cache/minimized | count 2
+//
+// Modifying a listed file makes the scan run again.
+// RUN: echo '// modified' >> %t.dir/cache-dir.cpp
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 -cache-dir %t.cache \
+// RUN:   | FileCheck %s --check-prefix=A
+// RUN: ls %t.cache/minimized | count 3
+
+#include "header.h"
+
+// B: cache-dir.cpp
+// B-NOT: a{{/|\\}}header.h
+// B: b{{/|\\}}header.h
+// A: cache-dir.cpp
+// A-NOT: b{{/|\\}}header.h
+// A: a{{/|\\}}header.h
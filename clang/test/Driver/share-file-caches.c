@@ -0,0 +1,35 @@
+// RUN: %clang -fshare-file-caches -c -### %s 2>&1 | FileCheck %s
+// RUN: %clang -c -### %s 2>&1 | FileCheck %s --check-prefix=NO
+
+// CHECK: "-cc1"
+// CHECK-SAME: "-fshare-file-caches"
+// NO-NOT: "-fshare-file-caches"
+
+// RUN: %clang -ffile-cache-path=%t.cache -c -### %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=PATH
+// PATH: "-cc1"
+// PATH-SAME: "-ffile-cache-path={{.*}}.cache"
+
+// Every job of an invocation compiling several files gets the flag.
+// RUN: %clang -fshare-file-caches -fsyntax-only -### %s %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=JOBS
+// JOBS: "-cc1" {{.*}}"-fshare-file-caches"
+// JOBS: "-cc1" {{.*}}"-fshare-file-caches"
+
+// The jobs still find the headers which the previous jobs looked up through
+// directories where they are missing.
+// RUN: rm -rf %t && mkdir -p %t/a %t/b %t/c
+// RUN: echo '#define VALUE 2' > %t/b/h.h
+// RUN: echo '#define VALUE 3' > %t/c/h.h
+// RUN: %clang -fintegrated-cc1 -fshare-file-caches -fsyntax-only -H \
+// RUN:   -DINCLUDE_H -I %t/a -I %t/b -I %t/c %s %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=HEADER
+// HEADER: . {{.*}}b{{/|\\}}h.h
+// HEADER-NOT: {{a|c}}{{/|\\}}h.h
+// HEADER: . {{.*}}b{{/|\\}}h.h
+// HEADER-NOT: {{a|c}}{{/|\\}}h.h
+
+#ifdef INCLUDE_H
+#include "h.h"
+_Static_assert(VALUE == 2, "h.h was found in the wrong directory");
+#endif
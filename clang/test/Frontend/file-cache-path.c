@@ -0,0 +1,38 @@
+// The files found to be missing are saved for later compilations, until their
+// directories are modified.
+// RUN: rm -rf %t && mkdir -p %t/a %t/b
+// RUN: echo '#define VALUE 1' > %t/b/h.h
+// The modification time of a directory modified in the last two seconds is
+// not trusted.
+// RUN: touch -m -a -t 201001010000 %t/a %t/b
+
+// RUN: %clang_cc1 -fsyntax-only -I %t/a -I %t/b -ffile-cache-path=%t/cache \
+// RUN:   -DEXPECTED=1 -print-stats %s 2>&1 | FileCheck %s --check-prefix=FIRST
+// FIRST: file-cache - Number of directories checked
+// FIRST-NOT: file-cache - Number of lookups of missing files
+// RUN: FileCheck %s --check-prefix=SAVED --input-file=%t/cache
+// SAVED: clang-missing-files-v1
+// SAVED: dir {{[0-9]+}} {{.*}}a{{$}}
+// SAVED-NEXT: missing h.h
+
+// A later compilation doesn't look up h.h in the first directory again.
+// RUN: %clang_cc1 -fsyntax-only -I %t/a -I %t/b -ffile-cache-path=%t/cache \
+// RUN:   -DEXPECTED=1 -print-stats %s 2>&1 | FileCheck %s --check-prefix=HIT
+// HIT: 1 file-cache - Number of lookups of missing files
+
+// Adding h.h to the first directory invalidates the saved entries.
+// RUN: echo '#define VALUE 2' > %t/a/h.h
+// RUN: touch -m -a -t 201101010000 %t/a
+// RUN: %clang_cc1 -fsyntax-only -I %t/a -I %t/b -ffile-cache-path=%t/cache \
+// RUN:   -DEXPECTED=2 -print-stats %s 2>&1 | FileCheck %s --check-prefix=MISS
+// MISS-NOT: file-cache - Number of lookups of missing files
+
+// A corrupt file is ignored and replaced.
+// RUN: echo garbage > %t/cache
+// RUN: %clang_cc1 -fsyntax-only -I %t/a -I %t/b -ffile-cache-path=%t/cache \
+// RUN:   -DEXPECTED=2 %s
+// RUN: FileCheck %s --check-prefix=REPLACED --input-file=%t/cache
+// REPLACED: clang-missing-files-v1
+
+#include <h.h>
+_Static_assert(VALUE == EXPECTED, "h.h was found in the wrong directory");
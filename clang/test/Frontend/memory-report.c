@@ -0,0 +1,36 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: echo 'struct S { int x; }; int f(struct S s) { return s.x; }' > %t/header.h
+// RUN: %clang_cc1 -fmemory-report -emit-llvm -o %t/out.ll -I %t %s
+// RUN: FileCheck %s < %t/out.memory.json
+// RUN: FileCheck %s --check-prefix=MAIN < %t/out.memory.json
+// RUN: FileCheck %s --check-prefix=POSITIVE < %t/out.memory.json
+
+#include "header.h"
+
+int g(void) { return f((struct S){1}); }
+
+// CHECK:      "total": {
+// CHECK-NEXT: "timeUs": {{[0-9]+}},
+// CHECK-NEXT: "astContextBytes": {{[1-9][0-9]*}},
+// CHECK-NEXT: "sourceManagerBytes": {{[1-9][0-9]*}},
+// CHECK-NEXT: "preprocessorBytes": {{[1-9][0-9]*}},
+// CHECK-NEXT: "decls": {{[1-9][0-9]*}},
+// CHECK-NEXT: "types": {{[1-9][0-9]*}},
+// CHECK-NEXT: "stmts": {{[1-9][0-9]*}}
+// CHECK:      "files": [
+// CHECK:      "name": "{{.*}}header.h",
+// CHECK-NEXT: "inclusions": 1,
+// CHECK-NEXT: "timeUs": {{[0-9]+}},
+// CHECK-NEXT: "astContextBytes": {{[1-9][0-9]*}},
+// CHECK-NEXT: "sourceManagerBytes": {{[0-9]+}},
+// CHECK-NEXT: "preprocessorBytes": {{[0-9]+}},
+// CHECK-NEXT: "decls": {{[1-9][0-9]*}},
+// CHECK-NEXT: "types": {{[1-9][0-9]*}},
+// CHECK-NEXT: "stmts": {{[1-9][0-9]*}}
+
+// The usage only grows, so no file is charged a negative amount.
+// POSITIVE-NOT: ": -
+
+// MAIN:      "name": "{{.*}}memory-report.c",
+// MAIN-NEXT: "inclusions": 1,
+// MAIN:      "decls": {{[1-9][0-9]*}},
@@ -12,6 +12,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/Stack.h"
 #include "clang/Basic/TargetOptions.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
@@ -26,6 +28,7 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/FrontendTool/Utils.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/Arg.h"
@@ -234,12 +237,35 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Success)
     return 1;
 
+  // Share the missing files found by the cc1 jobs run in this process. This
+  // saves most of the failed lookups of header search when the driver compiles
+  // several files in-process. With -ffile-cache-path, the missing files are
+  // also loaded from, and saved to, a file shared by separate processes.
+  static MissingFileCache MissingFiles;
+  static llvm::StringSet<> LoadedFileCaches;
+  StringRef FileCachePath = Clang->getFrontendOpts().FileCachePath;
+  const bool ShareFileCaches =
+      (Clang->getFrontendOpts().ShareFileCaches || !FileCachePath.empty()) &&
+      Clang->getHeaderSearchOpts().VFSOverlayFiles.empty();
+  if (ShareFileCaches) {
+    // Errors are ignored: a missing or corrupt file only means that the
+    // missing files have to be looked up again.
+    if (!FileCachePath.empty() &&
+        LoadedFileCaches.insert(FileCachePath).second)
+      (void)MissingFiles.load(FileCachePath);
+    Clang->createFileManager();
+    Clang->getFileManager().setStatCache(MissingFiles.createStatCache());
+  }
+
   // Execute the frontend actions.
   {
     llvm::TimeTraceScope TimeScope("ExecuteCompiler");
     Success = ExecuteCompilerInvocation(Clang.get());
   }
 
+  if (ShareFileCaches && !FileCachePath.empty())
+    (void)MissingFiles.save(FileCachePath);
+
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
   llvm::TimerGroup::printAll(llvm::errs());
@@ -10,6 +10,7 @@
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/FileSystemStatCache.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "gtest/gtest.h"
@@ -583,4 +584,144 @@ TEST_F(FileManagerTest, getBypassFile) {
       &expectedToOptional(Manager.getFileRef("/tmp/test"))->getFileEntry());
 }
 
+
+/// Counts the lookups of missing.h, and allows changing the modification time
+/// of the directory containing it.
+class CountingFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+  CountingFileSystem(IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override {
+    std::string P = Path.str();
+    count(P);
+    auto S = ProxyFileSystem::status(P);
+    if (!S || llvm::sys::path::filename(P) != "dir")
+      return S;
+    return llvm::vfs::Status(S->getName(), S->getUniqueID(), DirModTime,
+                             S->getUser(), S->getGroup(), S->getSize(),
+                             S->getType(), S->getPermissions());
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    std::string P = Path.str();
+    count(P);
+    return ProxyFileSystem::openFileForRead(P);
+  }
+
+  void count(StringRef Path) {
+    if (llvm::sys::path::filename(Path) == "missing.h")
+      ++MissingLookups;
+  }
+
+  unsigned MissingLookups = 0;
+  llvm::sys::TimePoint<> DirModTime;
+};
+
+TEST(MissingFileCacheTest, RemembersMissingFilesUntilDirectoryChanges) {
+#ifdef _WIN32
+  SmallString<64> Dir("C:/dir");
+#else
+  SmallString<64> Dir("/dir");
+#endif
+  SmallString<64> Present(Dir), Missing(Dir);
+  llvm::sys::path::append(Present, "present.h");
+  llvm::sys::path::append(Missing, "missing.h");
+
+  auto InMemoryFS = IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>(
+      new llvm::vfs::InMemoryFileSystem);
+  InMemoryFS->addFile(Present, 0, llvm::MemoryBuffer::getMemBuffer(""));
+  auto FS = IntrusiveRefCntPtr<CountingFileSystem>(
+      new CountingFileSystem(InMemoryFS));
+
+  MissingFileCache Cache;
+  auto lookup = [&](StringRef Path) {
+    FileManager Manager(FileSystemOptions(), FS);
+    Manager.setStatCache(Cache.createStatCache());
+    return static_cast<bool>(Manager.getFile(Path));
+  };
+
+  EXPECT_FALSE(lookup(Missing));
+  unsigned Lookups = FS->MissingLookups;
+  EXPECT_NE(0u, Lookups);
+
+  // Another FileManager only checks the directory.
+  EXPECT_FALSE(lookup(Missing));
+  EXPECT_EQ(Lookups, FS->MissingLookups);
+  EXPECT_TRUE(lookup(Present));
+
+  // Modifying the directory forgets its missing files.
+  FS->DirModTime += std::chrono::seconds(1);
+  InMemoryFS->addFile(Missing, 0, llvm::MemoryBuffer::getMemBuffer(""));
+  EXPECT_TRUE(lookup(Missing));
+  EXPECT_NE(Lookups, FS->MissingLookups);
+}
+
+TEST(MissingFileCacheTest, SavesMissingFilesForLaterProcesses) {
+#ifdef _WIN32
+  SmallString<64> Dir("C:/dir");
+#else
+  SmallString<64> Dir("/dir");
+#endif
+  SmallString<64> Present(Dir), Missing(Dir), Other(Dir);
+  llvm::sys::path::append(Present, "present.h");
+  llvm::sys::path::append(Missing, "missing.h");
+  llvm::sys::path::append(Other, "other.h");
+
+  auto InMemoryFS = IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>(
+      new llvm::vfs::InMemoryFileSystem);
+  InMemoryFS->addFile(Present, 0, llvm::MemoryBuffer::getMemBuffer(""));
+  auto FS = IntrusiveRefCntPtr<CountingFileSystem>(
+      new CountingFileSystem(InMemoryFS));
+
+  SmallString<128> CachePath;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("missing-files", "txt", CachePath));
+  auto lookup = [&](MissingFileCache &Cache, StringRef Path) {
+    FileManager Manager(FileSystemOptions(), FS);
+    Manager.setStatCache(Cache.createStatCache());
+    return static_cast<bool>(Manager.getFile(Path));
+  };
+
+  // An empty file isn't a valid cache.
+  {
+    MissingFileCache Cache;
+    EXPECT_TRUE(Cache.load(CachePath));
+    EXPECT_FALSE(lookup(Cache, Missing));
+    EXPECT_FALSE(Cache.save(CachePath));
+  }
+
+  // Another process loads the missing file, and merges its own into the file
+  // saved in the meantime.
+  unsigned Lookups = FS->MissingLookups;
+  {
+    MissingFileCache Cache, Concurrent;
+    EXPECT_FALSE(Cache.load(CachePath));
+    EXPECT_FALSE(lookup(Cache, Missing));
+    EXPECT_EQ(Lookups, FS->MissingLookups);
+    EXPECT_FALSE(lookup(Concurrent, Other));
+    EXPECT_FALSE(Concurrent.save(CachePath));
+    EXPECT_FALSE(Cache.save(CachePath));
+  }
+  {
+    MissingFileCache Cache;
+    EXPECT_FALSE(Cache.load(CachePath));
+    EXPECT_FALSE(lookup(Cache, Missing));
+    EXPECT_FALSE(lookup(Cache, Other));
+    EXPECT_EQ(Lookups, FS->MissingLookups);
+  }
+
+  // Once the directory is modified, the saved entries are not used.
+  FS->DirModTime += std::chrono::seconds(1);
+  InMemoryFS->addFile(Missing, 0, llvm::MemoryBuffer::getMemBuffer(""));
+  {
+    MissingFileCache Cache;
+    EXPECT_FALSE(Cache.load(CachePath));
+    EXPECT_TRUE(lookup(Cache, Missing));
+  }
+
+  llvm::sys::fs::remove(CachePath);
+}
+
 } // anonymous namespace
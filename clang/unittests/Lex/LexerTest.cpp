@@ -482,6 +482,102 @@ TEST_F(LexerTest, AvoidPastEndOfStringDereference) {
   EXPECT_TRUE(Lex("#include <\\\\\n").empty());
 }
 
+TEST_F(LexerTest, LongTokens) {
+  // Runs of characters which are long enough to be scanned in chunks, with
+  // escaped newlines and trigraphs in their middle.
+  LangOpts.Trigraphs = true;
+  std::vector<Token> Toks = CheckLex(
+      "int a_very_long_identifier_0123456789 = 0;\n"
+      "                                int identifier_with_an_esc\\\n"
+      "aped_newline;\n"
+      "// a line comment which is long enough to be scanned in chunks \\\n"
+      "   and continues on the next line \?\?/\n"
+      "   and on the next one through a trigraph\n"
+      "const char *s = \"a long string literal with an \\\" escaped quote\";\n"
+      "const char *t = "
+      "\"a long string literal with a trigraph \?\?/\" quote\";\n"
+      "char c = '\\'';\n",
+      {tok::kw_int, tok::identifier, tok::equal, tok::numeric_constant,
+       tok::semi, tok::kw_int, tok::identifier, tok::semi, tok::kw_const,
+       tok::kw_char, tok::star, tok::identifier, tok::equal,
+       tok::string_literal, tok::semi, tok::kw_const, tok::kw_char, tok::star,
+       tok::identifier, tok::equal, tok::string_literal, tok::semi,
+       tok::kw_char, tok::identifier, tok::equal, tok::char_constant,
+       tok::semi});
+  ASSERT_EQ(Toks.size(), 27u);
+  EXPECT_EQ("a_very_long_identifier_0123456789",
+            getSourceText(Toks[1], Toks[1]));
+  EXPECT_EQ("identifier_with_an_esc\\\naped_newline",
+            getSourceText(Toks[6], Toks[6]));
+  EXPECT_TRUE(Toks[8].isAtStartOfLine());
+  EXPECT_EQ("\"a long string literal with an \\\" escaped quote\"",
+            getSourceText(Toks[13], Toks[13]));
+  EXPECT_EQ("\"a long string literal with a trigraph \?\?/\" quote\"",
+            getSourceText(Toks[20], Toks[20]));
+  EXPECT_EQ("'\\''", getSourceText(Toks[25], Toks[25]));
+}
+
+TEST_F(LexerTest, LongTokensAtChunkBoundaries) {
+  // Put the character which ends each run at the end of the first 16-byte
+  // chunk scanned, at the start of the next one, and around it.
+  LangOpts.Trigraphs = true;
+  for (unsigned Len : {14u, 15u, 16u, 17u, 31u, 32u, 33u}) {
+    SCOPED_TRACE(Len);
+    // The scans start after the first character of an identifier, the
+    // first whitespace character, the "//" of a comment and the opening
+    // quote of a literal.
+    std::string Body(Len, 'x');
+    std::vector<Token> Toks = CheckLex(
+        "int a" + Body + "\\\nb;\n"
+        "int a" + Body + "\?\?/\nb;\n"
+        "int" + std::string(Len + 1, ' ') + "c;\n"
+        "//" + Body + "\\\nint d;\n"
+        "//" + Body + "\n"
+        "int e;\n"
+        "const char *s = \"" + Body + "\\\"\";\n"
+        "const char *t = \"" + Body + "\?\?/\"\";\n"
+        "const char *u = \"" + Body + "\";\n",
+        {tok::kw_int, tok::identifier, tok::semi, tok::kw_int,
+         tok::identifier, tok::semi, tok::kw_int, tok::identifier, tok::semi,
+         tok::kw_int, tok::identifier, tok::semi, tok::kw_const,
+         tok::kw_char, tok::star, tok::identifier, tok::equal,
+         tok::string_literal, tok::semi, tok::kw_const, tok::kw_char,
+         tok::star, tok::identifier, tok::equal, tok::string_literal,
+         tok::semi, tok::kw_const, tok::kw_char, tok::star, tok::identifier,
+         tok::equal, tok::string_literal, tok::semi});
+    ASSERT_EQ(Toks.size(), 33u);
+    EXPECT_EQ("a" + Body + "\\\nb", getSourceText(Toks[1], Toks[1]));
+    EXPECT_EQ("a" + Body + "\?\?/\nb", getSourceText(Toks[4], Toks[4]));
+    EXPECT_EQ("c", getSourceText(Toks[7], Toks[7]));
+    EXPECT_TRUE(Toks[7].hasLeadingSpace());
+    EXPECT_EQ("e", getSourceText(Toks[10], Toks[10]));
+    EXPECT_EQ("\"" + Body + "\\\"\"", getSourceText(Toks[17], Toks[17]));
+    EXPECT_EQ("\"" + Body + "\?\?/\"\"", getSourceText(Toks[24], Toks[24]));
+    EXPECT_EQ("\"" + Body + "\"", getSourceText(Toks[31], Toks[31]));
+  }
+}
+
+TEST_F(LexerTest, LongTokensAtBufferEnd) {
+  // Runs which end within 16 bytes of the end of the buffer, where they can't
+  // be scanned in whole chunks.
+  for (unsigned Len = 0; Len != 34; ++Len) {
+    SCOPED_TRACE(Len);
+    std::string Body(Len, 'x');
+    std::vector<Token> Toks =
+        CheckLex("int a" + Body, {tok::kw_int, tok::identifier});
+    ASSERT_EQ(Toks.size(), 2u);
+    EXPECT_EQ("a" + Body, getSourceText(Toks[1], Toks[1]));
+
+    Toks = CheckLex("s = \"" + Body + "\"", {tok::identifier, tok::equal,
+                                              tok::string_literal});
+    ASSERT_EQ(Toks.size(), 3u);
+    EXPECT_EQ("\"" + Body + "\"", getSourceText(Toks[2], Toks[2]));
+
+    CheckLex("int" + std::string(Len + 1, ' '), {tok::kw_int});
+    CheckLex("int a; //" + Body, {tok::kw_int, tok::identifier, tok::semi});
+  }
+}
+
 TEST_F(LexerTest, StringizingRasString) {
   // For "std::string Lexer::Stringify(StringRef Str, bool Charify)".
   std::string String1 = R"(foo
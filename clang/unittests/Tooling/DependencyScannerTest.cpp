@@ -14,10 +14,13 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningCache.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "gtest/gtest.h"
@@ -203,5 +206,79 @@ TEST(DependencyScanner, ScanDepsReuseFilemanagerHasInclude) {
   EXPECT_EQ(convert_to_slash(Deps[5]), "/root/symlink.h");
 }
 
+TEST(DependencyScanner, PersistentCache) {
+  using namespace dependencies;
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("scan-deps-cache", Dir));
+  DependencyScanningPersistentCache Cache(Dir);
+
+  std::string SourceKey = DependencyScanningPersistentCache::getSourceKey(
+      "#include \"a.h\"\nint x;\n");
+  EXPECT_FALSE(Cache.getMinimizedSource(SourceKey));
+  MinimizedSource Source;
+  Source.Contents = "#include \"a.h\"\n";
+  Source.SkippedRanges = {{4, 20}};
+  Cache.addMinimizedSource(SourceKey, Source);
+  llvm::Optional<MinimizedSource> Minimized =
+      Cache.getMinimizedSource(SourceKey);
+  ASSERT_TRUE(Minimized);
+  EXPECT_EQ(Minimized->Contents, Source.Contents);
+  EXPECT_EQ(Minimized->SkippedRanges, Source.SkippedRanges);
+
+  SmallString<128> Header(Dir);
+  llvm::sys::path::append(Header, "header.h");
+  auto WriteHeader = [&](StringRef Contents, llvm::sys::TimePoint<> ModTime) {
+    int FD;
+    ASSERT_FALSE(llvm::sys::fs::openFileForWrite(Header, FD));
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/false);
+      OS << Contents;
+    }
+    ASSERT_FALSE(
+        llvm::sys::fs::setLastAccessAndModificationTime(FD, ModTime, ModTime));
+    llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+  };
+  auto Now = std::chrono::system_clock::now();
+  WriteHeader("int x;\n", Now - std::chrono::hours(1));
+
+  CompileCommand Command(Dir, "test.cpp", {"clang", "-c", "test.cpp"}, "");
+  std::string CommandKey =
+      DependencyScanningPersistentCache::getCommandKey(Command, Dir);
+  EXPECT_FALSE(Cache.getDependencyFile(CommandKey));
+  Cache.addDependencyFile(CommandKey, {"header.h"}, {}, Dir,
+                          "test.o: header.h");
+  EXPECT_EQ(Cache.getDependencyFile(CommandKey),
+            llvm::Optional<std::string>("test.o: header.h"));
+
+  // Changing an input invalidates the entry.
+  WriteHeader("int xy;\n", Now + std::chrono::hours(1));
+  EXPECT_FALSE(Cache.getDependencyFile(CommandKey));
+
+  // An input modified after the cache, and with it the scanning service, was
+  // created isn't trusted, since the scan may have seen its old contents.
+  Cache.addDependencyFile(CommandKey, {"header.h"}, {}, Dir,
+                          "test.o: header.h");
+  EXPECT_FALSE(Cache.getDependencyFile(CommandKey));
+
+  // Creating a file which was looked up without success invalidates the
+  // entry, since it may be found instead of a listed one.
+  WriteHeader("int x;\n", Now - std::chrono::hours(1));
+  Cache.addDependencyFile(CommandKey, {"header.h"}, {"include/header.h"}, Dir,
+                          "test.o: header.h");
+  EXPECT_EQ(Cache.getDependencyFile(CommandKey),
+            llvm::Optional<std::string>("test.o: header.h"));
+  SmallString<128> Include(Dir);
+  llvm::sys::path::append(Include, "include");
+  ASSERT_FALSE(llvm::sys::fs::create_directory(Include));
+  SmallString<128> Shadowing(Include);
+  llvm::sys::path::append(Shadowing, "header.h");
+  int FD;
+  ASSERT_FALSE(llvm::sys::fs::openFileForWrite(Shadowing, FD));
+  llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+  EXPECT_FALSE(Cache.getDependencyFile(CommandKey));
+
+  llvm::sys::fs::remove_directories(Dir);
+}
+
 } // end namespace tooling
 } // end namespace clang
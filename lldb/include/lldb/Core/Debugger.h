@@ -102,6 +102,23 @@ public:
 
   static lldb::DebuggerSP GetDebuggerAtIndex(size_t index);
 
+  /// Return the strategy for a thread pool running \a num_tasks independent
+  /// tasks. This is bounded by any enclosing ThreadPoolConcurrencyScope on the
+  /// calling thread, so that pools created from inside another pool's tasks
+  /// don't multiply the number of threads.
+  static llvm::ThreadPoolStrategy GetThreadPoolStrategy(size_t num_tasks);
+
+  /// Limit the thread pools created on the current thread to \a max_threads
+  /// threads for the lifetime of this object.
+  class ThreadPoolConcurrencyScope {
+  public:
+    explicit ThreadPoolConcurrencyScope(unsigned max_threads);
+    ~ThreadPoolConcurrencyScope();
+
+  private:
+    unsigned m_saved_max_threads;
+  };
+
   static bool FormatDisassemblerAddress(const FormatEntity::Entry *format,
                                         const SymbolContext *sc,
                                         const SymbolContext *prev_sc,
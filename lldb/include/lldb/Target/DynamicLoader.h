@@ -17,6 +17,7 @@
 #include "lldb/lldb-forward.h"
 #include "lldb/lldb-private-enumerations.h"
 #include "lldb/lldb-types.h"
+#include "llvm/ADT/ArrayRef.h"
 
 #include <stddef.h>
 #include <stdint.h>
@@ -284,6 +285,14 @@ protected:
   // Utility method so base classes can share implementation of UnloadSections
   void UnloadSectionsCommon(const lldb::ModuleSP module);
 
+  /// Creates the modules for \p files that are not in the target yet, and
+  /// preloads their symbols, in parallel if the target's parallel-module-load
+  /// setting is enabled. The modules are added to the target without any
+  /// notification, so a subsequent LoadModuleAtAddress call finds them and
+  /// only needs to update their load addresses, and the caller is expected to
+  /// notify the target of all new modules at once with Target::ModulesDidLoad.
+  void PreloadModules(llvm::ArrayRef<FileSpec> files);
+
   const lldb_private::SectionList *
   GetSectionListFromModule(const lldb::ModuleSP module) const;
 
@@ -20,6 +20,19 @@ namespace lldb_private {
 // runs.
 class MemoryCache {
 public:
+  /// Counters describing how memory reads were serviced. They are kept for
+  /// the lifetime of the cache and are not reset by Clear().
+  struct Statistics {
+    /// Reads that were serviced entirely from the cache.
+    uint64_t hits = 0;
+    /// Reads that needed at least one batch of cache lines from the process.
+    uint64_t misses = 0;
+    /// Cache lines read from the process, including read-ahead lines.
+    uint64_t lines_read = 0;
+    /// Cache lines read speculatively ahead of a sequential access pattern.
+    uint64_t read_ahead_lines = 0;
+  };
+
   // Constructors and Destructors
   MemoryCache(Process &process);
 
@@ -43,6 +56,8 @@ public:
   void AddL1CacheData(lldb::addr_t addr,
                       const lldb::DataBufferSP &data_buffer_sp);
 
+  Statistics GetStatistics();
+
 protected:
   typedef std::map<lldb::addr_t, lldb::DataBufferSP> BlockMap;
   typedef RangeVector<lldb::addr_t, lldb::addr_t, 4> InvalidRanges;
@@ -57,8 +72,23 @@ protected:
   InvalidRanges m_invalid_ranges;
   Process &m_process;
   uint32_t m_L2_cache_line_byte_size;
+  uint32_t m_max_read_ahead_lines;
+  /// The number of lines read ahead on the last miss, doubled on every
+  /// sequential miss up to m_max_read_ahead_lines.
+  uint32_t m_read_ahead_lines = 0;
+  /// The address just past the last cache line read from the process. A miss
+  /// at this address continues a sequential access pattern.
+  lldb::addr_t m_next_sequential_addr = LLDB_INVALID_ADDRESS;
+  Statistics m_stats;
 
 private:
+  /// Read the missing L2 cache lines needed by a read of \a byte_size bytes
+  /// starting at the cache line \a line_addr, plus any read-ahead lines, in
+  /// one batch. Returns the number of bytes read for the line at
+  /// \a line_addr.
+  size_t FetchCacheLines(lldb::addr_t line_addr, size_t byte_size,
+                         Status &error);
+
   MemoryCache(const MemoryCache &) = delete;
   const MemoryCache &operator=(const MemoryCache &) = delete;
 };
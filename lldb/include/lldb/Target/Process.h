@@ -74,6 +74,7 @@ public:
 
   bool GetDisableMemoryCache() const;
   uint64_t GetMemoryCacheLineSize() const;
+  uint64_t GetMemoryCacheMaxReadAhead() const;
   Args GetExtraStartupCommands() const;
   void SetExtraStartupCommands(const Args &args);
   FileSpec GetPythonOSPluginPath() const;
@@ -1453,6 +1454,38 @@ public:
   size_t ReadMemoryFromInferior(lldb::addr_t vm_addr, void *buf, size_t size,
                                 Status &error);
 
+  /// A single range of a batched memory read: \a size bytes starting at
+  /// \a addr are read into \a buf.
+  struct MemoryReadRequest {
+    lldb::addr_t addr;
+    uint8_t *buf;
+    size_t size;
+  };
+
+  /// Read several, possibly discontiguous, ranges of memory from the process
+  /// without going through the memory cache.
+  ///
+  /// Processes that can service many ranges in one round trip (see
+  /// DoReadMemoryRanges) use this to batch cache misses.
+  ///
+  /// \param[in] requests
+  ///     The ranges to read.
+  ///
+  /// \return
+  ///     The number of bytes that were actually read for each request, in the
+  ///     same order as \a requests. Zero is returned for a request that could
+  ///     not be read at all.
+  std::vector<size_t>
+  ReadMemoryRangesFromInferior(llvm::ArrayRef<MemoryReadRequest> requests);
+
+  /// Returns true if DoReadMemoryRanges services several ranges in a single
+  /// round trip to the process, so that reading extra ranges is cheap.
+  virtual bool SupportsBatchedMemoryReads() { return false; }
+
+  MemoryCache::Statistics GetMemoryCacheStatistics() {
+    return m_memory_cache.GetStatistics();
+  }
+
   /// Read a NULL terminated string from memory
   ///
   /// This function will read a cache page at a time until a NULL string
@@ -2561,6 +2594,17 @@ protected:
   virtual size_t DoReadMemory(lldb::addr_t vm_addr, void *buf, size_t size,
                               Status &error) = 0;
 
+  /// Actually do the reading of several memory ranges from a process.
+  ///
+  /// The default implementation reads each range with DoReadMemory.
+  /// Subclasses that talk to a remote stub should override this to service
+  /// all ranges in as few round trips as possible.
+  ///
+  /// \return
+  ///     The number of bytes that were actually read for each request.
+  virtual std::vector<size_t>
+  DoReadMemoryRanges(llvm::ArrayRef<MemoryReadRequest> requests);
+
   void SetState(lldb::EventSP &event_sp);
 
   lldb::StateType GetPrivateState();
@@ -96,6 +96,8 @@ public:
 
   void SetPreloadSymbols(bool b);
 
+  bool GetParallelModuleLoad() const;
+
   bool GetDisableASLR() const;
 
   void SetDisableASLR(bool b);
@@ -181,6 +183,8 @@ public:
 
   uint64_t GetExprErrorLimit() const;
 
+  uint64_t GetExprCacheSize() const;
+
   bool GetUseHexImmediates() const;
 
   bool GetUseFastStepping() const;
@@ -1067,6 +1071,23 @@ public:
                                const EvaluateExpressionOptions &options,
                                ValueObject *ctx_obj, Status &error);
 
+  /// Remove and return a parsed expression stored under \a key by
+  /// CacheUserExpression that can run in \a exe_ctx, or an empty pointer if
+  /// there is none. The expression is handed out exclusively so that nested
+  /// evaluations of the same text never share its execution state. Contexts
+  /// without a frame never match.
+  lldb::UserExpressionSP TakeCachedUserExpression(llvm::StringRef key,
+                                                  ExecutionContext &exe_ctx);
+
+  /// Keep a parsed expression for reuse by TakeCachedUserExpression,
+  /// evicting the least recently used one if the cache is full.
+  void CacheUserExpression(llvm::StringRef key,
+                           const lldb::UserExpressionSP &expr_sp);
+
+  /// Drop all cached expressions, e.g. because the set of loaded modules,
+  /// and with it the declarations an expression may have resolved, changed.
+  void ClearUserExpressionCache();
+
   // Creates a FunctionCaller for the given language, the rest of the
   // parameters have the same meaning as for the FunctionCaller constructor.
   // Since a FunctionCaller can't be
@@ -1426,6 +1447,10 @@ protected:
   lldb::TraceSP m_trace_sp;
   /// Stores the frame recognizers of this target.
   lldb::StackFrameRecognizerManagerUP m_frame_recognizer_manager_up;
+  /// Parsed expressions available for reuse, most recently used first.
+  std::list<std::pair<std::string, lldb::UserExpressionSP>>
+      m_user_expression_cache;
+  std::mutex m_user_expression_cache_mutex;
 
   static void ImageSearchPathsChanged(const PathMappingList &path_list,
                                       void *baton);
@@ -169,6 +169,8 @@ public:
     eServerPacketType_jTraceConfigRead, // deprecated
 
     eServerPacketType_jLLDBTraceSupportedType,
+
+    eServerPacketType_MultiMemRead,
   };
 
   ServerPacketType GetServerPacketType() const;
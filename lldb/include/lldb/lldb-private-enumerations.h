@@ -213,7 +213,9 @@ enum StatisticKind {
   ExpressionFailure = 1,
   FrameVarSuccess = 2,
   FrameVarFailure = 3,
-  StatisticMax = 4
+  ExpressionCacheHit = 4,
+  ExpressionCacheMiss = 5,
+  StatisticMax = 6
 };
 
 
@@ -227,6 +229,10 @@ inline std::string GetStatDescription(lldb_private::StatisticKind K) {
      return "Number of frame var successes";
    case StatisticKind::FrameVarFailure:
      return "Number of frame var failures";
+   case StatisticKind::ExpressionCacheHit:
+     return "Number of expr evaluations that reused a parsed expression";
+   case StatisticKind::ExpressionCacheMiss:
+     return "Number of expr evaluations that had to parse the expression";
    case StatisticKind::StatisticMax:
      return "";
    }
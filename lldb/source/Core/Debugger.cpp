@@ -64,6 +64,7 @@
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -491,6 +492,28 @@ void Debugger::Terminate() {
   }
 }
 
+// The maximum number of threads a thread pool created on this thread may
+// use, or zero if unbounded.
+static thread_local unsigned g_max_thread_pool_threads = 0;
+
+llvm::ThreadPoolStrategy Debugger::GetThreadPoolStrategy(size_t num_tasks) {
+  unsigned num_threads =
+      llvm::optimal_concurrency(num_tasks).compute_thread_count();
+  if (g_max_thread_pool_threads != 0)
+    num_threads = std::min(num_threads, g_max_thread_pool_threads);
+  return llvm::optimal_concurrency(num_threads);
+}
+
+Debugger::ThreadPoolConcurrencyScope::ThreadPoolConcurrencyScope(
+    unsigned max_threads)
+    : m_saved_max_threads(g_max_thread_pool_threads) {
+  g_max_thread_pool_threads = std::max(max_threads, 1u);
+}
+
+Debugger::ThreadPoolConcurrencyScope::~ThreadPoolConcurrencyScope() {
+  g_max_thread_pool_threads = m_saved_max_threads;
+}
+
 void Debugger::SettingsInitialize() { Target::SettingsInitialize(); }
 
 void Debugger::SettingsTerminate() { Target::SettingsTerminate(); }
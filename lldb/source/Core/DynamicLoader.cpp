@@ -8,6 +8,7 @@
 
 #include "lldb/Target/DynamicLoader.h"
 
+#include "lldb/Core/Debugger.h"
 #include "lldb/Core/Module.h"
 #include "lldb/Core/ModuleList.h"
 #include "lldb/Core/ModuleSpec.h"
@@ -21,7 +22,9 @@
 #include "lldb/lldb-private-interfaces.h"
 
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ThreadPool.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <assert.h>
@@ -147,6 +150,35 @@ DynamicLoader::GetSectionListFromModule(const ModuleSP module) const {
   return sections;
 }
 
+void DynamicLoader::PreloadModules(llvm::ArrayRef<FileSpec> files) {
+  Target &target = m_process->GetTarget();
+  if (!target.GetParallelModuleLoad() || files.size() < 2)
+    return;
+
+  // Creating a module parses its object file, and preloading its symbols
+  // builds its symbol table and indexes its debug info. These are independent
+  // for each module, and dominate the time to load a large number of them.
+  // Indexing debug info runs its own thread pool. Share the hardware threads
+  // between the modules loaded concurrently instead of letting each of them
+  // start a pool of its own as large as the machine.
+  llvm::ThreadPoolStrategy strategy =
+      Debugger::GetThreadPoolStrategy(files.size());
+  const unsigned outer_threads = strategy.compute_thread_count();
+  const unsigned nested_threads = std::max(
+      1u, Debugger::GetThreadPoolStrategy(0).compute_thread_count() /
+              outer_threads);
+  llvm::ThreadPool pool(strategy);
+  for (const FileSpec &file : files) {
+    pool.async([&target, &file, nested_threads]() {
+      Debugger::ThreadPoolConcurrencyScope scope(nested_threads);
+      ModuleSpec module_spec(file, target.GetArchitecture());
+      if (!target.GetImages().FindFirstModule(module_spec))
+        target.GetOrCreateModule(module_spec, /*notify=*/false);
+    });
+  }
+  pool.wait();
+}
+
 ModuleSP DynamicLoader::LoadModuleAtAddress(const FileSpec &file,
                                             addr_t link_map_addr,
                                             addr_t base_addr,
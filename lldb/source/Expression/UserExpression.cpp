@@ -139,6 +139,36 @@ lldb::addr_t UserExpression::GetObjectPointer(lldb::StackFrameSP frame_sp,
   return ret;
 }
 
+/// Returns the key under which a parsed expression is cached in \a target, or
+/// an empty string if the expression must be parsed every time.
+static std::string GetExpressionCacheKey(
+    Target &target, ExecutionContext &exe_ctx, llvm::StringRef expr,
+    llvm::StringRef prefix, lldb::LanguageType language,
+    UserExpression::ResultType desired_type, ExecutionPolicy execution_policy,
+    const EvaluateExpressionOptions &options, ValueObject *ctx_obj) {
+  // Expressions that mention '$' may define persistent variables or types,
+  // which must happen exactly once. Top-level code, REPL input, expressions
+  // with debug info and expressions evaluated in an object's context depend
+  // on more than their text and location. Without a frame, there is no code
+  // address to tie the parsed expression to.
+  if (target.GetExprCacheSize() == 0 || !exe_ctx.GetFramePtr() || ctx_obj ||
+      expr.contains('$') ||
+      prefix.contains('$') || execution_policy == eExecutionPolicyTopLevel ||
+      options.GetREPLEnabled() || options.GetGenerateDebugInfo() ||
+      options.GetPoundLineFilePath())
+    return std::string();
+
+  std::string key;
+  llvm::raw_string_ostream stream(key);
+  // The requested execution policy records whether the expression may be
+  // JITted, which the effective one doesn't when the process can't JIT.
+  stream << language << ';' << desired_type << ';' << execution_policy << ';'
+         << options.GetExecutionPolicy() << ';' << target.GetImportStdModule()
+         << ';' << target.GetEnableAutoImportClangModules() << ';'
+         << prefix.size() << ';' << prefix << expr;
+  return stream.str();
+}
+
 lldb::ExpressionResults
 UserExpression::Evaluate(ExecutionContext &exe_ctx,
                          const EvaluateExpressionOptions &options,
@@ -219,18 +249,34 @@ UserExpression::Evaluate(ExecutionContext &exe_ctx,
       language = frame->GetLanguage();
   }
 
-  lldb::UserExpressionSP user_expression_sp(
-      target->GetUserExpressionForLanguage(expr, full_prefix, language,
-                                           desired_type, options, ctx_obj,
-                                           error));
-  if (error.Fail()) {
-    LLDB_LOG(log, "== [UserExpression::Evaluate] Getting expression: {0} ==",
-             error.AsCString());
-    return lldb::eExpressionSetupError;
+  // Evaluating the same expression again at the same location, as
+  // breakpoint conditions and data formatters do, can reuse the parsed and
+  // JITted code of the previous evaluation.
+  std::string cache_key =
+      GetExpressionCacheKey(*target, exe_ctx, expr, full_prefix, language,
+                            desired_type, execution_policy, options, ctx_obj);
+  lldb::UserExpressionSP user_expression_sp;
+  if (!cache_key.empty()) {
+    user_expression_sp = target->TakeCachedUserExpression(cache_key, exe_ctx);
+    target->IncrementStats(user_expression_sp
+                               ? StatisticKind::ExpressionCacheHit
+                               : StatisticKind::ExpressionCacheMiss);
+  }
+  const bool cached = static_cast<bool>(user_expression_sp);
+
+  if (!cached) {
+    user_expression_sp.reset(target->GetUserExpressionForLanguage(
+        expr, full_prefix, language, desired_type, options, ctx_obj, error));
+    if (error.Fail()) {
+      LLDB_LOG(log,
+               "== [UserExpression::Evaluate] Getting expression: {0} ==",
+               error.AsCString());
+      return lldb::eExpressionSetupError;
+    }
   }
 
-  LLDB_LOG(log, "== [UserExpression::Evaluate] Parsing expression {0} ==",
-           expr.str());
+  LLDB_LOG(log, "== [UserExpression::Evaluate] {0} expression {1} ==",
+           cached ? "Reusing parsed" : "Parsing", expr.str());
 
   const bool keep_expression_in_memory = true;
   const bool generate_debug_info = options.GetGenerateDebugInfo();
@@ -245,6 +291,7 @@ UserExpression::Evaluate(ExecutionContext &exe_ctx,
   DiagnosticManager diagnostic_manager;
 
   bool parse_success =
+      cached ||
       user_expression_sp->Parse(diagnostic_manager, exe_ctx, execution_policy,
                                 keep_expression_in_memory, generate_debug_info);
 
@@ -256,6 +303,8 @@ UserExpression::Evaluate(ExecutionContext &exe_ctx,
   const char *fixed_text = user_expression_sp->GetFixedText();
   if (fixed_text != nullptr)
     fixed_expression->append(fixed_text);
+  if (!fixed_expression->empty())
+    cache_key.clear();
 
   // If there is a fixed expression, try to parse it:
   if (!parse_success) {
@@ -356,6 +405,11 @@ UserExpression::Evaluate(ExecutionContext &exe_ctx,
           error.SetExpressionError(execution_results,
                                    diagnostic_manager.GetString().c_str());
       } else {
+        // Only keep expressions that ran to completion; a failed run may
+        // have left the expression in a state it cannot be reused from.
+        if (!cache_key.empty())
+          target->CacheUserExpression(cache_key, user_expression_sp);
+
         if (expr_result) {
           result_valobj_sp = expr_result->GetValueObject();
           result_valobj_sp->SetPreferredDisplayLanguage(language);
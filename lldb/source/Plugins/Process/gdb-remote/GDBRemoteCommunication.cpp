@@ -180,6 +180,7 @@ GDBRemoteCommunication::SendRawPacketNoLock(llvm::StringRef packet,
                         GDBRemotePacket::ePacketTypeSend, bytes_written);
 
     if (bytes_written == packet_length) {
+      ++m_num_packets_sent;
       if (!skip_ack && GetSendAcks())
         return GetAck();
       else
@@ -808,6 +809,7 @@ GDBRemoteCommunication::CheckForPacket(const uint8_t *src, size_t src_len,
 
       m_history.AddPacket(m_bytes, total_length,
                           GDBRemotePacket::ePacketTypeRecv, total_length);
+      ++m_num_packets_received;
 
       // Copy the packet from m_bytes to packet_str expanding the run-length
       // encoding in the process.
@@ -11,6 +11,7 @@
 
 #include "GDBRemoteCommunicationHistory.h"
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -137,6 +138,11 @@ public:
 
   void DumpHistory(Stream &strm);
 
+  /// The number of packets sent and received on this connection, not
+  /// counting acknowledgements.
+  uint64_t GetNumPacketsSent() const { return m_num_packets_sent; }
+  uint64_t GetNumPacketsReceived() const { return m_num_packets_received; }
+
   void SetPacketRecorder(repro::PacketRecorder *recorder);
 
   static llvm::Error ConnectLocally(GDBRemoteCommunication &client,
@@ -150,6 +156,8 @@ protected:
   uint32_t m_echo_number;
   LazyBool m_supports_qEcho;
   GDBRemoteCommunicationHistory m_history;
+  std::atomic<uint64_t> m_num_packets_sent{0};
+  std::atomic<uint64_t> m_num_packets_received{0};
   bool m_send_acks;
   bool m_is_platform; // Set to true if this class represents a platform,
                       // false if this class represents a debug session for
@@ -88,6 +88,7 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient()
       m_supports_jLoadedDynamicLibrariesInfos(eLazyBoolCalculate),
       m_supports_jGetSharedCacheInfo(eLazyBoolCalculate),
       m_supports_QPassSignals(eLazyBoolCalculate),
+      m_supports_MultiMemRead(eLazyBoolCalculate),
       m_supports_error_string_reply(eLazyBoolCalculate),
       m_supports_qProcessInfoPID(true), m_supports_qfProcessInfo(true),
       m_supports_qUserName(true), m_supports_qGroupName(true),
@@ -157,6 +158,13 @@ bool GDBRemoteCommunicationClient::GetQPassSignalsSupported() {
   return m_supports_QPassSignals == eLazyBoolYes;
 }
 
+bool GDBRemoteCommunicationClient::GetMultiMemReadSupported() {
+  if (m_supports_MultiMemRead == eLazyBoolCalculate) {
+    GetRemoteQSupported();
+  }
+  return m_supports_MultiMemRead == eLazyBoolYes;
+}
+
 bool GDBRemoteCommunicationClient::GetAugmentedLibrariesSVR4ReadSupported() {
   if (m_supports_augmented_libraries_svr4_read == eLazyBoolCalculate) {
     GetRemoteQSupported();
@@ -298,6 +306,7 @@ void GDBRemoteCommunicationClient::ResetDiscoverableSettings(bool did_exec) {
     m_supports_qXfer_features_read = eLazyBoolCalculate;
     m_supports_qXfer_memory_map_read = eLazyBoolCalculate;
     m_supports_augmented_libraries_svr4_read = eLazyBoolCalculate;
+    m_supports_MultiMemRead = eLazyBoolCalculate;
     m_supports_qProcessInfoPID = true;
     m_supports_qfProcessInfo = true;
     m_supports_qUserName = true;
@@ -433,6 +442,11 @@ void GDBRemoteCommunicationClient::GetRemoteQSupported() {
     else
       m_supports_QPassSignals = eLazyBoolNo;
 
+    if (::strstr(response_cstr, "MultiMemRead+"))
+      m_supports_MultiMemRead = eLazyBoolYes;
+    else
+      m_supports_MultiMemRead = eLazyBoolNo;
+
     const char *packet_size_str = ::strstr(response_cstr, "PacketSize=");
     if (packet_size_str) {
       StringExtractorGDBRemote packet_response(packet_size_str +
@@ -4107,6 +4121,61 @@ Status GDBRemoteCommunicationClient::SendSignalsToIgnore(
   }
 }
 
+llvm::Expected<std::vector<size_t>>
+GDBRemoteCommunicationClient::ReadMemoryRanges(
+    llvm::ArrayRef<std::pair<lldb::addr_t, llvm::MutableArrayRef<uint8_t>>>
+        ranges) {
+  // Format packet:
+  // MultiMemRead:ranges:<addr1>,<length1>,...,<addrN>,<lengthN>;
+  StreamString packet;
+  packet.PutCString("MultiMemRead:ranges:");
+  for (size_t i = 0; i < ranges.size(); ++i)
+    packet.Printf(i == 0 ? "%" PRIx64 ",%" PRIx64 : ",%" PRIx64 ",%" PRIx64,
+                  (uint64_t)ranges[i].first,
+                  (uint64_t)ranges[i].second.size());
+  packet.PutChar(';');
+
+  StringExtractorGDBRemote response;
+  if (SendPacketAndWaitForResponse(packet.GetString(), response, true) !=
+      PacketResult::Success)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "failed to send packet: MultiMemRead");
+  if (response.IsErrorResponse())
+    return response.GetStatus().ToError();
+  if (response.IsUnsupportedResponse()) {
+    m_supports_MultiMemRead = eLazyBoolNo;
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "MultiMemRead is unsupported");
+  }
+
+  // Response: <length1>,...,<lengthN>;<binary data of all ranges>. The
+  // packet layer has already removed the binary escaping.
+  std::vector<size_t> bytes_read;
+  bytes_read.reserve(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (i > 0 && response.GetChar() != ',')
+      break;
+    const uint64_t length = response.GetHexMaxU64(false, UINT64_MAX);
+    if (length > ranges[i].second.size())
+      break;
+    bytes_read.push_back(length);
+  }
+  if (bytes_read.size() != ranges.size() || response.GetChar() != ';')
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "malformed MultiMemRead response");
+
+  llvm::StringRef data =
+      response.GetStringRef().drop_front(response.GetFilePos());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (data.size() < bytes_read[i])
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "truncated MultiMemRead response");
+    memcpy(ranges[i].second.data(), data.data(), bytes_read[i]);
+    data = data.drop_front(bytes_read[i]);
+  }
+  return bytes_read;
+}
+
 Status GDBRemoteCommunicationClient::ConfigureRemoteStructuredData(
     ConstString type_name, const StructuredData::ObjectSP &config_sp) {
   Status error;
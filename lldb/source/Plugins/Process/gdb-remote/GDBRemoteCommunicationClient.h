@@ -352,6 +352,8 @@ public:
 
   bool GetQPassSignalsSupported();
 
+  bool GetMultiMemReadSupported();
+
   bool GetAugmentedLibrariesSVR4ReadSupported();
 
   bool GetQXferFeaturesReadSupported();
@@ -467,6 +469,19 @@ public:
   // Sends QPassSignals packet to the server with given signals to ignore.
   Status SendSignalsToIgnore(llvm::ArrayRef<int32_t> signals);
 
+  /// Read several memory ranges with a single MultiMemRead packet.
+  ///
+  /// \param[in] ranges
+  ///     The address of each range and the buffer to read it into. The size
+  ///     of the buffer is the number of bytes requested.
+  ///
+  /// \return
+  ///     The number of bytes read for each range, or an error if the packet
+  ///     as a whole failed.
+  llvm::Expected<std::vector<size_t>> ReadMemoryRanges(
+      llvm::ArrayRef<std::pair<lldb::addr_t, llvm::MutableArrayRef<uint8_t>>>
+          ranges);
+
   /// Return the feature set supported by the gdb-remote server.
   ///
   /// This method returns the remote side's response to the qSupported
@@ -557,6 +572,7 @@ protected:
   LazyBool m_supports_jLoadedDynamicLibrariesInfos;
   LazyBool m_supports_jGetSharedCacheInfo;
   LazyBool m_supports_QPassSignals;
+  LazyBool m_supports_MultiMemRead;
   LazyBool m_supports_error_string_reply;
 
   bool m_supports_qProcessInfoPID : 1, m_supports_qfProcessInfo : 1,
@@ -145,6 +145,10 @@ protected:
   virtual FileSpec FindModuleFile(const std::string &module_path,
                                   const ArchSpec &arch);
 
+  /// Append the features that only this kind of server supports to a
+  /// qSupported response, each preceded by a ';'.
+  virtual void AppendSupportedFeatures(StreamGDBRemote &response) {}
+
 private:
   ModuleSpec GetModuleInfo(llvm::StringRef module_path, llvm::StringRef triple);
 };
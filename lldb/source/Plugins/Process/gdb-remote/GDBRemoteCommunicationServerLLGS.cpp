@@ -93,6 +93,9 @@ void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
       &GDBRemoteCommunicationServerLLGS::Handle_memory_read);
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_M,
                                 &GDBRemoteCommunicationServerLLGS::Handle_M);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_MultiMemRead,
+      &GDBRemoteCommunicationServerLLGS::Handle_MultiMemRead);
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType__M,
                                 &GDBRemoteCommunicationServerLLGS::Handle__M);
   RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType__m,
@@ -2399,6 +2402,78 @@ GDBRemoteCommunicationServerLLGS::Handle_memory_read(
   return SendPacketNoLock(response.GetString());
 }
 
+void GDBRemoteCommunicationServerLLGS::AppendSupportedFeatures(
+    StreamGDBRemote &response) {
+  response.PutCString(";MultiMemRead+");
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_MultiMemRead(
+    StringExtractorGDBRemote &packet) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+
+  if (!m_debugged_process_up ||
+      (m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)) {
+    LLDB_LOGF(
+        log,
+        "GDBRemoteCommunicationServerLLGS::%s failed, no process available",
+        __FUNCTION__);
+    return SendErrorResponse(0x15);
+  }
+
+  // MultiMemRead:ranges:<addr>,<length>[,<addr>,<length>]*;
+  packet.SetFilePos(strlen("MultiMemRead:"));
+  if (!packet.ConsumeFront("ranges:"))
+    return SendIllFormedResponse(packet, "Missing ranges in MultiMemRead");
+
+  std::vector<std::pair<lldb::addr_t, uint64_t>> ranges;
+  uint64_t total_size = 0;
+  while (packet.GetBytesLeft() > 0 && packet.PeekChar() != ';') {
+    if (!ranges.empty() && packet.GetChar() != ',')
+      return SendIllFormedResponse(packet, "Comma sep missing in MultiMemRead");
+    const lldb::addr_t addr = packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+    if (addr == LLDB_INVALID_ADDRESS || packet.GetChar() != ',')
+      return SendIllFormedResponse(packet, "Bad address in MultiMemRead");
+    const uint64_t length = packet.GetHexMaxU64(false, UINT64_MAX);
+    if (length == UINT64_MAX || total_size + length < total_size)
+      return SendIllFormedResponse(packet, "Bad length in MultiMemRead");
+    total_size += length;
+    ranges.emplace_back(addr, length);
+  }
+  if (ranges.empty() || packet.GetChar() != ';')
+    return SendIllFormedResponse(packet, "Bad ranges in MultiMemRead");
+
+  // The reply lists the number of bytes read for each range, followed by the
+  // bytes of all ranges back to back. A range that cannot be read, or can
+  // only be read in part, is reported with a shorter length instead of
+  // failing the whole packet.
+  std::string buf(total_size, '\0');
+  std::vector<size_t> bytes_read(ranges.size(), 0);
+  size_t offset = 0;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (ranges[i].second > 0) {
+      Status error = m_debugged_process_up->ReadMemoryWithoutTrap(
+          ranges[i].first, &buf[offset], ranges[i].second, bytes_read[i]);
+      if (error.Fail())
+        LLDB_LOGF(log,
+                  "GDBRemoteCommunicationServerLLGS::%s pid %" PRIu64
+                  " mem 0x%" PRIx64 ": read %" PRIu64 " of %" PRIu64
+                  " requested bytes. Error: %s",
+                  __FUNCTION__, m_debugged_process_up->GetID(),
+                  ranges[i].first, (uint64_t)bytes_read[i], ranges[i].second,
+                  error.AsCString());
+    }
+    offset += bytes_read[i];
+  }
+
+  StreamGDBRemote response;
+  for (size_t i = 0; i < bytes_read.size(); ++i)
+    response.Printf(i == 0 ? "%" PRIx64 : ",%" PRIx64, (uint64_t)bytes_read[i]);
+  response.PutChar(';');
+  response.PutEscapedBytes(buf.data(), offset);
+  return SendPacketNoLock(response.GetString());
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle__M(StringExtractorGDBRemote &packet) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
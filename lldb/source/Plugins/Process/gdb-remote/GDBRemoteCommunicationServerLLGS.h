@@ -148,6 +148,8 @@ protected:
   // Handles $m and $x packets.
   PacketResult Handle_memory_read(StringExtractorGDBRemote &packet);
 
+  PacketResult Handle_MultiMemRead(StringExtractorGDBRemote &packet);
+
   PacketResult Handle_M(StringExtractorGDBRemote &packet);
   PacketResult Handle__M(StringExtractorGDBRemote &packet);
   PacketResult Handle__m(StringExtractorGDBRemote &packet);
@@ -236,6 +238,8 @@ private:
 
   void RegisterPacketHandlers();
 
+  void AppendSupportedFeatures(StreamGDBRemote &response) override;
+
   void DataAvailableCallback();
 
   void SendProcessOutput();
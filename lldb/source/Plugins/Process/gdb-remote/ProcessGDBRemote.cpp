@@ -2721,6 +2721,7 @@ size_t ProcessGDBRemote::DoReadMemory(addr_t addr, void *buf, size_t size,
   assert(packet_len + 1 < (int)sizeof(packet));
   UNUSED_IF_ASSERT_DISABLED(packet_len);
   StringExtractorGDBRemote response;
+  ++m_num_memory_read_packets;
   if (m_gdb_comm.SendPacketAndWaitForResponse(packet, response, true) ==
       GDBRemoteCommunication::PacketResult::Success) {
     if (response.IsNormalResponse()) {
@@ -2737,10 +2738,13 @@ size_t ProcessGDBRemote::DoReadMemory(addr_t addr, void *buf, size_t size,
           data_received_size = size;
         }
         memcpy(buf, response.GetStringRef().data(), data_received_size);
+        m_num_memory_bytes_read += data_received_size;
         return data_received_size;
       } else {
-        return response.GetHexBytes(
+        size_t data_received_size = response.GetHexBytes(
             llvm::MutableArrayRef<uint8_t>((uint8_t *)buf, size), '\xdd');
+        m_num_memory_bytes_read += data_received_size;
+        return data_received_size;
       }
     } else if (response.IsErrorResponse())
       error.SetErrorStringWithFormat("memory read failed for 0x%" PRIx64, addr);
@@ -2757,6 +2761,86 @@ size_t ProcessGDBRemote::DoReadMemory(addr_t addr, void *buf, size_t size,
   return 0;
 }
 
+void ProcessGDBRemote::DumpPacketStatistics(Stream &strm) {
+  strm.Printf("Packets sent: %" PRIu64 "\n", m_gdb_comm.GetNumPacketsSent());
+  strm.Printf("Packets received: %" PRIu64 "\n",
+              m_gdb_comm.GetNumPacketsReceived());
+  strm.Printf("Memory read packets: %" PRIu64 "\n",
+              m_num_memory_read_packets.load());
+  strm.Printf("MultiMemRead packets: %" PRIu64 " (%" PRIu64 " ranges)\n",
+              m_num_multi_memory_read_packets.load(),
+              m_num_multi_memory_read_ranges.load());
+  strm.Printf("Memory bytes read: %" PRIu64 "\n",
+              m_num_memory_bytes_read.load());
+
+  MemoryCache::Statistics stats = GetMemoryCacheStatistics();
+  strm.Printf("Memory cache hits: %" PRIu64 "\n", stats.hits);
+  strm.Printf("Memory cache misses: %" PRIu64 "\n", stats.misses);
+  strm.Printf("Memory cache lines read: %" PRIu64 " (%" PRIu64
+              " read ahead)\n",
+              stats.lines_read, stats.read_ahead_lines);
+}
+
+bool ProcessGDBRemote::SupportsBatchedMemoryReads() {
+  return m_gdb_comm.GetMultiMemReadSupported();
+}
+
+std::vector<size_t> ProcessGDBRemote::DoReadMemoryRanges(
+    llvm::ArrayRef<MemoryReadRequest> requests) {
+  if (requests.size() < 2 || !m_gdb_comm.GetMultiMemReadSupported())
+    return Process::DoReadMemoryRanges(requests);
+
+  GetMaxMemorySize();
+  std::vector<size_t> bytes_read(requests.size(), 0);
+
+  // Pack as many ranges as fit in one reply into each MultiMemRead packet.
+  // Ranges too large for a single reply are read on their own, since they
+  // need several packets anyway.
+  std::vector<std::pair<lldb::addr_t, llvm::MutableArrayRef<uint8_t>>> batch;
+  std::vector<size_t> batch_indexes;
+  uint64_t batch_size = 0;
+  auto flush_batch = [&]() {
+    if (batch.empty())
+      return;
+    ++m_num_multi_memory_read_packets;
+    m_num_multi_memory_read_ranges += batch.size();
+    llvm::Expected<std::vector<size_t>> batch_bytes_read =
+        m_gdb_comm.ReadMemoryRanges(batch);
+    if (batch_bytes_read) {
+      for (size_t i = 0; i < batch.size(); ++i) {
+        bytes_read[batch_indexes[i]] = (*batch_bytes_read)[i];
+        m_num_memory_bytes_read += (*batch_bytes_read)[i];
+      }
+    } else {
+      LLDB_LOG_ERROR(ProcessGDBRemoteLog::GetLogIfAnyCategoryIsSet(
+                         GDBR_LOG_MEMORY),
+                     batch_bytes_read.takeError(),
+                     "MultiMemRead failed, reading ranges one by one: {0}");
+      for (size_t index : batch_indexes)
+        bytes_read[index] = Process::DoReadMemoryRanges(requests[index])[0];
+    }
+    batch.clear();
+    batch_indexes.clear();
+    batch_size = 0;
+  };
+
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const MemoryReadRequest &request = requests[i];
+    if (request.size > m_max_memory_size) {
+      bytes_read[i] = Process::DoReadMemoryRanges(request)[0];
+      continue;
+    }
+    if (batch_size + request.size > m_max_memory_size)
+      flush_batch();
+    batch.emplace_back(request.addr, llvm::MutableArrayRef<uint8_t>(
+                                         request.buf, request.size));
+    batch_indexes.push_back(i);
+    batch_size += request.size;
+  }
+  flush_batch();
+  return bytes_read;
+}
+
 Status ProcessGDBRemote::WriteObjectFile(
     std::vector<ObjectFile::LoadableData> entries) {
   Status error;
@@ -5204,6 +5288,38 @@ public:
   }
 };
 
+class CommandObjectProcessGDBRemotePacketStatistics
+    : public CommandObjectParsed {
+private:
+public:
+  CommandObjectProcessGDBRemotePacketStatistics(CommandInterpreter &interpreter)
+      : CommandObjectParsed(interpreter, "process plugin packet statistics",
+                            "Dumps the number of packets exchanged with the "
+                            "remote stub and memory read statistics.",
+                            nullptr) {}
+
+  ~CommandObjectProcessGDBRemotePacketStatistics() override {}
+
+  bool DoExecute(Args &command, CommandReturnObject &result) override {
+    const size_t argc = command.GetArgumentCount();
+    if (argc == 0) {
+      ProcessGDBRemote *process =
+          (ProcessGDBRemote *)m_interpreter.GetExecutionContext()
+              .GetProcessPtr();
+      if (process) {
+        process->DumpPacketStatistics(result.GetOutputStream());
+        result.SetStatus(eReturnStatusSuccessFinishResult);
+        return true;
+      }
+    } else {
+      result.AppendErrorWithFormat("'%s' takes no arguments",
+                                   m_cmd_name.c_str());
+    }
+    result.SetStatus(eReturnStatusFailed);
+    return false;
+  }
+};
+
 class CommandObjectProcessGDBRemotePacketXferSize : public CommandObjectParsed {
 private:
 public:
@@ -5357,6 +5473,10 @@ public:
     LoadSubCommand(
         "send", CommandObjectSP(
                     new CommandObjectProcessGDBRemotePacketSend(interpreter)));
+    LoadSubCommand(
+        "statistics",
+        CommandObjectSP(
+            new CommandObjectProcessGDBRemotePacketStatistics(interpreter)));
     LoadSubCommand(
         "monitor",
         CommandObjectSP(
@@ -134,6 +134,15 @@ public:
   size_t DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
                       Status &error) override;
 
+  std::vector<size_t>
+  DoReadMemoryRanges(llvm::ArrayRef<MemoryReadRequest> requests) override;
+
+  bool SupportsBatchedMemoryReads() override;
+
+  /// Print the number of packets exchanged with the remote stub and how
+  /// memory reads were serviced.
+  void DumpPacketStatistics(Stream &strm);
+
   Status
   WriteObjectFile(std::vector<ObjectFile::LoadableData> entries) override;
 
@@ -280,6 +289,10 @@ protected:
                               // reading and writing memory
   uint64_t m_remote_stub_max_memory_size; // The maximum memory size the remote
                                           // gdb stub can handle
+  std::atomic<uint64_t> m_num_memory_read_packets{0};
+  std::atomic<uint64_t> m_num_multi_memory_read_packets{0};
+  std::atomic<uint64_t> m_num_multi_memory_read_ranges{0};
+  std::atomic<uint64_t> m_num_memory_bytes_read{0};
   MMapMap m_addr_to_mmap_size;
   lldb::BreakpointSP m_thread_create_bp_sp;
   bool m_waiting_for_attach;
@@ -12,15 +12,27 @@
 #include "Plugins/SymbolFile/DWARF/DWARFDeclContext.h"
 #include "Plugins/SymbolFile/DWARF/LogChannelDWARF.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARFDwo.h"
+#include "lldb/Core/Debugger.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Host/FileSystem.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/ThreadPool.h"
 
 using namespace lldb_private;
 using namespace lldb;
 
+/// Identifies a cached index and the version of its format. The version must
+/// be bumped whenever the format, or the way the index is built, changes.
+static const char g_cache_magic[] = "LLDBDWARFIndex";
+static const uint32_t g_cache_version = 1;
+
 void ManualDWARFIndex::Index() {
   if (!m_dwarf)
     return;
@@ -30,6 +42,10 @@ void ManualDWARFIndex::Index() {
 
   LLDB_SCOPED_TIMERF("%p", static_cast<void *>(&main_dwarf));
 
+  llvm::Optional<std::string> cache_file = GetCacheFileName(main_dwarf);
+  if (cache_file && LoadFromCache(*cache_file))
+    return;
+
   DWARFDebugInfo &main_info = main_dwarf.DebugInfo();
   SymbolFileDWARFDwo *dwp_dwarf = main_dwarf.GetDwpSymbolFile().get();
   DWARFDebugInfo *dwp_info = dwp_dwarf ? &dwp_dwarf->DebugInfo() : nullptr;
@@ -72,7 +88,8 @@ void ManualDWARFIndex::Index() {
 
   // Share one thread pool across operations to avoid the overhead of
   // recreating the threads.
-  llvm::ThreadPool pool(llvm::optimal_concurrency(units_to_index.size()));
+  llvm::ThreadPool pool(
+      Debugger::GetThreadPoolStrategy(units_to_index.size()));
 
   // Create a task runner that extracts dies for each DWARF unit in a
   // separate thread.
@@ -108,6 +125,169 @@ void ManualDWARFIndex::Index() {
   pool.async(finalize_fn, &IndexSet::types);
   pool.async(finalize_fn, &IndexSet::namespaces);
   pool.wait();
+
+  // Indexes that include dwo files aren't cached, since the dwo files may
+  // change without the module changing.
+  if (cache_file && !dwp_dwarf &&
+      llvm::none_of(units_to_index, [](DWARFUnit *unit) {
+        return unit->GetDwoSymbolFile() != nullptr;
+      }))
+    SaveToCache(*cache_file);
+}
+
+llvm::Optional<std::string>
+ManualDWARFIndex::GetCacheFileName(SymbolFileDWARF &dwarf) {
+  FileSpec cache_dir = SymbolFileDWARF::GetIndexCachePath();
+  if (!cache_dir)
+    return llvm::None;
+
+  // A dwp file may change without the module changing.
+  if (dwarf.GetDwpSymbolFile())
+    return llvm::None;
+
+  // Identify the module by its path and modification time, as well as its
+  // UUID when it has one. Modules without a file on disk aren't cached.
+  ObjectFile *objfile = m_module.GetObjectFile();
+  if (!objfile || !FileSystem::Instance().Exists(objfile->GetFileSpec()))
+    return llvm::None;
+  llvm::sys::TimePoint<> mod_time = m_module.GetObjectModificationTime();
+  if (mod_time == llvm::sys::TimePoint<>())
+    mod_time = m_module.GetModificationTime();
+  if (mod_time == llvm::sys::TimePoint<>())
+    return llvm::None;
+
+  llvm::MD5 hash;
+  hash.update(objfile->GetFileSpec().GetPath());
+  hash.update(m_module.GetObjectName().GetStringRef());
+  hash.update(std::to_string(m_module.GetObjectOffset()));
+  hash.update(std::to_string(mod_time.time_since_epoch().count()));
+  hash.update(m_module.GetUUID().GetAsString());
+  hash.update(m_module.GetArchitecture().GetTriple().str());
+  // The units to avoid are indexed elsewhere, so they are part of the key.
+  std::vector<dw_offset_t> units_to_avoid(m_units_to_avoid.begin(),
+                                          m_units_to_avoid.end());
+  llvm::sort(units_to_avoid);
+  for (dw_offset_t offset : units_to_avoid)
+    hash.update(std::to_string(offset));
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+
+  // The prefix is required for the files to be considered by the pruning.
+  llvm::SmallString<128> path(cache_dir.GetPath());
+  llvm::sys::path::append(path, "llvmcache-" + result.digest().str());
+  return std::string(path.str());
+}
+
+bool ManualDWARFIndex::LoadFromCache(llvm::StringRef path) {
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS);
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer_or =
+      llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!buffer_or)
+    return false;
+
+  llvm::DataExtractor data((*buffer_or)->getBuffer(), /*IsLittleEndian=*/true,
+                           /*AddressSize=*/8);
+  llvm::DataExtractor::Cursor cursor(0);
+  if (data.getBytes(cursor, sizeof(g_cache_magic)) !=
+          llvm::StringRef(g_cache_magic, sizeof(g_cache_magic)) ||
+      data.getU32(cursor) != g_cache_version) {
+    llvm::consumeError(cursor.takeError());
+    LLDB_LOG(log, "Ignoring DWARF index cache file '{0}' with unknown format",
+             path);
+    return false;
+  }
+
+  m_set.function_basenames.Decode(data, cursor);
+  m_set.function_fullnames.Decode(data, cursor);
+  m_set.function_methods.Decode(data, cursor);
+  m_set.function_selectors.Decode(data, cursor);
+  m_set.objc_class_selectors.Decode(data, cursor);
+  m_set.globals.Decode(data, cursor);
+  m_set.types.Decode(data, cursor);
+  m_set.namespaces.Decode(data, cursor);
+  if (llvm::Error error = cursor.takeError()) {
+    LLDB_LOG_ERROR(log, std::move(error),
+                   "Ignoring corrupt DWARF index cache file: {0}");
+    m_set = IndexSet();
+    return false;
+  }
+
+  // The entries are sorted by the address of the uniqued names, which differs
+  // from the process that saved them.
+  m_set.function_basenames.Finalize();
+  m_set.function_fullnames.Finalize();
+  m_set.function_methods.Finalize();
+  m_set.function_selectors.Finalize();
+  m_set.objc_class_selectors.Finalize();
+  m_set.globals.Finalize();
+  m_set.types.Finalize();
+  m_set.namespaces.Finalize();
+  LLDB_LOG(log, "Loaded DWARF index of '{0}' from cache file '{1}'",
+           m_module.GetFileSpec(), path);
+  return true;
+}
+
+void ManualDWARFIndex::SaveToCache(llvm::StringRef path) {
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS);
+
+  llvm::StringRef cache_dir = llvm::sys::path::parent_path(path);
+  if (std::error_code ec = llvm::sys::fs::create_directories(cache_dir)) {
+    LLDB_LOG(log, "Unable to create DWARF index cache directory '{0}': {1}",
+             cache_dir, ec.message());
+    return;
+  }
+
+  // Write the index into a temporary file first, and then move it into place,
+  // so that concurrent debugger sessions never see a partial cache file.
+  llvm::SmallString<128> temp_model(cache_dir);
+  llvm::sys::path::append(temp_model, "lldb-dwarf-index-%%%%%%.tmp");
+  llvm::Expected<llvm::sys::fs::TempFile> temp_or =
+      llvm::sys::fs::TempFile::create(temp_model);
+  if (!temp_or) {
+    LLDB_LOG_ERROR(log, temp_or.takeError(),
+                   "Unable to create DWARF index cache file: {0}");
+    return;
+  }
+  std::error_code write_error;
+  {
+    llvm::raw_fd_ostream os(temp_or->FD, /*shouldClose=*/false);
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    os.write(g_cache_magic, sizeof(g_cache_magic));
+    writer.write<uint32_t>(g_cache_version);
+    m_set.function_basenames.Encode(writer);
+    m_set.function_fullnames.Encode(writer);
+    m_set.function_methods.Encode(writer);
+    m_set.function_selectors.Encode(writer);
+    m_set.objc_class_selectors.Encode(writer);
+    m_set.globals.Encode(writer);
+    m_set.types.Encode(writer);
+    m_set.namespaces.Encode(writer);
+    os.flush();
+    // A write error that isn't cleared is fatal when the stream is destroyed.
+    if (os.has_error()) {
+      write_error = os.error();
+      os.clear_error();
+    }
+  }
+  if (write_error) {
+    LLDB_LOG(log, "Unable to write DWARF index cache file '{0}': {1}",
+             temp_or->TmpName, write_error.message());
+    if (llvm::Error error = temp_or->discard())
+      LLDB_LOG_ERROR(log, std::move(error),
+                     "Unable to remove DWARF index cache file: {0}");
+    return;
+  }
+  if (llvm::Error error = temp_or->keep(path)) {
+    LLDB_LOG_ERROR(log, std::move(error),
+                   "Unable to save DWARF index cache file: {0}");
+    return;
+  }
+
+  llvm::CachePruningPolicy policy;
+  policy.MaxSizeBytes = SymbolFileDWARF::GetIndexCacheMaxSize();
+  llvm::pruneCache(cache_dir, policy);
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, SymbolFileDWARFDwo *dwp,
@@ -69,6 +69,18 @@ private:
   void Index();
   void IndexUnit(DWARFUnit &unit, SymbolFileDWARFDwo *dwp, IndexSet &set);
 
+  /// Return the name of the file caching the index of this module, or None if
+  /// the index should not be cached. The name changes whenever the module
+  /// does, which invalidates the cached index.
+  llvm::Optional<std::string> GetCacheFileName(SymbolFileDWARF &dwarf);
+
+  /// Load the index from the cache file at \a path. Returns false, leaving
+  /// the index empty, if there is no usable cached index.
+  bool LoadFromCache(llvm::StringRef path);
+
+  /// Save the index into a cache file at \a path, and prune the cache.
+  void SaveToCache(llvm::StringRef path);
+
   static void IndexUnitImpl(DWARFUnit &unit,
                             const lldb::LanguageType cu_language,
                             IndexSet &set);
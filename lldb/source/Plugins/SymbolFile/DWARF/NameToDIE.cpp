@@ -86,3 +86,57 @@ void NameToDIE::Append(const NameToDIE &other) {
                  other.m_map.GetValueAtIndexUnchecked(i));
   }
 }
+
+void NameToDIE::Encode(llvm::support::endian::Writer &writer) const {
+  // Count the runs of entries with the same name first.
+  const uint32_t size = m_map.GetSize();
+  uint32_t num_names = 0;
+  for (uint32_t i = 0; i < size; ++i) {
+    if (i == 0 || m_map.GetCStringAtIndexUnchecked(i) !=
+                      m_map.GetCStringAtIndexUnchecked(i - 1))
+      ++num_names;
+  }
+  writer.write<uint32_t>(num_names);
+
+  // Each name is followed by the DIEs it refers to.
+  for (uint32_t i = 0; i < size;) {
+    ConstString name = m_map.GetCStringAtIndexUnchecked(i);
+    uint32_t end = i + 1;
+    while (end < size && m_map.GetCStringAtIndexUnchecked(end) == name)
+      ++end;
+
+    writer.write<uint32_t>(name.GetLength());
+    writer.OS << name.GetStringRef();
+    writer.write<uint32_t>(end - i);
+    for (; i < end; ++i) {
+      const DIERef &die_ref = m_map.GetValueAtIndexUnchecked(i);
+      llvm::Optional<uint32_t> dwo_num = die_ref.dwo_num();
+      writer.write<uint32_t>(dwo_num ? *dwo_num + 1 : 0);
+      writer.write<uint8_t>(die_ref.section());
+      writer.write<uint32_t>(die_ref.die_offset());
+    }
+  }
+}
+
+void NameToDIE::Decode(const llvm::DataExtractor &data,
+                       llvm::DataExtractor::Cursor &cursor) {
+  const uint32_t num_names = data.getU32(cursor);
+  for (uint32_t i = 0; i < num_names && cursor; ++i) {
+    const uint32_t length = data.getU32(cursor);
+    ConstString name(data.getBytes(cursor, length));
+    const uint32_t num_refs = data.getU32(cursor);
+    for (uint32_t j = 0; j < num_refs && cursor; ++j) {
+      const uint32_t dwo_num = data.getU32(cursor);
+      const uint8_t section = data.getU8(cursor);
+      const dw_offset_t die_offset = data.getU32(cursor);
+      if (!cursor)
+        return;
+      m_map.Append(name,
+                   DIERef(dwo_num ? llvm::Optional<uint32_t>(dwo_num - 1)
+                                  : llvm::None,
+                          section == DIERef::DebugTypes ? DIERef::DebugTypes
+                                                        : DIERef::DebugInfo,
+                          die_offset));
+    }
+  }
+}
@@ -15,6 +15,8 @@
 #include "lldb/Core/UniqueCStringMap.h"
 #include "lldb/Core/dwarf.h"
 #include "lldb/lldb-defines.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/EndianStream.h"
 
 class DWARFUnit;
 
@@ -47,6 +49,15 @@ public:
                              const DIERef &die_ref)> const
               &callback) const;
 
+  /// Serialize all entries of this table. Entries with the same name are
+  /// grouped together, so the table should be finalized first.
+  void Encode(llvm::support::endian::Writer &writer) const;
+
+  /// Append the entries serialized by Encode, reading them from \a data at
+  /// \a cursor. Any error is reported through the cursor.
+  void Decode(const llvm::DataExtractor &data,
+              llvm::DataExtractor::Cursor &cursor);
+
 protected:
   lldb_private::UniqueCStringMap<DIERef> m_map;
 };
@@ -74,6 +74,7 @@
 
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 
 #include <algorithm>
 #include <map>
@@ -141,6 +142,32 @@ public:
     return m_collection_sp->GetPropertyAtIndexAsBoolean(
         nullptr, ePropertyIgnoreIndexes, false);
   }
+
+  bool GetEnableIndexCache() const {
+    return m_collection_sp->GetPropertyAtIndexAsBoolean(
+        nullptr, ePropertyEnableIndexCache, false);
+  }
+
+  void SetEnableIndexCache(bool enable) {
+    m_collection_sp->SetPropertyAtIndexAsBoolean(
+        nullptr, ePropertyEnableIndexCache, enable);
+  }
+
+  FileSpec GetIndexCachePath() const {
+    return m_collection_sp->GetPropertyAtIndexAsFileSpec(
+        nullptr, ePropertyIndexCachePath);
+  }
+
+  void SetIndexCachePath(const FileSpec &path) {
+    m_collection_sp->SetPropertyAtIndexAsFileSpec(
+        nullptr, ePropertyIndexCachePath, path);
+  }
+
+  uint64_t GetIndexCacheMaxSize() const {
+    const uint32_t idx = ePropertyIndexCacheMaxSize;
+    return m_collection_sp->GetPropertyAtIndexAsUInt64(
+        nullptr, idx, g_symbolfiledwarf_properties[idx].default_uint_value);
+  }
 };
 
 typedef std::shared_ptr<PluginProperties> SymbolFileDWARFPropertiesSP;
@@ -500,6 +527,28 @@ void SymbolFileDWARF::InitializeObject() {
       std::make_unique<ManualDWARFIndex>(*GetObjectFile()->GetModule(), *this);
 }
 
+FileSpec SymbolFileDWARF::GetIndexCachePath() {
+  if (!GetGlobalPluginProperties()->GetEnableIndexCache())
+    return FileSpec();
+  FileSpec path = GetGlobalPluginProperties()->GetIndexCachePath();
+  if (path)
+    return path;
+  llvm::SmallString<128> cache_dir;
+  if (!llvm::sys::path::cache_directory(cache_dir))
+    return FileSpec();
+  llvm::sys::path::append(cache_dir, "lldb", "DWARFIndexCache");
+  return FileSpec(cache_dir);
+}
+
+void SymbolFileDWARF::SetIndexCachePath(const FileSpec &path) {
+  GetGlobalPluginProperties()->SetEnableIndexCache(static_cast<bool>(path));
+  GetGlobalPluginProperties()->SetIndexCachePath(path);
+}
+
+uint64_t SymbolFileDWARF::GetIndexCacheMaxSize() {
+  return GetGlobalPluginProperties()->GetIndexCacheMaxSize();
+}
+
 bool SymbolFileDWARF::SupportedVersion(uint16_t version) {
   return version >= 2 && version <= 5;
 }
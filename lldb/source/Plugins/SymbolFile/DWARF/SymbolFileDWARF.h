@@ -90,6 +90,19 @@ public:
   static lldb_private::SymbolFile *
   CreateInstance(lldb::ObjectFileSP objfile_sp);
 
+  /// Return the directory in which manually built indexes are cached, or an
+  /// empty FileSpec if the index cache is disabled.
+  static lldb_private::FileSpec GetIndexCachePath();
+
+  /// Enable the index cache in the directory \a path, or disable it if \a path
+  /// is empty.
+  static void SetIndexCachePath(const lldb_private::FileSpec &path);
+
+  /// Return the maximum size of the index cache in bytes, or 0 if only the
+  /// limits that always apply are enforced: the cache is kept below 75% of the
+  /// free disk space, and indexes unused for a week are removed.
+  static uint64_t GetIndexCacheMaxSize();
+
   // Constructors and Destructors
 
   SymbolFileDWARF(lldb::ObjectFileSP objfile_sp,
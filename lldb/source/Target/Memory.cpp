@@ -13,6 +13,7 @@
 #include "lldb/Utility/RangeMap.h"
 #include "lldb/Utility/State.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <memory>
 
@@ -23,7 +24,8 @@ using namespace lldb_private;
 MemoryCache::MemoryCache(Process &process)
     : m_mutex(), m_L1_cache(), m_L2_cache(), m_invalid_ranges(),
       m_process(process),
-      m_L2_cache_line_byte_size(process.GetMemoryCacheLineSize()) {}
+      m_L2_cache_line_byte_size(process.GetMemoryCacheLineSize()),
+      m_max_read_ahead_lines(process.GetMemoryCacheMaxReadAhead()) {}
 
 // Destructor
 MemoryCache::~MemoryCache() {}
@@ -35,6 +37,14 @@ void MemoryCache::Clear(bool clear_invalid_ranges) {
   if (clear_invalid_ranges)
     m_invalid_ranges.Clear();
   m_L2_cache_line_byte_size = m_process.GetMemoryCacheLineSize();
+  m_max_read_ahead_lines = m_process.GetMemoryCacheMaxReadAhead();
+  m_read_ahead_lines = 0;
+  m_next_sequential_addr = LLDB_INVALID_ADDRESS;
+}
+
+MemoryCache::Statistics MemoryCache::GetStatistics() {
+  std::lock_guard<std::recursive_mutex> guard(m_mutex);
+  return m_stats;
 }
 
 void MemoryCache::AddL1CacheData(lldb::addr_t addr, const void *src,
@@ -144,6 +154,7 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
     if (chunk_range.Contains(read_range)) {
       memcpy(dst, pos->second->GetBytes() + (addr - chunk_range.GetRangeBase()),
              dst_len);
+      ++m_stats.hits;
       return dst_len;
     }
   }
@@ -156,6 +167,7 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
   // 4 bytes after the large memory read - so there's little benefit to saving
   // it in the cache.
   if (dst && dst_len > m_L2_cache_line_byte_size) {
+    ++m_stats.misses;
     size_t bytes_read =
         m_process.ReadMemoryFromInferior(addr, dst, dst_len, error);
     // Add this non block sized range to the L1 cache if we actually read
@@ -170,6 +182,7 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
     uint8_t *dst_buf = (uint8_t *)dst;
     addr_t curr_addr = addr - (addr % cache_line_byte_size);
     addr_t cache_offset = addr - curr_addr;
+    bool missed = false;
 
     while (bytes_left > 0) {
       if (m_invalid_ranges.FindEntryThatContains(curr_addr)) {
@@ -224,31 +237,135 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
 
       if (bytes_left > 0) {
         assert((curr_addr % cache_line_byte_size) == 0);
-        std::unique_ptr<DataBufferHeap> data_buffer_heap_up(
-            new DataBufferHeap(cache_line_byte_size, 0));
-        size_t process_bytes_read = m_process.ReadMemoryFromInferior(
-            curr_addr, data_buffer_heap_up->GetBytes(),
-            data_buffer_heap_up->GetByteSize(), error);
+        if (!missed) {
+          ++m_stats.misses;
+          missed = true;
+        }
+        size_t process_bytes_read =
+            FetchCacheLines(curr_addr, cache_offset + bytes_left, error);
         if (process_bytes_read == 0)
           return dst_len - bytes_left;
 
-        if (process_bytes_read != cache_line_byte_size) {
-          if (process_bytes_read < data_buffer_heap_up->GetByteSize()) {
-            dst_len -= data_buffer_heap_up->GetByteSize() - process_bytes_read;
-            bytes_left = process_bytes_read;
-          }
-          data_buffer_heap_up->SetByteSize(process_bytes_read);
+        if (process_bytes_read < cache_line_byte_size) {
+          dst_len -= cache_line_byte_size - process_bytes_read;
+          bytes_left = process_bytes_read;
         }
-        m_L2_cache[curr_addr] = DataBufferSP(data_buffer_heap_up.release());
         // We have read data and put it into the cache, continue through the
         // loop again to get the data out of the cache...
       }
     }
+    if (!missed)
+      ++m_stats.hits;
   }
 
   return dst_len - bytes_left;
 }
 
+size_t MemoryCache::FetchCacheLines(addr_t line_addr, size_t byte_size,
+                                    Status &error) {
+  const uint32_t cache_line_byte_size = m_L2_cache_line_byte_size;
+  // Each run is a range of consecutive cache lines that is read with a single
+  // request. The first runs cover the lines this read needs, the last one
+  // (if any) the read-ahead lines.
+  struct Run {
+    addr_t addr;
+    size_t num_lines;
+  };
+  std::vector<Run> runs;
+  auto add_line = [&](addr_t line, bool new_run) {
+    if (!new_run && !runs.empty() &&
+        runs.back().addr + runs.back().num_lines * cache_line_byte_size ==
+            line)
+      ++runs.back().num_lines;
+    else
+      runs.push_back({line, 1});
+  };
+
+  // Collect every missing line up to the end of the read so that gaps
+  // between cached lines are filled in one batch rather than one round trip
+  // per gap.
+  const size_t num_lines =
+      (byte_size + cache_line_byte_size - 1) / cache_line_byte_size;
+  addr_t fetch_end = line_addr;
+  for (size_t i = 0; i < num_lines; ++i) {
+    const addr_t line = line_addr + i * cache_line_byte_size;
+    if (line < line_addr || m_invalid_ranges.FindEntryThatContains(line))
+      break;
+    if (m_L2_cache.count(line))
+      continue;
+    add_line(line, /*new_run=*/false);
+    fetch_end = line + cache_line_byte_size;
+  }
+  assert(!runs.empty() && runs.front().addr == line_addr);
+
+  // Grow the read-ahead window while misses continue where the previous
+  // batch ended. Read-ahead lines get their own request so that running off
+  // the end of a mapping cannot fail the read of the lines that are needed.
+  uint32_t read_ahead_lines = 0;
+  if (m_max_read_ahead_lines && m_process.SupportsBatchedMemoryReads()) {
+    if (line_addr == m_next_sequential_addr)
+      m_read_ahead_lines = std::min(std::max(m_read_ahead_lines * 2, 1u),
+                                    m_max_read_ahead_lines);
+    else
+      m_read_ahead_lines = 0;
+    for (; read_ahead_lines < m_read_ahead_lines; ++read_ahead_lines) {
+      const addr_t line = fetch_end + read_ahead_lines * cache_line_byte_size;
+      if (line < fetch_end || m_invalid_ranges.FindEntryThatContains(line) ||
+          m_L2_cache.count(line))
+        break;
+      add_line(line, /*new_run=*/read_ahead_lines == 0);
+    }
+  }
+  m_next_sequential_addr =
+      fetch_end + read_ahead_lines * cache_line_byte_size;
+
+  std::vector<std::vector<uint8_t>> buffers;
+  std::vector<Process::MemoryReadRequest> requests;
+  buffers.reserve(runs.size());
+  requests.reserve(runs.size());
+  for (const Run &run : runs) {
+    buffers.emplace_back(run.num_lines * cache_line_byte_size);
+    requests.push_back(
+        {run.addr, buffers.back().data(), buffers.back().size()});
+  }
+  std::vector<size_t> bytes_read =
+      m_process.ReadMemoryRangesFromInferior(requests);
+
+  // Split the runs back into cache lines. A short read ends a run: the line
+  // it stops in is cached with the bytes that were read, and the lines after
+  // it are left uncached.
+  for (size_t i = 0; i < runs.size(); ++i) {
+    for (size_t offset = 0; offset < bytes_read[i];
+         offset += cache_line_byte_size) {
+      const size_t line_size =
+          std::min<size_t>(cache_line_byte_size, bytes_read[i] - offset);
+      m_L2_cache[runs[i].addr + offset] = DataBufferSP(
+          new DataBufferHeap(buffers[i].data() + offset, line_size));
+      ++m_stats.lines_read;
+    }
+  }
+  m_stats.read_ahead_lines += read_ahead_lines;
+
+  if (bytes_read.front() > 0) {
+    error.Clear();
+    return std::min<size_t>(bytes_read.front(), cache_line_byte_size);
+  }
+
+  // The batched read does not report why a range could not be read. Read the
+  // first line again on its own to get the process' error.
+  std::unique_ptr<DataBufferHeap> data_buffer_heap_up(
+      new DataBufferHeap(cache_line_byte_size, 0));
+  size_t process_bytes_read = m_process.ReadMemoryFromInferior(
+      line_addr, data_buffer_heap_up->GetBytes(),
+      data_buffer_heap_up->GetByteSize(), error);
+  if (process_bytes_read == 0)
+    return 0;
+  data_buffer_heap_up->SetByteSize(process_bytes_read);
+  m_L2_cache[line_addr] = DataBufferSP(data_buffer_heap_up.release());
+  ++m_stats.lines_read;
+  return process_bytes_read;
+}
+
 AllocatedBlock::AllocatedBlock(lldb::addr_t addr, uint32_t byte_size,
                                uint32_t permissions, uint32_t chunk_size)
     : m_range(addr, byte_size), m_permissions(permissions),
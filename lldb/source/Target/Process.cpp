@@ -187,6 +187,12 @@ uint64_t ProcessProperties::GetMemoryCacheLineSize() const {
       nullptr, idx, g_process_properties[idx].default_uint_value);
 }
 
+uint64_t ProcessProperties::GetMemoryCacheMaxReadAhead() const {
+  const uint32_t idx = ePropertyMemCacheMaxReadAhead;
+  return m_collection_sp->GetPropertyAtIndexAsUInt64(
+      nullptr, idx, g_process_properties[idx].default_uint_value);
+}
+
 Args ProcessProperties::GetExtraStartupCommands() const {
   Args args;
   const uint32_t idx = ePropertyExtraStartCommand;
@@ -2044,6 +2050,40 @@ size_t Process::ReadMemoryFromInferior(addr_t addr, void *buf, size_t size,
   return bytes_read;
 }
 
+std::vector<size_t> Process::ReadMemoryRangesFromInferior(
+    llvm::ArrayRef<MemoryReadRequest> requests) {
+  std::vector<size_t> bytes_read = DoReadMemoryRanges(requests);
+  assert(bytes_read.size() == requests.size());
+
+  // Replace any software breakpoint opcodes that fall into the ranges back
+  // into the buffers before we return
+  for (size_t i = 0; i < requests.size(); ++i)
+    if (bytes_read[i] > 0)
+      RemoveBreakpointOpcodesFromBuffer(requests[i].addr, bytes_read[i],
+                                        requests[i].buf);
+  return bytes_read;
+}
+
+std::vector<size_t>
+Process::DoReadMemoryRanges(llvm::ArrayRef<MemoryReadRequest> requests) {
+  std::vector<size_t> bytes_read;
+  bytes_read.reserve(requests.size());
+  for (const MemoryReadRequest &request : requests) {
+    size_t total = 0;
+    while (total < request.size) {
+      Status error;
+      const size_t curr_size = request.size - total;
+      const size_t curr_bytes_read = DoReadMemory(
+          request.addr + total, request.buf + total, curr_size, error);
+      total += curr_bytes_read;
+      if (curr_bytes_read == curr_size || curr_bytes_read == 0)
+        break;
+    }
+    bytes_read.push_back(total);
+  }
+  return bytes_read;
+}
+
 uint64_t Process::ReadUnsignedIntegerFromMemory(lldb::addr_t vm_addr,
                                                 size_t integer_byte_size,
                                                 uint64_t fail_value,
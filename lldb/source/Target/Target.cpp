@@ -181,6 +181,7 @@ void Target::CleanupProcess() {
   DisableAllWatchpoints(false);
   ClearAllWatchpointHitCounts();
   ClearAllWatchpointHistoricValues();
+  ClearUserExpressionCache();
 }
 
 void Target::DeleteCurrentProcess() {
@@ -1613,6 +1614,7 @@ void Target::NotifyModulesRemoved(lldb_private::ModuleList &module_list) {
 void Target::ModulesDidLoad(ModuleList &module_list) {
   const size_t num_images = module_list.GetSize();
   if (m_valid && num_images) {
+    ClearUserExpressionCache();
     for (size_t idx = 0; idx < num_images; ++idx) {
       ModuleSP module_sp(module_list.GetModuleAtIndex(idx));
       LoadScriptingResourceForModule(module_sp, this);
@@ -1629,6 +1631,7 @@ void Target::ModulesDidLoad(ModuleList &module_list) {
 
 void Target::SymbolsDidLoad(ModuleList &module_list) {
   if (m_valid && module_list.GetSize()) {
+    ClearUserExpressionCache();
     if (m_process_sp) {
       for (LanguageRuntime *runtime : m_process_sp->GetLanguageRuntimes()) {
         runtime->SymbolsDidLoad(module_list);
@@ -1644,6 +1647,7 @@ void Target::SymbolsDidLoad(ModuleList &module_list) {
 
 void Target::ModulesDidUnload(ModuleList &module_list, bool delete_locations) {
   if (m_valid && module_list.GetSize()) {
+    ClearUserExpressionCache();
     UnloadModuleSections(module_list);
     m_breakpoint_list.UpdateBreakpoints(module_list, false, delete_locations);
     m_internal_breakpoint_list.UpdateBreakpoints(module_list, false,
@@ -2271,6 +2275,50 @@ UserExpression *Target::GetUserExpressionForLanguage(
   return user_expr;
 }
 
+lldb::UserExpressionSP
+Target::TakeCachedUserExpression(llvm::StringRef key,
+                                 ExecutionContext &exe_ctx) {
+  // Cached expressions are bound to the frame code address they were parsed
+  // at, which can only be compared against another frame.
+  if (!exe_ctx.GetFramePtr())
+    return lldb::UserExpressionSP();
+
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  for (auto pos = m_user_expression_cache.begin(),
+            end = m_user_expression_cache.end();
+       pos != end; ++pos) {
+    if (pos->first == key && pos->second->MatchesContext(exe_ctx)) {
+      lldb::UserExpressionSP expr_sp = std::move(pos->second);
+      m_user_expression_cache.erase(pos);
+      return expr_sp;
+    }
+  }
+  return lldb::UserExpressionSP();
+}
+
+void Target::CacheUserExpression(llvm::StringRef key,
+                                 const lldb::UserExpressionSP &expr_sp) {
+  const uint64_t max_size = GetExprCacheSize();
+  std::list<std::pair<std::string, lldb::UserExpressionSP>> evicted;
+  {
+    std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+    m_user_expression_cache.emplace_front(key.str(), expr_sp);
+    while (m_user_expression_cache.size() > max_size)
+      evicted.splice(evicted.end(), m_user_expression_cache,
+                     std::prev(m_user_expression_cache.end()));
+  }
+  // The evicted expressions are destroyed here, outside of the lock, since
+  // that may deallocate their code in the process.
+}
+
+void Target::ClearUserExpressionCache() {
+  // Declared before the guard so that the expressions are destroyed after the
+  // lock is released.
+  std::list<std::pair<std::string, lldb::UserExpressionSP>> cleared;
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  cleared.swap(m_user_expression_cache);
+}
+
 FunctionCaller *Target::GetFunctionCallerForLanguage(
     lldb::LanguageType language, const CompilerType &return_type,
     const Address &function_address, const ValueList &arg_value_list,
@@ -3809,6 +3857,12 @@ void TargetProperties::SetPreloadSymbols(bool b) {
   m_collection_sp->SetPropertyAtIndexAsBoolean(nullptr, idx, b);
 }
 
+bool TargetProperties::GetParallelModuleLoad() const {
+  const uint32_t idx = ePropertyParallelModuleLoad;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_target_properties[idx].default_uint_value != 0);
+}
+
 bool TargetProperties::GetDisableASLR() const {
   const uint32_t idx = ePropertyDisableASLR;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
@@ -4109,6 +4163,12 @@ uint64_t TargetProperties::GetExprErrorLimit() const {
       nullptr, idx, g_target_properties[idx].default_uint_value);
 }
 
+uint64_t TargetProperties::GetExprCacheSize() const {
+  const uint32_t idx = ePropertyExprCacheSize;
+  return m_collection_sp->GetPropertyAtIndexAsUInt64(
+      nullptr, idx, g_target_properties[idx].default_uint_value);
+}
+
 bool TargetProperties::GetBreakpointsConsultPlatformAvoidList() {
   const uint32_t idx = ePropertyBreakpointUseAvoidList;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
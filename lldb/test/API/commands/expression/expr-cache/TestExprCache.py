@@ -0,0 +1,67 @@
+"""
+Test that evaluating an expression again at the same location reuses the
+parsed expression, and that a different frame parses it anew.
+"""
+
+import re
+
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class ExprCacheTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    def get_cache_stats(self):
+        """Return the expression cache (hits, misses) from statistics dump."""
+        result = lldb.SBCommandReturnObject()
+        self.ci.HandleCommand("statistics dump", result)
+        self.assertTrue(result.Succeeded())
+        output = result.GetOutput()
+        hits = re.search(
+            r"reused a parsed expression : ([0-9]+)", output).group(1)
+        misses = re.search(
+            r"had to parse the expression : ([0-9]+)", output).group(1)
+        return int(hits), int(misses)
+
+    def evaluate(self, frame, expr, expected):
+        value = frame.EvaluateExpression(expr)
+        self.assertTrue(value.GetError().Success(), value.GetError())
+        self.assertEqual(value.GetValueAsSigned(), expected)
+
+    @skipIfWindows
+    def test_expr_cache(self):
+        self.build()
+        _, _, thread, _ = lldbutil.run_to_source_breakpoint(
+            self, "// break here", lldb.SBFileSpec("main.c"))
+        self.runCmd("statistics enable")
+
+        compute_frame = thread.GetFrameAtIndex(0)
+        main_frame = thread.GetFrameAtIndex(1)
+
+        # The first evaluation parses the expression, the second one at the
+        # same location reuses it.
+        self.evaluate(compute_frame, "value * 2", 2)
+        self.assertEqual(self.get_cache_stats(), (0, 1))
+        self.evaluate(compute_frame, "value * 2", 2)
+        self.assertEqual(self.get_cache_stats(), (1, 1))
+
+        # The same text in another frame refers to another variable, so it
+        # must not reuse the expression parsed for the first frame.
+        self.evaluate(main_frame, "value * 2", 42)
+        self.assertEqual(self.get_cache_stats(), (1, 2))
+        self.evaluate(compute_frame, "value * 2", 2)
+        self.assertEqual(self.get_cache_stats(), (2, 2))
+
+        # Expressions that may define persistent variables are never cached.
+        self.evaluate(compute_frame, "$__lldb_expr_cache_var = 1", 1)
+        self.assertEqual(self.get_cache_stats(), (2, 2))
+
+        # With the cache disabled every evaluation parses the expression.
+        self.runCmd("settings set target.expr-cache-size 0")
+        self.evaluate(compute_frame, "value * 2", 2)
+        self.evaluate(compute_frame, "value * 2", 2)
+        self.assertEqual(self.get_cache_stats(), (2, 2))
@@ -0,0 +1,8 @@
+int compute(int value) {
+  return value * 3; // break here
+}
+
+int main(int argc, char const *argv[]) {
+  int value = 20 + argc;
+  return compute(value - 20);
+}
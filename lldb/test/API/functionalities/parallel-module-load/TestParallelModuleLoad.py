@@ -0,0 +1,63 @@
+"""
+Test that the shared libraries reported by the dynamic loader are loaded, with
+their symbols, when target.parallel-module-load is enabled.
+"""
+
+import os
+import lldb
+from lldbsuite.test.decorators import *
+from lldbsuite.test.lldbtest import *
+from lldbsuite.test import lldbutil
+
+
+class ParallelModuleLoadTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    libraries = ["parallel_a", "parallel_b", "parallel_c", "parallel_d"]
+
+    def run_to_main(self, parallel):
+        self.build()
+        self.runCmd("settings set target.parallel-module-load {}".format(
+            "true" if parallel else "false"))
+        path = self.getBuildDir()
+        if self.dylibPath in os.environ:
+            sep = self.platformContext.shlib_path_separator
+            path = os.environ[self.dylibPath] + sep + path
+        self.runCmd("settings append target.env-vars '{}={}'".format(
+            self.dylibPath, path))
+        return lldbutil.run_to_source_breakpoint(
+            self, "// break here", lldb.SBFileSpec("main.c"))
+
+    def check_libraries(self, target):
+        module_names = [module.GetFileSpec().GetFilename()
+                        for module in target.module_iter()]
+        for library in self.libraries:
+            name = self.platformContext.shlib_prefix + library + "." + \
+                self.platformContext.shlib_extension
+            self.assertIn(name, module_names)
+
+            function = library.replace("parallel_", "") + "_function"
+            bkpt = target.BreakpointCreateByName(function)
+            self.assertEqual(bkpt.GetNumLocations(), 1,
+                             "{} resolved in {}".format(function, name))
+            address = bkpt.GetLocationAtIndex(0).GetAddress()
+            self.assertEqual(address.GetModule().GetFileSpec().GetFilename(),
+                             name)
+            self.assertEqual(address.GetFunction().GetName(), function)
+
+    @skipIfRemote
+    @skipIfWindows
+    @skipIfDarwin # Only the POSIX dynamic loader preloads modules.
+    def test_parallel_module_load(self):
+        """Test that libraries loaded in parallel have their symbols."""
+        target, _, _, _ = self.run_to_main(parallel=True)
+        self.check_libraries(target)
+
+    @skipIfRemote
+    @skipIfWindows
+    @skipIfDarwin # Only the POSIX dynamic loader preloads modules.
+    def test_serial_module_load(self):
+        """Test the same libraries with parallel module loading disabled."""
+        target, _, _, _ = self.run_to_main(parallel=False)
+        self.check_libraries(target)
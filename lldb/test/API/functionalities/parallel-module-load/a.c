@@ -0,0 +1 @@
+int a_function(int x) { return x + 1; }
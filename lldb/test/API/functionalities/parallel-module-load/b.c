@@ -0,0 +1 @@
+int b_function(int x) { return x + 1; }
@@ -0,0 +1 @@
+int c_function(int x) { return x + 1; }
@@ -0,0 +1 @@
+int d_function(int x) { return x + 1; }
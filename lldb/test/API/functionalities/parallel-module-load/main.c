@@ -0,0 +1,10 @@
+int a_function(int x);
+int b_function(int x);
+int c_function(int x);
+int d_function(int x);
+
+int main(int argc, char const *argv[]) {
+  int x = a_function(argc) + b_function(argc) + c_function(argc) +
+          d_function(argc);
+  return x; // break here
+}
@@ -574,6 +574,57 @@ class LldbGdbServerTestCase(gdbremote_testcase.GdbRemoteTestCaseBase, DwarfOpcod
         read_contents = seven.unhexlify(context.get("read_contents"))
         self.assertEqual(read_contents, MEMORY_CONTENTS)
 
+    @skipIfWindows # No pty support to test any inferior output
+    @skipIfDarwin # debugserver does not support MultiMemRead
+    def test_MultiMemRead_reads_memory_ranges(self):
+        self.build()
+        self.set_inferior_startup_launch()
+        MEMORY_CONTENTS = "Test contents 0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz"
+
+        # Start up the inferior.
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=[
+                "set-message:%s" %
+                MEMORY_CONTENTS,
+                "get-data-address-hex:g_message",
+                "sleep:5"])
+
+        # Run the process
+        self.test_sequence.add_log_lines(
+            [
+                # Start running after initial stop.
+                "read packet: $c#63",
+                # Match output line that prints the memory address of the message buffer within the inferior.
+                {"type": "output_match", "regex": self.maybe_strict_output_regex(r"data address: 0x([0-9a-fA-F]+)\r\n"),
+                 "capture": {1: "message_address"}},
+                # Now stop the inferior.
+                "read packet: {}".format(chr(3)),
+                # And wait for the stop notification.
+                {"direction": "send", "regex": r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture": {1: "stop_signo", 2: "stop_thread_id"}}],
+            True)
+
+        # Run the packet stream.
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertIsNotNone(context.get("message_address"))
+        message_address = int(context.get("message_address"), 16)
+
+        # Read two slices of the message and a range at address zero, which
+        # cannot be read and must come back empty without failing the packet.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $MultiMemRead:ranges:{0:x},a,0,10,{1:x},5;#00".format(
+                message_address, message_address + 20),
+             {"direction": "send", "regex": r"^\$([0-9a-f,]+);(.*)#[0-9a-fA-F]{2}$",
+              "capture": {1: "lengths", 2: "read_contents"}}],
+            True)
+
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertEqual(context.get("lengths"), "a,0,5")
+        self.assertEqual(context.get("read_contents"),
+                         MEMORY_CONTENTS[0:10] + MEMORY_CONTENTS[20:25])
+
     def test_qMemoryRegionInfo_is_supported(self):
         self.build()
         self.set_inferior_startup_launch()
@@ -320,6 +320,42 @@ TEST_F(GDBRemoteCommunicationClientTest, SendSignalsToIgnore) {
   EXPECT_TRUE(result.get().Success());
 }
 
+TEST_F(GDBRemoteCommunicationClientTest, ReadMemoryRanges) {
+  uint8_t buf1[4] = {}, buf2[4] = {}, buf3[2] = {};
+  std::vector<std::pair<addr_t, MutableArrayRef<uint8_t>>> ranges = {
+      {0x1000, buf1}, {0x2000, buf2}, {0x3000, buf3}};
+  std::future<Expected<std::vector<size_t>>> result =
+      std::async(std::launch::async,
+                 [&] { return client.ReadMemoryRanges(ranges); });
+
+  HandlePacket(server, "MultiMemRead:ranges:1000,4,2000,4,3000,2;",
+               "4,0,2;abcdef");
+  Expected<std::vector<size_t>> bytes_read = result.get();
+  ASSERT_THAT_EXPECTED(bytes_read, llvm::Succeeded());
+  EXPECT_EQ(std::vector<size_t>({4, 0, 2}), *bytes_read);
+  EXPECT_EQ("abcd", StringRef(reinterpret_cast<char *>(buf1), sizeof(buf1)));
+  EXPECT_EQ("ef", StringRef(reinterpret_cast<char *>(buf3), sizeof(buf3)));
+
+  // A range reported longer than requested is rejected.
+  result = std::async(std::launch::async,
+                      [&] { return client.ReadMemoryRanges(ranges); });
+  HandlePacket(server, "MultiMemRead:ranges:1000,4,2000,4,3000,2;",
+               "8,0,2;abcdefghij");
+  EXPECT_THAT_EXPECTED(result.get(), llvm::Failed());
+
+  // So is a reply with fewer bytes than it claims.
+  result = std::async(std::launch::async,
+                      [&] { return client.ReadMemoryRanges(ranges); });
+  HandlePacket(server, "MultiMemRead:ranges:1000,4,2000,4,3000,2;",
+               "4,4,2;abcd");
+  EXPECT_THAT_EXPECTED(result.get(), llvm::Failed());
+
+  result = std::async(std::launch::async,
+                      [&] { return client.ReadMemoryRanges(ranges); });
+  HandlePacket(server, "MultiMemRead:ranges:1000,4,2000,4,3000,2;", "E01");
+  EXPECT_THAT_EXPECTED(result.get(), llvm::Failed());
+}
+
 TEST_F(GDBRemoteCommunicationClientTest, GetMemoryRegionInfo) {
   const lldb::addr_t addr = 0xa000;
   MemoryRegionInfo region_info;
@@ -13,6 +13,7 @@
 #include "llvm/DebugInfo/PDB/PDBSymbolExe.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Testing/Support/Error.h"
 
 #include "Plugins/ObjectFile/PECOFF/ObjectFilePECOFF.h"
 #include "Plugins/SymbolFile/DWARF/DWARFAbbreviationDeclaration.h"
@@ -20,6 +21,7 @@
 #include "Plugins/SymbolFile/DWARF/DWARFDebugAbbrev.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDebugArangeSet.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDebugAranges.h"
+#include "Plugins/SymbolFile/DWARF/NameToDIE.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARF.h"
 #include "Plugins/SymbolFile/PDB/SymbolFilePDB.h"
 #include "Plugins/TypeSystem/Clang/TypeSystemClang.h"
@@ -385,3 +387,121 @@ TEST_F(SymbolFileDWARFTests, ParseAranges) {
   EXPECT_EQ(debug_aranges.FindAddress(0x2100 - 1), 255u);
   EXPECT_EQ(debug_aranges.FindAddress(0x2100), DW_INVALID_OFFSET);
 }
+
+TEST_F(SymbolFileDWARFTests, NameToDIEEncodeDecode) {
+  NameToDIE original;
+  original.Insert(ConstString("foo"), DIERef(llvm::None, DIERef::DebugInfo, 1));
+  original.Insert(ConstString("bar"), DIERef(2, DIERef::DebugTypes, 3));
+  original.Insert(ConstString("foo"), DIERef(0, DIERef::DebugInfo, 4));
+  original.Finalize();
+
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  original.Encode(writer);
+  os.flush();
+
+  llvm::DataExtractor data(buffer, /*IsLittleEndian=*/true, /*AddressSize=*/8);
+  llvm::DataExtractor::Cursor cursor(0);
+  NameToDIE decoded;
+  decoded.Decode(data, cursor);
+  ASSERT_THAT_ERROR(cursor.takeError(), llvm::Succeeded());
+  EXPECT_EQ(buffer.size(), cursor.tell());
+  decoded.Finalize();
+
+  StreamString original_dump, decoded_dump;
+  original.Dump(&original_dump);
+  decoded.Dump(&decoded_dump);
+  EXPECT_EQ(original_dump.GetString(), decoded_dump.GetString());
+
+  // A truncated table is reported as an error.
+  llvm::DataExtractor truncated(llvm::StringRef(buffer).drop_back(),
+                                /*IsLittleEndian=*/true, /*AddressSize=*/8);
+  llvm::DataExtractor::Cursor truncated_cursor(0);
+  NameToDIE partial;
+  partial.Decode(truncated, truncated_cursor);
+  EXPECT_THAT_ERROR(truncated_cursor.takeError(), llvm::Failed());
+}
+
+/// Index the module in \a path, and return the dump of its manual index.
+static std::string DumpManualIndex(llvm::StringRef path) {
+  ModuleSP module =
+      std::make_shared<Module>(FileSpec(path), ArchSpec("i686-pc-windows"));
+  SymbolFile *symfile = module->GetSymbolFile();
+  if (!symfile)
+    return "";
+  symfile->PreloadSymbols();
+  StreamString dump;
+  symfile->Dump(dump);
+  llvm::StringRef index = dump.GetString();
+  return index.substr(index.find("Manual DWARF index")).str();
+}
+
+/// Return the names of the cached indexes in \a cache_dir, sorted.
+static std::vector<std::string> GetCacheFiles(llvm::StringRef cache_dir) {
+  std::vector<std::string> files;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(cache_dir, ec), end;
+       !ec && it != end; it.increment(ec)) {
+    llvm::StringRef name = llvm::sys::path::filename(it->path());
+    if (name.startswith("llvmcache-"))
+      files.push_back(it->path());
+  }
+  llvm::sort(files);
+  return files;
+}
+
+TEST_F(SymbolFileDWARFTests, IndexCache) {
+  llvm::SmallString<128> cache_dir;
+  ASSERT_NO_ERROR(
+      llvm::sys::fs::createUniqueDirectory("lldb-index-cache", cache_dir));
+  // The module is copied, so that its modification time can be changed.
+  llvm::SmallString<128> exe_path(cache_dir);
+  llvm::sys::path::append(exe_path, "module", "test-dwarf.exe");
+  ASSERT_NO_ERROR(llvm::sys::fs::create_directories(
+      llvm::sys::path::parent_path(exe_path)));
+  ASSERT_NO_ERROR(llvm::sys::fs::copy_file(m_dwarf_test_exe, exe_path));
+  SymbolFileDWARF::SetIndexCachePath(FileSpec(cache_dir));
+
+  // The first session builds the index and saves it.
+  std::string built = DumpManualIndex(exe_path);
+  ASSERT_FALSE(built.empty());
+  std::vector<std::string> files = GetCacheFiles(cache_dir);
+  ASSERT_EQ(files.size(), 1u);
+  llvm::sys::fs::UniqueID saved_id;
+  ASSERT_NO_ERROR(llvm::sys::fs::getUniqueID(files[0], saved_id));
+
+  // The second session loads the same index. Rebuilding it would have
+  // replaced the cache file with a new one.
+  EXPECT_EQ(DumpManualIndex(exe_path), built);
+  EXPECT_EQ(GetCacheFiles(cache_dir), files);
+  llvm::sys::fs::UniqueID loaded_id;
+  ASSERT_NO_ERROR(llvm::sys::fs::getUniqueID(files[0], loaded_id));
+  EXPECT_EQ(saved_id, loaded_id);
+
+  // A change of the module invalidates the cached index, so the index is
+  // built again and saved into a new file.
+  int fd;
+  ASSERT_NO_ERROR(llvm::sys::fs::openFileForReadWrite(
+      exe_path, fd, llvm::sys::fs::CD_OpenExisting, llvm::sys::fs::OF_None));
+  ASSERT_NO_ERROR(llvm::sys::fs::setLastAccessAndModificationTime(
+      fd, std::chrono::system_clock::now() + std::chrono::hours(1)));
+  llvm::sys::fs::file_t file = llvm::sys::fs::convertFDToNativeFile(fd);
+  ASSERT_NO_ERROR(llvm::sys::fs::closeFile(file));
+  EXPECT_EQ(DumpManualIndex(exe_path), built);
+  std::vector<std::string> new_files = GetCacheFiles(cache_dir);
+  ASSERT_EQ(new_files.size(), 2u);
+  EXPECT_TRUE(llvm::is_contained(new_files, files[0]));
+
+  // A truncated cache file is ignored.
+  for (const std::string &file : new_files) {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(file, ec);
+    ASSERT_NO_ERROR(ec);
+    os << "LLDBDWARFIndex";
+  }
+  EXPECT_EQ(DumpManualIndex(exe_path), built);
+
+  SymbolFileDWARF::SetIndexCachePath(FileSpec());
+  llvm::sys::fs::remove_directories(cache_dir);
+}
@@ -0,0 +1,282 @@
+//===-- MemoryCacheTest.cpp -----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Target/Memory.h"
+#include "Plugins/Platform/Linux/PlatformLinux.h"
+#include "lldb/Core/Debugger.h"
+#include "lldb/Host/FileSystem.h"
+#include "lldb/Host/HostInfo.h"
+#include "lldb/Target/Platform.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/Target.h"
+#include "lldb/Utility/ArchSpec.h"
+#include "lldb/Utility/Reproducer.h"
+#include "gtest/gtest.h"
+
+#include <cinttypes>
+
+using namespace lldb_private;
+using namespace lldb_private::repro;
+using namespace lldb;
+
+namespace {
+/// A process whose memory is readable in [kBase, kBase + readable_size) and
+/// that records the ranges of every batched read.
+class FakeProcess : public Process {
+public:
+  static constexpr addr_t kBase = 0x10000;
+
+  using Process::Process;
+
+  bool CanDebug(lldb::TargetSP target, bool plugin_specified_by_name) override {
+    return true;
+  }
+  Status DoDestroy() override { return {}; }
+  void RefreshStateAfterStop() override {}
+  bool DoUpdateThreadList(ThreadList &old_thread_list,
+                          ThreadList &new_thread_list) override {
+    return false;
+  }
+  ConstString GetPluginName() override { return ConstString("Fake"); }
+  uint32_t GetPluginVersion() override { return 0; }
+
+  size_t DoReadMemory(lldb::addr_t vm_addr, void *buf, size_t size,
+                      Status &error) override {
+    ++num_single_reads;
+    if (vm_addr < kBase || vm_addr >= kBase + readable_size) {
+      error.SetErrorStringWithFormat("unreadable address 0x%" PRIx64, vm_addr);
+      return 0;
+    }
+    size = std::min<size_t>(size, kBase + readable_size - vm_addr);
+    for (size_t i = 0; i < size; ++i)
+      static_cast<uint8_t *>(buf)[i] = GetByte(vm_addr + i);
+    return size;
+  }
+
+  std::vector<size_t>
+  DoReadMemoryRanges(llvm::ArrayRef<MemoryReadRequest> requests) override {
+    std::vector<std::pair<addr_t, size_t>> ranges;
+    for (const MemoryReadRequest &request : requests)
+      ranges.emplace_back(request.addr, request.size);
+    batches.push_back(std::move(ranges));
+    size_t num_single_reads_before = num_single_reads;
+    std::vector<size_t> bytes_read = Process::DoReadMemoryRanges(requests);
+    num_single_reads = num_single_reads_before;
+    return bytes_read;
+  }
+
+  bool SupportsBatchedMemoryReads() override { return batched; }
+
+  static uint8_t GetByte(addr_t addr) { return (addr * 7) >> 3; }
+
+  bool batched = true;
+  size_t readable_size = 0x100000;
+  /// The ranges of every call to DoReadMemoryRanges.
+  std::vector<std::vector<std::pair<addr_t, size_t>>> batches;
+  /// The number of calls to DoReadMemory outside of DoReadMemoryRanges.
+  size_t num_single_reads = 0;
+};
+
+class MemoryCacheTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    llvm::cantFail(Reproducer::Initialize(ReproducerMode::Off, llvm::None));
+    FileSystem::Initialize();
+    HostInfo::Initialize();
+    platform_linux::PlatformLinux::Initialize();
+
+    ArchSpec arch("x86_64-pc-linux");
+    Platform::SetHostPlatform(
+        platform_linux::PlatformLinux::CreateInstance(true, &arch));
+    m_debugger_sp = Debugger::CreateInstance();
+    ASSERT_TRUE(m_debugger_sp);
+    PlatformSP platform_sp;
+    m_debugger_sp->GetTargetList().CreateTarget(
+        *m_debugger_sp, "", arch, eLoadDependentsNo, platform_sp, m_target_sp);
+    ASSERT_TRUE(m_target_sp);
+    m_process_sp = std::make_shared<FakeProcess>(
+        m_target_sp, Listener::MakeListener("fake"));
+    m_line_size = m_process_sp->GetMemoryCacheLineSize();
+    m_max_read_ahead = m_process_sp->GetMemoryCacheMaxReadAhead();
+    ASSERT_GT(m_max_read_ahead, 2u);
+  }
+  void TearDown() override {
+    m_process_sp.reset();
+    m_target_sp.reset();
+    Debugger::Destroy(m_debugger_sp);
+    m_debugger_sp.reset();
+    platform_linux::PlatformLinux::Terminate();
+    HostInfo::Terminate();
+    FileSystem::Terminate();
+    Reproducer::Terminate();
+  }
+
+protected:
+  /// Return the address of the cache line \a index.
+  addr_t Line(size_t index) const {
+    return FakeProcess::kBase + index * m_line_size;
+  }
+
+  /// Read \a size bytes at \a addr through \a cache, and check that the bytes
+  /// that were read are the process' memory.
+  size_t Read(MemoryCache &cache, addr_t addr, size_t size, Status &error) {
+    std::vector<uint8_t> buf(size);
+    size_t bytes_read = cache.Read(addr, buf.data(), size, error);
+    for (size_t i = 0; i < bytes_read; ++i)
+      EXPECT_EQ(buf[i], FakeProcess::GetByte(addr + i)) << "at offset " << i;
+    return bytes_read;
+  }
+
+  DebuggerSP m_debugger_sp;
+  TargetSP m_target_sp;
+  std::shared_ptr<FakeProcess> m_process_sp;
+  uint64_t m_line_size;
+  uint64_t m_max_read_ahead;
+};
+
+using Batch = std::vector<std::pair<addr_t, size_t>>;
+} // namespace
+
+TEST_F(MemoryCacheTest, MissingLinesAreReadInOneBatch) {
+  m_process_sp->batched = false;
+  MemoryCache cache(*m_process_sp);
+  Status error;
+
+  // A read that straddles two missing lines reads both with one request.
+  EXPECT_EQ(Read(cache, Line(0) + m_line_size / 2, m_line_size, error),
+            m_line_size);
+  EXPECT_TRUE(error.Success());
+  ASSERT_EQ(m_process_sp->batches.size(), 1u);
+  EXPECT_EQ(m_process_sp->batches[0], (Batch{{Line(0), 2 * m_line_size}}));
+
+  // Both lines are cached now.
+  EXPECT_EQ(Read(cache, Line(1), 8, error), 8u);
+  EXPECT_EQ(m_process_sp->batches.size(), 1u);
+
+  // Only the missing line of a partially cached read is fetched.
+  EXPECT_EQ(Read(cache, Line(1) + m_line_size / 2, m_line_size, error),
+            m_line_size);
+  ASSERT_EQ(m_process_sp->batches.size(), 2u);
+  EXPECT_EQ(m_process_sp->batches[1], (Batch{{Line(2), m_line_size}}));
+  EXPECT_EQ(m_process_sp->num_single_reads, 0u);
+
+  MemoryCache::Statistics stats = cache.GetStatistics();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.lines_read, 3u);
+  EXPECT_EQ(stats.read_ahead_lines, 0u);
+}
+
+TEST_F(MemoryCacheTest, ReadAheadGrowsOnSequentialMisses) {
+  MemoryCache cache(*m_process_sp);
+  Status error;
+
+  // Walk the memory one line at a time. Each miss continues where the
+  // previous batch ended, so the read-ahead window doubles up to its
+  // maximum, and is requested separately from the line that is needed.
+  size_t line = 0;
+  uint64_t window = 0;
+  uint64_t total_read_ahead = 0;
+  for (size_t miss = 0; miss < 8; ++miss) {
+    const size_t num_batches = m_process_sp->batches.size();
+    EXPECT_EQ(Read(cache, Line(line), 8, error), 8u);
+    ASSERT_EQ(m_process_sp->batches.size(), num_batches + 1);
+    Batch expected{{Line(line), m_line_size}};
+    if (window)
+      expected.emplace_back(Line(line + 1), window * m_line_size);
+    EXPECT_EQ(m_process_sp->batches.back(), expected) << "miss " << miss;
+
+    // The lines read ahead are hits.
+    for (uint64_t i = 1; i <= window; ++i)
+      EXPECT_EQ(Read(cache, Line(line + i), 8, error), 8u);
+    EXPECT_EQ(m_process_sp->batches.size(), num_batches + 1);
+
+    line += window + 1;
+    total_read_ahead += window;
+    window = std::min<uint64_t>(std::max<uint64_t>(window * 2, 1),
+                                m_max_read_ahead);
+  }
+  EXPECT_EQ(m_process_sp->num_single_reads, 0u);
+
+  MemoryCache::Statistics stats = cache.GetStatistics();
+  EXPECT_EQ(stats.misses, 8u);
+  EXPECT_EQ(stats.hits, total_read_ahead);
+  EXPECT_EQ(stats.read_ahead_lines, total_read_ahead);
+  EXPECT_EQ(stats.lines_read, line);
+
+  // A miss elsewhere resets the window.
+  EXPECT_EQ(Read(cache, Line(line + 100), 8, error), 8u);
+  EXPECT_EQ(m_process_sp->batches.back(),
+            (Batch{{Line(line + 100), m_line_size}}));
+}
+
+TEST_F(MemoryCacheTest, NoReadAheadWithoutBatchedReads) {
+  m_process_sp->batched = false;
+  MemoryCache cache(*m_process_sp);
+  Status error;
+
+  for (size_t line = 0; line < 4; ++line) {
+    EXPECT_EQ(Read(cache, Line(line), 8, error), 8u);
+    EXPECT_EQ(m_process_sp->batches.back(), (Batch{{Line(line), m_line_size}}));
+  }
+  MemoryCache::Statistics stats = cache.GetStatistics();
+  EXPECT_EQ(stats.misses, 4u);
+  EXPECT_EQ(stats.read_ahead_lines, 0u);
+}
+
+TEST_F(MemoryCacheTest, ShortRunIsSplitAtTheEndOfReadableMemory) {
+  m_process_sp->batched = false;
+  m_process_sp->readable_size = m_line_size + 100;
+  MemoryCache cache(*m_process_sp);
+  Status error;
+
+  // The run of lines 0 and 1 comes back short in line 1, which is cached
+  // with the bytes that could be read.
+  EXPECT_EQ(Read(cache, Line(0) + m_line_size / 2, m_line_size, error),
+            m_line_size / 2 + 100);
+  EXPECT_TRUE(error.Success());
+  EXPECT_EQ(m_process_sp->batches.back(), (Batch{{Line(0), 2 * m_line_size}}));
+  EXPECT_EQ(cache.GetStatistics().lines_read, 2u);
+
+  const size_t num_batches = m_process_sp->batches.size();
+  EXPECT_EQ(Read(cache, Line(1) + 16, 8, error), 8u);
+  EXPECT_EQ(m_process_sp->batches.size(), num_batches);
+
+  // A line that cannot be read at all is read again on its own to report
+  // the process' error.
+  EXPECT_EQ(Read(cache, Line(2), 8, error), 0u);
+  EXPECT_TRUE(error.Fail());
+  EXPECT_EQ(m_process_sp->batches.back(), (Batch{{Line(2), m_line_size}}));
+  EXPECT_EQ(m_process_sp->num_single_reads, 1u);
+}
+
+TEST_F(MemoryCacheTest, ReadAheadPastTheEndDoesNotFailTheRead) {
+  m_process_sp->readable_size = 4 * m_line_size;
+  MemoryCache cache(*m_process_sp);
+  Status error;
+
+  // Lines 0 and 1 are misses, line 2 is read ahead of line 1.
+  EXPECT_EQ(Read(cache, Line(0), 8, error), 8u);
+  EXPECT_EQ(Read(cache, Line(1), 8, error), 8u);
+  EXPECT_EQ(Read(cache, Line(2), 8, error), 8u);
+
+  // The read-ahead of lines 4 and 5 fails, but line 3 is still read.
+  EXPECT_EQ(Read(cache, Line(3), 8, error), 8u);
+  EXPECT_TRUE(error.Success());
+  EXPECT_EQ(m_process_sp->batches.back(),
+            (Batch{{Line(3), m_line_size}, {Line(4), 2 * m_line_size}}));
+  EXPECT_EQ(m_process_sp->num_single_reads, 0u);
+
+  MemoryCache::Statistics stats = cache.GetStatistics();
+  EXPECT_EQ(stats.lines_read, 4u);
+  EXPECT_EQ(stats.read_ahead_lines, 3u);
+
+  // Nothing was cached for the unreadable lines.
+  EXPECT_EQ(Read(cache, Line(4), 8, error), 0u);
+  EXPECT_TRUE(error.Fail());
+}
@@ -0,0 +1,45 @@
+//===- BytecodeReader.h - MLIR Bytecode Reader ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the interface for reading MLIR in the binary bytecode
+// format. The parser entry points in `mlir/Parser.h` detect bytecode input and
+// dispatch here, so most clients do not need to use this file directly.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_BYTECODE_BYTECODEREADER_H
+#define MLIR_BYTECODE_BYTECODEREADER_H
+
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace llvm {
+class MemoryBufferRef;
+} // end namespace llvm
+
+namespace mlir {
+class Block;
+class LocationAttr;
+class MLIRContext;
+
+/// Returns true if the given buffer starts with the bytecode magic number.
+bool isBytecode(llvm::MemoryBufferRef buffer);
+
+/// Read the operations from the given bytecode buffer and append them to the
+/// given block. If the block is non-empty, the operations are placed before the
+/// current terminator. If reading is successful, success is returned.
+/// Otherwise, an error is emitted through the diagnostic handler registered in
+/// the context, and failure is returned. If `sourceFileLoc` is non-null, it is
+/// populated with a file location representing the start of the buffer.
+LogicalResult readBytecodeFile(llvm::MemoryBufferRef buffer, Block *block,
+                               MLIRContext *context,
+                               LocationAttr *sourceFileLoc = nullptr);
+
+} // end namespace mlir
+
+#endif // MLIR_BYTECODE_BYTECODEREADER_H
@@ -0,0 +1,32 @@
+//===- BytecodeWriter.h - MLIR Bytecode Writer ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the interface for writing MLIR in the binary bytecode
+// format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_BYTECODE_BYTECODEWRITER_H
+#define MLIR_BYTECODE_BYTECODEWRITER_H
+
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir {
+class Operation;
+
+/// Write the bytecode for the given operation to the provided output stream.
+/// The operation is written as the single top-level operation of the file, and
+/// is read back by `parseSourceFile` like its textual form. Every operand must
+/// be defined within `op`; otherwise an error is emitted on the operation that
+/// uses it, nothing is written, and failure is returned.
+LogicalResult writeBytecodeToFile(Operation *op, raw_ostream &os);
+
+} // end namespace mlir
+
+#endif // MLIR_BYTECODE_BYTECODEWRITER_H
@@ -0,0 +1,125 @@
+//===- Encoding.h - MLIR bytecode encoding ----------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the constants shared by the MLIR bytecode reader and
+// writer.
+//
+// A bytecode file starts with the magic number and the format version, and is
+// followed by a sequence of sections. Every section starts with a byte holding
+// its kind, and the size of its payload. Sections whose kind has the alignment
+// bit set have their payload aligned to `kSectionAlignment` bytes from the
+// start of the file. All integers are encoded as unsigned LEB128 values,
+// referred to as varints below.
+//
+//   String:    varint count, then for each string its varint size and bytes.
+//   OpName:    varint count, then the string index of each operation name.
+//   Type:      varint count, then the string index of the textual form of
+//              each type.
+//   Attribute: varint count, then for each attribute its kind byte, the varint
+//              size of its payload and the payload (see AttributeKind).
+//   Blob:      varint count, then for each blob its varint size and its data,
+//              aligned to `kSectionAlignment` bytes.
+//   IR:        varint count of the values defined in the section, varint
+//              count of the top-level operations, then the operations (see
+//              below).
+//
+// Operations are encoded as:
+//   varint name index, varint location index, byte OpEncodingMask,
+//   [varint attribute dictionary index]               if kHasAttrs
+//   [varint count, varint type index...]              if kHasResults
+//   [varint count, varint value index...]             if kHasOperands
+//   [varint count, varint block index...]             if kHasSuccessors
+//   [varint count, region...]                         if kHasRegions
+//
+// A region is a varint block count followed by the blocks, each of which is
+// its varint argument count, the type index of each argument, its varint
+// operation count and the operations. Values are numbered in the order they
+// are defined: the arguments of a block, then the results of each of its
+// operations followed by the values defined in that operation's regions.
+// Blocks are numbered within their region. Value indices must be smaller than
+// the count at the start of the IR section.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_BYTECODE_ENCODING_H
+#define MLIR_BYTECODE_ENCODING_H
+
+#include <cstdint>
+
+namespace mlir {
+namespace bytecode {
+
+/// The magic number at the start of a bytecode file.
+static constexpr char kMagic[4] = {'M', 'L', '\xef', 'R'};
+
+/// The version of the format emitted by the writer. The reader rejects files
+/// with a different version.
+static constexpr uint64_t kVersion = 2;
+
+/// The alignment of aligned sections and of the blobs they contain.
+static constexpr unsigned kSectionAlignment = 8;
+
+/// The kinds of sections in a bytecode file.
+enum class Section : uint8_t {
+  String = 0,
+  OpName = 1,
+  Type = 2,
+  Attribute = 3,
+  Blob = 4,
+  IR = 5,
+
+  NumSections,
+};
+
+/// Set on the kind byte of sections whose payload is aligned.
+static constexpr uint8_t kAlignedSectionBit = 0x80;
+
+/// The encodings of entries in the attribute section. Attributes without a
+/// dedicated encoding are stored in their textual form and parsed on first
+/// use.
+enum class AttributeKind : uint8_t {
+  /// varint string index of the textual form.
+  Text = 0,
+  /// varint count, then varint string index and attribute index of each
+  /// entry, in sorted order.
+  Dictionary = 1,
+  /// varint count, then the attribute index of each element.
+  Array = 2,
+  /// varint string index; the attribute has no type.
+  String = 3,
+  /// varint type index.
+  Type = 4,
+  /// varint type index, byte isSplat, varint blob index of the raw data.
+  DenseElements = 5,
+  /// No payload.
+  UnknownLoc = 6,
+  /// varint string index of the filename, varint line, varint column.
+  FileLineColLoc = 7,
+  /// varint string index of the name, attribute index of the child location.
+  NameLoc = 8,
+  /// attribute index of the callee, attribute index of the caller.
+  CallSiteLoc = 9,
+  /// varint count, attribute index of each location, then the attribute
+  /// index of the metadata plus one, or zero if there is none.
+  FusedLoc = 10,
+};
+
+/// The bits of the mask describing which optional parts of an operation are
+/// present.
+enum OpEncodingMask : uint8_t {
+  kHasAttrs = 0x01,
+  kHasResults = 0x02,
+  kHasOperands = 0x04,
+  kHasSuccessors = 0x08,
+  kHasRegions = 0x10,
+};
+
+} // end namespace bytecode
+} // end namespace mlir
+
+#endif // MLIR_BYTECODE_ENCODING_H
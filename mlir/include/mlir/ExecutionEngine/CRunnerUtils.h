@@ -217,6 +217,17 @@ extern "C" MLIR_CRUNNERUTILS_EXPORT void *openTensorC(char *filename,
 extern "C" MLIR_CRUNNERUTILS_EXPORT void
 readTensorItemC(void *tensor, uint64_t *idata, double *ddata);
 extern "C" MLIR_CRUNNERUTILS_EXPORT void closeTensor(void *tensor);
+extern "C" MLIR_CRUNNERUTILS_EXPORT void *packTensorC(void *tensor,
+                                                      uint8_t *sparsity);
+extern "C" MLIR_CRUNNERUTILS_EXPORT void
+_mlir_ciface_sparsePointers(StridedMemRefType<uint64_t, 1> *ref, void *tensor,
+                            uint64_t d);
+extern "C" MLIR_CRUNNERUTILS_EXPORT void
+_mlir_ciface_sparseIndices(StridedMemRefType<uint64_t, 1> *ref, void *tensor,
+                           uint64_t d);
+extern "C" MLIR_CRUNNERUTILS_EXPORT void
+_mlir_ciface_sparseValues(StridedMemRefType<double, 1> *ref, void *tensor);
+extern "C" MLIR_CRUNNERUTILS_EXPORT void closePackedTensor(void *tensor);
 extern "C" MLIR_CRUNNERUTILS_EXPORT char *getTensorFilename(uint64_t id);
 
 #endif // EXECUTIONENGINE_CRUNNERUTILS_H_
@@ -24,15 +24,19 @@ template <bool IsPostDom> class DominanceInfoBase {
   using base = llvm::DominatorTreeBase<Block, IsPostDom>;
 
 public:
-  DominanceInfoBase(Operation *op) { recalculate(op); }
+  DominanceInfoBase(Operation *op, bool skipIsolatedFromAbove = false) {
+    recalculate(op, skipIsolatedFromAbove);
+  }
   DominanceInfoBase(DominanceInfoBase &&) = default;
   DominanceInfoBase &operator=(DominanceInfoBase &&) = default;
 
   DominanceInfoBase(const DominanceInfoBase &) = delete;
   DominanceInfoBase &operator=(const DominanceInfoBase &) = delete;
 
-  /// Recalculate the dominance info.
-  void recalculate(Operation *op);
+  /// Recalculate the dominance info. If `skipIsolatedFromAbove` is set, the
+  /// regions of nested operations that are known to be isolated from above are
+  /// not analyzed; no dominance queries may be made about them.
+  void recalculate(Operation *op, bool skipIsolatedFromAbove = false);
 
   /// Finds the nearest common dominator block for the two given blocks a
   /// and b. If no common dominator can be found, this function will return
@@ -63,6 +67,10 @@ protected:
   /// block of its region.
   bool isReachableFromEntry(Block *a) const;
 
+  /// Compute the dominance of the regions of `op` and, recursively, of the
+  /// operations nested within them.
+  void recalculateNested(Operation *op, bool skipIsolatedFromAbove);
+
   /// A mapping of regions to their base dominator tree.
   DenseMap<Region *, std::unique_ptr<base>> dominanceInfos;
 };
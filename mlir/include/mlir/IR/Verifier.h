@@ -16,6 +16,11 @@ class Operation;
 /// Perform (potentially expensive) checks of invariants, used to detect
 /// compiler bugs, on this operation and any nested operations. On error, this
 /// reports the error through the MLIRContext and returns failure.
+///
+/// If multithreading is enabled on the context, nested operations that are
+/// isolated from above are verified in parallel. The reported errors are the
+/// same either way: verification stops at the first failing operation in IR
+/// order.
 LogicalResult verify(Operation *op);
 } //  end namespace mlir
 
@@ -811,6 +811,66 @@ private:
   MLIRContext &ctx;
 };
 
+//===----------------------------------------------------------------------===//
+// ConversionConfig
+//===----------------------------------------------------------------------===//
+
+/// Statistics collected during a conversion for a single pattern. The times and
+/// undo log entries of a pattern include those of the patterns applied while
+/// legalizing the operations it generated.
+struct ConversionPatternStatistics {
+  /// The number of times the pattern was tried.
+  unsigned numAttempts = 0;
+  /// The number of times the pattern failed to match.
+  unsigned numMatchFailures = 0;
+  /// The number of times the pattern matched, but the operations it generated
+  /// could not be legalized, and its rewrites had to be rolled back.
+  unsigned numLegalizationFailures = 0;
+  /// The number of entries added to the undo log by successful applications.
+  size_t numUndoLogEntries = 0;
+  /// The time spent applying the pattern and legalizing its result, in
+  /// seconds.
+  double seconds = 0;
+};
+
+/// Statistics collected during a conversion. The counters are accumulated, so
+/// the same object may be used across several conversions. The counters other
+/// than the per-pattern ones are also always reported as LLVM statistics, under
+/// "dialect-conversion".
+struct ConversionStatistics {
+  /// The number of attempts to legalize an operation.
+  unsigned numLegalizationAttempts = 0;
+  /// The number of operations legalized by folding.
+  unsigned numFolds = 0;
+  /// The number of times the rewriter state was rolled back.
+  unsigned numRollbacks = 0;
+  /// The largest number of entries in the undo log at the end of a conversion,
+  /// whether or not it succeeded.
+  size_t maxUndoLogSize = 0;
+  /// The statistics of each pattern, in the order the patterns were first
+  /// tried.
+  llvm::MapVector<const Pattern *, ConversionPatternStatistics> patterns;
+
+  /// Print the statistics, with the patterns sorted by decreasing time.
+  void print(raw_ostream &os) const;
+};
+
+/// This struct allows control over the bookkeeping performed by a conversion.
+struct ConversionConfig {
+  /// If false, the in-place updates of the patterns are declared to never need
+  /// to be rolled back: an operation updated in place can always be legalized.
+  /// The rewriter then does not record the state needed to undo in-place
+  /// operation updates. Created, replaced and erased operations are still
+  /// rolled back as usual. If an in-place update has to be rolled back anyway,
+  /// the conversion fails with an error and the IR is left in an unspecified
+  /// state.
+  bool allowPatternRollback = true;
+
+  /// If non-null, the conversion accumulates statistics into this object.
+  /// This adds timing overhead to every pattern application.
+  ConversionStatistics *statistics = nullptr;
+};
+
 //===----------------------------------------------------------------------===//
 // Op Conversion Entry Points
 //===----------------------------------------------------------------------===//
@@ -837,6 +897,16 @@ LLVM_NODISCARD LogicalResult
 applyPartialConversion(Operation *op, ConversionTarget &target,
                        const FrozenRewritePatternList &patterns,
                        DenseSet<Operation *> *unconvertedOps = nullptr);
+LLVM_NODISCARD LogicalResult
+applyPartialConversion(ArrayRef<Operation *> ops, ConversionTarget &target,
+                       const FrozenRewritePatternList &patterns,
+                       const ConversionConfig &config,
+                       DenseSet<Operation *> *unconvertedOps = nullptr);
+LLVM_NODISCARD LogicalResult
+applyPartialConversion(Operation *op, ConversionTarget &target,
+                       const FrozenRewritePatternList &patterns,
+                       const ConversionConfig &config,
+                       DenseSet<Operation *> *unconvertedOps = nullptr);
 
 /// Apply a complete conversion on the given operations, and all nested
 /// operations. This method returns failure if the conversion of any operation
@@ -848,6 +918,14 @@ applyFullConversion(ArrayRef<Operation *> ops, ConversionTarget &target,
 LLVM_NODISCARD LogicalResult
 applyFullConversion(Operation *op, ConversionTarget &target,
                     const FrozenRewritePatternList &patterns);
+LLVM_NODISCARD LogicalResult
+applyFullConversion(ArrayRef<Operation *> ops, ConversionTarget &target,
+                    const FrozenRewritePatternList &patterns,
+                    const ConversionConfig &config);
+LLVM_NODISCARD LogicalResult
+applyFullConversion(Operation *op, ConversionTarget &target,
+                    const FrozenRewritePatternList &patterns,
+                    const ConversionConfig &config);
 
 /// Apply an analysis conversion on the given operations, and all nested
 /// operations. This method analyzes which operations would be successfully
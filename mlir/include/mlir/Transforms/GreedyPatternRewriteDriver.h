@@ -15,9 +15,74 @@
 #define MLIR_TRANSFORMS_GREEDYPATTERNREWRITEDRIVER_H_
 
 #include "mlir/Rewrite/FrozenRewritePatternList.h"
+#include "llvm/ADT/MapVector.h"
 
 namespace mlir {
 
+//===----------------------------------------------------------------------===//
+// GreedyRewriteConfig
+//===----------------------------------------------------------------------===//
+
+/// Statistics collected by the greedy pattern rewrite driver for one pattern.
+struct GreedyRewritePatternStatistics {
+  /// The number of times the pattern was tried.
+  unsigned numAttempts = 0;
+  /// The number of times the pattern matched and rewrote the IR.
+  unsigned numApplications = 0;
+  /// The time spent matching and rewriting with the pattern, in seconds.
+  double seconds = 0;
+};
+
+/// Statistics collected by the greedy pattern rewrite driver. The counters are
+/// accumulated, so the same object may be used across several invocations.
+struct GreedyRewriteStatistics {
+  /// The number of times the worklist was seeded with all of the operations.
+  unsigned numIterations = 0;
+  /// The number of operations popped from the worklist.
+  unsigned numVisitedOps = 0;
+  /// The number of operations folded.
+  unsigned numFolds = 0;
+  /// The number of trivially dead operations erased.
+  unsigned numErasedDeadOps = 0;
+  /// The statistics of each pattern, in the order the patterns were first
+  /// tried.
+  llvm::MapVector<const Pattern *, GreedyRewritePatternStatistics> patterns;
+
+  /// If false, only the counters above are collected. The per-pattern
+  /// statistics time every pattern application, which is not free.
+  bool collectPatternStatistics = true;
+
+  /// Print the statistics, with the patterns sorted by decreasing time.
+  void print(raw_ostream &os) const;
+};
+
+/// This class allows control over how the greedy pattern rewrite driver
+/// traverses the IR and decides that it has converged.
+struct GreedyRewriteConfig {
+  /// If true, the worklist is seeded so that operations are visited top-down,
+  /// i.e. parents before their children and definitions before their uses.
+  /// Otherwise operations are visited bottom-up.
+  bool useTopDownTraversal = false;
+
+  /// If true, the worklist is seeded with all of the operations only once.
+  /// Afterwards, only the operations affected by a change are revisited: the
+  /// users of replaced values, the defining operations of the operands of
+  /// modified or erased operations, and their parent operations. The regions
+  /// are only rescanned if simplifying their control flow changed them.
+  /// Otherwise all of the operations are rescanned until an iteration makes no
+  /// change.
+  bool incremental = false;
+
+  /// The maximum number of times the worklist is seeded with all of the
+  /// operations before giving up on convergence.
+  unsigned maxIterations = 10;
+
+  /// If non-null, the driver accumulates statistics into this object. Unless
+  /// disabled on the object, this adds timing overhead to every pattern
+  /// application.
+  GreedyRewriteStatistics *statistics = nullptr;
+};
+
 //===----------------------------------------------------------------------===//
 // applyPatternsGreedily
 //===----------------------------------------------------------------------===//
@@ -56,6 +121,20 @@ applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
                              const FrozenRewritePatternList &patterns,
                              unsigned maxIterations);
 
+/// Rewrite the regions of the specified operation, with the traversal and
+/// convergence behavior described by `config`.
+LogicalResult
+applyPatternsAndFoldGreedily(Operation *op,
+                             const FrozenRewritePatternList &patterns,
+                             const GreedyRewriteConfig &config);
+
+/// Rewrite the given regions, with the traversal and convergence behavior
+/// described by `config`.
+LogicalResult
+applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
+                             const FrozenRewritePatternList &patterns,
+                             const GreedyRewriteConfig &config);
+
 /// Applies the specified patterns on `op` alone while also trying to fold it,
 /// by selecting the highest benefits patterns in a greedy manner. Returns
 /// success if no more patterns can be matched. `erased` is set to true if `op`
@@ -0,0 +1,70 @@
+// RUN:   mlir-opt %s -async-ref-counting                                      \
+// RUN:               -async-to-async-runtime                                  \
+// RUN:               -convert-async-to-llvm                                   \
+// RUN:               -convert-scf-to-std                                      \
+// RUN:               -convert-std-to-llvm                                     \
+// RUN: | mlir-cpu-runner                                                      \
+// RUN:     -e main -entry-point-result=void -O3                               \
+// RUN:     -shared-libs=%mlir_integration_test_dir/libmlir_c_runner_utils%shlibext \
+// RUN:     -shared-libs=%mlir_integration_test_dir/libmlir_runner_utils%shlibext \
+// RUN:     -shared-libs=%mlir_integration_test_dir/libmlir_async_runtime%shlibext \
+// RUN: | FileCheck %s
+
+// Measures the per-task overhead of the async runtime: every round spawns
+// thousands of async tasks that each store a single element, and the caller
+// waits for all of them with a group. The task body is negligible, so the
+// tasks per second rate printed to stderr is dominated by task creation,
+// scheduling and completion. The result is checked for correctness.
+
+func @main() {
+  %c0 = constant 0 : index
+  %c1 = constant 1 : index
+  %c10 = constant 10 : index
+  %c10000 = constant 10000 : index
+
+  %A = alloc() : memref<10000xf32>
+
+  %t_start = call @rtclock() : () -> f64
+  scf.for %round = %c0 to %c10 step %c1 {
+    %group = async.create_group
+    scf.for %i = %c0 to %c10000 step %c1 {
+      %token = async.execute {
+        %0 = index_cast %i : index to i32
+        %1 = sitofp %0 : i32 to f32
+        store %1, %A[%i] : memref<10000xf32>
+        async.yield
+      }
+      %rank = async.add_to_group %token, %group : !async.token
+    }
+    async.await_all %group
+  }
+  %t_end = call @rtclock() : () -> f64
+  %t = subf %t_end, %t_start : f64
+
+  // Number of tasks completed per second.
+  %num_tasks = muli %c10, %c10000 : index
+  %num_tasks_i = index_cast %num_tasks : index to i64
+  %num_tasks_f = sitofp %num_tasks_i : i64 to f64
+  %rate = divf %num_tasks_f, %t : f64
+  call @print_flops(%rate) : (f64) -> ()
+
+  // Check the first and the last elements written by the tasks.
+  %B = alloc() : memref<2xf32>
+  %last = subi %c10000, %c1 : index
+  %first_value = load %A[%c0] : memref<10000xf32>
+  %last_value = load %A[%last] : memref<10000xf32>
+  store %first_value, %B[%c0] : memref<2xf32>
+  store %last_value, %B[%c1] : memref<2xf32>
+
+  // CHECK: [0, {{ *}}9999]
+  %U = memref_cast %B : memref<2xf32> to memref<*xf32>
+  call @print_memref_f32(%U): (memref<*xf32>) -> ()
+
+  dealloc %B : memref<2xf32>
+  dealloc %A : memref<10000xf32>
+  return
+}
+
+func private @rtclock() -> f64
+func private @print_flops(f64)
+func private @print_memref_f32(memref<*xf32>) attributes { llvm.emit_c_interface }
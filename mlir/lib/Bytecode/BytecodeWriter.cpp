@@ -0,0 +1,396 @@
+//===- BytecodeWriter.cpp - MLIR Bytecode Writer --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the writer for the MLIR bytecode format. See
+// `mlir/Bytecode/Encoding.h` for a description of the format.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/Bytecode/Encoding.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Operation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace mlir;
+using namespace mlir::bytecode;
+
+namespace {
+/// A buffer that bytecode is encoded into.
+class EncodingEmitter {
+public:
+  void emitByte(uint8_t byte) { buffer.push_back(byte); }
+
+  void emitVarInt(uint64_t value) {
+    uint8_t encoded[16];
+    unsigned size = llvm::encodeULEB128(value, encoded);
+    buffer.append(encoded, encoded + size);
+  }
+
+  void emitBytes(ArrayRef<uint8_t> bytes) {
+    buffer.append(bytes.begin(), bytes.end());
+  }
+  void emitBytes(ArrayRef<char> bytes) {
+    emitBytes(ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size()));
+  }
+
+  /// Pad the buffer with zeros until its size is a multiple of `alignment`.
+  void alignTo(unsigned alignment) {
+    while (buffer.size() % alignment)
+      buffer.push_back(0);
+  }
+
+  ArrayRef<uint8_t> getBytes() const { return buffer; }
+  size_t size() const { return buffer.size(); }
+
+private:
+  SmallVector<uint8_t, 0> buffer;
+};
+
+/// This class assigns the indices of the entries of the tables and encodes
+/// them, along with the IR, into the sections of a bytecode file.
+class BytecodeWriter {
+public:
+  LogicalResult write(Operation *rootOp, raw_ostream &os);
+
+private:
+  //===--------------------------------------------------------------------===//
+  // Tables
+
+  unsigned getStringID(StringRef str) {
+    auto it = stringIDs.try_emplace(str, strings.size());
+    if (it.second)
+      strings.push_back(it.first->getKey());
+    return it.first->second;
+  }
+
+  unsigned getOpNameID(OperationName name) {
+    return opNameIDs.insert({name, opNameIDs.size()}).first->second;
+  }
+
+  unsigned getTypeID(Type type) {
+    auto it = typeIDs.insert({type, types.size()});
+    if (it.second)
+      types.push_back(type);
+    return it.first->second;
+  }
+
+  unsigned getAttrID(Attribute attr) {
+    auto it = attrIDs.insert({attr, attrs.size()});
+    if (it.second)
+      attrs.push_back(attr);
+    return it.first->second;
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Sections
+
+  /// Assign a value index to every value defined within the given operation,
+  /// in the order they will be defined by the reader, and an index to every
+  /// nested block.
+  void numberValues(Operation *op);
+
+  LogicalResult writeOperation(EncodingEmitter &emitter, Operation *op);
+  LogicalResult writeRegion(EncodingEmitter &emitter, Region &region);
+
+  /// Encode the given attribute into `emitter`, and return its kind.
+  AttributeKind writeAttribute(EncodingEmitter &emitter, Attribute attr);
+
+  void writeStringSection(EncodingEmitter &emitter);
+  void writeOpNameSection(EncodingEmitter &emitter);
+  void writeTypeSection(EncodingEmitter &emitter);
+  void writeAttributeSection(EncodingEmitter &emitter);
+  void writeBlobSection(EncodingEmitter &emitter);
+
+  /// The strings referenced by the other sections, in index order.
+  llvm::StringMap<unsigned> stringIDs;
+  std::vector<StringRef> strings;
+
+  llvm::MapVector<OperationName, unsigned> opNameIDs;
+
+  DenseMap<Type, unsigned> typeIDs;
+  std::vector<Type> types;
+
+  DenseMap<Attribute, unsigned> attrIDs;
+  std::vector<Attribute> attrs;
+
+  /// The raw data of the dense elements attributes.
+  std::vector<ArrayRef<char>> blobs;
+
+  DenseMap<Value, unsigned> valueIDs;
+
+  /// The position of each block within its parent region.
+  DenseMap<Block *, unsigned> blockIDs;
+};
+} // end anonymous namespace
+
+void BytecodeWriter::numberValues(Operation *op) {
+  for (Value result : op->getResults())
+    valueIDs.try_emplace(result, valueIDs.size());
+  for (Region &region : op->getRegions()) {
+    for (auto it : llvm::enumerate(region))
+      blockIDs.try_emplace(&it.value(), it.index());
+    for (Block &block : region) {
+      for (BlockArgument arg : block.getArguments())
+        valueIDs.try_emplace(arg, valueIDs.size());
+      for (Operation &nestedOp : block)
+        numberValues(&nestedOp);
+    }
+  }
+}
+
+LogicalResult BytecodeWriter::writeOperation(EncodingEmitter &emitter,
+                                             Operation *op) {
+  emitter.emitVarInt(getOpNameID(op->getName()));
+  emitter.emitVarInt(getAttrID(op->getLoc()));
+
+  DictionaryAttr attrDict = op->getAttrDictionary();
+  uint8_t mask = 0;
+  if (!attrDict.empty())
+    mask |= kHasAttrs;
+  if (op->getNumResults())
+    mask |= kHasResults;
+  if (op->getNumOperands())
+    mask |= kHasOperands;
+  if (op->getNumSuccessors())
+    mask |= kHasSuccessors;
+  if (op->getNumRegions())
+    mask |= kHasRegions;
+  emitter.emitByte(mask);
+
+  if (mask & kHasAttrs)
+    emitter.emitVarInt(getAttrID(attrDict));
+  if (mask & kHasResults) {
+    emitter.emitVarInt(op->getNumResults());
+    for (Type type : op->getResultTypes())
+      emitter.emitVarInt(getTypeID(type));
+  }
+  if (mask & kHasOperands) {
+    emitter.emitVarInt(op->getNumOperands());
+    for (OpOperand &operand : op->getOpOperands()) {
+      // Values defined above the root operation have no index the reader
+      // could resolve.
+      auto it = valueIDs.find(operand.get());
+      if (it == valueIDs.end())
+        return op->emitOpError("operand #")
+               << operand.getOperandNumber()
+               << " is defined outside of the operation written as bytecode";
+      emitter.emitVarInt(it->second);
+    }
+  }
+  if (mask & kHasSuccessors) {
+    emitter.emitVarInt(op->getNumSuccessors());
+    for (Block *successor : op->getSuccessors())
+      emitter.emitVarInt(blockIDs.lookup(successor));
+  }
+  if (mask & kHasRegions) {
+    emitter.emitVarInt(op->getNumRegions());
+    for (Region &region : op->getRegions())
+      if (failed(writeRegion(emitter, region)))
+        return failure();
+  }
+  return success();
+}
+
+LogicalResult BytecodeWriter::writeRegion(EncodingEmitter &emitter,
+                                          Region &region) {
+  emitter.emitVarInt(llvm::size(region));
+  for (Block &block : region) {
+    emitter.emitVarInt(block.getNumArguments());
+    for (BlockArgument arg : block.getArguments())
+      emitter.emitVarInt(getTypeID(arg.getType()));
+    emitter.emitVarInt(block.getOperations().size());
+    for (Operation &op : block)
+      if (failed(writeOperation(emitter, &op)))
+        return failure();
+  }
+  return success();
+}
+
+AttributeKind BytecodeWriter::writeAttribute(EncodingEmitter &emitter,
+                                             Attribute attr) {
+  if (auto dict = attr.dyn_cast<DictionaryAttr>()) {
+    emitter.emitVarInt(dict.size());
+    for (NamedAttribute namedAttr : dict) {
+      emitter.emitVarInt(getStringID(namedAttr.first.strref()));
+      emitter.emitVarInt(getAttrID(namedAttr.second));
+    }
+    return AttributeKind::Dictionary;
+  }
+  if (auto array = attr.dyn_cast<ArrayAttr>()) {
+    emitter.emitVarInt(array.size());
+    for (Attribute element : array)
+      emitter.emitVarInt(getAttrID(element));
+    return AttributeKind::Array;
+  }
+  if (auto str = attr.dyn_cast<StringAttr>()) {
+    if (str.getType().isa<NoneType>()) {
+      emitter.emitVarInt(getStringID(str.getValue()));
+      return AttributeKind::String;
+    }
+  }
+  if (auto typeAttr = attr.dyn_cast<TypeAttr>()) {
+    emitter.emitVarInt(getTypeID(typeAttr.getValue()));
+    return AttributeKind::Type;
+  }
+  if (auto elements = attr.dyn_cast<DenseIntOrFPElementsAttr>()) {
+    // Store the raw data of dense elements, so that reading them is a copy
+    // instead of parsing their (potentially very large) textual form.
+    emitter.emitVarInt(getTypeID(elements.getType()));
+    emitter.emitByte(elements.isSplat());
+    emitter.emitVarInt(blobs.size());
+    blobs.push_back(elements.getRawData());
+    return AttributeKind::DenseElements;
+  }
+
+  // Locations.
+  if (attr.isa<UnknownLoc>())
+    return AttributeKind::UnknownLoc;
+  if (auto loc = attr.dyn_cast<FileLineColLoc>()) {
+    emitter.emitVarInt(getStringID(loc.getFilename()));
+    emitter.emitVarInt(loc.getLine());
+    emitter.emitVarInt(loc.getColumn());
+    return AttributeKind::FileLineColLoc;
+  }
+  if (auto loc = attr.dyn_cast<NameLoc>()) {
+    emitter.emitVarInt(getStringID(loc.getName().strref()));
+    emitter.emitVarInt(getAttrID(loc.getChildLoc()));
+    return AttributeKind::NameLoc;
+  }
+  if (auto loc = attr.dyn_cast<CallSiteLoc>()) {
+    emitter.emitVarInt(getAttrID(loc.getCallee()));
+    emitter.emitVarInt(getAttrID(loc.getCaller()));
+    return AttributeKind::CallSiteLoc;
+  }
+  if (auto loc = attr.dyn_cast<FusedLoc>()) {
+    emitter.emitVarInt(loc.getLocations().size());
+    for (Location nestedLoc : loc.getLocations())
+      emitter.emitVarInt(getAttrID(nestedLoc));
+    Attribute metadata = loc.getMetadata();
+    emitter.emitVarInt(metadata ? getAttrID(metadata) + 1 : 0);
+    return AttributeKind::FusedLoc;
+  }
+  // Opaque locations only have meaning within the current process.
+  if (auto loc = attr.dyn_cast<OpaqueLoc>())
+    return writeAttribute(emitter, loc.getFallbackLocation());
+
+  // Otherwise, fall back to the textual form.
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  attr.print(os);
+  emitter.emitVarInt(getStringID(os.str()));
+  return AttributeKind::Text;
+}
+
+void BytecodeWriter::writeStringSection(EncodingEmitter &emitter) {
+  emitter.emitVarInt(strings.size());
+  for (StringRef str : strings) {
+    emitter.emitVarInt(str.size());
+    emitter.emitBytes(ArrayRef<char>(str.data(), str.size()));
+  }
+}
+
+void BytecodeWriter::writeOpNameSection(EncodingEmitter &emitter) {
+  emitter.emitVarInt(opNameIDs.size());
+  for (auto &it : opNameIDs)
+    emitter.emitVarInt(getStringID(it.first.getStringRef()));
+}
+
+void BytecodeWriter::writeTypeSection(EncodingEmitter &emitter) {
+  // The textual form of a type is only referenced by the string section.
+  std::vector<std::string> typeStrs;
+  typeStrs.reserve(types.size());
+  for (Type type : types) {
+    typeStrs.emplace_back();
+    llvm::raw_string_ostream os(typeStrs.back());
+    type.print(os);
+    os.flush();
+  }
+
+  emitter.emitVarInt(types.size());
+  for (const std::string &str : typeStrs)
+    emitter.emitVarInt(getStringID(str));
+}
+
+void BytecodeWriter::writeAttributeSection(EncodingEmitter &emitter) {
+  // Encoding an attribute may reference new attributes, so `attrs` grows while
+  // it is being walked; the count is only known at the end.
+  EncodingEmitter entries;
+  for (unsigned i = 0; i < attrs.size(); ++i) {
+    EncodingEmitter payload;
+    AttributeKind kind = writeAttribute(payload, attrs[i]);
+    entries.emitByte(static_cast<uint8_t>(kind));
+    entries.emitVarInt(payload.size());
+    entries.emitBytes(payload.getBytes());
+  }
+  emitter.emitVarInt(attrs.size());
+  emitter.emitBytes(entries.getBytes());
+}
+
+void BytecodeWriter::writeBlobSection(EncodingEmitter &emitter) {
+  emitter.emitVarInt(blobs.size());
+  for (ArrayRef<char> blob : blobs) {
+    emitter.emitVarInt(blob.size());
+    emitter.alignTo(kSectionAlignment);
+    emitter.emitBytes(blob);
+  }
+}
+
+LogicalResult BytecodeWriter::write(Operation *rootOp, raw_ostream &os) {
+  // Encode the IR first; this populates the tables referenced by it. Types
+  // and strings are encoded last, as the other tables may add entries to
+  // them.
+  numberValues(rootOp);
+  EncodingEmitter irSection;
+  irSection.emitVarInt(valueIDs.size());
+  irSection.emitVarInt(/*numTopLevelOps=*/1);
+  if (failed(writeOperation(irSection, rootOp)))
+    return failure();
+
+  EncodingEmitter attrSection, blobSection, opNameSection, typeSection,
+      stringSection;
+  writeAttributeSection(attrSection);
+  writeBlobSection(blobSection);
+  writeOpNameSection(opNameSection);
+  writeTypeSection(typeSection);
+  writeStringSection(stringSection);
+
+  // Emit the header and the sections.
+  EncodingEmitter file;
+  file.emitBytes(ArrayRef<char>(kMagic));
+  file.emitVarInt(kVersion);
+  auto emitSection = [&](Section kind, const EncodingEmitter &section,
+                         bool aligned = false) {
+    file.emitByte(static_cast<uint8_t>(kind) |
+                  (aligned ? kAlignedSectionBit : 0));
+    file.emitVarInt(section.size());
+    if (aligned)
+      file.alignTo(kSectionAlignment);
+    file.emitBytes(section.getBytes());
+  };
+  emitSection(Section::String, stringSection);
+  emitSection(Section::OpName, opNameSection);
+  emitSection(Section::Type, typeSection);
+  emitSection(Section::Attribute, attrSection);
+  emitSection(Section::Blob, blobSection, /*aligned=*/true);
+  emitSection(Section::IR, irSection);
+
+  ArrayRef<uint8_t> bytes = file.getBytes();
+  os.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  return success();
+}
+
+LogicalResult mlir::writeBytecodeToFile(Operation *op, raw_ostream &os) {
+  return BytecodeWriter().write(op, os);
+}
@@ -24,8 +24,8 @@
 #include <thread>
 #include <vector>
 
+#include "WorkStealingThreadPool.h"
 #include "llvm/ADT/StringMap.h"
-#include "llvm/Support/ThreadPool.h"
 
 using namespace mlir::runtime;
 
@@ -47,7 +47,9 @@ class RefCounted;
 
 class AsyncRuntime {
 public:
-  AsyncRuntime() : numRefCountedObjects(0) {}
+  AsyncRuntime()
+      : numRefCountedObjects(0),
+        threadPool(std::max(1u, std::thread::hardware_concurrency())) {}
 
   ~AsyncRuntime() {
     threadPool.wait(); // wait for the completion of all async tasks
@@ -59,7 +61,7 @@ public:
     return numRefCountedObjects.load(std::memory_order_relaxed);
   }
 
-  llvm::ThreadPool &getThreadPool() { return threadPool; }
+  WorkStealingThreadPool &getThreadPool() { return threadPool; }
 
 private:
   friend class RefCounted;
@@ -74,7 +76,7 @@ private:
   }
 
   std::atomic<int32_t> numRefCountedObjects;
-  llvm::ThreadPool threadPool;
+  WorkStealingThreadPool threadPool;
 };
 
 // -------------------------------------------------------------------------- //
@@ -105,6 +107,8 @@ public:
       destroy();
   }
 
+  AsyncRuntime *getRuntime() { return runtime; }
+
 protected:
   virtual void destroy() { delete this; }
 
@@ -113,6 +117,78 @@ private:
   std::atomic<int32_t> refCount;
 };
 
+// -------------------------------------------------------------------------- //
+// A lock free list of the callbacks to run when an async object becomes ready.
+// Callbacks are pushed onto a Treiber stack, and the completing thread takes
+// the whole stack with a single exchange, so every callback runs exactly once
+// even if it is added concurrently with the completion.
+// -------------------------------------------------------------------------- //
+
+class AwaiterList {
+public:
+  AwaiterList() : head(nullptr) {}
+
+  ~AwaiterList() { assert(head.load() == nullptr && "pending awaiters"); }
+
+  void push(std::function<void()> awaiter) {
+    Node *node = new Node{std::move(awaiter), head.load()};
+    while (!head.compare_exchange_weak(node->next, node))
+      ;
+  }
+
+  // Runs and removes all the callbacks currently in the list, in the order they
+  // were added.
+  void runAll() {
+    Node *node = head.exchange(nullptr);
+    Node *reversed = nullptr;
+    while (node) {
+      Node *next = node->next;
+      node->next = reversed;
+      reversed = node;
+      node = next;
+    }
+    while (reversed) {
+      Node *next = reversed->next;
+      reversed->awaiter();
+      delete reversed;
+      reversed = next;
+    }
+  }
+
+private:
+  struct Node {
+    std::function<void()> awaiter;
+    Node *next;
+  };
+
+  std::atomic<Node *> head;
+};
+
+// A base class for the async objects that become ready exactly once. The
+// `ready` flag and the awaiter list are both updated without locks: the awaiter
+// is pushed before `ready` is checked again, and the completing thread sets
+// `ready` before taking the list, so one of them always runs the awaiter.
+struct AsyncReadyObject : public RefCounted {
+  AsyncReadyObject(AsyncRuntime *runtime, int32_t refCount)
+      : RefCounted(runtime, refCount), ready(false) {}
+
+  std::atomic<bool> ready;
+  AwaiterList awaiters;
+
+  void setReady() {
+    ready.store(true);
+    awaiters.runAll();
+  }
+
+  void addAwaiter(std::function<void()> awaiter) {
+    if (ready.load())
+      return awaiter();
+    awaiters.push(std::move(awaiter));
+    if (ready.load())
+      awaiters.runAll();
+  }
+};
+
 } // namespace
 
 // Returns the default per-process instance of an async runtime.
@@ -130,40 +206,26 @@ static AsyncRuntime *getDefaultAsyncRuntime() {
 }
 
 // Async token provides a mechanism to signal asynchronous operation completion.
-struct AsyncToken : public RefCounted {
+struct AsyncToken : public AsyncReadyObject {
   // AsyncToken created with a reference count of 2 because it will be returned
   // to the `async.execute` caller and also will be later on emplaced by the
   // asynchronously executed task. If the caller immediately will drop its
   // reference we must ensure that the token will be alive until the
   // asynchronous operation is completed.
   AsyncToken(AsyncRuntime *runtime)
-      : RefCounted(runtime, /*count=*/2), ready(false) {}
-
-  std::atomic<bool> ready;
-
-  // Pending awaiters are guarded by a mutex.
-  std::mutex mu;
-  std::condition_variable cv;
-  std::vector<std::function<void()>> awaiters;
+      : AsyncReadyObject(runtime, /*count=*/2) {}
 };
 
 // Async value provides a mechanism to access the result of asynchronous
 // operations. It owns the storage that is used to store/load the value of the
 // underlying type, and a flag to signal if the value is ready or not.
-struct AsyncValue : public RefCounted {
+struct AsyncValue : public AsyncReadyObject {
   // AsyncValue similar to an AsyncToken created with a reference count of 2.
   AsyncValue(AsyncRuntime *runtime, int32_t size)
-      : RefCounted(runtime, /*count=*/2), ready(false), storage(size) {}
-
-  std::atomic<bool> ready;
+      : AsyncReadyObject(runtime, /*count=*/2), storage(size) {}
 
   // Use vector of bytes to store async value payload.
   std::vector<int8_t> storage;
-
-  // Pending awaiters are guarded by a mutex.
-  std::mutex mu;
-  std::condition_variable cv;
-  std::vector<std::function<void()>> awaiters;
 };
 
 // Async group provides a mechanism to group together multiple async tokens or
@@ -175,12 +237,50 @@ struct AsyncGroup : public RefCounted {
 
   std::atomic<int> pendingTokens;
   std::atomic<int> rank;
+  AwaiterList awaiters;
+
+  bool isReady() { return pendingTokens.load() == 0; }
+
+  // Runs the awaiters when the last pending token becomes ready. As for the
+  // tokens, an awaiter added concurrently with the completion is run by exactly
+  // one of the two threads.
+  void addAwaiter(std::function<void()> awaiter) {
+    if (isReady())
+      return awaiter();
+    awaiters.push(std::move(awaiter));
+    if (isReady())
+      awaiters.runAll();
+  }
+};
+
+// Blocks the caller until `isReady` returns true, after registering a wake up
+// callback with `addAwaiter`. Worker threads run other tasks in the meantime.
+template <typename IsReady, typename AddAwaiter>
+static void blockUntilReady(AsyncRuntime *runtime, const IsReady &isReady,
+                            const AddAwaiter &addAwaiter) {
+  if (isReady())
+    return;
+
+  WorkStealingThreadPool &threadPool = runtime->getThreadPool();
+  if (threadPool.isWorkerThread()) {
+    addAwaiter([&threadPool]() { threadPool.notify(); });
+    threadPool.helpUntil(isReady);
+    return;
+  }
 
-  // Pending awaiters are guarded by a mutex.
+  // The awaiter signals completion while holding the lock, so the state below
+  // is not accessed after the waiting thread returns.
   std::mutex mu;
   std::condition_variable cv;
-  std::vector<std::function<void()>> awaiters;
-};
+  bool done = false;
+  addAwaiter([&]() {
+    std::unique_lock<std::mutex> lock(mu);
+    done = true;
+    cv.notify_one();
+  });
+  std::unique_lock<std::mutex> lock(mu);
+  cv.wait(lock, [&]() { return done; });
+}
 
 } // namespace runtime
 } // namespace mlir
@@ -217,55 +317,26 @@ extern "C" AsyncGroup *mlirAsyncRuntimeCreateGroup() {
 
 extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token,
                                                    AsyncGroup *group) {
-  std::unique_lock<std::mutex> lockToken(token->mu);
-  std::unique_lock<std::mutex> lockGroup(group->mu);
-
   // Get the rank of the token inside the group before we drop the reference.
   int rank = group->rank.fetch_add(1);
   group->pendingTokens.fetch_add(1);
 
-  auto onTokenReady = [group]() {
-    // Run all group awaiters if it was the last token in the group.
-    if (group->pendingTokens.fetch_sub(1) == 1) {
-      group->cv.notify_all();
-      for (auto &awaiter : group->awaiters)
-        awaiter();
-    }
-  };
-
-  if (token->ready) {
-    // Update group pending tokens immediately and maybe run awaiters.
-    onTokenReady();
-
-  } else {
-    // Update group pending tokens when token will become ready. Because this
-    // will happen asynchronously we must ensure that `group` is alive until
-    // then, and re-ackquire the lock.
-    group->addRef();
-
-    token->awaiters.push_back([group, onTokenReady]() {
-      // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-      {
-        std::unique_lock<std::mutex> lockGroup(group->mu);
-        onTokenReady();
-      }
-      group->dropRef();
-    });
-  }
+  // Update group pending tokens when the token becomes ready, and run all group
+  // awaiters if it was the last token in the group. Because this may happen
+  // asynchronously we must ensure that `group` is alive until then.
+  group->addRef();
+  token->addAwaiter([group]() {
+    if (group->pendingTokens.fetch_sub(1) == 1)
+      group->awaiters.runAll();
+    group->dropRef();
+  });
 
   return rank;
 }
 
 // Switches `async.token` to ready state and runs all awaiters.
 extern "C" void mlirAsyncRuntimeEmplaceToken(AsyncToken *token) {
-  // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-  {
-    std::unique_lock<std::mutex> lock(token->mu);
-    token->ready = true;
-    token->cv.notify_all();
-    for (auto &awaiter : token->awaiters)
-      awaiter();
-  }
+  token->setReady();
 
   // Async tokens created with a ref count `2` to keep token alive until the
   // async task completes. Drop this reference explicitly when token emplaced.
@@ -274,14 +345,7 @@ extern "C" void mlirAsyncRuntimeEmplaceToken(AsyncToken *token) {
 
 // Switches `async.value` to ready state and runs all awaiters.
 extern "C" void mlirAsyncRuntimeEmplaceValue(AsyncValue *value) {
-  // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-  {
-    std::unique_lock<std::mutex> lock(value->mu);
-    value->ready = true;
-    value->cv.notify_all();
-    for (auto &awaiter : value->awaiters)
-      awaiter();
-  }
+  value->setReady();
 
   // Async values created with a ref count `2` to keep value alive until the
   // async task completes. Drop this reference explicitly when value emplaced.
@@ -289,21 +353,27 @@ extern "C" void mlirAsyncRuntimeEmplaceValue(AsyncValue *value) {
 }
 
 extern "C" void mlirAsyncRuntimeAwaitToken(AsyncToken *token) {
-  std::unique_lock<std::mutex> lock(token->mu);
-  if (!token->ready)
-    token->cv.wait(lock, [token] { return token->ready.load(); });
+  blockUntilReady(
+      token->getRuntime(), [token]() { return token->ready.load(); },
+      [token](std::function<void()> awaiter) {
+        token->addAwaiter(std::move(awaiter));
+      });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitValue(AsyncValue *value) {
-  std::unique_lock<std::mutex> lock(value->mu);
-  if (!value->ready)
-    value->cv.wait(lock, [value] { return value->ready.load(); });
+  blockUntilReady(
+      value->getRuntime(), [value]() { return value->ready.load(); },
+      [value](std::function<void()> awaiter) {
+        value->addAwaiter(std::move(awaiter));
+      });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroup(AsyncGroup *group) {
-  std::unique_lock<std::mutex> lock(group->mu);
-  if (group->pendingTokens != 0)
-    group->cv.wait(lock, [group] { return group->pendingTokens == 0; });
+  blockUntilReady(
+      group->getRuntime(), [group]() { return group->isReady(); },
+      [group](std::function<void()> awaiter) {
+        group->addAwaiter(std::move(awaiter));
+      });
 }
 
 // Returns a pointer to the storage owned by the async value.
@@ -313,43 +383,25 @@ extern "C" ValueStorage mlirAsyncRuntimeGetValueStorage(AsyncValue *value) {
 
 extern "C" void mlirAsyncRuntimeExecute(CoroHandle handle, CoroResume resume) {
   auto *runtime = getDefaultAsyncRuntime();
-  runtime->getThreadPool().async([handle, resume]() { (*resume)(handle); });
+  runtime->getThreadPool().submit([handle, resume]() { (*resume)(handle); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitTokenAndExecute(AsyncToken *token,
                                                      CoroHandle handle,
                                                      CoroResume resume) {
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  if (token->ready) {
-    execute();
-  } else {
-    std::unique_lock<std::mutex> lock(token->mu);
-    token->awaiters.push_back([execute]() { execute(); });
-  }
+  token->addAwaiter([handle, resume]() { (*resume)(handle); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitValueAndExecute(AsyncValue *value,
                                                      CoroHandle handle,
                                                      CoroResume resume) {
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  if (value->ready) {
-    execute();
-  } else {
-    std::unique_lock<std::mutex> lock(value->mu);
-    value->awaiters.push_back([execute]() { execute(); });
-  }
+  value->addAwaiter([handle, resume]() { (*resume)(handle); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroupAndExecute(AsyncGroup *group,
                                                           CoroHandle handle,
                                                           CoroResume resume) {
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  if (group->pendingTokens == 0) {
-    execute();
-  } else {
-    std::unique_lock<std::mutex> lock(group->mu);
-    group->awaiters.push_back([execute]() { execute(); });
-  }
+  group->addAwaiter([handle, resume]() { (*resume)(handle); });
 }
 
 //===----------------------------------------------------------------------===//
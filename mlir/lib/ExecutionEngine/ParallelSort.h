@@ -0,0 +1,77 @@
+//===- ParallelSort.h - Parallel sort for the runtime libraries -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a parallel sort used by the sparse runtime support
+// library. It is header only, and does not depend on LLVM, so that the runtime
+// libraries stay self contained.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_LIB_EXECUTIONENGINE_PARALLELSORT_H_
+#define MLIR_LIB_EXECUTIONENGINE_PARALLELSORT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace mlir {
+namespace runtime {
+
+/// Sorts the range [begin, end) with the given comparator. Large ranges are
+/// split into chunks that are sorted on separate threads and then merged
+/// pairwise, also in parallel. At most `maxThreads` chunks are used, each of
+/// at least `minChunkSize` elements; a `maxThreads` of 0 uses one thread per
+/// hardware thread.
+template <typename Iterator, typename Compare>
+void parallelSort(Iterator begin, Iterator end, Compare comp,
+                  size_t maxThreads = 0, size_t minChunkSize = 1 << 16) {
+  if (maxThreads == 0)
+    maxThreads = std::thread::hardware_concurrency();
+  size_t size = end - begin;
+  size_t numChunks =
+      std::min<size_t>(maxThreads, size / std::max<size_t>(minChunkSize, 1));
+  if (numChunks <= 1) {
+    std::sort(begin, end, comp);
+    return;
+  }
+
+  // Chunk `c` covers the range [bounds[c], bounds[c + 1]).
+  std::vector<Iterator> bounds;
+  for (size_t c = 0; c < numChunks; c++)
+    bounds.push_back(begin + c * size / numChunks);
+  bounds.push_back(end);
+
+  std::vector<std::thread> threads;
+  for (size_t c = 0; c < numChunks; c++)
+    threads.emplace_back([&bounds, &comp, c]() {
+      std::sort(bounds[c], bounds[c + 1], comp);
+    });
+  for (std::thread &thread : threads)
+    thread.join();
+
+  // Merge adjacent sorted chunks until a single one remains.
+  for (size_t width = 1; width < numChunks; width *= 2) {
+    threads.clear();
+    for (size_t c = 0; c + width < numChunks; c += 2 * width) {
+      Iterator first = bounds[c];
+      Iterator middle = bounds[c + width];
+      Iterator last = bounds[std::min(c + 2 * width, numChunks)];
+      threads.emplace_back([first, middle, last, &comp]() {
+        std::inplace_merge(first, middle, last, comp);
+      });
+    }
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+}
+
+} // namespace runtime
+} // namespace mlir
+
+#endif // MLIR_LIB_EXECUTIONENGINE_PARALLELSORT_H_
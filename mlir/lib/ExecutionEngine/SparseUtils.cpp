@@ -18,6 +18,8 @@
 
 #ifdef MLIR_CRUNNERUTILS_DEFINE_FUNCTIONS
 
+#include "ParallelSort.h"
+
 #include <algorithm>
 #include <cassert>
 #include <cctype>
@@ -25,6 +27,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <numeric>
 #include <vector>
 
 //===----------------------------------------------------------------------===//
@@ -42,58 +45,173 @@
 
 namespace {
 
-/// A sparse tensor element in coordinate scheme (value and indices).
-/// For example, a rank-1 vector element would look like
-///   ({i}, a[i])
-/// and a rank-5 tensor element like
-///   ({i,j,k,l,m}, a[i,j,k,l,m])
-struct Element {
-  Element(const std::vector<uint64_t> &ind, double val)
-      : indices(ind), value(val){};
-  std::vector<uint64_t> indices;
-  double value;
-};
-
-/// A memory-resident sparse tensor in coordinate scheme (collection of
-/// elements). This data structure is used to read a sparse tensor from
-/// external file format into memory and sort the elements lexicographically
-/// by indices before passing it back to the client (most packed storage
-/// formats require the elements to appear in lexicographic index order).
+/// A memory-resident sparse tensor in coordinate scheme. This data structure
+/// is used to read a sparse tensor from external file format into memory and
+/// sort the elements lexicographically by indices before passing it back to
+/// the client (most packed storage formats require the elements to appear in
+/// lexicographic index order).
+///
+/// The elements are stored as a structure of arrays: the indices of all
+/// elements live in one flat buffer (rank consecutive indices per element)
+/// next to a buffer with the values, so that building a tensor with many
+/// nonzero elements does not allocate any per-element heap objects. For
+/// example, a rank-2 matrix with elements a[i0,j0] and a[i1,j1] is stored as
+///   indices = {i0, j0, i1, j1}
+///   values  = {a[i0,j0], a[i1,j1]}
 struct SparseTensor {
 public:
   SparseTensor(const std::vector<uint64_t> &szs, uint64_t capacity)
-      : sizes(szs), pos(0) {
-    elements.reserve(capacity);
+      : sizes(szs), rank(szs.size()), pos(0) {
+    indices.reserve(capacity * rank);
+    values.reserve(capacity);
   }
   // Add element as indices and value.
-  void add(const std::vector<uint64_t> &ind, double val) {
-    assert(sizes.size() == ind.size());
-    for (int64_t r = 0, rank = sizes.size(); r < rank; r++)
+  void add(const uint64_t *ind, double val) {
+    for (uint64_t r = 0; r < rank; r++) {
       assert(ind[r] < sizes[r]); // within bounds
-    elements.emplace_back(Element(ind, val));
+      indices.push_back(ind[r]);
+    }
+    values.push_back(val);
   }
   // Sort elements lexicographically by index.
-  void sort() { std::sort(elements.begin(), elements.end(), lexOrder); }
+  void sort();
   // Primitive one-time iteration.
-  const Element &next() { return elements[pos++]; }
+  uint64_t next() { return pos++; }
+
+  uint64_t getRank() const { return rank; }
+  uint64_t getSize(uint64_t r) const { return sizes[r]; }
+  uint64_t getNumElements() const { return values.size(); }
+  // Returns the indices of the k-th element.
+  const uint64_t *getIndices(uint64_t k) const { return &indices[k * rank]; }
+  // Returns the r-th index of the k-th element.
+  uint64_t getIndex(uint64_t k, uint64_t r) const {
+    return indices[k * rank + r];
+  }
+  double getValue(uint64_t k) const { return values[k]; }
 
 private:
-  // Returns true if indices of e1 < indices of e2.
-  static bool lexOrder(const Element &e1, const Element &e2) {
-    assert(e1.indices.size() == e2.indices.size());
-    for (int64_t r = 0, rank = e1.indices.size(); r < rank; r++) {
-      if (e1.indices[r] == e2.indices[r])
+  // Returns true if indices of the k1-th element < indices of the k2-th one.
+  bool lexOrder(uint64_t k1, uint64_t k2) const {
+    const uint64_t *i1 = getIndices(k1);
+    const uint64_t *i2 = getIndices(k2);
+    for (uint64_t r = 0; r < rank; r++) {
+      if (i1[r] == i2[r])
         continue;
-      return e1.indices[r] < e2.indices[r];
+      return i1[r] < i2[r];
     }
     return false;
   }
 
   std::vector<uint64_t> sizes; // per-rank dimension sizes
-  std::vector<Element> elements;
+  std::vector<uint64_t> indices;
+  std::vector<double> values;
+  uint64_t rank;
   uint64_t pos;
 };
 
+void SparseTensor::sort() {
+  // Sort a permutation of the elements, and then move the indices and values
+  // into the sorted order. This moves every element at most twice, instead of
+  // swapping `rank` indices at every step of the sort.
+  uint64_t nnz = getNumElements();
+  std::vector<uint64_t> perm(nnz);
+  std::iota(perm.begin(), perm.end(), 0);
+  mlir::runtime::parallelSort(
+      perm.begin(), perm.end(),
+      [this](uint64_t k1, uint64_t k2) { return lexOrder(k1, k2); });
+  // Position `k` receives the element at position `perm[k]`. Apply this in
+  // place by following the cycles of the permutation, so that only one element
+  // is buffered instead of a second copy of all indices and values. Positions
+  // that are done are marked by setting `perm[k] = k`.
+  std::vector<uint64_t> tmpIndices(rank);
+  for (uint64_t k = 0; k < nnz; k++) {
+    if (perm[k] == k)
+      continue;
+    std::copy_n(getIndices(k), rank, tmpIndices.begin());
+    double tmpValue = values[k];
+    uint64_t j = k;
+    while (perm[j] != k) {
+      uint64_t src = perm[j];
+      std::copy_n(getIndices(src), rank, indices.begin() + j * rank);
+      values[j] = values[src];
+      perm[j] = j;
+      j = src;
+    }
+    std::copy_n(tmpIndices.begin(), rank, indices.begin() + j * rank);
+    values[j] = tmpValue;
+    perm[j] = j;
+  }
+}
+
+/// A sparse tensor in a packed storage scheme, built from the elements of a
+/// sorted coordinate scheme. Every dimension is either dense or compressed.
+/// A compressed dimension `d` stores the indices of its nonzero entries in
+/// `indices[d]`, and `pointers[d]` delimits the entries that belong to each
+/// entry of the enclosing dimension; a dense dimension stores neither. For
+/// example, a matrix with a dense outer and a compressed inner dimension is
+/// stored in CSR format, and compressing all dimensions yields CSF.
+struct SparsePackedTensor {
+public:
+  SparsePackedTensor(const SparseTensor &tensor, const uint8_t *sparsity)
+      : sizes(tensor.getRank()), pointers(tensor.getRank()),
+        indices(tensor.getRank()), sparse(tensor.getRank()) {
+    uint64_t rank = tensor.getRank();
+    for (uint64_t r = 0; r < rank; r++) {
+      sizes[r] = tensor.getSize(r);
+      sparse[r] = sparsity[r];
+      if (sparse[r])
+        pointers[r].push_back(0);
+    }
+    fromCOO(tensor, 0, tensor.getNumElements(), 0);
+  }
+
+  uint64_t getRank() const { return sizes.size(); }
+  std::vector<uint64_t> &getPointers(uint64_t d) { return pointers[d]; }
+  std::vector<uint64_t> &getIndices(uint64_t d) { return indices[d]; }
+  std::vector<double> &getValues() { return values; }
+
+private:
+  // Packs the elements [lo, hi) of the sorted coordinate scheme, which all
+  // have the same indices in the dimensions before `d`, into dimensions `d`
+  // and beyond. Duplicate elements are summed.
+  void fromCOO(const SparseTensor &tensor, uint64_t lo, uint64_t hi,
+               uint64_t d) {
+    if (d == getRank()) {
+      double value = 0.0;
+      for (; lo < hi; lo++)
+        value += tensor.getValue(lo);
+      values.push_back(value);
+      return;
+    }
+    if (sparse[d]) {
+      while (lo < hi) {
+        uint64_t i = tensor.getIndex(lo, d);
+        uint64_t seg = lo + 1;
+        while (seg < hi && tensor.getIndex(seg, d) == i)
+          seg++;
+        indices[d].push_back(i);
+        fromCOO(tensor, lo, seg, d + 1);
+        lo = seg;
+      }
+      pointers[d].push_back(indices[d].size());
+    } else {
+      for (uint64_t i = 0; i < sizes[d]; i++) {
+        uint64_t seg = lo;
+        while (seg < hi && tensor.getIndex(seg, d) == i)
+          seg++;
+        fromCOO(tensor, lo, seg, d + 1);
+        lo = seg;
+      }
+    }
+  }
+
+  std::vector<uint64_t> sizes; // per-rank dimension sizes
+  std::vector<std::vector<uint64_t>> pointers;
+  std::vector<std::vector<uint64_t>> indices;
+  std::vector<double> values;
+  std::vector<bool> sparse;
+};
+
 /// Helper to convert string to lower case.
 static char *toLower(char *token) {
   for (char *c = token; *c; c++)
@@ -171,6 +289,40 @@ static void readExtFROSTTHeader(FILE *file, char *name, uint64_t *idata) {
   }
 }
 
+/// Reads the next nonzero element, given as `rank` 1-based indices followed
+/// by a value on a single line, into 0-based indices and a value. The line is
+/// parsed in place, without the format string interpretation of `fscanf`.
+static void readElement(FILE *file, char *name, uint64_t rank,
+                        uint64_t *indices, double *value) {
+  char line[1025];
+  char *ptr;
+  // Skip empty lines.
+  do {
+    if (!fgets(line, 1025, file)) {
+      fprintf(stderr, "Cannot find next element in %s\n", name);
+      exit(1);
+    }
+    for (ptr = line; isspace(*ptr); ptr++)
+      ;
+  } while (!*ptr);
+  for (uint64_t r = 0; r < rank; r++) {
+    char *end;
+    uint64_t index = strtoull(ptr, &end, 10);
+    if (end == ptr) {
+      fprintf(stderr, "Cannot find next index in %s\n", name);
+      exit(1);
+    }
+    indices[r] = index - 1; // 0-based index
+    ptr = end;
+  }
+  char *end;
+  *value = strtod(ptr, &end);
+  if (end == ptr) {
+    fprintf(stderr, "Cannot find next value in %s\n", name);
+    exit(1);
+  }
+}
+
 } // anonymous namespace
 
 //===----------------------------------------------------------------------===//
@@ -198,6 +350,21 @@ static void readExtFROSTTHeader(FILE *file, char *name, uint64_t *idata) {
 //   }
 //   call @closeTensor(%tensor) : (!llvm.ptr<i8>) -> ()
 //
+// Alternatively, the elements can be packed into a CSR (or, more generally, a
+// CSF-like) storage scheme with one flag per rank to select between a dense
+// and a compressed dimension, and then accessed in bulk as memrefs.
+//
+//   %packed = call @packTensor(%tensor, %sparsity)
+//     : (!llvm.ptr<i8>, memref<?xi8>) -> (!llvm.ptr<i8>)
+//   call @closeTensor(%tensor) : (!llvm.ptr<i8>) -> ()
+//   %p = call @sparsePointers(%packed, %c1)
+//     : (!llvm.ptr<i8>, index) -> (memref<?xindex>)
+//   %i = call @sparseIndices(%packed, %c1)
+//     : (!llvm.ptr<i8>, index) -> (memref<?xindex>)
+//   %v = call @sparseValues(%packed) : (!llvm.ptr<i8>) -> (memref<?xf64>)
+//   .. process the packed sparse tensor ..
+//   call @closePackedTensor(%packed) : (!llvm.ptr<i8>) -> ()
+//
 //
 // Note that input parameters in the "MLIRized" version of a function mimic
 // the data layout of a MemRef<?xT>:
@@ -218,12 +385,13 @@ static void readExtFROSTTHeader(FILE *file, char *name, uint64_t *idata) {
 /// array parameter is used to pass the rank, the number of nonzero elements,
 /// and the dimension sizes (one per rank).
 extern "C" void *openTensorC(char *filename, uint64_t *idata) {
-  // Open the file.
+  // Open the file, with a large buffer for the bulk of the elements.
   FILE *file = fopen(filename, "r");
   if (!file) {
     fprintf(stderr, "Cannot find %s\n", filename);
     exit(1);
   }
+  setvbuf(file, nullptr, _IOFBF, 1 << 20);
   // Perform some file format dependent set up.
   if (strstr(filename, ".mtx")) {
     readMMEHeader(file, filename, idata);
@@ -241,21 +409,11 @@ extern "C" void *openTensorC(char *filename, uint64_t *idata) {
   for (uint64_t r = 0; r < rank; r++)
     indices[r] = idata[2 + r];
   SparseTensor *tensor = new SparseTensor(indices, nnz);
-  // Read all nonzero elements.
+  // Read all nonzero elements, streaming them into the tensor.
   for (uint64_t k = 0; k < nnz; k++) {
-    for (uint64_t r = 0; r < rank; r++) {
-      if (fscanf(file, "%" PRIu64, &indices[r]) != 1) {
-        fprintf(stderr, "Cannot find next index in %s\n", filename);
-        exit(1);
-      }
-      indices[r]--; // 0-based index
-    }
     double value;
-    if (fscanf(file, "%lg\n", &value) != 1) {
-      fprintf(stderr, "Cannot find next value in %s\n", filename);
-      exit(1);
-    }
-    tensor->add(indices, value);
+    readElement(file, filename, rank, indices.data(), &value);
+    tensor->add(indices.data(), value);
   }
   // Close the file and return sorted tensor.
   fclose(file);
@@ -272,10 +430,10 @@ extern "C" void *openTensor(char *filename, uint64_t *ibase, uint64_t *idata,
 
 /// Yields the next element from the given opaque sparse tensor object.
 extern "C" void readTensorItemC(void *tensor, uint64_t *idata, double *ddata) {
-  const Element &e = static_cast<SparseTensor *>(tensor)->next();
-  for (uint64_t r = 0, rank = e.indices.size(); r < rank; r++)
-    idata[r] = e.indices[r];
-  ddata[0] = e.value;
+  SparseTensor *t = static_cast<SparseTensor *>(tensor);
+  uint64_t k = t->next();
+  std::copy_n(t->getIndices(k), t->getRank(), idata);
+  ddata[0] = t->getValue(k);
 }
 
 /// "MLIRized" version.
@@ -293,6 +451,58 @@ extern "C" void closeTensor(void *tensor) {
   delete static_cast<SparseTensor *>(tensor);
 }
 
+/// Packs all elements of the given opaque sparse tensor object into a new
+/// opaque object with the given per-rank sparsity (nonzero for a compressed
+/// dimension, zero for a dense one). The original object is not affected, and
+/// may be closed right away to release the memory of the coordinate scheme.
+extern "C" void *packTensorC(void *tensor, uint8_t *sparsity) {
+  return new SparsePackedTensor(*static_cast<SparseTensor *>(tensor),
+                                sparsity);
+}
+
+/// "MLIRized" version.
+extern "C" void *packTensor(void *tensor, uint8_t *sbase, uint8_t *sdata,
+                            uint64_t soff, uint64_t ssize, uint64_t sstride) {
+  assert(sstride == 1);
+  return packTensorC(tensor, sdata + soff);
+}
+
+/// Helper to expose a buffer of a packed sparse tensor as a memref.
+template <typename T>
+static void toMemRef(StridedMemRefType<T, 1> *ref, std::vector<T> &v) {
+  ref->basePtr = ref->data = v.data();
+  ref->offset = 0;
+  ref->sizes[0] = v.size();
+  ref->strides[0] = 1;
+}
+
+/// Returns the pointers of the given compressed dimension of a packed sparse
+/// tensor object as a memref that remains owned by the object.
+extern "C" void _mlir_ciface_sparsePointers(StridedMemRefType<uint64_t, 1> *ref,
+                                            void *tensor, uint64_t d) {
+  toMemRef(ref, static_cast<SparsePackedTensor *>(tensor)->getPointers(d));
+}
+
+/// Returns the indices of the given compressed dimension of a packed sparse
+/// tensor object as a memref that remains owned by the object.
+extern "C" void _mlir_ciface_sparseIndices(StridedMemRefType<uint64_t, 1> *ref,
+                                           void *tensor, uint64_t d) {
+  toMemRef(ref, static_cast<SparsePackedTensor *>(tensor)->getIndices(d));
+}
+
+/// Returns the values of a packed sparse tensor object as a memref that
+/// remains owned by the object.
+extern "C" void _mlir_ciface_sparseValues(StridedMemRefType<double, 1> *ref,
+                                          void *tensor) {
+  toMemRef(ref, static_cast<SparsePackedTensor *>(tensor)->getValues());
+}
+
+/// Closes the given opaque packed sparse tensor object, releasing its memory
+/// resources. After this call, the opaque object cannot be used anymore.
+extern "C" void closePackedTensor(void *tensor) {
+  delete static_cast<SparsePackedTensor *>(tensor);
+}
+
 /// Helper method to read a sparse tensor filename from the environment,
 /// defined with the naming convention ${TENSOR0}, ${TENSOR1}, etc.
 extern "C" char *getTensorFilename(uint64_t id) {
@@ -0,0 +1,234 @@
+//===- WorkStealingThreadPool.h - Async runtime thread pool -----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the thread pool that runs the tasks of the Async runtime.
+// It is header only so that it can be tested without the runtime library,
+// whose symbols are hidden.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_LIB_EXECUTIONENGINE_WORKSTEALINGTHREADPOOL_H_
+#define MLIR_LIB_EXECUTIONENGINE_WORKSTEALINGTHREADPOOL_H_
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mlir {
+namespace runtime {
+
+// A work stealing thread pool. Every worker owns a deque of tasks: the owner
+// pushes and pops tasks at the back, so that the most recently spawned (and
+// most likely cache hot) task runs first, and idle workers steal from the front
+// of the other deques. Tasks submitted from outside of the pool are spread
+// round robin across the workers, so there is no global queue to contend on.
+
+class WorkStealingThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingThreadPool(unsigned numWorkers)
+      : workers(numWorkers), numQueued(0), numUnfinished(0), numSleeping(0),
+        shutdown(false) {
+    threads.reserve(numWorkers);
+    for (unsigned i = 0; i < numWorkers; ++i)
+      threads.emplace_back([this, i]() { workerLoop(i); });
+  }
+
+  ~WorkStealingThreadPool() {
+    wait();
+    {
+      std::unique_lock<std::mutex> lock(sleepMu);
+      shutdown = true;
+    }
+    sleepCv.notify_all();
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+
+  // Submits the task for execution. Tasks submitted by a worker are pushed to
+  // its own deque.
+  void submit(Task task) {
+    numUnfinished.fetch_add(1);
+    unsigned index = currentPool() == this
+                         ? currentWorker()
+                         : nextWorker.fetch_add(1, std::memory_order_relaxed) %
+                               workers.size();
+    {
+      Worker &worker = workers[index];
+      std::unique_lock<std::mutex> lock(worker.mu);
+      worker.tasks.push_back(std::move(task));
+    }
+
+    // Wake up a sleeping worker. This pairs with the check of `numQueued` in
+    // `sleep`: either the worker sees the new task, or we see the sleeper.
+    numQueued.fetch_add(1);
+    if (numSleeping.load() > 0) {
+      std::unique_lock<std::mutex> lock(sleepMu);
+      sleepCv.notify_one();
+    }
+  }
+
+  // Waits for the completion of all submitted tasks.
+  void wait() {
+    std::unique_lock<std::mutex> lock(waitMu);
+    waitCv.wait(lock, [this]() { return numUnfinished.load() == 0; });
+  }
+
+  // Returns true if the caller is one of the workers of this pool.
+  bool isWorkerThread() const { return currentPool() == this; }
+
+  // Runs tasks on the calling worker thread until `isDone` returns true. This
+  // is used to block a worker on an async object without idling it, which also
+  // guarantees progress when all of the workers are blocked. `notify` must be
+  // called when the result of `isDone` may have changed.
+  void helpUntil(const std::function<bool()> &isDone) {
+    assert(isWorkerThread() && "only workers can help while waiting");
+    while (!isDone()) {
+      if (!runOneTask(currentWorker()))
+        sleep(isDone);
+    }
+  }
+
+  // Wakes up all the workers sleeping in `helpUntil`.
+  void notify() {
+    std::unique_lock<std::mutex> lock(sleepMu);
+    sleepCv.notify_all();
+  }
+
+private:
+  struct Worker {
+    std::mutex mu;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop(unsigned index) {
+    currentPool() = this;
+    currentWorker() = index;
+    while (true) {
+      if (runOneTask(index))
+        continue;
+      if (!sleep([]() { return false; }))
+        return;
+    }
+  }
+
+  // Pops a task from the back of the worker's own deque, or steals one from the
+  // front of another deque, and runs it. Returns false if there was no task.
+  bool runOneTask(unsigned index) {
+    Task task;
+    if (!popTask(index, task))
+      return false;
+    task();
+
+    if (numUnfinished.fetch_sub(1) == 1) {
+      std::unique_lock<std::mutex> lock(waitMu);
+      waitCv.notify_all();
+    }
+    return true;
+  }
+
+  bool popTask(unsigned index, Task &task) {
+    // Check if there are any tasks at all before touching the deques.
+    if (numQueued.load() == 0)
+      return false;
+
+    {
+      Worker &worker = workers[index];
+      std::unique_lock<std::mutex> lock(worker.mu);
+      if (!worker.tasks.empty()) {
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        numQueued.fetch_sub(1);
+        return true;
+      }
+    }
+
+    // Try not to wait on a busy deque first. If some were skipped, go over
+    // them again with a blocking lock, so that a task is never left behind
+    // because of a lost `try_lock`.
+    bool skippedBusyDeque = false;
+    for (bool blocking : {false, true}) {
+      for (unsigned i = 1, e = workers.size(); i < e; ++i) {
+        Worker &victim = workers[(index + i) % e];
+        std::unique_lock<std::mutex> lock(victim.mu, std::defer_lock);
+        if (blocking) {
+          lock.lock();
+        } else if (!lock.try_lock()) {
+          skippedBusyDeque = true;
+          continue;
+        }
+        if (victim.tasks.empty())
+          continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        numQueued.fetch_sub(1);
+        return true;
+      }
+      if (!skippedBusyDeque)
+        break;
+    }
+    return false;
+  }
+
+  // Puts the calling worker to sleep until new tasks are submitted, `isDone`
+  // returns true, or the pool is shut down. Returns false on shutdown.
+  template <typename IsDone> bool sleep(const IsDone &isDone) {
+    std::unique_lock<std::mutex> lock(sleepMu);
+    numSleeping.fetch_add(1);
+    // Every event that can make the predicate true notifies `sleepCv` while
+    // holding `sleepMu`, so there is no need to wake up periodically.
+    sleepCv.wait(lock, [&]() {
+      return numQueued.load() > 0 || shutdown || isDone();
+    });
+    numSleeping.fetch_sub(1);
+    return !shutdown;
+  }
+
+  std::vector<Worker> workers;
+  std::vector<std::thread> threads;
+
+  // The worker that receives the next task submitted from outside the pool.
+  std::atomic<unsigned> nextWorker{0};
+
+  // The number of tasks in the deques, and the number of tasks that have not
+  // finished executing yet.
+  std::atomic<int64_t> numQueued;
+  std::atomic<int64_t> numUnfinished;
+
+  // Idle workers sleep on `sleepCv`.
+  std::mutex sleepMu;
+  std::condition_variable sleepCv;
+  std::atomic<int> numSleeping;
+  bool shutdown;
+
+  // `wait` callers sleep on `waitCv`.
+  std::mutex waitMu;
+  std::condition_variable waitCv;
+
+  // The pool and the index of the worker running on the current thread. These
+  // are function local so that the class can be defined in a header.
+  static WorkStealingThreadPool *&currentPool() {
+    static thread_local WorkStealingThreadPool *pool = nullptr;
+    return pool;
+  }
+  static unsigned &currentWorker() {
+    static thread_local unsigned worker = 0;
+    return worker;
+  }
+};
+
+} // namespace runtime
+} // namespace mlir
+
+#endif // MLIR_LIB_EXECUTIONENGINE_WORKSTEALINGTHREADPOOL_H_
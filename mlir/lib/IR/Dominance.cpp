@@ -37,35 +37,47 @@ static bool hasSSADominance(Operation *op, unsigned index) {
 //===----------------------------------------------------------------------===//
 
 template <bool IsPostDom>
-void DominanceInfoBase<IsPostDom>::recalculate(Operation *op) {
+void DominanceInfoBase<IsPostDom>::recalculate(Operation *op,
+                                               bool skipIsolatedFromAbove) {
   dominanceInfos.clear();
 
   // Build the dominance for each of the operation regions.
-  op->walk([&](Operation *op) {
-    auto kindInterface = dyn_cast<RegionKindInterface>(op);
-    unsigned numRegions = op->getNumRegions();
-    for (unsigned i = 0; i < numRegions; i++) {
-      Region &region = op->getRegion(i);
-      // Don't compute dominance if the region is empty.
-      if (region.empty())
-        continue;
-
-      // Dominance changes based on the region type. Avoid the helper
-      // function here so we don't do the region cast repeatedly.
-      bool hasSSADominance =
-          op->isRegistered() &&
-          (!kindInterface || kindInterface.hasSSADominance(i));
-      // If a region has SSADominance, then compute detailed dominance
-      // info.  Otherwise, all values in the region are live anywhere
-      // in the region, which is represented as an empty entry in the
-      // dominanceInfos map.
-      if (hasSSADominance) {
-        auto opDominance = std::make_unique<base>();
-        opDominance->recalculate(region);
-        dominanceInfos.try_emplace(&region, std::move(opDominance));
-      }
+  recalculateNested(op, skipIsolatedFromAbove);
+}
+
+template <bool IsPostDom>
+void DominanceInfoBase<IsPostDom>::recalculateNested(
+    Operation *op, bool skipIsolatedFromAbove) {
+  auto kindInterface = dyn_cast<RegionKindInterface>(op);
+  unsigned numRegions = op->getNumRegions();
+  for (unsigned i = 0; i < numRegions; i++) {
+    Region &region = op->getRegion(i);
+    // Don't compute dominance if the region is empty.
+    if (region.empty())
+      continue;
+
+    // Compute the dominance of the nested operations first, skipping those
+    // that are isolated from above if requested.
+    for (Block &block : region)
+      for (Operation &nestedOp : block)
+        if (!skipIsolatedFromAbove || !nestedOp.isKnownIsolatedFromAbove())
+          recalculateNested(&nestedOp, skipIsolatedFromAbove);
+
+    // Dominance changes based on the region type. Avoid the helper
+    // function here so we don't do the region cast repeatedly.
+    bool hasSSADominance =
+        op->isRegistered() &&
+        (!kindInterface || kindInterface.hasSSADominance(i));
+    // If a region has SSADominance, then compute detailed dominance
+    // info.  Otherwise, all values in the region are live anywhere
+    // in the region, which is represented as an empty entry in the
+    // dominanceInfos map.
+    if (hasSSADominance) {
+      auto opDominance = std::make_unique<base>();
+      opDominance->recalculate(region);
+      dominanceInfos.try_emplace(&region, std::move(opDominance));
     }
-  });
+  }
 }
 
 /// Walks up the list of containers of the given block and calls the
@@ -26,14 +26,20 @@
 
 #include "mlir/IR/Verifier.h"
 #include "mlir/IR/Attributes.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/RegionKindInterface.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Regex.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
+#include <mutex>
 
 using namespace mlir;
 
@@ -41,7 +47,8 @@ namespace {
 /// This class encapsulates all the state used to verify an operation region.
 class OperationVerifier {
 public:
-  explicit OperationVerifier(MLIRContext *ctx) : ctx(ctx) {}
+  explicit OperationVerifier(MLIRContext *ctx, bool verifyInParallel)
+      : ctx(ctx), verifyInParallel(verifyInParallel) {}
 
   /// Verify the given operation.
   LogicalResult verify(Operation &op);
@@ -59,6 +66,20 @@ private:
   LogicalResult verifyBlock(Block &block);
   LogicalResult verifyOperation(Operation &op);
 
+  /// Verify an operation nested within the root operation. When verifying in
+  /// parallel, operations that are isolated from above are deferred to
+  /// `isolatedOps` instead.
+  LogicalResult verifyNestedOperation(Operation &op);
+
+  /// Verify each of the deferred isolated operations with a separate verifier,
+  /// in parallel.
+  LogicalResult verifyIsolatedOperations();
+
+  /// Returns true if `op` was deferred by verifyNestedOperation.
+  bool isDeferred(Operation &op) const {
+    return verifyInParallel && op.isKnownIsolatedFromAbove();
+  }
+
   /// Verify the dominance property of operations within the given Region.
   LogicalResult verifyDominance(Region &region);
 
@@ -79,6 +100,14 @@ private:
   /// The current context for the verifier.
   MLIRContext *ctx;
 
+  /// Whether nested operations that are isolated from above should be
+  /// verified in parallel.
+  bool verifyInParallel;
+
+  /// The nested operations that are isolated from above, in the order they
+  /// were encountered, whose verification has been deferred.
+  SmallVector<Operation *, 8> isolatedOps;
+
   /// Dominance information for this operation, when checking dominance.
   DominanceInfo *domInfo = nullptr;
 
@@ -97,14 +126,77 @@ LogicalResult OperationVerifier::verify(Operation &op) {
   // Since everything looks structurally ok to this point, we do a dominance
   // check for any nested regions. We do this as a second pass since malformed
   // CFG's can cause dominator analysis constructure to crash and we want the
-  // verifier to be resilient to malformed code.
-  DominanceInfo theDomInfo(&op);
+  // verifier to be resilient to malformed code. The regions of deferred
+  // operations get their own dominance information when they are verified.
+  DominanceInfo theDomInfo(&op, /*skipIsolatedFromAbove=*/verifyInParallel);
   domInfo = &theDomInfo;
   if (failed(verifyDominanceOfContainedRegions(op)))
     return failure();
 
   domInfo = nullptr;
-  return success();
+  return verifyIsolatedOperations();
+}
+
+LogicalResult OperationVerifier::verifyNestedOperation(Operation &op) {
+  if (isDeferred(op)) {
+    isolatedOps.push_back(&op);
+    return success();
+  }
+  return verifyOperation(op);
+}
+
+LogicalResult OperationVerifier::verifyIsolatedOperations() {
+  // A single operation gains nothing from being verified on another thread.
+  if (isolatedOps.size() < 2) {
+    for (Operation *op : isolatedOps)
+      if (failed(
+              OperationVerifier(ctx, /*verifyInParallel=*/false).verify(*op)))
+        return failure();
+    return success();
+  }
+
+  // Report the same diagnostics as a sequential verification would: those of
+  // the operations up to and including the first one, in IR order, that
+  // fails. The diagnostics of each operation are buffered until the threads
+  // are done; diagnostics emitted by other threads are passed through.
+  size_t numOps = isolatedOps.size();
+  std::vector<std::vector<Diagnostic>> diagnostics(numOps);
+  llvm::DenseMap<uint64_t, size_t> threadToOp;
+  std::mutex threadToOpMutex;
+  std::atomic<size_t> firstFailure(numOps);
+  {
+    ScopedDiagnosticHandler handler(ctx, [&](Diagnostic &diag) {
+      std::lock_guard<std::mutex> lock(threadToOpMutex);
+      auto it = threadToOp.find(llvm::get_threadid());
+      if (it == threadToOp.end())
+        return failure();
+      diagnostics[it->second].push_back(std::move(diag));
+      return success();
+    });
+    llvm::parallelForEachN(0, numOps, [&](size_t i) {
+      // Operations after a known failure would not be reached sequentially.
+      if (i > firstFailure)
+        return;
+      {
+        std::lock_guard<std::mutex> lock(threadToOpMutex);
+        threadToOp[llvm::get_threadid()] = i;
+      }
+      if (failed(OperationVerifier(ctx, /*verifyInParallel=*/false)
+                     .verify(*isolatedOps[i]))) {
+        size_t prev = firstFailure;
+        while (i < prev && !firstFailure.compare_exchange_weak(prev, i))
+          ;
+      }
+      std::lock_guard<std::mutex> lock(threadToOpMutex);
+      threadToOp.erase(llvm::get_threadid());
+    });
+  }
+
+  for (size_t i = 0, e = std::min<size_t>(firstFailure + 1, numOps); i != e;
+       ++i)
+    for (Diagnostic &diag : diagnostics[i])
+      ctx->getDiagEngine().emit(std::move(diag));
+  return failure(firstFailure != numOps);
 }
 
 LogicalResult OperationVerifier::verifyRegion(Region &region) {
@@ -140,12 +232,12 @@ LogicalResult OperationVerifier::verifyBlock(Block &block) {
       return op.emitError(
           "operation with block successors must terminate its parent block");
 
-    if (failed(verifyOperation(op)))
+    if (failed(verifyNestedOperation(op)))
       return failure();
   }
 
   // Verify the terminator.
-  if (failed(verifyOperation(block.back())))
+  if (failed(verifyNestedOperation(block.back())))
     return failure();
   if (block.back().isKnownNonTerminator())
     return block.back().emitError("block with no terminator");
@@ -316,9 +408,10 @@ LogicalResult OperationVerifier::verifyDominance(Region &region) {
         }
     // Recursively verify dominance within each operation in the
     // block, even if the block itself is not reachable, or we are in
-    // a region which doesn't respect dominance.
+    // a region which doesn't respect dominance. Deferred operations check
+    // their own regions.
     for (Operation &op : block)
-      if (failed(verifyDominanceOfContainedRegions(op)))
+      if (!isDeferred(op) && failed(verifyDominanceOfContainedRegions(op)))
         return failure();
   }
   return success();
@@ -340,7 +433,9 @@ OperationVerifier::verifyDominanceOfContainedRegions(Operation &op) {
 
 /// Perform (potentially expensive) checks of invariants, used to detect
 /// compiler bugs.  On error, this reports the error through the MLIRContext and
-/// returns failure.
+/// returns failure. When multithreading is enabled on the context, nested
+/// operations that are isolated from above are verified in parallel.
 LogicalResult mlir::verify(Operation *op) {
-  return OperationVerifier(op->getContext()).verify(*op);
+  MLIRContext *ctx = op->getContext();
+  return OperationVerifier(ctx, ctx->isMultithreadingEnabled()).verify(*op);
 }
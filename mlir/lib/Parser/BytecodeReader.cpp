@@ -0,0 +1,777 @@
+//===- BytecodeReader.cpp - MLIR Bytecode Reader --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the reader for the MLIR bytecode format. See
+// `mlir/Bytecode/Encoding.h` for a description of the format.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/Encoding.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/IR/Verifier.h"
+#include "mlir/Parser.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace mlir;
+using namespace mlir::bytecode;
+
+namespace {
+/// A cursor over a range of encoded bytes.
+class EncodingReader {
+public:
+  EncodingReader(ArrayRef<uint8_t> contents, Location fileLoc)
+      : dataIt(contents.begin()), dataEnd(contents.end()), fileLoc(fileLoc) {}
+
+  bool empty() const { return dataIt == dataEnd; }
+
+  /// Returns the number of bytes that have not been read yet.
+  size_t size() const { return dataEnd - dataIt; }
+
+  InFlightDiagnostic emitError(const Twine &msg) {
+    return mlir::emitError(fileLoc, msg);
+  }
+
+  LogicalResult parseByte(uint8_t &value) {
+    if (empty())
+      return emitError("unexpected end of bytecode");
+    value = *dataIt++;
+    return success();
+  }
+
+  LogicalResult parseVarInt(uint64_t &value) {
+    const char *error = nullptr;
+    unsigned size = 0;
+    value = llvm::decodeULEB128(dataIt, &size, dataEnd, &error);
+    if (error)
+      return emitError("invalid varint in bytecode: ") << error;
+    dataIt += size;
+    return success();
+  }
+
+  /// Parse the number of entries of a list. Every entry is encoded in at least
+  /// one byte, so counts larger than the remaining data are rejected before
+  /// they are used to size anything.
+  LogicalResult parseCount(uint64_t &count) {
+    if (failed(parseVarInt(count)))
+      return failure();
+    if (count > size())
+      return emitError("invalid entry count ") << count << " in bytecode";
+    return success();
+  }
+
+  LogicalResult parseBytes(uint64_t size, ArrayRef<uint8_t> &bytes) {
+    if (size > uint64_t(dataEnd - dataIt))
+      return emitError("unexpected end of bytecode");
+    bytes = ArrayRef<uint8_t>(dataIt, size);
+    dataIt += size;
+    return success();
+  }
+
+  /// Skip padding until the cursor is aligned to `alignment` bytes, relative
+  /// to `base`.
+  LogicalResult alignTo(const uint8_t *base, unsigned alignment) {
+    while ((dataIt - base) % alignment) {
+      uint8_t padding;
+      if (failed(parseByte(padding)))
+        return failure();
+    }
+    return success();
+  }
+
+private:
+  const uint8_t *dataIt, *dataEnd;
+  Location fileLoc;
+};
+
+/// This class reads a bytecode buffer into IR. The entries of the string,
+/// type and attribute tables are only decoded the first time they are
+/// referenced.
+class BytecodeReader {
+public:
+  BytecodeReader(MLIRContext *context, Location fileLoc)
+      : context(context), fileLoc(fileLoc) {}
+  ~BytecodeReader();
+
+  LogicalResult read(llvm::MemoryBufferRef buffer, Block *block);
+
+private:
+  InFlightDiagnostic emitError(const Twine &msg) {
+    return mlir::emitError(fileLoc, msg);
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Sections
+
+  LogicalResult parseStringSection(ArrayRef<uint8_t> contents);
+  LogicalResult parseOpNameSection(ArrayRef<uint8_t> contents);
+  LogicalResult parseTypeSection(ArrayRef<uint8_t> contents);
+  LogicalResult parseAttributeSection(ArrayRef<uint8_t> contents);
+  LogicalResult parseBlobSection(ArrayRef<uint8_t> contents);
+  LogicalResult parseIRSection(ArrayRef<uint8_t> contents, Block *block);
+
+  //===--------------------------------------------------------------------===//
+  // Tables
+
+  LogicalResult parseString(EncodingReader &reader, StringRef &str);
+  LogicalResult parseOpName(EncodingReader &reader,
+                            Optional<OperationName> &name);
+  LogicalResult parseType(EncodingReader &reader, Type &type);
+  LogicalResult parseAttribute(EncodingReader &reader, Attribute &attr);
+  template <typename T>
+  LogicalResult parseAttribute(EncodingReader &reader, T &attr);
+
+  /// Decode the attribute with the given index, if it hasn't been already.
+  /// Returns null and emits an error on failure.
+  Attribute resolveAttribute(uint64_t index);
+  Attribute decodeAttribute(AttributeKind kind, EncodingReader &reader);
+
+  //===--------------------------------------------------------------------===//
+  // IR
+
+  /// Parse an operation and insert it into `block` before `insertPt`.
+  /// `regionBlocks` are the blocks of the parent region, which successors
+  /// refer to.
+  LogicalResult parseOperation(EncodingReader &reader,
+                               ArrayRef<Block *> regionBlocks, Block *block,
+                               Block::iterator insertPt);
+  LogicalResult parseRegion(EncodingReader &reader, Region &region);
+
+  /// Return the value with the given index, creating a forward reference
+  /// placeholder if it hasn't been defined yet. Returns null and emits an
+  /// error if the index is out of range.
+  Value getValue(uint64_t index);
+  /// Define the value with the next value index.
+  LogicalResult defineValue(Value value);
+
+  MLIRContext *context;
+  Location fileLoc;
+
+  std::vector<StringRef> strings;
+  std::vector<OperationName> opNames;
+
+  /// The textual form of each type, and the type once it has been parsed.
+  std::vector<std::pair<StringRef, Type>> types;
+
+  /// The encoding of each attribute, and the attribute once it has been
+  /// decoded.
+  struct AttrEntry {
+    AttributeKind kind;
+    ArrayRef<uint8_t> payload;
+    Attribute attr;
+    /// Set while the attribute is being decoded, to detect attributes that
+    /// refer to themselves.
+    bool isResolving = false;
+  };
+  std::vector<AttrEntry> attrs;
+
+  std::vector<ArrayRef<uint8_t>> blobs;
+
+  /// The values defined so far, indexed by their value index. Values that
+  /// have only been used are forward reference placeholders. This is sized to
+  /// the number of values declared by the IR section.
+  std::vector<Value> values;
+  DenseSet<Operation *> forwardRefOps;
+
+  /// The index of the next value to be defined.
+  uint64_t nextValueIndex = 0;
+};
+} // end anonymous namespace
+
+BytecodeReader::~BytecodeReader() {
+  // Drop all uses of undefined forward references and destroy the
+  // placeholders.
+  for (Operation *op : forwardRefOps) {
+    op->getResult(0).dropAllUses();
+    op->destroy();
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Sections
+//===----------------------------------------------------------------------===//
+
+LogicalResult BytecodeReader::read(llvm::MemoryBufferRef buffer, Block *block) {
+  ArrayRef<uint8_t> contents(
+      reinterpret_cast<const uint8_t *>(buffer.getBufferStart()),
+      buffer.getBufferSize());
+  EncodingReader reader(contents, fileLoc);
+
+  ArrayRef<uint8_t> magic;
+  if (failed(reader.parseBytes(sizeof(kMagic), magic)) ||
+      memcmp(magic.data(), kMagic, sizeof(kMagic)) != 0)
+    return emitError("input is not MLIR bytecode");
+  uint64_t version;
+  if (failed(reader.parseVarInt(version)))
+    return failure();
+  if (version != kVersion)
+    return emitError("unsupported bytecode version ")
+           << version << ", expected " << kVersion;
+
+  // Collect the payload of each section.
+  Optional<ArrayRef<uint8_t>> sections[(unsigned)Section::NumSections];
+  while (!reader.empty()) {
+    uint8_t kindAndAlignment;
+    uint64_t size;
+    if (failed(reader.parseByte(kindAndAlignment)) ||
+        failed(reader.parseVarInt(size)))
+      return failure();
+    if ((kindAndAlignment & kAlignedSectionBit) &&
+        failed(reader.alignTo(contents.data(), kSectionAlignment)))
+      return failure();
+
+    uint8_t kind = kindAndAlignment & ~kAlignedSectionBit;
+    if (kind >= (uint8_t)Section::NumSections)
+      return emitError("invalid section kind ") << (unsigned)kind;
+    if (sections[kind])
+      return emitError("duplicate section kind ") << (unsigned)kind;
+    ArrayRef<uint8_t> payload;
+    if (failed(reader.parseBytes(size, payload)))
+      return failure();
+    sections[kind] = payload;
+  }
+  for (unsigned i = 0, e = (unsigned)Section::NumSections; i != e; ++i)
+    if (!sections[i])
+      return emitError("missing section kind ") << i;
+
+  // The string section must be read first, as all other sections reference
+  // it.
+  return failure(
+      failed(parseStringSection(*sections[(unsigned)Section::String])) ||
+      failed(parseOpNameSection(*sections[(unsigned)Section::OpName])) ||
+      failed(parseTypeSection(*sections[(unsigned)Section::Type])) ||
+      failed(parseAttributeSection(*sections[(unsigned)Section::Attribute])) ||
+      failed(parseBlobSection(*sections[(unsigned)Section::Blob])) ||
+      failed(parseIRSection(*sections[(unsigned)Section::IR], block)));
+}
+
+LogicalResult BytecodeReader::parseStringSection(ArrayRef<uint8_t> contents) {
+  EncodingReader reader(contents, fileLoc);
+  uint64_t numStrings;
+  if (failed(reader.parseCount(numStrings)))
+    return failure();
+  strings.reserve(numStrings);
+  for (uint64_t i = 0; i < numStrings; ++i) {
+    uint64_t size;
+    ArrayRef<uint8_t> bytes;
+    if (failed(reader.parseVarInt(size)) ||
+        failed(reader.parseBytes(size, bytes)))
+      return failure();
+    strings.emplace_back(reinterpret_cast<const char *>(bytes.data()),
+                         bytes.size());
+  }
+  return success();
+}
+
+LogicalResult BytecodeReader::parseOpNameSection(ArrayRef<uint8_t> contents) {
+  EncodingReader reader(contents, fileLoc);
+  uint64_t numOpNames;
+  if (failed(reader.parseCount(numOpNames)))
+    return failure();
+  opNames.reserve(numOpNames);
+  for (uint64_t i = 0; i < numOpNames; ++i) {
+    StringRef name;
+    if (failed(parseString(reader, name)))
+      return failure();
+
+    // Lazy load dialects in the context as needed.
+    StringRef dialectName = name.split('.').first;
+    if (!AbstractOperation::lookup(name, context) &&
+        !context->getLoadedDialect(dialectName))
+      context->getOrLoadDialect(dialectName);
+    opNames.emplace_back(name, context);
+  }
+  return success();
+}
+
+LogicalResult BytecodeReader::parseTypeSection(ArrayRef<uint8_t> contents) {
+  EncodingReader reader(contents, fileLoc);
+  uint64_t numTypes;
+  if (failed(reader.parseCount(numTypes)))
+    return failure();
+  types.reserve(numTypes);
+  for (uint64_t i = 0; i < numTypes; ++i) {
+    StringRef str;
+    if (failed(parseString(reader, str)))
+      return failure();
+    types.emplace_back(str, Type());
+  }
+  return success();
+}
+
+LogicalResult
+BytecodeReader::parseAttributeSection(ArrayRef<uint8_t> contents) {
+  EncodingReader reader(contents, fileLoc);
+  uint64_t numAttrs;
+  if (failed(reader.parseCount(numAttrs)))
+    return failure();
+  attrs.reserve(numAttrs);
+  for (uint64_t i = 0; i < numAttrs; ++i) {
+    uint8_t kind;
+    uint64_t size;
+    ArrayRef<uint8_t> payload;
+    if (failed(reader.parseByte(kind)) || failed(reader.parseVarInt(size)) ||
+        failed(reader.parseBytes(size, payload)))
+      return failure();
+    if (kind > (uint8_t)AttributeKind::FusedLoc)
+      return emitError("invalid attribute kind ") << (unsigned)kind;
+    attrs.push_back({(AttributeKind)kind, payload, Attribute(), false});
+  }
+  return success();
+}
+
+LogicalResult BytecodeReader::parseBlobSection(ArrayRef<uint8_t> contents) {
+  EncodingReader reader(contents, fileLoc);
+  uint64_t numBlobs;
+  if (failed(reader.parseCount(numBlobs)))
+    return failure();
+  blobs.reserve(numBlobs);
+  for (uint64_t i = 0; i < numBlobs; ++i) {
+    uint64_t size;
+    ArrayRef<uint8_t> blob;
+    if (failed(reader.parseVarInt(size)) ||
+        failed(reader.alignTo(contents.data(), kSectionAlignment)) ||
+        failed(reader.parseBytes(size, blob)))
+      return failure();
+    blobs.push_back(blob);
+  }
+  return success();
+}
+
+LogicalResult BytecodeReader::parseIRSection(ArrayRef<uint8_t> contents,
+                                             Block *block) {
+  EncodingReader reader(contents, fileLoc);
+
+  // Read the operations into a temporary module, so that they can be verified
+  // before being handed out.
+  OwningModuleRef moduleOp(ModuleOp::create(fileLoc));
+  Block *moduleBody = moduleOp->getBody();
+
+  // Every value index is checked against the declared number of values.
+  uint64_t numValues, numOps;
+  if (failed(reader.parseCount(numValues)) ||
+      failed(reader.parseCount(numOps)))
+    return failure();
+  values.resize(numValues);
+  for (uint64_t i = 0; i < numOps; ++i)
+    if (failed(parseOperation(reader, /*regionBlocks=*/{}, moduleBody,
+                               std::prev(moduleBody->end()))))
+      return failure();
+  if (!reader.empty())
+    return emitError("unexpected trailing data in the IR section");
+
+  if (!forwardRefOps.empty())
+    return emitError("use of undefined value in bytecode");
+  if (nextValueIndex != numValues)
+    return emitError("bytecode declares ")
+           << numValues << " values but defines " << nextValueIndex;
+  if (failed(verify(*moduleOp)))
+    return failure();
+
+  // Splice the operations over to the provided block, leaving the terminator
+  // of the temporary module behind.
+  auto &parsedOps = moduleBody->getOperations();
+  auto &destOps = block->getOperations();
+  destOps.splice(destOps.empty() ? destOps.end() : std::prev(destOps.end()),
+                 parsedOps, parsedOps.begin(), std::prev(parsedOps.end()));
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Tables
+//===----------------------------------------------------------------------===//
+
+LogicalResult BytecodeReader::parseString(EncodingReader &reader,
+                                          StringRef &str) {
+  uint64_t index;
+  if (failed(reader.parseVarInt(index)))
+    return failure();
+  if (index >= strings.size())
+    return emitError("invalid string index ") << index;
+  str = strings[index];
+  return success();
+}
+
+LogicalResult BytecodeReader::parseOpName(EncodingReader &reader,
+                                          Optional<OperationName> &name) {
+  uint64_t index;
+  if (failed(reader.parseVarInt(index)))
+    return failure();
+  if (index >= opNames.size())
+    return emitError("invalid operation name index ") << index;
+  name = opNames[index];
+  return success();
+}
+
+LogicalResult BytecodeReader::parseType(EncodingReader &reader, Type &type) {
+  uint64_t index;
+  if (failed(reader.parseVarInt(index)))
+    return failure();
+  if (index >= types.size())
+    return emitError("invalid type index ") << index;
+
+  std::pair<StringRef, Type> &entry = types[index];
+  if (!entry.second) {
+    size_t numRead = 0;
+    entry.second = mlir::parseType(entry.first, context, numRead);
+    if (!entry.second || numRead != entry.first.size())
+      return emitError("invalid type '") << entry.first << "' in bytecode";
+  }
+  type = entry.second;
+  return success();
+}
+
+LogicalResult BytecodeReader::parseAttribute(EncodingReader &reader,
+                                             Attribute &attr) {
+  uint64_t index;
+  if (failed(reader.parseVarInt(index)))
+    return failure();
+  attr = resolveAttribute(index);
+  return success(attr != nullptr);
+}
+
+template <typename T>
+LogicalResult BytecodeReader::parseAttribute(EncodingReader &reader, T &attr) {
+  Attribute baseAttr;
+  if (failed(parseAttribute(reader, baseAttr)))
+    return failure();
+  attr = baseAttr.dyn_cast<T>();
+  if (!attr)
+    return emitError("unexpected attribute kind in bytecode");
+  return success();
+}
+
+Attribute BytecodeReader::resolveAttribute(uint64_t index) {
+  if (index >= attrs.size())
+    return emitError("invalid attribute index ") << index, nullptr;
+
+  AttrEntry &entry = attrs[index];
+  if (!entry.attr) {
+    if (entry.isResolving)
+      return emitError("cyclic reference to attribute at index ") << index,
+             nullptr;
+    entry.isResolving = true;
+    EncodingReader reader(entry.payload, fileLoc);
+    entry.attr = decodeAttribute(entry.kind, reader);
+    entry.isResolving = false;
+    if (!entry.attr)
+      return nullptr;
+    if (!reader.empty())
+      return emitError("unexpected trailing data in attribute at index ")
+                 << index,
+             nullptr;
+  }
+  return entry.attr;
+}
+
+Attribute BytecodeReader::decodeAttribute(AttributeKind kind,
+                                          EncodingReader &reader) {
+  switch (kind) {
+  case AttributeKind::Text: {
+    StringRef str;
+    if (failed(parseString(reader, str)))
+      return nullptr;
+    size_t numRead = 0;
+    Attribute attr = mlir::parseAttribute(str, context, numRead);
+    if (!attr || numRead != str.size())
+      return emitError("invalid attribute '") << str << "' in bytecode",
+             nullptr;
+    return attr;
+  }
+  case AttributeKind::Dictionary: {
+    uint64_t numEntries;
+    if (failed(reader.parseCount(numEntries)))
+      return nullptr;
+    SmallVector<NamedAttribute, 8> entries;
+    entries.reserve(numEntries);
+    for (uint64_t i = 0; i < numEntries; ++i) {
+      StringRef name;
+      Attribute value;
+      if (failed(parseString(reader, name)) ||
+          failed(parseAttribute(reader, value)))
+        return nullptr;
+      entries.emplace_back(Identifier::get(name, context), value);
+    }
+    return DictionaryAttr::getWithSorted(entries, context);
+  }
+  case AttributeKind::Array: {
+    uint64_t numElements;
+    if (failed(reader.parseCount(numElements)))
+      return nullptr;
+    SmallVector<Attribute, 8> elements(numElements);
+    for (Attribute &element : elements)
+      if (failed(parseAttribute(reader, element)))
+        return nullptr;
+    return ArrayAttr::get(elements, context);
+  }
+  case AttributeKind::String: {
+    StringRef str;
+    if (failed(parseString(reader, str)))
+      return nullptr;
+    return StringAttr::get(str, context);
+  }
+  case AttributeKind::Type: {
+    Type type;
+    if (failed(parseType(reader, type)))
+      return nullptr;
+    return TypeAttr::get(type);
+  }
+  case AttributeKind::DenseElements: {
+    Type type;
+    uint8_t isSplat;
+    uint64_t blobIndex;
+    if (failed(parseType(reader, type)) || failed(reader.parseByte(isSplat)) ||
+        failed(reader.parseVarInt(blobIndex)))
+      return nullptr;
+    auto shapedType = type.dyn_cast<ShapedType>();
+    if (!shapedType || !shapedType.hasStaticShape() ||
+        blobIndex >= blobs.size())
+      return emitError("invalid dense elements attribute in bytecode"),
+             nullptr;
+
+    ArrayRef<char> data(reinterpret_cast<const char *>(blobs[blobIndex].data()),
+                        blobs[blobIndex].size());
+    bool detectedSplat;
+    if (!DenseElementsAttr::isValidRawBuffer(shapedType, data, detectedSplat))
+      return emitError("invalid dense elements data in bytecode"), nullptr;
+
+    // The splat flag must agree with the size of the data. The only ambiguous
+    // case is a single byte holding up to eight packed i1 elements, which is
+    // both a valid splat and a valid non-splat buffer.
+    bool packedBools = shapedType.getElementType().isInteger(1) &&
+                       shapedType.getNumElements() <= CHAR_BIT;
+    if (isSplat > 1 ||
+        (isSplat != detectedSplat && !(detectedSplat && packedBools)))
+      return emitError("dense elements splat flag does not match its data in "
+                       "bytecode"),
+             nullptr;
+    return DenseElementsAttr::getFromRawBuffer(shapedType, data, isSplat);
+  }
+  case AttributeKind::UnknownLoc:
+    return UnknownLoc::get(context);
+  case AttributeKind::FileLineColLoc: {
+    StringRef filename;
+    uint64_t line, column;
+    if (failed(parseString(reader, filename)) ||
+        failed(reader.parseVarInt(line)) || failed(reader.parseVarInt(column)))
+      return nullptr;
+    return FileLineColLoc::get(filename, line, column, context);
+  }
+  case AttributeKind::NameLoc: {
+    StringRef name;
+    LocationAttr childLoc;
+    if (failed(parseString(reader, name)) ||
+        failed(parseAttribute(reader, childLoc)))
+      return nullptr;
+    return NameLoc::get(Identifier::get(name, context), childLoc);
+  }
+  case AttributeKind::CallSiteLoc: {
+    LocationAttr callee, caller;
+    if (failed(parseAttribute(reader, callee)) ||
+        failed(parseAttribute(reader, caller)))
+      return nullptr;
+    return CallSiteLoc::get(callee, caller);
+  }
+  case AttributeKind::FusedLoc: {
+    uint64_t numLocs;
+    if (failed(reader.parseCount(numLocs)))
+      return nullptr;
+    SmallVector<Location, 4> locs;
+    locs.reserve(numLocs);
+    for (uint64_t i = 0; i < numLocs; ++i) {
+      LocationAttr loc;
+      if (failed(parseAttribute(reader, loc)))
+        return nullptr;
+      locs.push_back(loc);
+    }
+    uint64_t metadataIndex;
+    if (failed(reader.parseVarInt(metadataIndex)))
+      return nullptr;
+    Attribute metadata;
+    if (metadataIndex && !(metadata = resolveAttribute(metadataIndex - 1)))
+      return nullptr;
+    return FusedLoc::get(locs, metadata, context);
+  }
+  }
+  llvm_unreachable("unknown attribute kind");
+}
+
+//===----------------------------------------------------------------------===//
+// IR
+//===----------------------------------------------------------------------===//
+
+LogicalResult BytecodeReader::parseOperation(EncodingReader &reader,
+                                             ArrayRef<Block *> regionBlocks,
+                                             Block *block,
+                                             Block::iterator insertPt) {
+  Optional<OperationName> name;
+  LocationAttr loc;
+  uint8_t mask;
+  if (failed(parseOpName(reader, name)) ||
+      failed(parseAttribute(reader, loc)) || failed(reader.parseByte(mask)))
+    return failure();
+
+  DictionaryAttr attrDict;
+  if (mask & kHasAttrs) {
+    if (failed(parseAttribute(reader, attrDict)))
+      return failure();
+  } else {
+    attrDict = DictionaryAttr::get({}, context);
+  }
+
+  SmallVector<Type, 4> resultTypes;
+  if (mask & kHasResults) {
+    uint64_t numResults;
+    if (failed(reader.parseCount(numResults)))
+      return failure();
+    resultTypes.resize(numResults);
+    for (Type &type : resultTypes)
+      if (failed(parseType(reader, type)))
+        return failure();
+  }
+
+  SmallVector<Value, 4> operands;
+  if (mask & kHasOperands) {
+    uint64_t numOperands;
+    if (failed(reader.parseCount(numOperands)))
+      return failure();
+    operands.reserve(numOperands);
+    for (uint64_t i = 0; i < numOperands; ++i) {
+      uint64_t index;
+      if (failed(reader.parseVarInt(index)))
+        return failure();
+      Value operand = getValue(index);
+      if (!operand)
+        return failure();
+      operands.push_back(operand);
+    }
+  }
+
+  SmallVector<Block *, 2> successors;
+  if (mask & kHasSuccessors) {
+    uint64_t numSuccessors;
+    if (failed(reader.parseCount(numSuccessors)))
+      return failure();
+    for (uint64_t i = 0; i < numSuccessors; ++i) {
+      uint64_t index;
+      if (failed(reader.parseVarInt(index)))
+        return failure();
+      if (index >= regionBlocks.size())
+        return emitError("invalid successor index ") << index;
+      successors.push_back(regionBlocks[index]);
+    }
+  }
+
+  uint64_t numRegions = 0;
+  if ((mask & kHasRegions) && failed(reader.parseCount(numRegions)))
+    return failure();
+
+  Operation *op = Operation::create(loc, *name, resultTypes, operands, attrDict,
+                                    successors, numRegions);
+  block->getOperations().insert(insertPt, op);
+
+  // The results are defined before the values of the nested regions.
+  for (OpResult result : op->getResults())
+    if (failed(defineValue(result)))
+      return failure();
+  for (Region &region : op->getRegions())
+    if (failed(parseRegion(reader, region)))
+      return failure();
+  return success();
+}
+
+LogicalResult BytecodeReader::parseRegion(EncodingReader &reader,
+                                          Region &region) {
+  uint64_t numBlocks;
+  if (failed(reader.parseCount(numBlocks)))
+    return failure();
+
+  // Create all of the blocks up front, so that successors can refer to them.
+  SmallVector<Block *, 8> blocks;
+  blocks.reserve(numBlocks);
+  for (uint64_t i = 0; i < numBlocks; ++i) {
+    blocks.push_back(new Block());
+    region.push_back(blocks.back());
+  }
+
+  for (Block &block : region) {
+    uint64_t numArgs;
+    if (failed(reader.parseCount(numArgs)))
+      return failure();
+    for (uint64_t i = 0; i < numArgs; ++i) {
+      Type type;
+      if (failed(parseType(reader, type)) ||
+          failed(defineValue(block.addArgument(type))))
+        return failure();
+    }
+
+    uint64_t numOps;
+    if (failed(reader.parseCount(numOps)))
+      return failure();
+    for (uint64_t i = 0; i < numOps; ++i)
+      if (failed(parseOperation(reader, blocks, &block, block.end())))
+        return failure();
+  }
+  return success();
+}
+
+Value BytecodeReader::getValue(uint64_t index) {
+  if (index >= values.size())
+    return emitError("invalid value index ") << index, nullptr;
+  if (Value value = values[index])
+    return value;
+
+  // Forward references are created as operations, because we just need
+  // something with a def/use chain. The placeholder's type is never fixed up:
+  // its uses are moved over to the definition, and the placeholder destroyed.
+  Operation *op = Operation::create(
+      fileLoc, OperationName("placeholder", context), NoneType::get(context),
+      /*operands=*/{}, /*attributes=*/llvm::None, /*successors=*/{},
+      /*numRegions=*/0);
+  forwardRefOps.insert(op);
+  return values[index] = op->getResult(0);
+}
+
+LogicalResult BytecodeReader::defineValue(Value value) {
+  uint64_t index = nextValueIndex++;
+  if (index >= values.size())
+    return emitError("more values defined than the ")
+           << values.size() << " declared in bytecode";
+  if (Value existing = values[index]) {
+    Operation *placeholder = existing.getDefiningOp();
+    if (!placeholder || !forwardRefOps.erase(placeholder))
+      return emitError("value at index ") << index << " defined twice";
+    existing.replaceAllUsesWith(value);
+    placeholder->destroy();
+  }
+  values[index] = value;
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Entry points
+//===----------------------------------------------------------------------===//
+
+bool mlir::isBytecode(llvm::MemoryBufferRef buffer) {
+  return buffer.getBuffer().startswith(StringRef(kMagic, sizeof(kMagic)));
+}
+
+LogicalResult mlir::readBytecodeFile(llvm::MemoryBufferRef buffer, Block *block,
+                                     MLIRContext *context,
+                                     LocationAttr *sourceFileLoc) {
+  Location fileLoc = FileLineColLoc::get(buffer.getBufferIdentifier(),
+                                         /*line=*/0, /*column=*/0, context);
+  if (sourceFileLoc)
+    *sourceFileLoc = fileLoc;
+
+  return BytecodeReader(context, fileLoc).read(buffer, block);
+}
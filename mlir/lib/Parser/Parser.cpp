@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Parser.h"
+#include "mlir/Bytecode/BytecodeReader.h"
 #include "mlir/IR/AffineMap.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Dialect.h"
@@ -2087,6 +2088,9 @@ LogicalResult mlir::parseSourceFile(const llvm::SourceMgr &sourceMgr,
                                     Block *block, MLIRContext *context,
                                     LocationAttr *sourceFileLoc) {
   const auto *sourceBuf = sourceMgr.getMemoryBuffer(sourceMgr.getMainFileID());
+  if (isBytecode(sourceBuf->getMemBufferRef()))
+    return readBytecodeFile(sourceBuf->getMemBufferRef(), block, context,
+                            sourceFileLoc);
 
   Location parserLoc = FileLineColLoc::get(sourceBuf->getBufferIdentifier(),
                                            /*line=*/0, /*column=*/0, context);
@@ -124,6 +124,9 @@ enum OpCode : ByteCodeField {
   SwitchResultCount,
   /// Compare a type with a set of constants.
   SwitchType,
+  /// Compare an operation name, attribute, or type with a large set of
+  /// constants, using a precomputed lookup table.
+  SwitchTable,
 };
 
 enum class PDLValueKind { Attribute, Operation, Type, Value };
@@ -146,13 +149,14 @@ public:
             SmallVectorImpl<ByteCodeField> &matcherByteCode,
             SmallVectorImpl<ByteCodeField> &rewriterByteCode,
             SmallVectorImpl<PDLByteCodePattern> &patterns,
+            std::vector<PDLByteCodeSwitchTable> &switchTables,
             ByteCodeField &maxValueMemoryIndex,
             llvm::StringMap<PDLConstraintFunction> &constraintFns,
             llvm::StringMap<PDLCreateFunction> &createFns,
             llvm::StringMap<PDLRewriteFunction> &rewriteFns)
       : ctx(ctx), uniquedData(uniquedData), matcherByteCode(matcherByteCode),
         rewriterByteCode(rewriterByteCode), patterns(patterns),
-        maxValueMemoryIndex(maxValueMemoryIndex) {
+        switchTables(switchTables), maxValueMemoryIndex(maxValueMemoryIndex) {
     for (auto it : llvm::enumerate(constraintFns))
       constraintToMemIndex.try_emplace(it.value().first(), it.index());
     for (auto it : llvm::enumerate(createFns))
@@ -224,6 +228,13 @@ private:
   void generate(pdl_interp::SwitchOperationNameOp op, ByteCodeWriter &writer);
   void generate(pdl_interp::SwitchResultCountOp op, ByteCodeWriter &writer);
 
+  /// Generate a switch over the given case values, which are compared by
+  /// their opaque pointer, with a lookup table if there are enough cases to
+  /// make it profitable. Returns false if no table was generated.
+  bool generateSwitchTable(PDLValueKind kind, Value value,
+                           ArrayRef<const void *> cases,
+                           SuccessorRange successors, ByteCodeWriter &writer);
+
   /// Mapping from value to its corresponding memory index.
   DenseMap<Value, ByteCodeField> valueToMemIndex;
 
@@ -255,6 +266,7 @@ private:
   SmallVectorImpl<ByteCodeField> &matcherByteCode;
   SmallVectorImpl<ByteCodeField> &rewriterByteCode;
   SmallVectorImpl<PDLByteCodePattern> &patterns;
+  std::vector<PDLByteCodeSwitchTable> &switchTables;
   ByteCodeField &maxValueMemoryIndex;
 };
 
@@ -646,6 +658,13 @@ void Generator::generate(pdl_interp::ReplaceOp op, ByteCodeWriter &writer) {
 }
 void Generator::generate(pdl_interp::SwitchAttributeOp op,
                          ByteCodeWriter &writer) {
+  auto cases = llvm::to_vector<8>(
+      llvm::map_range(op.caseValuesAttr(), [](Attribute attr) {
+        return static_cast<const void *>(attr.getAsOpaquePointer());
+      }));
+  if (generateSwitchTable(PDLValueKind::Attribute, op.attribute(), cases,
+                          op.getSuccessors(), writer))
+    return;
   writer.append(OpCode::SwitchAttribute, op.attribute(), op.caseValuesAttr(),
                 op.getSuccessors());
 }
@@ -659,6 +678,13 @@ void Generator::generate(pdl_interp::SwitchOperationNameOp op,
   auto cases = llvm::map_range(op.caseValuesAttr(), [&](Attribute attr) {
     return OperationName(attr.cast<StringAttr>().getValue(), ctx);
   });
+  auto tableCases = llvm::to_vector<8>(
+      llvm::map_range(cases, [](OperationName name) {
+        return static_cast<const void *>(name.getAsOpaquePointer());
+      }));
+  if (generateSwitchTable(PDLValueKind::Operation, op.operation(), tableCases,
+                          op.getSuccessors(), writer))
+    return;
   writer.append(OpCode::SwitchOperationName, op.operation(), cases,
                 op.getSuccessors());
 }
@@ -668,10 +694,42 @@ void Generator::generate(pdl_interp::SwitchResultCountOp op,
                 op.getSuccessors());
 }
 void Generator::generate(pdl_interp::SwitchTypeOp op, ByteCodeWriter &writer) {
+  auto cases = llvm::to_vector<8>(llvm::map_range(
+      op.caseValuesAttr().getAsValueRange<TypeAttr>(), [](Type type) {
+        return static_cast<const void *>(type.getAsOpaquePointer());
+      }));
+  if (generateSwitchTable(PDLValueKind::Type, op.value(), cases,
+                          op.getSuccessors(), writer))
+    return;
   writer.append(OpCode::SwitchType, op.value(), op.caseValuesAttr(),
                 op.getSuccessors());
 }
 
+bool Generator::generateSwitchTable(PDLValueKind kind, Value value,
+                                    ArrayRef<const void *> cases,
+                                    SuccessorRange successors,
+                                    ByteCodeWriter &writer) {
+  // A linear scan is faster than a hash lookup for a handful of cases. The
+  // switches that get large are usually the ones that dispatch on the root
+  // operation name, where each case leads to the patterns rooted at one
+  // operation.
+  if (cases.size() < 8)
+    return false;
+
+  // Map each case to its successor index, the first successor being the
+  // default destination. If a case value appears multiple times, the first
+  // occurrence wins as it would in a linear scan.
+  PDLByteCodeSwitchTable table;
+  for (auto it : llvm::enumerate(cases))
+    table.try_emplace(it.value(), it.index() + 1);
+  switchTables.push_back(std::move(table));
+
+  writer.append(OpCode::SwitchTable, static_cast<ByteCodeField>(kind), value,
+                static_cast<ByteCodeField>(switchTables.size() - 1),
+                successors);
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 // PDLByteCode
 //===----------------------------------------------------------------------===//
@@ -681,10 +739,20 @@ PDLByteCode::PDLByteCode(ModuleOp module,
                          llvm::StringMap<PDLCreateFunction> createFns,
                          llvm::StringMap<PDLRewriteFunction> rewriteFns) {
   Generator generator(module.getContext(), uniquedData, matcherByteCode,
-                      rewriterByteCode, patterns, maxValueMemoryIndex,
-                      constraintFns, createFns, rewriteFns);
+                      rewriterByteCode, patterns, switchTables,
+                      maxValueMemoryIndex, constraintFns, createFns,
+                      rewriteFns);
   generator.generate(module);
 
+  // Collect the operations that the patterns may be rooted at, so that the
+  // matcher doesn't need to run on any other operation.
+  for (const PDLByteCodePattern &pattern : patterns) {
+    if (Optional<OperationName> rootKind = pattern.getRootKind())
+      rootKinds.insert(*rootKind);
+    else
+      hasAnyRootKind = true;
+  }
+
   // Initialize the external functions.
   for (auto &it : constraintFns)
     constraintFunctions.push_back(std::move(it.second));
@@ -716,12 +784,14 @@ public:
                    ArrayRef<ByteCodeField> code,
                    ArrayRef<PatternBenefit> currentPatternBenefits,
                    ArrayRef<PDLByteCodePattern> patterns,
+                   ArrayRef<PDLByteCodeSwitchTable> switchTables,
                    ArrayRef<PDLConstraintFunction> constraintFunctions,
                    ArrayRef<PDLCreateFunction> createFunctions,
                    ArrayRef<PDLRewriteFunction> rewriteFunctions)
       : curCodeIt(curCodeIt), memory(memory), uniquedMemory(uniquedMemory),
         code(code), currentPatternBenefits(currentPatternBenefits),
-        patterns(patterns), constraintFunctions(constraintFunctions),
+        patterns(patterns), switchTables(switchTables),
+        constraintFunctions(constraintFunctions),
         createFunctions(createFunctions), rewriteFunctions(rewriteFunctions) {}
 
   /// Start executing the code at the current bytecode index. `matches` is an
@@ -837,6 +907,7 @@ private:
   ArrayRef<ByteCodeField> code;
   ArrayRef<PatternBenefit> currentPatternBenefits;
   ArrayRef<PDLByteCodePattern> patterns;
+  ArrayRef<PDLByteCodeSwitchTable> switchTables;
   ArrayRef<PDLConstraintFunction> constraintFunctions;
   ArrayRef<PDLCreateFunction> createFunctions;
   ArrayRef<PDLRewriteFunction> rewriteFunctions;
@@ -1226,6 +1297,31 @@ void ByteCodeExecutor::execute(
       handleSwitch(value, cases);
       break;
     }
+    case SwitchTable: {
+      LLVM_DEBUG(llvm::dbgs() << "Executing SwitchTable:\n");
+      const void *value = nullptr;
+      switch (static_cast<PDLValueKind>(read())) {
+      case PDLValueKind::Attribute:
+        value = read<Attribute>().getAsOpaquePointer();
+        break;
+      case PDLValueKind::Operation:
+        value = read<Operation *>()->getName().getAsOpaquePointer();
+        break;
+      case PDLValueKind::Type:
+        value = read<Type>().getAsOpaquePointer();
+        break;
+      case PDLValueKind::Value:
+        llvm_unreachable("unexpected switch over a value");
+      }
+      const PDLByteCodeSwitchTable &table = switchTables[read()];
+      LLVM_DEBUG(llvm::dbgs() << "  * Value: " << value << "\n"
+                              << "  * Cases: " << table.size() << "\n\n");
+
+      // Jump to the successor of the matching case, or to the default one.
+      auto it = table.find(value);
+      selectJump(size_t(it == table.end() ? 0 : it->second));
+      break;
+    }
     }
   }
 }
@@ -1235,14 +1331,18 @@ void ByteCodeExecutor::execute(
 void PDLByteCode::match(Operation *op, PatternRewriter &rewriter,
                         SmallVectorImpl<MatchResult> &matches,
                         PDLByteCodeMutableState &state) const {
+  // Don't bother running the matcher if no pattern can be rooted at `op`.
+  if (!hasAnyRootKind && !rootKinds.count(op->getName()))
+    return;
+
   // The first memory slot is always the root operation.
   state.memory[0] = op;
 
   // The matcher function always starts at code address 0.
   ByteCodeExecutor executor(matcherByteCode.data(), state.memory, uniquedData,
                             matcherByteCode, state.currentPatternBenefits,
-                            patterns, constraintFunctions, createFunctions,
-                            rewriteFunctions);
+                            patterns, switchTables, constraintFunctions,
+                            createFunctions, rewriteFunctions);
   executor.execute(rewriter, &matches);
 
   // Order the found matches by benefit.
@@ -1262,6 +1362,6 @@ void PDLByteCode::rewrite(PatternRewriter &rewriter, const MatchResult &match,
   ByteCodeExecutor executor(
       &rewriterByteCode[match.pattern->getRewriterAddr()], state.memory,
       uniquedData, rewriterByteCode, state.currentPatternBenefits, patterns,
-      constraintFunctions, createFunctions, rewriteFunctions);
+      switchTables, constraintFunctions, createFunctions, rewriteFunctions);
   executor.execute(rewriter, /*matches=*/nullptr, match.location);
 }
@@ -15,6 +15,7 @@
 #define MLIR_REWRITE_BYTECODE_H_
 
 #include "mlir/IR/PatternMatch.h"
+#include "llvm/ADT/DenseSet.h"
 
 namespace mlir {
 namespace pdl_interp {
@@ -30,6 +31,11 @@ class PDLByteCode;
 using ByteCodeField = uint16_t;
 using ByteCodeAddr = uint32_t;
 
+/// A lookup table used to dispatch switches with many cases. It maps the
+/// opaque pointer of a case value (an operation name, attribute, or type) to
+/// the index of the successor to jump to; the default successor has index 0.
+using PDLByteCodeSwitchTable = DenseMap<const void *, ByteCodeField>;
+
 //===----------------------------------------------------------------------===//
 // PDLByteCodePattern
 //===----------------------------------------------------------------------===//
@@ -158,6 +164,14 @@ private:
   /// The set of patterns contained within the bytecode.
   SmallVector<PDLByteCodePattern, 32> patterns;
 
+  /// The lookup tables of the switches within the matcher.
+  std::vector<PDLByteCodeSwitchTable> switchTables;
+
+  /// The operations that the patterns are rooted at, and whether any pattern
+  /// may be rooted at any operation.
+  DenseSet<OperationName> rootKinds;
+  bool hasAnyRootKind = false;
+
   /// A set of user defined functions invoked via PDL.
   std::vector<PDLConstraintFunction> constraintFunctions;
   std::vector<PDLCreateFunction> createFunctions;
@@ -15,9 +15,12 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
 
 using namespace mlir;
 
+#define DEBUG_TYPE "canonicalize"
+
 namespace {
 /// Canonicalize operations in nested regions.
 struct Canonicalizer : public CanonicalizerBase<Canonicalizer> {
@@ -30,7 +33,29 @@ struct Canonicalizer : public CanonicalizerBase<Canonicalizer> {
     patterns = std::move(owningPatterns);
   }
   void runOnOperation() override {
-    applyPatternsAndFoldGreedily(getOperation()->getRegions(), patterns);
+    GreedyRewriteConfig config;
+    config.useTopDownTraversal = topDownProcessingEnabled;
+    config.incremental = incrementalProcessingEnabled;
+
+    // Collecting per-pattern statistics times every pattern application, so
+    // only do it when they will be printed.
+    GreedyRewriteStatistics statistics;
+    statistics.collectPatternStatistics = false;
+    LLVM_DEBUG(statistics.collectPatternStatistics = true);
+    config.statistics = &statistics;
+
+    applyPatternsAndFoldGreedily(getOperation()->getRegions(), patterns,
+                                 config);
+    numIterations += statistics.numIterations;
+    numVisitedOps += statistics.numVisitedOps;
+    numFolds += statistics.numFolds;
+    numErasedDeadOps += statistics.numErasedDeadOps;
+
+    LLVM_DEBUG({
+      llvm::dbgs() << "Canonicalization statistics for '"
+                   << getOperation()->getName() << "':\n";
+      statistics.print(llvm::dbgs());
+    });
   }
 
   FrozenRewritePatternList patterns;
@@ -16,16 +16,25 @@
 #include "mlir/Transforms/Utils.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include <chrono>
 
 using namespace mlir;
 using namespace mlir::detail;
 
 #define DEBUG_TYPE "dialect-conversion"
 
+STATISTIC(NumLegalizationAttempts,
+          "Number of attempts to legalize an operation");
+STATISTIC(NumFolds, "Number of operations legalized by folding");
+STATISTIC(NumRollbacks, "Number of times the rewriter state was rolled back");
+STATISTIC(MaxUndoLogSize, "Largest undo log at the end of a conversion");
+
 /// Recursively collect all of the operations to convert from within 'region'.
 /// If 'target' is nonnull, operations that are recursively legal have their
 /// regions pre-filtered to avoid considering them for legalization.
@@ -549,6 +558,12 @@ struct RewriterState {
 
   /// The current number of operations that were updated in place.
   unsigned numRootUpdates;
+
+  /// Return the total number of entries in the undo log at this state.
+  size_t getUndoLogSize() const {
+    return size_t(numCreatedOps) + numReplacements + numArgReplacements +
+           numBlockActions + numIgnoredOperations + numRootUpdates;
+  }
 };
 
 /// The state of an operation that was updated by a pattern in-place. This
@@ -557,14 +572,23 @@ struct RewriterState {
 class OperationTransactionState {
 public:
   OperationTransactionState() = default;
-  OperationTransactionState(Operation *op)
-      : op(op), loc(op->getLoc()), attrs(op->getAttrDictionary()),
-        operands(op->operand_begin(), op->operand_end()),
-        successors(op->successor_begin(), op->successor_end()) {}
+  /// Track an update of `op`. If `takeSnapshot` is false, the original state of
+  /// the operation is not recorded and the update cannot be undone.
+  OperationTransactionState(Operation *op, bool takeSnapshot)
+      : op(op), hasSnapshot(takeSnapshot) {
+    if (!takeSnapshot)
+      return;
+    loc = op->getLoc();
+    attrs = op->getAttrDictionary();
+    operands.assign(op->operand_begin(), op->operand_end());
+    successors.assign(op->successor_begin(), op->successor_end());
+  }
 
   /// Discard the transaction state and reset the state of the original
-  /// operation.
+  /// operation, if it was recorded.
   void resetOperation() const {
+    if (!hasSnapshot)
+      return;
     op->setLoc(loc);
     op->setAttrs(attrs);
     op->setOperands(operands);
@@ -577,6 +601,7 @@ public:
 
 private:
   Operation *op;
+  bool hasSnapshot = false;
   LocationAttr loc;
   DictionaryAttr attrs;
   SmallVector<Value, 8> operands;
@@ -821,6 +846,13 @@ struct ConversionPatternRewriterImpl {
   /// called from outside of a conversion pattern rewrite.
   const ConversionPattern *currentConversionPattern = nullptr;
 
+  /// Whether the rewrites performed by patterns may be rolled back. If false,
+  /// in-place updates are not recorded in a way that allows undoing them.
+  bool allowPatternRollback = true;
+
+  /// Set if a rollback was needed while `allowPatternRollback` is false.
+  bool disallowedRollback = false;
+
 #ifndef NDEBUG
   /// A set of operations that have pending updates. This tracking isn't
   /// strictly necessary, and is thus only active during debug builds for extra
@@ -920,6 +952,12 @@ RewriterState ConversionPatternRewriterImpl::getCurrentState() {
 }
 
 void ConversionPatternRewriterImpl::resetState(RewriterState state) {
+  // Without snapshots the in-place updates can't be undone, so rolling one of
+  // them back leaves the IR inconsistent. The other rewrites are still recorded
+  // in full and can be undone.
+  if (!allowPatternRollback && rootUpdates.size() != state.numRootUpdates)
+    disallowedRollback = true;
+
   // Reset any operations that were updated in place.
   for (unsigned i = state.numRootUpdates, e = rootUpdates.size(); i != e; ++i)
     rootUpdates[i].resetOperation();
@@ -1394,7 +1432,7 @@ void ConversionPatternRewriter::startRootUpdate(Operation *op) {
 #ifndef NDEBUG
   impl->pendingRootUpdates.insert(op);
 #endif
-  impl->rootUpdates.emplace_back(op);
+  impl->rootUpdates.emplace_back(op, impl->allowPatternRollback);
 }
 
 /// PatternRewriter hook for updating the root operation in-place.
@@ -1472,7 +1510,8 @@ public:
   using LegalizationAction = ConversionTarget::LegalizationAction;
 
   OperationLegalizer(ConversionTarget &targetInfo,
-                     const FrozenRewritePatternList &patterns);
+                     const FrozenRewritePatternList &patterns,
+                     ConversionStatistics *statistics = nullptr);
 
   /// Returns true if the given operation is known to be illegal on the target.
   bool isIllegal(Operation *op) const;
@@ -1494,6 +1533,10 @@ private:
   LogicalResult legalizeWithPattern(Operation *op,
                                     ConversionPatternRewriter &rewriter);
 
+  /// Reset the rewriter to the given state, after a failed attempt to legalize
+  /// an operation.
+  void rollback(ConversionPatternRewriterImpl &impl, RewriterState state);
+
   /// Return true if the given pattern may be applied to the given operation,
   /// false otherwise.
   bool canApplyPattern(Operation *op, const Pattern &pattern,
@@ -1564,12 +1607,16 @@ private:
 
   /// The pattern applicator to use for conversions.
   PatternApplicator applicator;
+
+  /// If non-null, the statistics to update while legalizing.
+  ConversionStatistics *statistics;
 };
 } // namespace
 
 OperationLegalizer::OperationLegalizer(ConversionTarget &targetInfo,
-                                       const FrozenRewritePatternList &patterns)
-    : target(targetInfo), applicator(patterns) {
+                                       const FrozenRewritePatternList &patterns,
+                                       ConversionStatistics *statistics)
+    : target(targetInfo), applicator(patterns), statistics(statistics) {
   // The set of patterns that can be applied to illegal operations to transform
   // them into legal ones.
   DenseMap<OperationName, LegalizationPatterns> legalizerPatterns;
@@ -1608,6 +1655,10 @@ OperationLegalizer::legalize(Operation *op,
     }
   });
 
+  ++NumLegalizationAttempts;
+  if (statistics)
+    ++statistics->numLegalizationAttempts;
+
   // Check if this operation is legal on the target.
   if (auto legalityInfo = target.isLegal(op)) {
     LLVM_DEBUG({
@@ -1693,11 +1744,14 @@ OperationLegalizer::legalizeWithFold(Operation *op,
       LLVM_DEBUG(logFailure(rewriterImpl.logger,
                             "generated constant '{0}' was illegal",
                             cstOp->getName()));
-      rewriterImpl.resetState(curState);
+      rollback(rewriterImpl, curState);
       return failure();
     }
   }
 
+  ++NumFolds;
+  if (statistics)
+    ++statistics->numFolds;
   LLVM_DEBUG(logSuccess(rewriterImpl.logger, ""));
   return success();
 }
@@ -1708,16 +1762,38 @@ OperationLegalizer::legalizeWithPattern(Operation *op,
   auto &rewriterImpl = rewriter.getImpl();
 
   // Functor that returns if the given pattern may be applied.
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point startTime;
   auto canApply = [&](const Pattern &pattern) {
-    return canApplyPattern(op, pattern, rewriter);
+    if (!canApplyPattern(op, pattern, rewriter))
+      return false;
+    if (statistics) {
+      ++statistics->patterns[&pattern].numAttempts;
+      startTime = Clock::now();
+    }
+    return true;
+  };
+
+  // Functor that records the time spent in the given pattern.
+  auto recordTime = [&](const Pattern &pattern) {
+    std::chrono::duration<double> elapsed = Clock::now() - startTime;
+    statistics->patterns[&pattern].seconds += elapsed.count();
   };
 
   // Functor that cleans up the rewriter state after a pattern failed to match.
+  // This is also invoked after `onSuccess` fails, in which case the statistics
+  // have already been updated.
   RewriterState curState = rewriterImpl.getCurrentState();
+  bool patternMatched = false;
   auto onFailure = [&](const Pattern &pattern) {
     LLVM_DEBUG(logFailure(rewriterImpl.logger, "pattern failed to match"));
-    rewriterImpl.resetState(curState);
+    rollback(rewriterImpl, curState);
     appliedPatterns.erase(&pattern);
+    if (statistics && !patternMatched) {
+      recordTime(pattern);
+      ++statistics->patterns[&pattern].numMatchFailures;
+    }
+    patternMatched = false;
   };
 
   // Functor that performs additional legalization when a pattern is
@@ -1725,8 +1801,20 @@ OperationLegalizer::legalizeWithPattern(Operation *op,
   auto onSuccess = [&](const Pattern &pattern) {
     auto result = legalizePatternResult(op, pattern, rewriter, curState);
     appliedPatterns.erase(&pattern);
+    patternMatched = true;
+    if (statistics) {
+      recordTime(pattern);
+      ConversionPatternStatistics &patternStats =
+          statistics->patterns[&pattern];
+      if (failed(result))
+        ++patternStats.numLegalizationFailures;
+      else
+        patternStats.numUndoLogEntries +=
+            rewriterImpl.getCurrentState().getUndoLogSize() -
+            curState.getUndoLogSize();
+    }
     if (failed(result))
-      rewriterImpl.resetState(curState);
+      rollback(rewriterImpl, curState);
     return result;
   };
 
@@ -1735,6 +1823,16 @@ OperationLegalizer::legalizeWithPattern(Operation *op,
                                     onSuccess);
 }
 
+void OperationLegalizer::rollback(ConversionPatternRewriterImpl &impl,
+                                  RewriterState state) {
+  if (impl.getCurrentState().getUndoLogSize() != state.getUndoLogSize()) {
+    ++NumRollbacks;
+    if (statistics)
+      ++statistics->numRollbacks;
+  }
+  impl.resetState(state);
+}
+
 bool OperationLegalizer::canApplyPattern(Operation *op, const Pattern &pattern,
                                          ConversionPatternRewriter &rewriter) {
   LLVM_DEBUG({
@@ -2093,8 +2191,14 @@ struct OperationConverter {
   explicit OperationConverter(ConversionTarget &target,
                               const FrozenRewritePatternList &patterns,
                               OpConversionMode mode,
-                              DenseSet<Operation *> *trackedOps = nullptr)
-      : opLegalizer(target, patterns), mode(mode), trackedOps(trackedOps) {}
+                              DenseSet<Operation *> *trackedOps = nullptr,
+                              const ConversionConfig &config = {})
+      : opLegalizer(target, patterns, config.statistics), mode(mode),
+        trackedOps(trackedOps), config(config) {
+    assert((mode != OpConversionMode::Analysis ||
+            config.allowPatternRollback) &&
+           "analysis conversions always roll back their rewrites");
+  }
 
   /// Converts the given operations to the conversion target.
   LogicalResult convertOperations(ArrayRef<Operation *> ops);
@@ -2136,13 +2240,25 @@ private:
   /// When mode == OpConversionMode::Partial, this is populated with ops found
   /// *not* to be legalizable to the target.
   DenseSet<Operation *> *trackedOps;
+
+  /// The configuration of this conversion.
+  ConversionConfig config;
 };
 } // end anonymous namespace
 
 LogicalResult OperationConverter::convert(ConversionPatternRewriter &rewriter,
                                           Operation *op) {
   // Legalize the given operation.
-  if (failed(opLegalizer.legalize(op, rewriter))) {
+  LogicalResult legalized = opLegalizer.legalize(op, rewriter);
+
+  // If legalizing the operation needed a rollback that can't be performed, the
+  // IR can't be trusted anymore.
+  if (rewriter.getImpl().disallowedRollback)
+    return op->emitError()
+           << "legalizing operation '" << op->getName()
+           << "' required rolling back a pattern, which was disallowed";
+
+  if (failed(legalized)) {
     // Handle the case of a failed conversion for each of the different modes.
     // Full conversions expect all operations to be converted.
     if (mode == OpConversionMode::Full)
@@ -2186,15 +2302,34 @@ LogicalResult OperationConverter::convertOperations(ArrayRef<Operation *> ops) {
   // Convert each operation and discard rewrites on failure.
   ConversionPatternRewriter rewriter(ops.front()->getContext());
   ConversionPatternRewriterImpl &rewriterImpl = rewriter.getImpl();
+  rewriterImpl.allowPatternRollback = config.allowPatternRollback;
+
+  // Record the size of the undo log before the rewrites are applied or
+  // discarded, whether or not the conversion succeeded.
+  auto recordStatistics = [&] {
+    size_t undoLogSize = rewriterImpl.getCurrentState().getUndoLogSize();
+    MaxUndoLogSize.updateMax(undoLogSize);
+    ConversionStatistics *statistics = config.statistics;
+    if (!statistics)
+      return;
+    statistics->maxUndoLogSize =
+        std::max(statistics->maxUndoLogSize, undoLogSize);
+    LLVM_DEBUG({
+      llvm::dbgs() << "Dialect conversion statistics:\n";
+      statistics->print(llvm::dbgs());
+    });
+  };
+
   for (auto *op : toConvert)
     if (failed(convert(rewriter, op)))
-      return rewriterImpl.discardRewrites(), failure();
+      return recordStatistics(), rewriterImpl.discardRewrites(), failure();
 
   // Now that all of the operations have been converted, finalize the conversion
   // process to ensure any lingering conversion artifacts are cleaned up and
   // legalized.
   if (failed(finalize(rewriter)))
-    return rewriterImpl.discardRewrites(), failure();
+    return recordStatistics(), rewriterImpl.discardRewrites(), failure();
+  recordStatistics();
 
   // After a successful conversion, apply rewrites if this is not an analysis
   // conversion.
@@ -2681,6 +2816,39 @@ auto ConversionTarget::getOpInfo(OperationName op) const
   return llvm::None;
 }
 
+//===----------------------------------------------------------------------===//
+// ConversionStatistics
+//===----------------------------------------------------------------------===//
+
+void ConversionStatistics::print(raw_ostream &os) const {
+  os << "legalization attempts: " << numLegalizationAttempts
+     << ", folds: " << numFolds << ", rollbacks: " << numRollbacks
+     << ", max undo log size: " << maxUndoLogSize << "\n";
+
+  // Sort the patterns by decreasing time, keeping the first-tried order for
+  // ties.
+  SmallVector<std::pair<const Pattern *, ConversionPatternStatistics>, 16>
+      sorted(patterns.begin(), patterns.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.second.seconds > rhs.second.seconds;
+                   });
+  for (auto &it : sorted) {
+    const ConversionPatternStatistics &patternStats = it.second;
+    os << llvm::format("  %10.4f s  attempts: %u, match failures: %u, "
+                       "legalization failures: %u, undo log entries: %zu  ",
+                       patternStats.seconds, patternStats.numAttempts,
+                       patternStats.numMatchFailures,
+                       patternStats.numLegalizationFailures,
+                       patternStats.numUndoLogEntries);
+    if (Optional<OperationName> rootKind = it.first->getRootKind())
+      os << "'" << *rootKind << "'";
+    else
+      os << "<any operation>";
+    os << " (benefit " << it.first->getBenefit().getBenefit() << ")\n";
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Op Conversion Entry Points
 //===----------------------------------------------------------------------===//
@@ -2709,6 +2877,24 @@ mlir::applyPartialConversion(Operation *op, ConversionTarget &target,
   return applyPartialConversion(llvm::makeArrayRef(op), target, patterns,
                                 unconvertedOps);
 }
+LogicalResult
+mlir::applyPartialConversion(ArrayRef<Operation *> ops,
+                             ConversionTarget &target,
+                             const FrozenRewritePatternList &patterns,
+                             const ConversionConfig &config,
+                             DenseSet<Operation *> *unconvertedOps) {
+  OperationConverter opConverter(target, patterns, OpConversionMode::Partial,
+                                 unconvertedOps, config);
+  return opConverter.convertOperations(ops);
+}
+LogicalResult
+mlir::applyPartialConversion(Operation *op, ConversionTarget &target,
+                             const FrozenRewritePatternList &patterns,
+                             const ConversionConfig &config,
+                             DenseSet<Operation *> *unconvertedOps) {
+  return applyPartialConversion(llvm::makeArrayRef(op), target, patterns,
+                                config, unconvertedOps);
+}
 
 /// Apply a complete conversion on the given operations, and all nested
 /// operations. This method will return failure if the conversion of any
@@ -2724,6 +2910,20 @@ mlir::applyFullConversion(Operation *op, ConversionTarget &target,
                           const FrozenRewritePatternList &patterns) {
   return applyFullConversion(llvm::makeArrayRef(op), target, patterns);
 }
+LogicalResult
+mlir::applyFullConversion(ArrayRef<Operation *> ops, ConversionTarget &target,
+                          const FrozenRewritePatternList &patterns,
+                          const ConversionConfig &config) {
+  OperationConverter opConverter(target, patterns, OpConversionMode::Full,
+                                 /*trackedOps=*/nullptr, config);
+  return opConverter.convertOperations(ops);
+}
+LogicalResult
+mlir::applyFullConversion(Operation *op, ConversionTarget &target,
+                          const FrozenRewritePatternList &patterns,
+                          const ConversionConfig &config) {
+  return applyFullConversion(llvm::makeArrayRef(op), target, patterns, config);
+}
 
 /// Apply an analysis conversion on the given operations, and all nested
 /// operations. This method analyzes which operations would be successfully
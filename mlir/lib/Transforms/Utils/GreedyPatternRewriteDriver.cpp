@@ -16,9 +16,12 @@
 #include "mlir/Transforms/FoldUtils.h"
 #include "mlir/Transforms/RegionUtils.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
 
 using namespace mlir;
 
@@ -27,25 +30,55 @@ using namespace mlir;
 /// The max number of iterations scanning for pattern match.
 static unsigned maxPatternMatchIterations = 10;
 
+//===----------------------------------------------------------------------===//
+// GreedyRewriteStatistics
+//===----------------------------------------------------------------------===//
+
+void GreedyRewriteStatistics::print(raw_ostream &os) const {
+  os << "iterations: " << numIterations << ", visited operations: "
+     << numVisitedOps << ", folds: " << numFolds
+     << ", erased dead operations: " << numErasedDeadOps << "\n";
+
+  // Sort the patterns by decreasing time, keeping the first-tried order for
+  // ties.
+  SmallVector<std::pair<const Pattern *, GreedyRewritePatternStatistics>, 16>
+      sorted(patterns.begin(), patterns.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.second.seconds > rhs.second.seconds;
+                   });
+  for (auto &it : sorted) {
+    os << llvm::format("  %10.4f s  %8u / %-8u  ", it.second.seconds,
+                       it.second.numApplications, it.second.numAttempts);
+    if (Optional<OperationName> rootKind = it.first->getRootKind())
+      os << "'" << *rootKind << "'";
+    else
+      os << "<any operation>";
+    os << " (benefit " << it.first->getBenefit().getBenefit() << ")\n";
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // GreedyPatternRewriteDriver
 //===----------------------------------------------------------------------===//
 
 namespace {
 /// This is a worklist-driven driver for the PatternMatcher, which repeatedly
-/// applies the locally optimal patterns in a roughly "bottom up" way.
+/// applies the locally optimal patterns in a roughly "bottom up" way, or "top
+/// down" if requested by the config.
 class GreedyPatternRewriteDriver : public PatternRewriter {
 public:
   explicit GreedyPatternRewriteDriver(MLIRContext *ctx,
-                                      const FrozenRewritePatternList &patterns)
-      : PatternRewriter(ctx), matcher(patterns), folder(ctx) {
+                                      const FrozenRewritePatternList &patterns,
+                                      const GreedyRewriteConfig &config)
+      : PatternRewriter(ctx), matcher(patterns), folder(ctx), config(config) {
     worklist.reserve(64);
 
     // Apply a simple cost model based solely on pattern benefit.
     matcher.applyDefaultCostModel();
   }
 
-  bool simplify(MutableArrayRef<Region> regions, int maxIterations);
+  bool simplify(MutableArrayRef<Region> regions);
 
   void addToWorklist(Operation *op) {
     // Check to see if the worklist already contains this op.
@@ -81,12 +114,16 @@ public:
 protected:
   // Implement the hook for inserting operations, and make sure that newly
   // inserted ops are added to the worklist for processing.
-  void notifyOperationInserted(Operation *op) override { addToWorklist(op); }
+  void notifyOperationInserted(Operation *op) override {
+    addToWorklist(op);
+    addParentToWorklist(op);
+  }
 
   // If an operation is about to be removed, make sure it is not in our
   // worklist anymore because we'd get dangling references to it.
   void notifyOperationRemoved(Operation *op) override {
     addToWorklist(op->getOperands());
+    addParentToWorklist(op);
     op->walk([this](Operation *operation) {
       removeFromWorklist(operation);
       folder.notifyRemoval(operation);
@@ -102,7 +139,50 @@ protected:
         addToWorklist(user);
   }
 
+  // When an operation is about to be updated in place, its operands may be
+  // replaced, which can leave their defining operations dead or with a single
+  // use. Requeue them while the old operands are still known. This is only
+  // tracked in incremental mode, like finalizeRootUpdate.
+  void startRootUpdate(Operation *op) override {
+    if (config.incremental)
+      addToWorklist(op->getOperands());
+  }
+
+  // When an operation is updated in place, it and its users may now be
+  // simplified further. This is only tracked in incremental mode; otherwise
+  // the next iteration revisits every operation anyway.
+  void finalizeRootUpdate(Operation *op) override {
+    if (!config.incremental)
+      return;
+    addToWorklist(op);
+    for (auto result : op->getResults())
+      for (auto *user : result.getUsers())
+        addToWorklist(user);
+    addParentToWorklist(op);
+  }
+
 private:
+  /// Add all of the operations nested within `regions` to the worklist, in the
+  /// traversal order requested by the config.
+  void seedWorklist(MutableArrayRef<Region> regions);
+
+  /// Try to match and rewrite `op` with the patterns, recording statistics if
+  /// requested.
+  LogicalResult matchAndRewrite(Operation *op);
+
+  // In incremental mode, add the parent of the given operation to the
+  // worklist, as a change to its body may enable further simplifications. The
+  // operations owning the regions being simplified are never added.
+  void addParentToWorklist(Operation *op) {
+    if (!config.incremental)
+      return;
+    Region *parentRegion = op->getParentRegion();
+    if (!parentRegion || topLevelRegions.count(parentRegion))
+      return;
+    if (Operation *parentOp = parentRegion->getParentOp())
+      addToWorklist(parentOp);
+  }
+
   // Look over the provided operands for any defining operations that should
   // be re-added to the worklist. This function should be called when an
   // operation is modified or removed, as it may trigger further
@@ -114,7 +194,9 @@ private:
       // TODO: This is based on the fact that zero use operations
       // may be deleted, and that single use values often have more
       // canonicalization opportunities.
-      if (!operand.use_empty() && !operand.hasOneUse())
+      // In incremental mode there is no later rescan to catch any missed
+      // opportunity, so all of the defining operations are re-added.
+      if (!config.incremental && !operand.use_empty() && !operand.hasOneUse())
         continue;
       if (auto *defInst = operand.getDefiningOp())
         addToWorklist(defInst);
@@ -133,22 +215,91 @@ private:
 
   /// Non-pattern based folder for operations.
   OperationFolder folder;
+
+  /// The configuration of this driver.
+  const GreedyRewriteConfig &config;
+
+  /// The regions being simplified.
+  SmallPtrSet<Region *, 2> topLevelRegions;
 };
 } // end anonymous namespace
 
+/// Collect the operations nested within `region` in pre-order.
+static void collectOpsPreOrder(Region &region,
+                               std::vector<Operation *> &ops) {
+  for (Block &block : region) {
+    for (Operation &op : block) {
+      ops.push_back(&op);
+      for (Region &nestedRegion : op.getRegions())
+        collectOpsPreOrder(nestedRegion, ops);
+    }
+  }
+}
+
+void GreedyPatternRewriteDriver::seedWorklist(
+    MutableArrayRef<Region> regions) {
+  if (!config.useTopDownTraversal) {
+    for (auto &region : regions)
+      region.walk([this](Operation *op) { addToWorklist(op); });
+    return;
+  }
+
+  // The worklist is processed from the back, so add the operations in reverse
+  // pre-order.
+  std::vector<Operation *> ops;
+  for (auto &region : regions)
+    collectOpsPreOrder(region, ops);
+  for (Operation *op : llvm::reverse(ops))
+    addToWorklist(op);
+}
+
+LogicalResult GreedyPatternRewriteDriver::matchAndRewrite(Operation *op) {
+  GreedyRewriteStatistics *statistics = config.statistics;
+  if (!statistics || !statistics->collectPatternStatistics)
+    return matcher.matchAndRewrite(op, *this);
+
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point startTime;
+  auto record = [&](const Pattern &pattern, bool applied) {
+    std::chrono::duration<double> elapsed = Clock::now() - startTime;
+    GreedyRewritePatternStatistics &patternStats =
+        statistics->patterns[&pattern];
+    ++patternStats.numAttempts;
+    patternStats.numApplications += applied;
+    patternStats.seconds += elapsed.count();
+  };
+  return matcher.matchAndRewrite(
+      op, *this,
+      /*canApply=*/
+      [&](const Pattern &) {
+        startTime = Clock::now();
+        return true;
+      },
+      /*onFailure=*/[&](const Pattern &pattern) { record(pattern, false); },
+      /*onSuccess=*/
+      [&](const Pattern &pattern) {
+        record(pattern, true);
+        return success();
+      });
+}
+
 /// Performs the rewrites while folding and erasing any dead ops. Returns true
-/// if the rewrite converges in `maxIterations`.
-bool GreedyPatternRewriteDriver::simplify(MutableArrayRef<Region> regions,
-                                          int maxIterations) {
+/// if the rewrite converges in `config.maxIterations`.
+bool GreedyPatternRewriteDriver::simplify(MutableArrayRef<Region> regions) {
+  for (auto &region : regions)
+    topLevelRegions.insert(&region);
+
   // Add the given operation to the worklist.
   auto collectOps = [this](Operation *op) { addToWorklist(op); };
 
+  GreedyRewriteStatistics *statistics = config.statistics;
   bool changed = false;
-  int i = 0;
+  unsigned i = 0;
   do {
     // Add all nested operations to the worklist.
-    for (auto &region : regions)
-      region.walk(collectOps);
+    seedWorklist(regions);
+    if (statistics)
+      ++statistics->numIterations;
 
     // These are scratch vectors used in the folding loop below.
     SmallVector<Value, 8> originalOperands, resultValues;
@@ -161,12 +312,16 @@ bool GreedyPatternRewriteDriver::simplify(MutableArrayRef<Region> regions,
       // them.
       if (op == nullptr)
         continue;
+      if (statistics)
+        ++statistics->numVisitedOps;
 
       // If the operation is trivially dead - remove it.
       if (isOpTriviallyDead(op)) {
         notifyOperationRemoved(op);
         op->erase();
         changed = true;
+        if (statistics)
+          ++statistics->numErasedDeadOps;
         continue;
       }
 
@@ -191,22 +346,30 @@ bool GreedyPatternRewriteDriver::simplify(MutableArrayRef<Region> regions,
       if ((succeeded(folder.tryToFold(op, collectOps, preReplaceAction,
                                       &inPlaceUpdate)))) {
         changed = true;
+        if (statistics)
+          ++statistics->numFolds;
         if (!inPlaceUpdate)
           continue;
       }
 
       // Try to match one of the patterns. The rewriter is automatically
       // notified of any necessary changes, so there is nothing else to do here.
-      changed |= succeeded(matcher.matchAndRewrite(op, *this));
+      changed |= succeeded(matchAndRewrite(op));
     }
 
+    // In incremental mode, the changes made by the patterns have already been
+    // propagated through the worklist; only a change to the structure of the
+    // regions requires another scan.
+    if (config.incremental)
+      changed = false;
+
     // After applying patterns, make sure that the CFG of each of the regions is
     // kept up to date.
     if (succeeded(simplifyRegions(regions))) {
       folder.clear();
       changed = true;
     }
-  } while (changed && ++i < maxIterations);
+  } while (changed && ++i < config.maxIterations);
   // Whether the rewrite converges, i.e. wasn't changed in the last iteration.
   return !changed;
 }
@@ -229,6 +392,12 @@ mlir::applyPatternsAndFoldGreedily(Operation *op,
   return applyPatternsAndFoldGreedily(op->getRegions(), patterns,
                                       maxIterations);
 }
+LogicalResult
+mlir::applyPatternsAndFoldGreedily(Operation *op,
+                                   const FrozenRewritePatternList &patterns,
+                                   const GreedyRewriteConfig &config) {
+  return applyPatternsAndFoldGreedily(op->getRegions(), patterns, config);
+}
 /// Rewrite the given regions, which must be isolated from above.
 LogicalResult
 mlir::applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
@@ -240,6 +409,14 @@ LogicalResult
 mlir::applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
                                    const FrozenRewritePatternList &patterns,
                                    unsigned maxIterations) {
+  GreedyRewriteConfig config;
+  config.maxIterations = maxIterations;
+  return applyPatternsAndFoldGreedily(regions, patterns, config);
+}
+LogicalResult
+mlir::applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
+                                   const FrozenRewritePatternList &patterns,
+                                   const GreedyRewriteConfig &config) {
   if (regions.empty())
     return success();
 
@@ -254,11 +431,11 @@ mlir::applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
          "patterns can only be applied to operations IsolatedFromAbove");
 
   // Start the pattern driver.
-  GreedyPatternRewriteDriver driver(regions[0].getContext(), patterns);
-  bool converged = driver.simplify(regions, maxIterations);
+  GreedyPatternRewriteDriver driver(regions[0].getContext(), patterns, config);
+  bool converged = driver.simplify(regions);
   LLVM_DEBUG(if (!converged) {
     llvm::dbgs() << "The pattern rewrite doesn't converge after scanning "
-                 << maxIterations << " times\n";
+                 << config.maxIterations << " times\n";
   });
   return success(converged);
 }
@@ -0,0 +1,28 @@
+// RUN: mlir-opt -allow-unregistered-dialect %s --emit-bytecode | mlir-opt -allow-unregistered-dialect -mlir-print-debuginfo | FileCheck %s
+
+// Bytecode input is detected by mlir-opt, and prints like the original.
+
+// CHECK-LABEL: func @forward_refs
+func @forward_refs(%arg0: i32) -> i32 {
+  // CHECK: "test.br"(%arg0)[^bb2] : (i32) -> () loc("a.mlir":1:2)
+  "test.br"(%arg0)[^bb2] : (i32) -> () loc("a.mlir":1:2)
+// CHECK: ^bb1(%[[A:[^:]+]]: i32):
+^bb1(%a: i32):
+  // CHECK: "test.use"(%[[V:[0-9]+]]) : (i32) -> () loc(callsite("foo" at "b.mlir":3:4))
+  "test.use"(%v) : (i32) -> () loc(callsite("foo" at "b.mlir":3:4))
+  // CHECK: return %[[A]] : i32
+  return %a : i32
+// CHECK: ^bb2(%[[B:[^:]+]]: i32):
+^bb2(%b: i32):
+  // CHECK: %[[V]] = "test.op"(%[[B]])
+  // CHECK-SAME: dense = dense<[1, 2, 3]> : tensor<3xi32>
+  // CHECK-SAME: list = [1 : i64, "str", i32, unit]
+  // CHECK-SAME: splat = dense<1.500000e+00> : tensor<4x4xf32>
+  // CHECK-SAME: loc("name"("c.mlir":7:8))
+  %v = "test.op"(%b) {
+    dense = dense<[1, 2, 3]> : tensor<3xi32>,
+    splat = dense<1.5> : tensor<4x4xf32>,
+    list = [1 : i64, "str", i32, unit]
+  } : (i32) -> i32 loc("name"("c.mlir":7:8))
+  "test.br"(%v)[^bb1] : (i32) -> ()
+}
@@ -0,0 +1,273 @@
+// RUN: mlir-opt %s -test-pdl-bytecode-pass -split-input-file | FileCheck %s
+
+// Switches with at least 8 cases are dispatched through a lookup table
+// instead of a linear scan. Each case records a match whose rewrite replaces
+// the root with a "test.success" operation that carries the index of the case
+// that was taken.
+
+//===----------------------------------------------------------------------===//
+// pdl_interp::SwitchOperationNameOp
+//===----------------------------------------------------------------------===//
+
+module @patterns {
+  func @matcher(%root : !pdl.operation) {
+    pdl_interp.switch_operation_name of %root to ["test.op0", "test.op1", "test.op2", "test.op3", "test.op4", "test.op5", "test.op6", "test.op7"](^case0, ^case1, ^case2, ^case3, ^case4, ^case5, ^case6, ^case7) -> ^default
+
+  ^case0:
+    %c0 = pdl_interp.create_attribute 0
+    pdl_interp.record_match @rewriters::@success(%root, %c0 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case1:
+    %c1 = pdl_interp.create_attribute 1
+    pdl_interp.record_match @rewriters::@success(%root, %c1 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case2:
+    %c2 = pdl_interp.create_attribute 2
+    pdl_interp.record_match @rewriters::@success(%root, %c2 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case3:
+    %c3 = pdl_interp.create_attribute 3
+    pdl_interp.record_match @rewriters::@success(%root, %c3 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case4:
+    %c4 = pdl_interp.create_attribute 4
+    pdl_interp.record_match @rewriters::@success(%root, %c4 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case5:
+    %c5 = pdl_interp.create_attribute 5
+    pdl_interp.record_match @rewriters::@success(%root, %c5 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case6:
+    %c6 = pdl_interp.create_attribute 6
+    pdl_interp.record_match @rewriters::@success(%root, %c6 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case7:
+    %c7 = pdl_interp.create_attribute 7
+    pdl_interp.record_match @rewriters::@success(%root, %c7 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^default:
+    pdl_interp.check_operation_name of %root is "test.default" -> ^case8, ^end
+
+  ^case8:
+    %c8 = pdl_interp.create_attribute 8
+    pdl_interp.record_match @rewriters::@success(%root, %c8 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^end:
+    pdl_interp.finalize
+  }
+
+  module @rewriters {
+    func @success(%root : !pdl.operation, %case : !pdl.attribute) {
+      %op = pdl_interp.create_operation "test.success" {"case" = %case}
+      pdl_interp.erase %root
+      pdl_interp.finalize
+    }
+  }
+}
+
+// CHECK-LABEL: test.switch_operation_name
+// CHECK: "test.success"() {case = 7 : i64}
+// CHECK: "test.success"() {case = 0 : i64}
+// CHECK: "test.success"() {case = 3 : i64}
+// CHECK: "test.success"() {case = 8 : i64}
+// CHECK: "test.unmatched"
+module @ir attributes { test.switch_operation_name } {
+  "test.op7"() : () -> ()
+  "test.op0"() : () -> ()
+  "test.op3"() : () -> ()
+  "test.default"() : () -> ()
+  "test.unmatched"() : () -> ()
+}
+
+// -----
+
+//===----------------------------------------------------------------------===//
+// pdl_interp::SwitchAttributeOp
+//===----------------------------------------------------------------------===//
+
+module @patterns {
+  func @matcher(%root : !pdl.operation) {
+    %attr = pdl_interp.get_attribute "test_attr" of %root
+    pdl_interp.is_not_null %attr : !pdl.attribute -> ^switch, ^end
+
+  ^switch:
+    pdl_interp.switch_attribute %attr to [0, 1, "two", 3.0 : f32, unit, i32, [6], 7 : i8](^case0, ^case1, ^case2, ^case3, ^case4, ^case5, ^case6, ^case7) -> ^case8
+
+  ^case0:
+    %c0 = pdl_interp.create_attribute 0
+    pdl_interp.record_match @rewriters::@success(%root, %c0 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case1:
+    %c1 = pdl_interp.create_attribute 1
+    pdl_interp.record_match @rewriters::@success(%root, %c1 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case2:
+    %c2 = pdl_interp.create_attribute 2
+    pdl_interp.record_match @rewriters::@success(%root, %c2 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case3:
+    %c3 = pdl_interp.create_attribute 3
+    pdl_interp.record_match @rewriters::@success(%root, %c3 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case4:
+    %c4 = pdl_interp.create_attribute 4
+    pdl_interp.record_match @rewriters::@success(%root, %c4 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case5:
+    %c5 = pdl_interp.create_attribute 5
+    pdl_interp.record_match @rewriters::@success(%root, %c5 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case6:
+    %c6 = pdl_interp.create_attribute 6
+    pdl_interp.record_match @rewriters::@success(%root, %c6 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case7:
+    %c7 = pdl_interp.create_attribute 7
+    pdl_interp.record_match @rewriters::@success(%root, %c7 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case8:
+    %c8 = pdl_interp.create_attribute 8
+    pdl_interp.record_match @rewriters::@success(%root, %c8 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^end:
+    pdl_interp.finalize
+  }
+
+  module @rewriters {
+    func @success(%root : !pdl.operation, %case : !pdl.attribute) {
+      %op = pdl_interp.create_operation "test.success" {"case" = %case}
+      pdl_interp.erase %root
+      pdl_interp.finalize
+    }
+  }
+}
+
+// CHECK-LABEL: test.switch_attribute
+// CHECK: "test.success"() {case = 2 : i64}
+// CHECK: "test.success"() {case = 3 : i64}
+// CHECK: "test.success"() {case = 6 : i64}
+// CHECK: "test.success"() {case = 7 : i64}
+// CHECK: "test.success"() {case = 8 : i64}
+// CHECK: "test.success"() {case = 8 : i64}
+module @ir attributes { test.switch_attribute } {
+  "test.op"() { test_attr = "two" } : () -> ()
+  "test.op"() { test_attr = 3.0 : f32 } : () -> ()
+  "test.op"() { test_attr = [6] } : () -> ()
+  "test.op"() { test_attr = 7 : i8 } : () -> ()
+  // The value and the type of an attribute must both match.
+  "test.op"() { test_attr = 7 : i16 } : () -> ()
+  "test.op"() { test_attr = "eight" } : () -> ()
+}
+
+// -----
+
+//===----------------------------------------------------------------------===//
+// pdl_interp::SwitchTypeOp
+//===----------------------------------------------------------------------===//
+
+module @patterns {
+  func @matcher(%root : !pdl.operation) {
+    %result = pdl_interp.get_result 0 of %root
+    pdl_interp.is_not_null %result : !pdl.value -> ^get_type, ^end
+
+  ^get_type:
+    %type = pdl_interp.get_value_type of %result
+    pdl_interp.switch_type %type to [i8, i16, i32, i64, f16, f32, f64, index](^case0, ^case1, ^case2, ^case3, ^case4, ^case5, ^case6, ^case7) -> ^case8
+
+  ^case0:
+    %c0 = pdl_interp.create_attribute 0
+    pdl_interp.record_match @rewriters::@success(%root, %c0 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case1:
+    %c1 = pdl_interp.create_attribute 1
+    pdl_interp.record_match @rewriters::@success(%root, %c1 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case2:
+    %c2 = pdl_interp.create_attribute 2
+    pdl_interp.record_match @rewriters::@success(%root, %c2 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case3:
+    %c3 = pdl_interp.create_attribute 3
+    pdl_interp.record_match @rewriters::@success(%root, %c3 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case4:
+    %c4 = pdl_interp.create_attribute 4
+    pdl_interp.record_match @rewriters::@success(%root, %c4 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case5:
+    %c5 = pdl_interp.create_attribute 5
+    pdl_interp.record_match @rewriters::@success(%root, %c5 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case6:
+    %c6 = pdl_interp.create_attribute 6
+    pdl_interp.record_match @rewriters::@success(%root, %c6 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case7:
+    %c7 = pdl_interp.create_attribute 7
+    pdl_interp.record_match @rewriters::@success(%root, %c7 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^case8:
+    %c8 = pdl_interp.create_attribute 8
+    pdl_interp.record_match @rewriters::@success(%root, %c8 : !pdl.operation, !pdl.attribute) : benefit(1), loc([%root]) -> ^end
+
+  ^end:
+    pdl_interp.finalize
+  }
+
+  module @rewriters {
+    func @success(%root : !pdl.operation, %case : !pdl.attribute) {
+      %op = pdl_interp.create_operation "test.success" {"case" = %case}
+      pdl_interp.erase %root
+      pdl_interp.finalize
+    }
+  }
+}
+
+// CHECK-LABEL: test.switch_type
+// CHECK: "test.success"() {case = 0 : i64}
+// CHECK: "test.success"() {case = 5 : i64}
+// CHECK: "test.success"() {case = 7 : i64}
+// CHECK: "test.success"() {case = 8 : i64}
+module @ir attributes { test.switch_type } {
+  %0 = "test.op"() : () -> i8
+  %1 = "test.op"() : () -> f32
+  %2 = "test.op"() : () -> index
+  %3 = "test.op"() : () -> i1
+}
+
+// -----
+
+//===----------------------------------------------------------------------===//
+// Root kind filtering
+//===----------------------------------------------------------------------===//
+
+// The matcher records a match for any operation other than "test.success",
+// but its only pattern is rooted at "test.op". The interpreter must not run
+// the matcher on operations of any other kind.
+module @patterns {
+  func @matcher(%root : !pdl.operation) {
+    pdl_interp.check_operation_name of %root is "test.success" -> ^end, ^pat
+
+  ^pat:
+    pdl_interp.record_match @rewriters::@success(%root : !pdl.operation) : benefit(1), loc([%root]), root("test.op") -> ^end
+
+  ^end:
+    pdl_interp.finalize
+  }
+
+  module @rewriters {
+    func @success(%root : !pdl.operation) {
+      %op = pdl_interp.create_operation "test.success"
+      pdl_interp.erase %root
+      pdl_interp.finalize
+    }
+  }
+}
+
+// CHECK-LABEL: test.root_kind_filter
+// CHECK: "test.success"
+// CHECK: "test.other"
+module @ir attributes { test.root_kind_filter } {
+  "test.op"() : () -> ()
+  "test.other"() : () -> ()
+}
@@ -0,0 +1,284 @@
+//===- BytecodeTest.cpp - MLIR bytecode unit tests ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/Bytecode/Encoding.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace mlir;
+
+static const char *const irWithForwardRefs = R"mlir(
+module {
+  func @f(%arg0: i32, %arg1: i1) -> i32 {
+    "test.br"(%arg0)[^bb2] : (i32) -> () loc("a.mlir":1:2)
+  ^bb1(%a: i32):
+    // %v is defined in ^bb2, which dominates ^bb1 but comes after it.
+    "test.use"(%v) : (i32) -> () loc(callsite("foo" at "b.mlir":3:4))
+    "test.return"(%a) : (i32) -> () loc(fused["a.mlir":5:6, unknown])
+  ^bb2(%b: i32):
+    %v = "test.op"(%b) {
+      dense = dense<[1, 2, 3]> : tensor<3xi32>,
+      splat = dense<1.5> : tensor<4x4xf32>,
+      bools = dense<[true, false, true]> : tensor<3xi1>,
+      list = [1 : i64, "str", i32, unit],
+      sym = @f
+    } : (i32) -> i32 loc("name"("c.mlir":7:8))
+    "test.br"(%v)[^bb1] : (i32) -> ()
+  }
+}
+)mlir";
+
+static std::string printWithLocs(ModuleOp module) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  module.print(os, OpPrintingFlags().enableDebugInfo());
+  return os.str();
+}
+
+static std::string writeBytecode(ModuleOp module) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  EXPECT_TRUE(succeeded(writeBytecodeToFile(module.getOperation(), os)));
+  return os.str();
+}
+
+/// Assemble a bytecode file from the payloads of its sections, in section
+/// kind order. Every integer in the payloads is encoded as a varint.
+static std::string
+buildBytecode(ArrayRef<std::vector<uint64_t>> sectionPayloads) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os.write(bytecode::kMagic, sizeof(bytecode::kMagic));
+  llvm::encodeULEB128(bytecode::kVersion, os);
+  for (auto it : llvm::enumerate(sectionPayloads)) {
+    std::string payload;
+    llvm::raw_string_ostream payloadOS(payload);
+    for (uint64_t value : it.value())
+      llvm::encodeULEB128(value, payloadOS);
+    os << static_cast<char>(it.index());
+    llvm::encodeULEB128(payloadOS.str().size(), os);
+    os << payloadOS.str();
+  }
+  return os.str();
+}
+
+/// Read the given IR section, preceded by tables holding the operation name
+/// "test.op" and the given attribute entries. The string table holds
+/// "test.op" at index 0 followed by `extraStrings`, which the type section
+/// may refer to. Returns the error emitted.
+static std::string
+readMalformed(std::vector<uint64_t> attrSection,
+              std::vector<uint64_t> irSection,
+              std::vector<uint64_t> typeSection = {0},
+              std::vector<uint64_t> blobSection = {0},
+              ArrayRef<StringRef> extraStrings = llvm::None) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  std::string errors;
+  ScopedDiagnosticHandler handler(&context, [&](Diagnostic &diag) {
+    errors += diag.str();
+    return success();
+  });
+
+  SmallVector<StringRef, 4> strings = {"test.op"};
+  strings.append(extraStrings.begin(), extraStrings.end());
+  std::vector<uint64_t> stringSection(1, strings.size());
+  for (StringRef str : strings) {
+    stringSection.push_back(str.size());
+    stringSection.insert(stringSection.end(), str.bytes_begin(),
+                         str.bytes_end());
+  }
+  std::string bytecode =
+      buildBytecode({stringSection, /*opNames=*/{1, 0}, typeSection,
+                     attrSection, blobSection, irSection});
+  EXPECT_FALSE(parseSourceString(bytecode, &context));
+  return errors;
+}
+
+namespace {
+TEST(BytecodeTest, RoundTrip) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module = parseSourceString(irWithForwardRefs, &context);
+  ASSERT_TRUE(module);
+
+  std::string bytecode = writeBytecode(*module);
+  ASSERT_TRUE(isBytecode(llvm::MemoryBufferRef(bytecode, "bytecode")));
+
+  // The parser detects bytecode input.
+  OwningModuleRef roundTripped = parseSourceString(bytecode, &context);
+  ASSERT_TRUE(roundTripped);
+  EXPECT_EQ(printWithLocs(*module), printWithLocs(*roundTripped));
+
+  // Writing the module again produces the same bytes.
+  EXPECT_EQ(bytecode, writeBytecode(*roundTripped));
+}
+
+TEST(BytecodeTest, RoundTripInFreshContext) {
+  std::string text, bytecode;
+  {
+    MLIRContext context;
+    context.allowUnregisteredDialects();
+    OwningModuleRef module = parseSourceString(irWithForwardRefs, &context);
+    ASSERT_TRUE(module);
+    text = printWithLocs(*module);
+    bytecode = writeBytecode(*module);
+  }
+
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module = parseSourceString(bytecode, &context);
+  ASSERT_TRUE(module);
+  EXPECT_EQ(text, printWithLocs(*module));
+}
+
+TEST(BytecodeTest, RejectsMalformedInput) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module = parseSourceString(irWithForwardRefs, &context);
+  ASSERT_TRUE(module);
+  std::string bytecode = writeBytecode(*module);
+
+  unsigned numErrors = 0;
+  ScopedDiagnosticHandler handler(&context, [&](Diagnostic &) {
+    ++numErrors;
+    return success();
+  });
+
+  // Truncated input.
+  std::string truncated = bytecode.substr(0, bytecode.size() / 2);
+  EXPECT_FALSE(parseSourceString(truncated, &context));
+  EXPECT_NE(numErrors, 0u);
+
+  // Unknown version.
+  numErrors = 0;
+  std::string badVersion = bytecode;
+  badVersion[4] = 0x7f;
+  EXPECT_FALSE(parseSourceString(badVersion, &context));
+  EXPECT_NE(numErrors, 0u);
+}
+
+TEST(BytecodeTest, RejectsOutOfRangeIndicesAndCounts) {
+  using bytecode::AttributeKind;
+  uint64_t unknownLoc = static_cast<uint64_t>(AttributeKind::UnknownLoc);
+  std::vector<uint64_t> attrs = {1, unknownLoc, /*payloadSize=*/0};
+
+  // An operand index past the declared number of values.
+  EXPECT_NE(readMalformed(attrs, {/*numValues=*/0, /*numOps=*/1,
+                                  /*name=*/0, /*loc=*/0,
+                                  bytecode::kHasOperands, /*numOperands=*/1,
+                                  /*index=*/1ULL << 62})
+                .find("invalid value index"),
+            std::string::npos);
+
+  // Counts that could not possibly fit in the remaining data.
+  EXPECT_NE(readMalformed(attrs, {/*numValues=*/1ULL << 62, /*numOps=*/0})
+                .find("invalid entry count"),
+            std::string::npos);
+  EXPECT_NE(readMalformed(attrs, {/*numValues=*/0, /*numOps=*/1,
+                                  /*name=*/0, /*loc=*/0,
+                                  bytecode::kHasRegions,
+                                  /*numRegions=*/1ULL << 40})
+                .find("invalid entry count"),
+            std::string::npos);
+
+  // A value declared but never defined.
+  EXPECT_NE(readMalformed(attrs, {/*numValues=*/1, /*numOps=*/1, /*name=*/0,
+                                  /*loc=*/0, /*mask=*/0})
+                .find("declares 1 values but defines 0"),
+            std::string::npos);
+}
+
+TEST(BytecodeTest, RejectsCyclicAttributes) {
+  // An array attribute whose only element is itself, used as a location.
+  uint64_t array = static_cast<uint64_t>(bytecode::AttributeKind::Array);
+  std::vector<uint64_t> attrs = {1, array, /*payloadSize=*/2,
+                                 /*numElements=*/1, /*element=*/0};
+  EXPECT_NE(readMalformed(attrs, {/*numValues=*/0, /*numOps=*/1, /*name=*/0,
+                                  /*loc=*/0, /*mask=*/0})
+                .find("cyclic reference to attribute at index 0"),
+            std::string::npos);
+}
+
+TEST(BytecodeTest, RejectsMalformedDenseElements) {
+  uint64_t dense = static_cast<uint64_t>(bytecode::AttributeKind::DenseElements);
+  auto denseAttr = [&](uint64_t isSplat) {
+    return std::vector<uint64_t>{1, dense, /*payloadSize=*/3, /*type=*/0,
+                                 isSplat, /*blob=*/0};
+  };
+  // The dense attribute is used as the location of the operation.
+  std::vector<uint64_t> ir = {/*numValues=*/0, /*numOps=*/1, /*name=*/0,
+                              /*loc=*/0, /*mask=*/0};
+  // One blob of 4 bytes, padded to the 8 byte alignment.
+  std::vector<uint64_t> oneElement = {1, 4, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0};
+  // One blob of 8 bytes.
+  std::vector<uint64_t> twoElements = {1, 8, 0, 0, 0, 0, 0, 0,
+                                       1, 0, 0, 0, 2, 0, 0, 0};
+  std::vector<uint64_t> types = {1, /*string=*/1};
+
+  // A splat flag that disagrees with the size of the data.
+  StringRef tensor2 = "tensor<2xi32>";
+  EXPECT_NE(readMalformed(denseAttr(/*isSplat=*/1), ir, types, twoElements,
+                          tensor2)
+                .find("splat flag does not match"),
+            std::string::npos);
+  EXPECT_NE(readMalformed(denseAttr(/*isSplat=*/0), ir, types, oneElement,
+                          tensor2)
+                .find("splat flag does not match"),
+            std::string::npos);
+  EXPECT_NE(readMalformed(denseAttr(/*isSplat=*/2), ir, types, oneElement,
+                          tensor2)
+                .find("splat flag does not match"),
+            std::string::npos);
+
+  // A type without a static shape.
+  EXPECT_NE(readMalformed(denseAttr(/*isSplat=*/1), ir, types, oneElement,
+                          StringRef("tensor<?xi32>"))
+                .find("invalid dense elements attribute"),
+            std::string::npos);
+  EXPECT_NE(readMalformed(denseAttr(/*isSplat=*/1), ir, types, oneElement,
+                          StringRef("tensor<*xi32>"))
+                .find("invalid dense elements attribute"),
+            std::string::npos);
+
+  // Well-formed data still gets past the attribute, and fails only because
+  // the location is not a location attribute.
+  EXPECT_NE(readMalformed(denseAttr(/*isSplat=*/0), ir, types, twoElements,
+                          tensor2)
+                .find("unexpected attribute kind"),
+            std::string::npos);
+}
+
+TEST(BytecodeTest, WriterRejectsValuesDefinedAbove) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module = parseSourceString(irWithForwardRefs, &context);
+  ASSERT_TRUE(module);
+
+  std::string errors;
+  ScopedDiagnosticHandler handler(&context, [&](Diagnostic &diag) {
+    errors += diag.str();
+    return success();
+  });
+
+  // The first operation of the function uses one of its arguments.
+  Operation &br = module->getBody()->front().getRegion(0).front().front();
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  EXPECT_TRUE(failed(writeBytecodeToFile(&br, os)));
+  EXPECT_TRUE(os.str().empty());
+  EXPECT_NE(errors.find("operand #0 is defined outside"), std::string::npos);
+}
+} // end anonymous namespace
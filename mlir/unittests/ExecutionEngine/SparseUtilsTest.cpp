@@ -0,0 +1,221 @@
+//===- SparseUtilsTest.cpp - Sparse runtime support library tests ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ParallelSort.h"
+#include "mlir/ExecutionEngine/CRunnerUtils.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+/// A sparse matrix file in the Matrix Market format, removed at the end of the
+/// test.
+class MatrixFile {
+public:
+  explicit MatrixFile(llvm::StringRef contents) {
+    int fd;
+    llvm::SmallString<64> tempPath;
+    EXPECT_FALSE(
+        llvm::sys::fs::createTemporaryFile("sparse", "mtx", fd, tempPath));
+    path = tempPath.str().str();
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << contents;
+  }
+  ~MatrixFile() { llvm::sys::fs::remove(path); }
+
+  /// The library takes the filename as a mutable string.
+  char *getPath() { return &path[0]; }
+
+private:
+  std::string path;
+};
+
+/// Read all of the elements of an opened tensor as (i, j, value) triples.
+static std::vector<std::vector<double>> readMatrix(void *tensor,
+                                                   uint64_t nnz) {
+  std::vector<std::vector<double>> elements;
+  for (uint64_t k = 0; k < nnz; k++) {
+    uint64_t idata[2];
+    double value;
+    readTensorItemC(tensor, idata, &value);
+    elements.push_back({double(idata[0]), double(idata[1]), value});
+  }
+  return elements;
+}
+
+template <typename T>
+static std::vector<T> toVector(const StridedMemRefType<T, 1> &ref) {
+  EXPECT_EQ(ref.strides[0], 1);
+  return std::vector<T>(ref.data + ref.offset,
+                        ref.data + ref.offset + ref.sizes[0]);
+}
+
+/// A 3x4 matrix with its elements out of order, and two entries for (0, 1).
+static const char *const unsortedMatrix =
+    "%%MatrixMarket matrix coordinate real general\n"
+    "% A comment.\n"
+    "3 4 5\n"
+    "3 4 5.0\n"
+    "1 2 1.0\n"
+    "2 1 2.0\n"
+    "1 2 0.5\n"
+    "3 1 3.0\n";
+
+TEST(SparseUtilsTest, OpenSortsElements) {
+  MatrixFile file(unsortedMatrix);
+  uint64_t idata[4];
+  void *tensor = openTensorC(file.getPath(), idata);
+  EXPECT_EQ(idata[0], 2u);
+  EXPECT_EQ(idata[1], 5u);
+  EXPECT_EQ(idata[2], 3u);
+  EXPECT_EQ(idata[3], 4u);
+
+  std::vector<std::vector<double>> elements = readMatrix(tensor, 5);
+  closeTensor(tensor);
+  // The order of the duplicates is unspecified.
+  EXPECT_EQ(elements[0][0], 0);
+  EXPECT_EQ(elements[0][1], 1);
+  EXPECT_EQ(elements[0][2] + elements[1][2], 1.5);
+  EXPECT_EQ(elements[1][0], 0);
+  EXPECT_EQ(elements[1][1], 1);
+  std::vector<std::vector<double>> rest(elements.begin() + 2, elements.end());
+  std::vector<std::vector<double>> expected = {
+      {1, 0, 2.0}, {2, 0, 3.0}, {2, 3, 5.0}};
+  EXPECT_EQ(rest, expected);
+}
+
+TEST(SparseUtilsTest, OpenSortsLongPermutation) {
+  // List the elements of a 10x100 matrix in the order k * 37 % 1000, which
+  // splits the sorting permutation into many cycles.
+  std::string contents;
+  llvm::raw_string_ostream os(contents);
+  os << "%%MatrixMarket matrix coordinate real general\n10 100 1000\n";
+  for (unsigned k = 0; k < 1000; k++) {
+    unsigned e = k * 37 % 1000;
+    os << e / 100 + 1 << " " << e % 100 + 1 << " " << e << "\n";
+  }
+  MatrixFile file(os.str());
+
+  uint64_t idata[4];
+  void *tensor = openTensorC(file.getPath(), idata);
+  std::vector<std::vector<double>> elements = readMatrix(tensor, 1000);
+  closeTensor(tensor);
+  for (unsigned e = 0; e < 1000; e++) {
+    std::vector<double> expected = {double(e / 100), double(e % 100),
+                                    double(e)};
+    EXPECT_EQ(elements[e], expected);
+  }
+}
+
+TEST(SparseUtilsTest, ParallelSortMatchesStdSort) {
+  // Enough elements for several chunks of the default size, with many
+  // duplicates, in a size that does not divide evenly into chunks.
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> input(3 * (1 << 16) + 12345);
+  for (uint64_t &value : input)
+    value = rng() % 50000;
+  std::vector<uint64_t> expected = input;
+  std::sort(expected.begin(), expected.end());
+
+  // Every number of chunks, including odd ones that leave a chunk unmerged
+  // in some rounds, and more threads than chunks.
+  for (size_t maxThreads : {1, 2, 3, 4, 7, 16}) {
+    std::vector<uint64_t> sorted = input;
+    mlir::runtime::parallelSort(sorted.begin(), sorted.end(),
+                                std::less<uint64_t>(), maxThreads);
+    EXPECT_EQ(sorted, expected) << "maxThreads = " << maxThreads;
+  }
+
+  // Small chunks exercise many merge rounds.
+  std::vector<uint64_t> sorted = input;
+  mlir::runtime::parallelSort(sorted.begin(), sorted.end(),
+                              std::less<uint64_t>(), /*maxThreads=*/13,
+                              /*minChunkSize=*/100);
+  EXPECT_EQ(sorted, expected);
+}
+
+TEST(SparseUtilsTest, OpenSortsLargeMatrix) {
+  // A 512x512 matrix with more elements than two default sort chunks, listed
+  // in a scrambled order, so that it is sorted in parallel on hosts with more
+  // than one hardware thread.
+  const unsigned n = 512, nnz = n * n;
+  std::string contents;
+  llvm::raw_string_ostream os(contents);
+  os << "%%MatrixMarket matrix coordinate real general\n"
+     << n << " " << n << " " << nnz << "\n";
+  for (unsigned k = 0; k < nnz; k++) {
+    unsigned e = (k * 40503u) % nnz;
+    os << e / n + 1 << " " << e % n + 1 << " " << e << "\n";
+  }
+  MatrixFile file(os.str());
+
+  uint64_t idata[4];
+  void *tensor = openTensorC(file.getPath(), idata);
+  std::vector<std::vector<double>> elements = readMatrix(tensor, nnz);
+  closeTensor(tensor);
+  for (unsigned e = 0; e < nnz; e++) {
+    std::vector<double> expected = {double(e / n), double(e % n), double(e)};
+    ASSERT_EQ(elements[e], expected);
+  }
+}
+
+TEST(SparseUtilsTest, PackCSR) {
+  MatrixFile file(unsortedMatrix);
+  uint64_t idata[4];
+  void *tensor = openTensorC(file.getPath(), idata);
+  uint8_t sparsity[] = {0, 1};
+  void *packed = packTensorC(tensor, sparsity);
+  // The packed tensor doesn't depend on the coordinate scheme.
+  closeTensor(tensor);
+
+  StridedMemRefType<uint64_t, 1> pointers, indices;
+  StridedMemRefType<double, 1> values;
+  _mlir_ciface_sparsePointers(&pointers, packed, 1);
+  _mlir_ciface_sparseIndices(&indices, packed, 1);
+  _mlir_ciface_sparseValues(&values, packed);
+  EXPECT_EQ(toVector(pointers), std::vector<uint64_t>({0, 1, 2, 4}));
+  EXPECT_EQ(toVector(indices), std::vector<uint64_t>({1, 0, 0, 3}));
+  // The duplicate entries are summed.
+  EXPECT_EQ(toVector(values), std::vector<double>({1.5, 2.0, 3.0, 5.0}));
+
+  // The dense dimension has no pointers or indices.
+  _mlir_ciface_sparsePointers(&pointers, packed, 0);
+  _mlir_ciface_sparseIndices(&indices, packed, 0);
+  EXPECT_EQ(pointers.sizes[0], 0);
+  EXPECT_EQ(indices.sizes[0], 0);
+  closePackedTensor(packed);
+}
+
+TEST(SparseUtilsTest, PackCSF) {
+  MatrixFile file(unsortedMatrix);
+  uint64_t idata[4];
+  void *tensor = openTensorC(file.getPath(), idata);
+  uint8_t sparsity[] = {1, 1};
+  void *packed = packTensorC(tensor, sparsity);
+  closeTensor(tensor);
+
+  StridedMemRefType<uint64_t, 1> pointers, indices;
+  StridedMemRefType<double, 1> values;
+  _mlir_ciface_sparsePointers(&pointers, packed, 0);
+  _mlir_ciface_sparseIndices(&indices, packed, 0);
+  EXPECT_EQ(toVector(pointers), std::vector<uint64_t>({0, 3}));
+  EXPECT_EQ(toVector(indices), std::vector<uint64_t>({0, 1, 2}));
+  _mlir_ciface_sparsePointers(&pointers, packed, 1);
+  _mlir_ciface_sparseIndices(&indices, packed, 1);
+  EXPECT_EQ(toVector(pointers), std::vector<uint64_t>({0, 1, 2, 4}));
+  EXPECT_EQ(toVector(indices), std::vector<uint64_t>({1, 0, 0, 3}));
+  _mlir_ciface_sparseValues(&values, packed);
+  EXPECT_EQ(toVector(values), std::vector<double>({1.5, 2.0, 3.0, 5.0}));
+  closePackedTensor(packed);
+}
+} // end anonymous namespace
@@ -0,0 +1,124 @@
+//===- WorkStealingThreadPoolTest.cpp - Async runtime thread pool tests ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "WorkStealingThreadPool.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+
+using namespace mlir::runtime;
+
+namespace {
+/// Submits a task that adds `value` to `sum`, and returns the flag that the
+/// task sets when it is done.
+std::shared_ptr<std::atomic<bool>> submitAdd(WorkStealingThreadPool &pool,
+                                             std::atomic<int> &sum, int value) {
+  auto done = std::make_shared<std::atomic<bool>>(false);
+  pool.submit([&pool, &sum, value, done]() {
+    sum.fetch_add(value);
+    done->store(true);
+    pool.notify();
+  });
+  return done;
+}
+
+/// Computes the `n`th Fibonacci number by spawning a task for `n - 1` and
+/// waiting on it from the calling worker, which runs `n - 2` in the meantime.
+/// Every level of the recursion blocks a worker in `helpUntil`.
+int fibonacci(WorkStealingThreadPool &pool, int n,
+              std::atomic<int> &numTasks) {
+  numTasks.fetch_add(1);
+  if (n < 2)
+    return n;
+  std::atomic<bool> done(false);
+  int first = 0;
+  pool.submit([&]() {
+    first = fibonacci(pool, n - 1, numTasks);
+    done.store(true);
+    pool.notify();
+  });
+  int second = fibonacci(pool, n - 2, numTasks);
+  pool.helpUntil([&]() { return done.load(); });
+  return first + second;
+}
+} // end anonymous namespace
+
+TEST(WorkStealingThreadPoolTest, RunsAllTasks) {
+  WorkStealingThreadPool pool(4);
+  std::atomic<int> sum(0);
+  for (int i = 1; i <= 1000; ++i)
+    submitAdd(pool, sum, i);
+  pool.wait();
+  EXPECT_EQ(sum.load(), 500500);
+}
+
+TEST(WorkStealingThreadPoolTest, TasksSubmitTasks) {
+  WorkStealingThreadPool pool(4);
+  std::atomic<int> sum(0);
+  for (int i = 0; i < 100; ++i)
+    pool.submit([&]() {
+      EXPECT_TRUE(pool.isWorkerThread());
+      for (int j = 0; j < 10; ++j)
+        submitAdd(pool, sum, 1);
+    });
+  pool.wait();
+  EXPECT_EQ(sum.load(), 1000);
+  EXPECT_FALSE(pool.isWorkerThread());
+}
+
+// With a single worker, a task waiting on a task it submitted can only make
+// progress if the worker runs the other task while it waits.
+TEST(WorkStealingThreadPoolTest, HelpWhileWaiting) {
+  WorkStealingThreadPool pool(1);
+  std::atomic<int> sum(0);
+  std::atomic<bool> outerDone(false);
+  pool.submit([&]() {
+    auto innerDone = submitAdd(pool, sum, 1);
+    pool.helpUntil([&]() { return innerDone->load(); });
+    EXPECT_EQ(sum.load(), 1);
+    outerDone.store(true);
+  });
+  pool.wait();
+  EXPECT_TRUE(outerDone.load());
+}
+
+// A task blocked in `helpUntil` is woken up by `notify` when the task it waits
+// on runs on another worker.
+TEST(WorkStealingThreadPoolTest, WaitForTaskOnAnotherWorker) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<bool> started(false), release(false), done(false);
+  pool.submit([&]() {
+    started.store(true);
+    while (!release.load())
+      std::this_thread::yield();
+    done.store(true);
+    pool.notify();
+  });
+  while (!started.load())
+    std::this_thread::yield();
+  pool.submit([&]() {
+    release.store(true);
+    pool.helpUntil([&]() { return done.load(); });
+  });
+  pool.wait();
+  EXPECT_TRUE(done.load());
+}
+
+// Nested awaits block more tasks than there are workers at once.
+TEST(WorkStealingThreadPoolTest, NestedAwaits) {
+  for (unsigned numWorkers : {1u, 2u, 4u}) {
+    WorkStealingThreadPool pool(numWorkers);
+    std::atomic<int> numTasks(0);
+    std::atomic<int> result(-1);
+    pool.submit([&]() { result.store(fibonacci(pool, 15, numTasks)); });
+    pool.wait();
+    EXPECT_EQ(result.load(), 610);
+    // fib(15) makes 2 * fib(16) - 1 calls.
+    EXPECT_EQ(numTasks.load(), 1973);
+  }
+}
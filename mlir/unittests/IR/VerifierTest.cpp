@@ -0,0 +1,90 @@
+//===- VerifierTest.cpp - MLIR verifier unit tests ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/Verifier.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "gtest/gtest.h"
+
+using namespace mlir;
+
+/// Append a function named `name` to `module`. If `valid` is false, the body
+/// of the function uses a value before it is defined.
+static void addFunction(ModuleOp module, StringRef name, bool valid) {
+  MLIRContext *context = module.getContext();
+  OpBuilder builder(context);
+  Location loc = FileLineColLoc::get(name, 0, 0, context);
+  FuncOp func = FuncOp::create(
+      loc, name, builder.getFunctionType(llvm::None, llvm::None));
+  module.push_back(func);
+
+  builder.setInsertionPointToStart(func.addEntryBlock());
+  OperationState defState(loc, "foo.def");
+  defState.addTypes(builder.getI32Type());
+  Operation *def = builder.createOperation(defState);
+  OperationState useState(loc, "foo.use");
+  useState.addOperands(def->getResult(0));
+  Operation *use = builder.createOperation(useState);
+  if (!valid)
+    use->moveBefore(def);
+}
+
+/// Verify `module` and return the filenames of the locations of the reported
+/// errors, in the order they were reported.
+static std::vector<std::string> verifyAndCollectErrors(ModuleOp module) {
+  std::vector<std::string> errors;
+  ScopedDiagnosticHandler handler(module.getContext(), [&](Diagnostic &diag) {
+    if (auto loc = diag.getLocation().dyn_cast<FileLineColLoc>())
+      errors.push_back(loc.getFilename().str());
+    return success();
+  });
+  EXPECT_TRUE(failed(verify(module)));
+  return errors;
+}
+
+namespace {
+TEST(VerifierTest, ParallelStopsAtFirstError) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  context.enableMultithreading();
+
+  OwningModuleRef module(ModuleOp::create(UnknownLoc::get(&context)));
+  for (unsigned i = 0; i < 32; ++i)
+    addFunction(*module, "f" + std::to_string(i), /*valid=*/i % 8 != 3);
+
+  // Only the first invalid function in the module is reported, whichever
+  // thread verified it first.
+  std::vector<std::string> expected = {"f3"};
+  for (unsigned i = 0; i < 4; ++i)
+    EXPECT_EQ(verifyAndCollectErrors(*module), expected);
+}
+
+TEST(VerifierTest, SequentialStopsAtFirstError) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  context.enableMultithreading(false);
+
+  OwningModuleRef module(ModuleOp::create(UnknownLoc::get(&context)));
+  for (unsigned i = 0; i < 32; ++i)
+    addFunction(*module, "f" + std::to_string(i), /*valid=*/i % 8 != 3);
+
+  std::vector<std::string> expected = {"f3"};
+  EXPECT_EQ(verifyAndCollectErrors(*module), expected);
+}
+
+TEST(VerifierTest, ValidModule) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+
+  OwningModuleRef module(ModuleOp::create(UnknownLoc::get(&context)));
+  for (unsigned i = 0; i < 32; ++i)
+    addFunction(*module, "f" + std::to_string(i), /*valid=*/true);
+  EXPECT_TRUE(succeeded(verify(*module)));
+}
+} // end namespace
@@ -0,0 +1,188 @@
+//===- DialectConversionTest.cpp - Dialect conversion unit tests ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Transforms/DialectConversion.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "gtest/gtest.h"
+
+using namespace mlir;
+
+namespace {
+/// Replace a "foo.a" operation with an operation named `replacementName`.
+struct ReplaceA : public ConversionPattern {
+  ReplaceA(MLIRContext *context, StringRef replacementName)
+      : ConversionPattern("foo.a", 1, context),
+        replacementName(replacementName) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    OperationState state(op->getLoc(), replacementName);
+    state.addTypes(op->getResultTypes());
+    rewriter.replaceOp(op, rewriter.createOperation(state)->getResults());
+    return success();
+  }
+
+  StringRef replacementName;
+};
+
+/// Update a "foo.a" operation in place by adding an attribute, which leaves it
+/// illegal.
+struct UpdateAInPlace : public ConversionPattern {
+  UpdateAInPlace(MLIRContext *context)
+      : ConversionPattern("foo.a", 1, context) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.updateRootInPlace(
+        op, [&] { op->setAttr("updated", rewriter.getUnitAttr()); });
+    return success();
+  }
+};
+
+/// This class contains the state shared by the tests: a function with a few
+/// "foo.a" operations, and a target where "foo.b" is legal and "foo.c" is
+/// illegal.
+class DialectConversionTest : public ::testing::Test {
+protected:
+  DialectConversionTest()
+      : module(ModuleOp::create(UnknownLoc::get(&context))), target(context) {
+    context.allowUnregisteredDialects();
+    OpBuilder builder(&context);
+    Location loc = UnknownLoc::get(&context);
+    func = FuncOp::create(loc, "f",
+                          builder.getFunctionType(llvm::None, llvm::None));
+    module->push_back(func);
+    builder.setInsertionPointToStart(func.addEntryBlock());
+    for (unsigned i = 0; i < 4; ++i) {
+      OperationState state(loc, "foo.a");
+      state.addTypes(builder.getI32Type());
+      builder.createOperation(state);
+    }
+
+    target.addLegalOp<FuncOp>();
+    target.setOpAction(OperationName("foo.b", &context),
+                       ConversionTarget::LegalizationAction::Legal);
+    target.setOpAction(OperationName("foo.c", &context),
+                       ConversionTarget::LegalizationAction::Illegal);
+  }
+
+  /// Return the number of operations named `name` in the function.
+  unsigned countOps(StringRef name) {
+    unsigned count = 0;
+    func.walk([&](Operation *op) {
+      count += op->getName().getStringRef() == name;
+    });
+    return count;
+  }
+
+  FrozenRewritePatternList getPatterns(StringRef replacementName) {
+    OwningRewritePatternList patterns;
+    patterns.insert<ReplaceA>(&context, replacementName);
+    return std::move(patterns);
+  }
+
+  MLIRContext context;
+  OwningModuleRef module;
+  FuncOp func;
+  ConversionTarget target;
+};
+} // end anonymous namespace
+
+TEST_F(DialectConversionTest, NoRollback) {
+  ConversionStatistics statistics;
+  ConversionConfig config;
+  config.allowPatternRollback = false;
+  config.statistics = &statistics;
+  ASSERT_TRUE(succeeded(
+      applyFullConversion(func, target, getPatterns("foo.b"), config)));
+
+  EXPECT_EQ(countOps("foo.a"), 0u);
+  EXPECT_EQ(countOps("foo.b"), 4u);
+  EXPECT_EQ(statistics.numRollbacks, 0u);
+  ASSERT_EQ(statistics.patterns.size(), 1u);
+  const ConversionPatternStatistics &patternStats =
+      statistics.patterns.front().second;
+  EXPECT_EQ(patternStats.numAttempts, 4u);
+  EXPECT_EQ(patternStats.numMatchFailures, 0u);
+  EXPECT_EQ(patternStats.numLegalizationFailures, 0u);
+  // Each application records a created operation and a replacement.
+  EXPECT_EQ(patternStats.numUndoLogEntries, 8u);
+}
+
+TEST_F(DialectConversionTest, RollbackOfIllegalResult) {
+  ConversionStatistics statistics;
+  ConversionConfig config;
+  config.statistics = &statistics;
+  ASSERT_TRUE(succeeded(
+      applyPartialConversion(func, target, getPatterns("foo.c"), config)));
+
+  // The rewrites were rolled back, leaving the original operations.
+  EXPECT_EQ(countOps("foo.a"), 4u);
+  EXPECT_EQ(countOps("foo.c"), 0u);
+  EXPECT_EQ(statistics.numRollbacks, 4u);
+  ASSERT_EQ(statistics.patterns.size(), 1u);
+  EXPECT_EQ(statistics.patterns.front().second.numLegalizationFailures, 4u);
+}
+
+TEST_F(DialectConversionTest, NoRollbackStillUndoesReplacements) {
+  ConversionStatistics statistics;
+  ConversionConfig config;
+  config.allowPatternRollback = false;
+  config.statistics = &statistics;
+  ASSERT_TRUE(succeeded(
+      applyPartialConversion(func, target, getPatterns("foo.c"), config)));
+
+  // Replacements are recorded in full even without rollback support, so the
+  // illegal results are still rolled back.
+  EXPECT_EQ(countOps("foo.a"), 4u);
+  EXPECT_EQ(countOps("foo.c"), 0u);
+  EXPECT_EQ(statistics.numRollbacks, 4u);
+}
+
+TEST_F(DialectConversionTest, DisallowedRollbackFails) {
+  ConversionConfig config;
+  config.allowPatternRollback = false;
+
+  std::vector<std::string> errors;
+  ScopedDiagnosticHandler handler(&context, [&](Diagnostic &diag) {
+    errors.push_back(diag.str());
+    return success();
+  });
+  OwningRewritePatternList patterns;
+  patterns.insert<UpdateAInPlace>(&context);
+  EXPECT_TRUE(failed(applyPartialConversion(func, target, std::move(patterns),
+                                            config)));
+  ASSERT_EQ(errors.size(), 1u);
+  EXPECT_NE(errors.front().find("required rolling back a pattern"),
+            std::string::npos);
+}
+
+TEST_F(DialectConversionTest, FailedConversionRecordsUndoLog) {
+  // An operation without a pattern after the "foo.a" operations makes the full
+  // conversion fail once they have been converted.
+  OpBuilder builder = OpBuilder::atBlockEnd(&func.front());
+  builder.createOperation(OperationState(UnknownLoc::get(&context), "foo.d"));
+
+  ConversionStatistics statistics;
+  ConversionConfig config;
+  config.statistics = &statistics;
+  ScopedDiagnosticHandler handler(&context, [](Diagnostic &) {
+    return success();
+  });
+  EXPECT_TRUE(failed(
+      applyFullConversion(func, target, getPatterns("foo.b"), config)));
+
+  // The rewrites of the four "foo.a" operations were discarded, but are still
+  // accounted for.
+  EXPECT_EQ(countOps("foo.a"), 4u);
+  EXPECT_EQ(statistics.maxUndoLogSize, 8u);
+}
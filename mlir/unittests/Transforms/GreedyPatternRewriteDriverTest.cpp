@@ -0,0 +1,207 @@
+//===- GreedyPatternRewriteDriverTest.cpp - Greedy driver unit tests ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "gtest/gtest.h"
+
+using namespace mlir;
+
+namespace {
+/// Rewrite a "foo.a" operation into a "foo.b" operation.
+struct RewriteA : public RewritePattern {
+  RewriteA(MLIRContext *context) : RewritePattern("foo.a", 1, context) {}
+
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    OperationState state(op->getLoc(), "foo.b");
+    state.addOperands(op->getOperands());
+    state.addTypes(op->getResultTypes());
+    rewriter.replaceOp(op, rewriter.createOperation(state)->getResults());
+    return success();
+  }
+};
+
+/// Rewrite a "foo.use" operation of a value defined by "foo.b" into a
+/// "foo.done" operation.
+struct RewriteUse : public RewritePattern {
+  RewriteUse(MLIRContext *context) : RewritePattern("foo.use", 1, context) {}
+
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    Operation *def = op->getOperand(0).getDefiningOp();
+    if (!def || def->getName().getStringRef() != "foo.b")
+      return failure();
+    OperationState state(op->getLoc(), "foo.done");
+    state.addOperands(op->getOperands());
+    rewriter.createOperation(state);
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+/// Switch the operand of a "foo.user" operation from a value defined by
+/// "foo.x" to the result of the operation after its definition.
+struct UpdateUser : public RewritePattern {
+  UpdateUser(MLIRContext *context) : RewritePattern("foo.user", 1, context) {}
+
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    Operation *def = op->getOperand(0).getDefiningOp();
+    if (!def || def->getName().getStringRef() != "foo.x")
+      return failure();
+    Value replacement = def->getNextNode()->getResult(0);
+    rewriter.updateRootInPlace(op, [&] { op->setOperand(0, replacement); });
+    return success();
+  }
+};
+
+/// Erase a "foo.x" operation without uses.
+struct EraseUnusedX : public RewritePattern {
+  EraseUnusedX(MLIRContext *context) : RewritePattern("foo.x", 1, context) {}
+
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!op->use_empty())
+      return failure();
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+} // end anonymous namespace
+
+/// Build a function with `n` pairs of "foo.a" and "foo.use" operations.
+static FuncOp buildFunction(ModuleOp module, unsigned n) {
+  MLIRContext *context = module.getContext();
+  OpBuilder builder(context);
+  Location loc = UnknownLoc::get(context);
+  FuncOp func = FuncOp::create(loc, "f",
+                               builder.getFunctionType(llvm::None, llvm::None));
+  module.push_back(func);
+
+  builder.setInsertionPointToStart(func.addEntryBlock());
+  for (unsigned i = 0; i < n; ++i) {
+    OperationState defState(loc, "foo.a");
+    defState.addTypes(builder.getI32Type());
+    Operation *def = builder.createOperation(defState);
+    OperationState useState(loc, "foo.use");
+    useState.addOperands(def->getResult(0));
+    builder.createOperation(useState);
+  }
+  return func;
+}
+
+/// Count the operations named `name` within `op`.
+static unsigned countOps(Operation *op, StringRef name) {
+  unsigned count = 0;
+  op->walk([&](Operation *nested) {
+    count += nested->getName().getStringRef() == name;
+  });
+  return count;
+}
+
+/// Rewrite a function with the given traversal settings, and check that every
+/// operation was rewritten.
+static GreedyRewriteStatistics rewrite(bool incremental, bool topDown) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module(ModuleOp::create(UnknownLoc::get(&context)));
+  FuncOp func = buildFunction(*module, 16);
+
+  OwningRewritePatternList patterns;
+  patterns.insert<RewriteA, RewriteUse>(&context);
+  FrozenRewritePatternList frozenPatterns(std::move(patterns));
+
+  GreedyRewriteStatistics statistics;
+  GreedyRewriteConfig config;
+  config.incremental = incremental;
+  config.useTopDownTraversal = topDown;
+  config.statistics = &statistics;
+  EXPECT_TRUE(succeeded(
+      applyPatternsAndFoldGreedily(func.getOperation(), frozenPatterns,
+                                   config)));
+
+  EXPECT_EQ(countOps(func.getOperation(), "foo.a"), 0u);
+  EXPECT_EQ(countOps(func.getOperation(), "foo.use"), 0u);
+  EXPECT_EQ(countOps(func.getOperation(), "foo.b"), 16u);
+  EXPECT_EQ(countOps(func.getOperation(), "foo.done"), 16u);
+  return statistics;
+}
+
+static unsigned getNumApplications(const GreedyRewriteStatistics &statistics) {
+  unsigned numApplications = 0;
+  for (auto &it : statistics.patterns)
+    numApplications += it.second.numApplications;
+  return numApplications;
+}
+
+TEST(GreedyPatternRewriteDriverTest, RescansUntilNoChange) {
+  GreedyRewriteStatistics statistics =
+      rewrite(/*incremental=*/false, /*topDown=*/false);
+  // The second scan finds nothing left to rewrite.
+  EXPECT_EQ(statistics.numIterations, 2u);
+  EXPECT_EQ(getNumApplications(statistics), 32u);
+}
+
+TEST(GreedyPatternRewriteDriverTest, IncrementalScansOnce) {
+  GreedyRewriteStatistics statistics =
+      rewrite(/*incremental=*/true, /*topDown=*/false);
+  EXPECT_EQ(statistics.numIterations, 1u);
+  EXPECT_EQ(getNumApplications(statistics), 32u);
+}
+
+TEST(GreedyPatternRewriteDriverTest, IncrementalTopDown) {
+  GreedyRewriteStatistics statistics =
+      rewrite(/*incremental=*/true, /*topDown=*/true);
+  EXPECT_EQ(statistics.numIterations, 1u);
+  EXPECT_EQ(getNumApplications(statistics), 32u);
+  // Visiting the definitions first means that every "foo.use" matches on its
+  // first attempt.
+  unsigned numAttempts = 0;
+  for (auto &it : statistics.patterns)
+    numAttempts += it.second.numAttempts;
+  EXPECT_EQ(numAttempts, 32u);
+}
+
+TEST(GreedyPatternRewriteDriverTest, IncrementalRequeuesReplacedOperands) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module(ModuleOp::create(UnknownLoc::get(&context)));
+  OpBuilder builder(&context);
+  Location loc = UnknownLoc::get(&context);
+  FuncOp func = FuncOp::create(loc, "f",
+                               builder.getFunctionType(llvm::None, llvm::None));
+  module->push_back(func);
+
+  builder.setInsertionPointToStart(func.addEntryBlock());
+  OperationState xState(loc, "foo.x"), yState(loc, "foo.y");
+  xState.addTypes(builder.getI32Type());
+  yState.addTypes(builder.getI32Type());
+  Operation *x = builder.createOperation(xState);
+  builder.createOperation(yState);
+  OperationState userState(loc, "foo.user");
+  userState.addOperands(x->getResult(0));
+  builder.createOperation(userState);
+
+  OwningRewritePatternList patterns;
+  patterns.insert<UpdateUser, EraseUnusedX>(&context);
+  FrozenRewritePatternList frozenPatterns(std::move(patterns));
+
+  // Top-down, "foo.x" is visited while it still has a use. It can only be
+  // erased if updating "foo.user" in place requeues it.
+  GreedyRewriteStatistics statistics;
+  GreedyRewriteConfig config;
+  config.incremental = true;
+  config.useTopDownTraversal = true;
+  config.statistics = &statistics;
+  EXPECT_TRUE(succeeded(applyPatternsAndFoldGreedily(
+      func.getOperation(), frozenPatterns, config)));
+  EXPECT_EQ(statistics.numIterations, 1u);
+  EXPECT_EQ(countOps(func.getOperation(), "foo.x"), 0u);
+}
@@ -39,6 +39,10 @@
 #define NUMBER_OF_DEVICES 4
 #define OFFLOADSECTIONNAME "omp_offloading_entries"
 
+// Submissions up to this size are copied into the queue when they are
+// enqueued, so the caller may pass the address of a temporary.
+#define MAX_STAGED_SUBMIT_SIZE 256
+
 /// Array of Dynamic libraries loaded for this target.
 struct DynLibTy {
   char *FileName;
@@ -50,6 +54,89 @@ struct FuncOrGblEntryTy {
   __tgt_target_table Table;
 };
 
+/// Asynchronous queue handed out through __tgt_async_info::Queue.
+///
+/// The device shares the host address space, so transfers are plain memcpys.
+/// They are deferred until the next kernel launch or synchronization of the
+/// queue, and a transfer that continues the last pending one of the queue is
+/// merged into it. Both are performed by the host thread which owns the
+/// queue, so target regions of different host threads still run concurrently
+/// and kernels run on the encountering thread, as in the synchronous case.
+class AsyncQueueTy {
+  /// Copy Size bytes from Src (or from Staged, if not empty) to Dst.
+  struct CopyTy {
+    void *Dst;
+    void *Src;
+    int64_t Size;
+    std::vector<char> Staged;
+  };
+  std::vector<CopyTy> Copies;
+
+  // Try to merge a transfer into the last pending one.
+  bool coalesce(void *Dst, void *Src, int64_t Size, bool Stage) {
+    if (Copies.empty())
+      return false;
+    CopyTy &Last = Copies.back();
+    if ((char *)Last.Dst + Last.Size != Dst ||
+        Last.Staged.empty() != !Stage)
+      return false;
+    if (Stage) {
+      if (Last.Size + Size > MAX_STAGED_SUBMIT_SIZE)
+        return false;
+      Last.Staged.insert(Last.Staged.end(), (char *)Src, (char *)Src + Size);
+    } else if ((char *)Last.Src + Last.Size != Src) {
+      return false;
+    }
+    Last.Size += Size;
+    return true;
+  }
+
+public:
+  /// Returns the queue of AsyncInfo, creating it if needed.
+  static AsyncQueueTy &get(__tgt_async_info *AsyncInfo) {
+    if (!AsyncInfo->Queue)
+      AsyncInfo->Queue = new AsyncQueueTy();
+    return *reinterpret_cast<AsyncQueueTy *>(AsyncInfo->Queue);
+  }
+
+  void enqueueCopy(void *Dst, void *Src, int64_t Size, bool Stage) {
+    if (Size == 0)
+      return;
+    if (coalesce(Dst, Src, Size, Stage)) {
+      DP("Merged %" PRId64 " bytes into pending transfer to " DPxMOD "\n",
+         Size, DPxPTR(Copies.back().Dst));
+      return;
+    }
+
+    CopyTy Copy;
+    Copy.Dst = Dst;
+    Copy.Src = Src;
+    Copy.Size = Size;
+    if (Stage)
+      Copy.Staged.assign((char *)Src, (char *)Src + Size);
+    Copies.push_back(std::move(Copy));
+  }
+
+  /// Performs all pending transfers, in the order they were enqueued.
+  void flush() {
+    for (CopyTy &Copy : Copies)
+      memcpy(Copy.Dst, Copy.Staged.empty() ? Copy.Src : Copy.Staged.data(),
+             Copy.Size);
+    Copies.clear();
+  }
+
+  /// Performs the pending transfers and releases the queue of AsyncInfo.
+  static int32_t synchronize(__tgt_async_info *AsyncInfo) {
+    auto *Queue = reinterpret_cast<AsyncQueueTy *>(AsyncInfo->Queue);
+    if (!Queue)
+      return OFFLOAD_SUCCESS;
+    Queue->flush();
+    delete Queue;
+    AsyncInfo->Queue = nullptr;
+    return OFFLOAD_SUCCESS;
+  }
+};
+
 /// Class containing all the device information.
 class RTLDeviceInfoTy {
   std::vector<std::list<FuncOrGblEntryTy>> FuncGblEntries;
@@ -264,12 +351,31 @@ int32_t __tgt_rtl_data_submit(int32_t device_id, void *tgt_ptr, void *hst_ptr,
   return OFFLOAD_SUCCESS;
 }
 
+int32_t __tgt_rtl_data_submit_async(int32_t device_id, void *tgt_ptr,
+                                    void *hst_ptr, int64_t size,
+                                    __tgt_async_info *async_info_ptr) {
+  assert(async_info_ptr && "async_info_ptr is nullptr");
+  AsyncQueueTy::get(async_info_ptr)
+      .enqueueCopy(tgt_ptr, hst_ptr, size,
+                   /*Stage=*/size <= MAX_STAGED_SUBMIT_SIZE);
+  return OFFLOAD_SUCCESS;
+}
+
 int32_t __tgt_rtl_data_retrieve(int32_t device_id, void *hst_ptr, void *tgt_ptr,
                                 int64_t size) {
   memcpy(hst_ptr, tgt_ptr, size);
   return OFFLOAD_SUCCESS;
 }
 
+int32_t __tgt_rtl_data_retrieve_async(int32_t device_id, void *hst_ptr,
+                                      void *tgt_ptr, int64_t size,
+                                      __tgt_async_info *async_info_ptr) {
+  assert(async_info_ptr && "async_info_ptr is nullptr");
+  AsyncQueueTy::get(async_info_ptr)
+      .enqueueCopy(hst_ptr, tgt_ptr, size, /*Stage=*/false);
+  return OFFLOAD_SUCCESS;
+}
+
 int32_t __tgt_rtl_data_delete(int32_t device_id, void *tgt_ptr) {
   free(tgt_ptr);
   return OFFLOAD_SUCCESS;
@@ -320,6 +426,36 @@ int32_t __tgt_rtl_run_target_region(int32_t device_id, void *tgt_entry_ptr,
                                           tgt_offsets, arg_num, 1, 1, 0);
 }
 
+int32_t __tgt_rtl_run_target_team_region_async(
+    int32_t device_id, void *tgt_entry_ptr, void **tgt_args,
+    ptrdiff_t *tgt_offsets, int32_t arg_num, int32_t team_num,
+    int32_t thread_limit, uint64_t loop_tripcount,
+    __tgt_async_info *async_info_ptr) {
+  assert(async_info_ptr && "async_info_ptr is nullptr");
+  // The kernel runs on the calling thread once its inputs are transferred.
+  AsyncQueueTy::get(async_info_ptr).flush();
+  return __tgt_rtl_run_target_team_region(device_id, tgt_entry_ptr, tgt_args,
+                                          tgt_offsets, arg_num, team_num,
+                                          thread_limit, loop_tripcount);
+}
+
+int32_t __tgt_rtl_run_target_region_async(int32_t device_id,
+                                          void *tgt_entry_ptr, void **tgt_args,
+                                          ptrdiff_t *tgt_offsets,
+                                          int32_t arg_num,
+                                          __tgt_async_info *async_info_ptr) {
+  // use one team and one thread.
+  return __tgt_rtl_run_target_team_region_async(
+      device_id, tgt_entry_ptr, tgt_args, tgt_offsets, arg_num, 1, 1, 0,
+      async_info_ptr);
+}
+
+int32_t __tgt_rtl_synchronize(int32_t device_id,
+                              __tgt_async_info *async_info_ptr) {
+  assert(async_info_ptr && "async_info_ptr is nullptr");
+  return AsyncQueueTy::synchronize(async_info_ptr);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -121,7 +121,7 @@ uint64_t DeviceTy::getMapEntryRefCnt(void *HstPtrBegin) {
   uintptr_t hp = (uintptr_t)HstPtrBegin;
   uint64_t RefCnt = 0;
 
-  DataMapMtx.lock();
+  DataMapMtx.lock_shared();
   if (!HostDataToTargetMap.empty()) {
     auto upper = HostDataToTargetMap.upper_bound(hp);
     if (upper != HostDataToTargetMap.begin()) {
@@ -132,7 +132,7 @@ uint64_t DeviceTy::getMapEntryRefCnt(void *HstPtrBegin) {
       }
     }
   }
-  DataMapMtx.unlock();
+  DataMapMtx.unlock_shared();
 
   if (RefCnt == 0) {
     DP("DeviceTy::getMapEntry: requested entry not found\n");
@@ -186,6 +186,31 @@ LookupResult DeviceTy::lookupMapping(void *HstPtrBegin, int64_t Size) {
   return lr;
 }
 
+// Return the target pointer corresponding to HstPtrBegin in the existing
+// mapping found by lookupMapping, incrementing its reference count if
+// requested. Only the (atomic) reference count is modified, so DataMapMtx may
+// be held in shared mode.
+static void *useExistingMapping(DeviceTy &Device, const LookupResult &lr,
+                                void *HstPtrBegin, int64_t Size,
+                                map_var_info_t HstPtrName, bool IsImplicit,
+                                bool UpdateRefCount) {
+  auto &HT = *lr.Entry;
+
+  if (UpdateRefCount)
+    HT.incRefCount();
+
+  uintptr_t tp = HT.TgtPtrBegin + ((uintptr_t)HstPtrBegin - HT.HstPtrBegin);
+  INFO(OMP_INFOTYPE_MAPPING_EXISTS, Device.DeviceID,
+       "Mapping exists%s with HstPtrBegin=" DPxMOD ", TgtPtrBegin=" DPxMOD
+       ", "
+       "Size=%" PRId64 ",%s RefCount=%s, Name=%s\n",
+       (IsImplicit ? " (implicit)" : ""), DPxPTR(HstPtrBegin), DPxPTR(tp),
+       Size, (UpdateRefCount ? " updated" : ""),
+       HT.isRefCountInf() ? "INF" : std::to_string(HT.getRefCount()).c_str(),
+       (HstPtrName) ? getNameFromMapping(HstPtrName).c_str() : "unknown");
+  return (void *)tp;
+}
+
 // Used by targetDataBegin
 // Return the target pointer begin (where the data will be moved).
 // Allocate memory if this is the first occurrence of this mapping.
@@ -200,8 +225,24 @@ void *DeviceTy::getOrAllocTgtPtr(void *HstPtrBegin, void *HstPtrBase,
   void *rc = NULL;
   IsHostPtr = false;
   IsNew = false;
-  DataMapMtx.lock();
+
+  // Fast path: the data is mapped already, which is the common case for
+  // target regions inside a target data region. This only bumps the reference
+  // count, so threads offloading concurrently do not serialize here.
+  DataMapMtx.lock_shared();
   LookupResult lr = lookupMapping(HstPtrBegin, Size);
+  if (lr.Flags.IsContained ||
+      ((lr.Flags.ExtendsBefore || lr.Flags.ExtendsAfter) && IsImplicit)) {
+    rc = useExistingMapping(*this, lr, HstPtrBegin, Size, HstPtrName,
+                            IsImplicit, UpdateRefCount);
+    DataMapMtx.unlock_shared();
+    return rc;
+  }
+  DataMapMtx.unlock_shared();
+
+  DataMapMtx.lock();
+  // The map may have changed while the lock was released
+  lr = lookupMapping(HstPtrBegin, Size);
 
   // Check if the pointer is contained.
   // If a variable is mapped to the device manually by the user - which would
@@ -209,22 +250,8 @@ void *DeviceTy::getOrAllocTgtPtr(void *HstPtrBegin, void *HstPtrBase,
   // device address is returned even under unified memory conditions.
   if (lr.Flags.IsContained ||
       ((lr.Flags.ExtendsBefore || lr.Flags.ExtendsAfter) && IsImplicit)) {
-    auto &HT = *lr.Entry;
-    IsNew = false;
-
-    if (UpdateRefCount)
-      HT.incRefCount();
-
-    uintptr_t tp = HT.TgtPtrBegin + ((uintptr_t)HstPtrBegin - HT.HstPtrBegin);
-    INFO(OMP_INFOTYPE_MAPPING_EXISTS, DeviceID,
-         "Mapping exists%s with HstPtrBegin=" DPxMOD ", TgtPtrBegin=" DPxMOD
-         ", "
-         "Size=%" PRId64 ",%s RefCount=%s, Name=%s\n",
-         (IsImplicit ? " (implicit)" : ""), DPxPTR(HstPtrBegin), DPxPTR(tp),
-         Size, (UpdateRefCount ? " updated" : ""),
-         HT.isRefCountInf() ? "INF" : std::to_string(HT.getRefCount()).c_str(),
-         (HstPtrName) ? getNameFromMapping(HstPtrName).c_str() : "unknown");
-    rc = (void *)tp;
+    rc = useExistingMapping(*this, lr, HstPtrBegin, Size, HstPtrName,
+                            IsImplicit, UpdateRefCount);
   } else if ((lr.Flags.ExtendsBefore || lr.Flags.ExtendsAfter) && !IsImplicit) {
     // Explicit extension of mapped data - not allowed.
     MESSAGE("explicit extension not allowed: host address specified is " DPxMOD
@@ -285,16 +312,18 @@ void *DeviceTy::getTgtPtrBegin(void *HstPtrBegin, int64_t Size, bool &IsLast,
   void *rc = NULL;
   IsHostPtr = false;
   IsLast = false;
-  DataMapMtx.lock();
+  // The last reference is released by deallocTgtPtr, so only the reference
+  // count may change here and a shared lock is sufficient.
+  DataMapMtx.lock_shared();
   LookupResult lr = lookupMapping(HstPtrBegin, Size);
 
   if (lr.Flags.IsContained ||
       (!MustContain && (lr.Flags.ExtendsBefore || lr.Flags.ExtendsAfter))) {
     auto &HT = *lr.Entry;
-    IsLast = HT.getRefCount() == 1;
-
-    if (!IsLast && UpdateRefCount)
-      HT.decRefCount();
+    if (UpdateRefCount)
+      IsLast = HT.decRefCountUnlessLast();
+    else
+      IsLast = HT.getRefCount() == 1;
 
     uintptr_t tp = HT.TgtPtrBegin + ((uintptr_t)HstPtrBegin - HT.HstPtrBegin);
     DP("Mapping exists with HstPtrBegin=" DPxMOD ", TgtPtrBegin=" DPxMOD ", "
@@ -312,7 +341,7 @@ void *DeviceTy::getTgtPtrBegin(void *HstPtrBegin, int64_t Size, bool &IsLast,
     rc = HstPtrBegin;
   }
 
-  DataMapMtx.unlock();
+  DataMapMtx.unlock_shared();
   return rc;
 }
 
@@ -444,7 +473,7 @@ int32_t DeviceTy::dataExchange(void *SrcPtr, DeviceTy &DstDev, void *DstPtr,
 int32_t DeviceTy::runRegion(void *TgtEntryPtr, void **TgtVarsPtr,
                             ptrdiff_t *TgtOffsets, int32_t TgtVarsSize,
                             __tgt_async_info *AsyncInfoPtr) {
-  if (!AsyncInfoPtr || !RTL->run_region || !RTL->synchronize)
+  if (!AsyncInfoPtr || !RTL->run_region_async || !RTL->synchronize)
     return RTL->run_region(RTLDeviceID, TgtEntryPtr, TgtVarsPtr, TgtOffsets,
                            TgtVarsSize);
   else
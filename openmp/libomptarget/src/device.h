@@ -13,6 +13,7 @@
 #ifndef _OMPTARGET_DEVICE_H
 #define _OMPTARGET_DEVICE_H
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <list>
@@ -20,6 +21,7 @@
 #include <memory>
 #include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <vector>
 
 #include "rtl.h"
@@ -51,7 +53,10 @@ struct HostDataToTargetTy {
 
 private:
   /// use mutable to allow modification via std::set iterator which is const.
-  mutable uint64_t RefCount;
+  /// The count is atomic so that lookups holding DataMapMtx in shared mode can
+  /// update it concurrently; the entry itself is only inserted or erased with
+  /// DataMapMtx held exclusively.
+  mutable std::atomic<uint64_t> RefCount;
   static const uint64_t INFRefCount = ~(uint64_t)0;
 
 public:
@@ -60,37 +65,72 @@ public:
       : HstPtrBase(BP), HstPtrBegin(B), HstPtrEnd(E), HstPtrName(Name),
         TgtPtrBegin(TB), RefCount(IsINF ? INFRefCount : 1) {}
 
+  HostDataToTargetTy(const HostDataToTargetTy &Other)
+      : HstPtrBase(Other.HstPtrBase), HstPtrBegin(Other.HstPtrBegin),
+        HstPtrEnd(Other.HstPtrEnd), HstPtrName(Other.HstPtrName),
+        TgtPtrBegin(Other.TgtPtrBegin), RefCount(Other.getRefCount()) {}
+
+  HostDataToTargetTy &operator=(const HostDataToTargetTy &Other) {
+    HstPtrBase = Other.HstPtrBase;
+    HstPtrBegin = Other.HstPtrBegin;
+    HstPtrEnd = Other.HstPtrEnd;
+    HstPtrName = Other.HstPtrName;
+    TgtPtrBegin = Other.TgtPtrBegin;
+    RefCount.store(Other.getRefCount(), std::memory_order_relaxed);
+    return *this;
+  }
+
   uint64_t getRefCount() const {
-    return RefCount;
+    return RefCount.load(std::memory_order_relaxed);
   }
 
   uint64_t resetRefCount() const {
-    if (RefCount != INFRefCount)
-      RefCount = 1;
+    if (isRefCountInf())
+      return INFRefCount;
 
-    return RefCount;
+    RefCount.store(1, std::memory_order_relaxed);
+    return 1;
   }
 
   uint64_t incRefCount() const {
-    if (RefCount != INFRefCount) {
-      ++RefCount;
-      assert(RefCount < INFRefCount && "refcount overflow");
-    }
+    if (isRefCountInf())
+      return INFRefCount;
 
-    return RefCount;
+    uint64_t NewCount = RefCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    assert(NewCount < INFRefCount && "refcount overflow");
+    return NewCount;
   }
 
   uint64_t decRefCount() const {
-    if (RefCount != INFRefCount) {
-      assert(RefCount > 0 && "refcount underflow");
-      --RefCount;
-    }
+    if (isRefCountInf())
+      return INFRefCount;
+
+    uint64_t OldCount = RefCount.fetch_sub(1, std::memory_order_relaxed);
+    assert(OldCount > 0 && "refcount underflow");
+    return OldCount - 1;
+  }
 
-    return RefCount;
+  /// Decrement the reference count unless this is the last reference, which
+  /// has to be released with DataMapMtx held exclusively. Return true if the
+  /// last reference was found (and not released).
+  bool decRefCountUnlessLast() const {
+    if (isRefCountInf())
+      return false;
+
+    uint64_t Count = RefCount.load(std::memory_order_relaxed);
+    do {
+      if (Count == 1)
+        return true;
+      assert(Count > 0 && "refcount underflow");
+    } while (!RefCount.compare_exchange_weak(Count, Count - 1,
+                                             std::memory_order_relaxed));
+    return false;
   }
 
+  /// The infinite count is only set at construction, so this does not race
+  /// with updates of the count.
   bool isRefCountInf() const {
-    return RefCount == INFRefCount;
+    return getRefCount() == INFRefCount;
   }
 };
 
@@ -150,7 +190,11 @@ struct DeviceTy {
 
   ShadowPtrListTy ShadowPtrMap;
 
-  std::mutex DataMapMtx, PendingGlobalsMtx, ShadowMtx;
+  /// Guards HostDataToTargetMap. Lookups that only update the reference count
+  /// of an existing entry take it in shared mode; inserting or erasing entries
+  /// requires exclusive ownership.
+  std::shared_timed_mutex DataMapMtx;
+  std::mutex PendingGlobalsMtx, ShadowMtx;
 
   // NOTE: Once libomp gains full target-task support, this state should be
   // moved into the target task in libomp.
@@ -601,7 +601,16 @@ int targetDataEnd(ident_t *loc, DeviceTy &Device, int32_t ArgNum,
           break;
 
         // If we copied the struct to the host, we need to restore the pointer.
+        // The copy may still be in flight, so wait for it to land first.
         if (ArgTypes[I] & OMP_TGT_MAPTYPE_FROM) {
+          if (AsyncInfo && AsyncInfo->Queue) {
+            Ret = Device.synchronize(AsyncInfo);
+            if (Ret != OFFLOAD_SUCCESS) {
+              Device.ShadowMtx.unlock();
+              REPORT("Failed to synchronize device.\n");
+              return OFFLOAD_FAIL;
+            }
+          }
           DP("Restoring original host pointer value " DPxMOD " for host "
              "pointer " DPxMOD "\n",
              DPxPTR(Itr->second.HstPtrVal), DPxPTR(ShadowHstPtrAddr));
@@ -1309,5 +1318,15 @@ int target(ident_t *loc, int64_t DeviceId, void *HostPtr, int32_t ArgNum,
     }
   }
 
+  // The kernel itself may still be running if there was no data to transfer
+  // back.
+  if (AsyncInfo.Queue) {
+    Ret = Device.synchronize(&AsyncInfo);
+    if (Ret != OFFLOAD_SUCCESS) {
+      REPORT("Failed to synchronize device.\n");
+      return OFFLOAD_FAIL;
+    }
+  }
+
   return OFFLOAD_SUCCESS;
 }
@@ -0,0 +1,52 @@
+// RUN: %libomptarget-compilexx-run-and-check-aarch64-unknown-linux-gnu
+// RUN: %libomptarget-compilexx-run-and-check-powerpc64-ibm-linux-gnu
+// RUN: %libomptarget-compilexx-run-and-check-powerpc64le-ibm-linux-gnu
+// RUN: %libomptarget-compilexx-run-and-check-x86_64-pc-linux-gnu
+// RUN: %libomptarget-compilexx-run-and-check-nvptx64-nvidia-cuda
+
+// Many host threads offload target regions that map data already mapped by an
+// enclosing target data region, so the reference count of the same entries is
+// updated concurrently. The mapping must survive until the end of the data
+// region and be removed afterwards.
+
+#include <cassert>
+#include <iostream>
+#include <omp.h>
+
+int main(int argc, char *argv[]) {
+  constexpr const int num_threads = 64, N = 1024, iters = 16;
+  int data[N];
+  int sums[num_threads] = {0};
+
+  for (int j = 0; j < N; ++j)
+    data[j] = j;
+
+#pragma omp target data map(to : data)
+  {
+#pragma omp parallel for num_threads(8)
+    for (int i = 0; i < num_threads; ++i) {
+      for (int k = 0; k < iters; ++k) {
+        int sum = 0;
+#pragma omp target map(to : data) map(tofrom : sum)
+        for (int j = 0; j < N; ++j)
+          sum += data[j];
+        sums[i] += sum;
+      }
+    }
+
+    // Still mapped by the enclosing data region
+    assert(omp_target_is_present(data, omp_get_default_device()));
+  }
+
+  assert(!omp_target_is_present(data, omp_get_default_device()));
+
+  // Verify
+  for (int i = 0; i < num_threads; ++i)
+    assert(sums[i] == iters * (N - 1) * N / 2);
+
+  std::cout << "PASS\n";
+
+  return 0;
+}
+
+// CHECK: PASS
@@ -0,0 +1,68 @@
+// RUN: %libomptarget-compile-run-and-check-aarch64-unknown-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-powerpc64-ibm-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-powerpc64le-ibm-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-x86_64-pc-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-nvptx64-nvidia-cuda
+
+// Transfers of a target region are queued and may be merged with each other;
+// check that the host observes all of them once the region returns.
+
+#include <stdio.h>
+
+#define N 1024
+#define ITERS 100
+
+struct S {
+  int *P;
+  int V[4];
+};
+
+int A[N];
+int Counter;
+
+int main(void) {
+  int B[N];
+  int Small = 0;
+  struct S Obj = {B, {0, 0, 0, 0}};
+
+  for (int I = 0; I < N; ++I)
+    A[I] = B[I] = I;
+
+  int Errors = 0;
+  for (int It = 0; It < ITERS; ++It) {
+    // Adjacent sections of the same array, plus a small scalar.
+#pragma omp target map(tofrom : A[0 : N / 2], A[N / 2 : N / 2], Small)
+    {
+      for (int I = 0; I < N; ++I)
+        A[I] += 1;
+      Small += 1;
+    }
+
+    // The struct contains a pointer attached on the device; its host value
+    // must be restored after the struct is copied back.
+#pragma omp target map(tofrom : Obj) map(tofrom : Obj.P[0 : N])
+    {
+      for (int I = 0; I < N; ++I)
+        Obj.P[I] += 1;
+      Obj.V[It % 4] += 1;
+    }
+
+    // A region without any data to transfer back.
+#pragma omp target
+    { Counter += 0; }
+
+    if (Obj.P != B)
+      ++Errors;
+  }
+
+  for (int I = 0; I < N; ++I)
+    if (A[I] != I + ITERS || B[I] != I + ITERS)
+      ++Errors;
+  if (Small != ITERS ||
+      Obj.V[0] + Obj.V[1] + Obj.V[2] + Obj.V[3] != ITERS)
+    ++Errors;
+
+  // CHECK: Errors: 0
+  printf("Errors: %d\n", Errors);
+  return Errors != 0;
+}
@@ -0,0 +1,60 @@
+// RUN: %libomptarget-compile-run-and-check-aarch64-unknown-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-powerpc64-ibm-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-powerpc64le-ibm-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-x86_64-pc-linux-gnu
+// RUN: %libomptarget-compile-run-and-check-nvptx64-nvidia-cuda
+
+// Timed driver for target regions that map many small arrays, where the
+// per-transfer overhead dominates. Half of the arrays are adjacent members
+// of one struct, which the queue can coalesce; the others are separate
+// objects. Reports target regions per second. The default size keeps the test
+// short; pass the number of iterations to measure longer runs, e.g.
+// "./a.out 100000".
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define M 8
+
+struct {
+  int B0[M], B1[M], B2[M], B3[M];
+} S;
+int A0[M], A1[M], A2[M], A3[M];
+
+int main(int argc, char **argv) {
+  int Iters = argc > 1 ? atoi(argv[1]) : 1000;
+  int Errors = 0;
+
+  double Start = omp_get_wtime();
+  for (int It = 0; It < Iters; ++It) {
+#pragma omp target map(tofrom : S.B0, S.B1, S.B2, S.B3, A0, A1, A2, A3)
+    {
+      for (int I = 0; I < M; ++I) {
+        S.B0[I] += 1;
+        S.B1[I] += 1;
+        S.B2[I] += 1;
+        S.B3[I] += 1;
+        A0[I] += 1;
+        A1[I] += 1;
+        A2[I] += 1;
+        A3[I] += 1;
+      }
+    }
+  }
+  double Elapsed = omp_get_wtime() - Start;
+  fprintf(stderr, "%d target regions in %.3f s, %.0f regions/s\n", Iters,
+          Elapsed, Iters / Elapsed);
+
+  for (int I = 0; I < M; ++I)
+    if (S.B0[I] != Iters || S.B1[I] != Iters || S.B2[I] != Iters ||
+        S.B3[I] != Iters)
+      ++Errors;
+  for (int I = 0; I < M; ++I)
+    if (A0[I] != Iters || A1[I] != Iters || A2[I] != Iters || A3[I] != Iters)
+      ++Errors;
+
+  // CHECK: Errors: 0
+  printf("Errors: %d\n", Errors);
+  return Errors != 0;
+}
@@ -2250,6 +2250,7 @@ typedef struct kmp_base_depnode {
   kmp_lock_t *mtx_locks[MAX_MTX_DEPS]; /* lock mutexinoutset dependent tasks */
   kmp_int32 mtx_num_locks; /* number of locks in mtx_locks array */
   kmp_lock_t lock; /* guards shared fields: task, successors */
+  kmp_int32 tg_id; /* node index in the task graph being recorded, or -1 */
 #if KMP_SUPPORT_GRAPH_OUTPUT
   kmp_uint32 id;
 #endif
@@ -2268,19 +2269,45 @@ struct kmp_dephash_entry {
   kmp_depnode_t *last_out;
   kmp_depnode_list_t *last_ins;
   kmp_depnode_list_t *last_mtxs;
-  kmp_int32 last_flag;
+  kmp_int32 last_flag; /* ENTRY_UNUSED marks a free slot of the table */
   kmp_lock_t *mtx_lock; /* is referenced by depnodes w/mutexinoutset dep */
-  kmp_dephash_entry_t *next_in_bucket;
 };
 
+// Open-addressed (linear probing) table; entries are stored inline and size
+// is always a power of two.
 typedef struct kmp_dephash {
-  kmp_dephash_entry_t **buckets;
+  kmp_dephash_entry_t *entries;
   size_t size;
-  size_t generation;
-  kmp_uint32 nelements;
-  kmp_uint32 nconflicts;
+  size_t nelements;
 } kmp_dephash_t;
 
+// Task graph record-and-replay (see __kmpc_taskgraph_begin)
+typedef struct kmp_taskgraph_node {
+  kmp_taskdata_t *td_template; // copy of the task taken when it was created
+  size_t sizeof_kmp_task_t; // sizes to pass to __kmp_task_alloc on replay
+  size_t sizeof_shareds;
+  kmp_int32 npredecessors; // number of recorded incoming edges
+  kmp_int32 nsuccessors; // number of recorded outgoing edges
+  kmp_int32 successors_size; // allocated length of successors
+  kmp_int32 *successors; // indices of the dependent nodes
+} kmp_taskgraph_node_t;
+
+typedef enum kmp_taskgraph_status {
+  KMP_TASKGRAPH_RECORDING = 0, // first encounter, tasks are being recorded
+  KMP_TASKGRAPH_READY = 1, // recorded, later encounters replay the graph
+  KMP_TASKGRAPH_DISABLED = 2 // region cannot be replayed, always re-executed
+} kmp_taskgraph_status_t;
+
+typedef struct kmp_taskgraph {
+  kmp_int32 graph_id;
+  kmp_taskgraph_status_t status;
+  kmp_taskdata_t *owner; // task generating the graph while recording
+  kmp_int32 nnodes;
+  kmp_int32 nodes_size; // allocated length of nodes
+  kmp_taskgraph_node_t *nodes;
+  struct kmp_taskgraph *next; // next graph in the global list
+} kmp_taskgraph_t;
+
 typedef struct kmp_task_affinity_info {
   kmp_intptr_t base_addr;
   size_t len;
@@ -2607,6 +2634,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   /* Tasking-related data for the thread */
   kmp_task_team_t *th_task_team; // Task team struct
   kmp_taskdata_t *th_current_task; // Innermost Task being executed
+  kmp_taskgraph_t *th_taskgraph; // Task graph recorded by th_current_task
   kmp_uint8 th_task_state; // alternating 0/1 for task team identification
   kmp_uint8 *th_task_state_memo_stack; // Stack holding memos of th_task_state
   // at nested levels
@@ -3783,6 +3811,24 @@ KMP_EXPORT void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid,
                                      kmp_depend_info_t *noalias_dep_list);
 extern kmp_int32 __kmp_omp_task(kmp_int32 gtid, kmp_task_t *new_task,
                                 bool serialize_immediate);
+extern void __kmp_omp_tasks(kmp_int32 gtid, kmp_task_t **tasks,
+                            kmp_int32 ntasks);
+
+KMP_EXPORT kmp_int32 __kmpc_taskgraph_begin(ident_t *loc_ref, kmp_int32 gtid,
+                                            kmp_int32 graph_id);
+KMP_EXPORT void __kmpc_taskgraph_end(ident_t *loc_ref, kmp_int32 gtid,
+                                     kmp_int32 graph_id);
+KMP_EXPORT void __kmpc_taskgraph_reset(ident_t *loc_ref, kmp_int32 gtid,
+                                       kmp_int32 graph_id);
+extern void __kmp_taskgraph_record_task(kmp_info_t *thread, kmp_task_t *task,
+                                        kmp_depnode_t *node);
+extern void __kmp_taskgraph_abandon(kmp_info_t *thread);
+extern void __kmp_taskgraph_cleanup(void);
+
+// True if the current task of the thread is recording a task graph
+#define KMP_TASKGRAPH_RECORDING(thread)                                        \
+  ((thread)->th.th_taskgraph != NULL &&                                        \
+   (thread)->th.th_taskgraph->owner == (thread)->th.th_current_task)
 
 KMP_EXPORT kmp_int32 __kmpc_cancel(ident_t *loc_ref, kmp_int32 gtid,
                                    kmp_int32 cncl_kind);
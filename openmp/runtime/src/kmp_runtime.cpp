@@ -7726,6 +7726,7 @@ void __kmp_cleanup(void) {
   }
 
   __kmp_cleanup_threadprivate_caches();
+  __kmp_taskgraph_cleanup();
 
   for (f = 0; f < __kmp_threads_capacity; f++) {
     if (__kmp_root[f] != NULL) {
@@ -20,8 +20,8 @@
 #include "ompt-specific.h"
 #endif
 
-// TODO: Improve memory allocation? keep a list of pre-allocated structures?
-// allocate in blocks? re-use list finished list entries?
+// TODO: Improve memory allocation of depnode lists? keep a list of
+// pre-allocated structures? allocate in blocks?
 // TODO: don't use atomic ref counters for stack-allocated nodes.
 // TODO: find an alternate to atomic refs for heap-allocated nodes?
 // TODO: Finish graph output support
@@ -40,6 +40,7 @@ static void __kmp_init_node(kmp_depnode_t *node) {
   for (int i = 0; i < MAX_MTX_DEPS; ++i)
     node->dn.mtx_locks[i] = NULL;
   node->dn.mtx_num_locks = 0;
+  node->dn.tg_id = -1;
   __kmp_init_lock(&node->dn.lock);
   KMP_ATOMIC_ST_RLX(&node->dn.nrefs, 1); // init creates the first reference
 #ifdef KMP_SUPPORT_GRAPH_OUTPUT
@@ -52,61 +53,56 @@ static inline kmp_depnode_t *__kmp_node_ref(kmp_depnode_t *node) {
   return node;
 }
 
-enum { KMP_DEPHASH_OTHER_SIZE = 97, KMP_DEPHASH_MASTER_SIZE = 997 };
-
-size_t sizes[] = { 997, 2003, 4001, 8191, 16001, 32003, 64007, 131071, 270029 };
-const size_t MAX_GEN = 8;
+// Initial number of slots; must be powers of two
+enum { KMP_DEPHASH_OTHER_SIZE = 32, KMP_DEPHASH_MASTER_SIZE = 1024 };
 
 static inline size_t __kmp_dephash_hash(kmp_intptr_t addr, size_t hsize) {
-  // TODO alternate to try: set = (((Addr64)(addrUsefulBits * 9.618)) %
-  // m_num_sets );
-  return ((addr >> 6) ^ (addr >> 2)) % hsize;
+  // Multiplicative (Fibonacci) hashing: dependence addresses are usually
+  // aligned and clustered, so mix the high bits of the product back in before
+  // masking with the power-of-two table size.
+  kmp_uint64 h = (kmp_uint64)addr * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(h ^ (h >> 32)) & (hsize - 1);
 }
 
-static kmp_dephash_t *__kmp_dephash_extend(kmp_info_t *thread,
-                                           kmp_dephash_t *current_dephash) {
+static kmp_dephash_t *__kmp_dephash_alloc(kmp_info_t *thread, size_t h_size) {
   kmp_dephash_t *h;
 
-  size_t gen = current_dephash->generation + 1;
-  if (gen >= MAX_GEN)
-    return current_dephash;
-  size_t new_size = sizes[gen];
-
-  size_t size_to_allocate =
-      new_size * sizeof(kmp_dephash_entry_t *) + sizeof(kmp_dephash_t);
+  KMP_DEBUG_ASSERT((h_size & (h_size - 1)) == 0);
+  size_t size = h_size * sizeof(kmp_dephash_entry_t) + sizeof(kmp_dephash_t);
 
 #if USE_FAST_MEMORY
-  h = (kmp_dephash_t *)__kmp_fast_allocate(thread, size_to_allocate);
+  h = (kmp_dephash_t *)__kmp_fast_allocate(thread, size);
 #else
-  h = (kmp_dephash_t *)__kmp_thread_malloc(thread, size_to_allocate);
+  h = (kmp_dephash_t *)__kmp_thread_malloc(thread, size);
 #endif
+  h->size = h_size;
+  h->nelements = 0;
+  h->entries = (kmp_dephash_entry_t *)(h + 1);
 
-  h->size = new_size;
-  h->nelements = current_dephash->nelements;
-  h->buckets = (kmp_dephash_entry **)(h + 1);
-  h->generation = gen;
-  h->nconflicts = 0;
+  // make sure all slots are marked as free
+  for (size_t i = 0; i < h_size; i++)
+    h->entries[i].last_flag = ENTRY_UNUSED;
 
-  // make sure buckets are properly initialized
-  for (size_t i = 0; i < new_size; i++) {
-    h->buckets[i] = NULL;
-  }
+  return h;
+}
 
-  // insert existing elements in the new table
+static kmp_dephash_t *__kmp_dephash_extend(kmp_info_t *thread,
+                                           kmp_dephash_t *current_dephash) {
+  kmp_dephash_t *h = __kmp_dephash_alloc(thread, 2 * current_dephash->size);
+  size_t mask = h->size - 1;
+
+  // insert existing elements in the new table; entries are moved by value
+  // since no one keeps pointers to them across lookups
   for (size_t i = 0; i < current_dephash->size; i++) {
-    kmp_dephash_entry_t *next, *entry;
-    for (entry = current_dephash->buckets[i]; entry; entry = next) {
-      next = entry->next_in_bucket;
-      // Compute the new hash using the new size, and insert the entry in
-      // the new bucket.
-      size_t new_bucket = __kmp_dephash_hash(entry->addr, h->size);
-      entry->next_in_bucket = h->buckets[new_bucket];
-      if (entry->next_in_bucket) {
-        h->nconflicts++;
-      }
-      h->buckets[new_bucket] = entry;
-    }
+    kmp_dephash_entry_t *entry = &current_dephash->entries[i];
+    if (entry->last_flag == ENTRY_UNUSED)
+      continue;
+    size_t slot = __kmp_dephash_hash(entry->addr, h->size);
+    while (h->entries[slot].last_flag != ENTRY_UNUSED)
+      slot = (slot + 1) & mask;
+    h->entries[slot] = *entry;
   }
+  h->nelements = current_dephash->nelements;
 
   // Free old hash table
 #if USE_FAST_MEMORY
@@ -120,74 +116,39 @@ static kmp_dephash_t *__kmp_dephash_extend(kmp_info_t *thread,
 
 static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
                                            kmp_taskdata_t *current_task) {
-  kmp_dephash_t *h;
-
-  size_t h_size;
-
   if (current_task->td_flags.tasktype == TASK_IMPLICIT)
-    h_size = KMP_DEPHASH_MASTER_SIZE;
-  else
-    h_size = KMP_DEPHASH_OTHER_SIZE;
-
-  size_t size = h_size * sizeof(kmp_dephash_entry_t *) + sizeof(kmp_dephash_t);
-
-#if USE_FAST_MEMORY
-  h = (kmp_dephash_t *)__kmp_fast_allocate(thread, size);
-#else
-  h = (kmp_dephash_t *)__kmp_thread_malloc(thread, size);
-#endif
-  h->size = h_size;
-
-  h->generation = 0;
-  h->nelements = 0;
-  h->nconflicts = 0;
-  h->buckets = (kmp_dephash_entry **)(h + 1);
-
-  for (size_t i = 0; i < h_size; i++)
-    h->buckets[i] = 0;
-
-  return h;
+    return __kmp_dephash_alloc(thread, KMP_DEPHASH_MASTER_SIZE);
+  return __kmp_dephash_alloc(thread, KMP_DEPHASH_OTHER_SIZE);
 }
 
-#define ENTRY_LAST_INS 0
-#define ENTRY_LAST_MTXS 1
-
 static kmp_dephash_entry *
 __kmp_dephash_find(kmp_info_t *thread, kmp_dephash_t **hash, kmp_intptr_t addr) {
   kmp_dephash_t *h = *hash;
-  if (h->nelements != 0
-      && h->nconflicts/h->size >= 1) {
+  // keep the load factor at or below 1/2 so probe sequences stay short
+  if (2 * (h->nelements + 1) > h->size) {
     *hash = __kmp_dephash_extend(thread, h);
     h = *hash;
   }
-  size_t bucket = __kmp_dephash_hash(addr, h->size);
+  size_t mask = h->size - 1;
+  size_t slot = __kmp_dephash_hash(addr, h->size);
 
   kmp_dephash_entry_t *entry;
-  for (entry = h->buckets[bucket]; entry; entry = entry->next_in_bucket)
-    if (entry->addr == addr)
+  for (;; slot = (slot + 1) & mask) {
+    entry = &h->entries[slot];
+    if (entry->last_flag == ENTRY_UNUSED)
       break;
-
-  if (entry == NULL) {
-// create entry. This is only done by one thread so no locking required
-#if USE_FAST_MEMORY
-    entry = (kmp_dephash_entry_t *)__kmp_fast_allocate(
-        thread, sizeof(kmp_dephash_entry_t));
-#else
-    entry = (kmp_dephash_entry_t *)__kmp_thread_malloc(
-        thread, sizeof(kmp_dephash_entry_t));
-#endif
-    entry->addr = addr;
-    entry->last_out = NULL;
-    entry->last_ins = NULL;
-    entry->last_mtxs = NULL;
-    entry->last_flag = ENTRY_LAST_INS;
-    entry->mtx_lock = NULL;
-    entry->next_in_bucket = h->buckets[bucket];
-    h->buckets[bucket] = entry;
-    h->nelements++;
-    if (entry->next_in_bucket)
-      h->nconflicts++;
+    if (entry->addr == addr)
+      return entry;
   }
+
+  // create entry. This is only done by one thread so no locking required
+  entry->addr = addr;
+  entry->last_out = NULL;
+  entry->last_ins = NULL;
+  entry->last_mtxs = NULL;
+  entry->last_flag = ENTRY_LAST_INS;
+  entry->mtx_lock = NULL;
+  h->nelements++;
   return entry;
 }
 
@@ -241,6 +202,9 @@ static inline void __kmp_track_dependence(kmp_int32 gtid, kmp_depnode_t *source,
 #endif /* OMPT_SUPPORT && OMPT_OPTIONAL */
 }
 
+static void __kmp_taskgraph_add_edge(kmp_taskgraph_t *tg, kmp_depnode_t *source,
+                                     kmp_depnode_t *sink);
+
 static inline kmp_int32
 __kmp_depnode_link_successor(kmp_int32 gtid, kmp_info_t *thread,
                              kmp_task_t *task, kmp_depnode_t *node,
@@ -251,6 +215,9 @@ __kmp_depnode_link_successor(kmp_int32 gtid, kmp_info_t *thread,
   // link node as successor of list elements
   for (kmp_depnode_list_t *p = plist; p; p = p->next) {
     kmp_depnode_t *dep = p->node;
+    // a recorded graph needs the edge even if the predecessor already finished
+    if (UNLIKELY(thread->th.th_taskgraph != NULL))
+      __kmp_taskgraph_add_edge(thread->th.th_taskgraph, dep, node);
     if (dep->dn.task) {
       KMP_ACQUIRE_DEPNODE(gtid, dep);
       if (dep->dn.task) {
@@ -276,6 +243,8 @@ static inline kmp_int32 __kmp_depnode_link_successor(kmp_int32 gtid,
   if (!sink)
     return 0;
   kmp_int32 npredecessors = 0;
+  if (UNLIKELY(thread->th.th_taskgraph != NULL))
+    __kmp_taskgraph_add_edge(thread->th.th_taskgraph, sink, source);
   if (sink->dn.task) {
     // synchronously add source to sink' list of successors
     KMP_ACQUIRE_DEPNODE(gtid, sink);
@@ -608,6 +577,17 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
     __kmp_init_node(node);
     new_taskdata->td_depnode = node;
 
+    if (UNLIKELY(KMP_TASKGRAPH_RECORDING(thread))) {
+      // mutexinoutset locks live in the dependence hash, which is not replayed
+      for (kmp_int32 i = 0; i < ndeps; i++)
+        if (dep_list[i].flags.mtx)
+          __kmp_taskgraph_abandon(thread);
+      for (kmp_int32 i = 0; i < ndeps_noalias; i++)
+        if (noalias_dep_list[i].flags.mtx)
+          __kmp_taskgraph_abandon(thread);
+      __kmp_taskgraph_record_task(thread, new_task, node);
+    }
+
     if (__kmp_check_deps(gtid, node, new_task, &current_task->td_dephash,
                          NO_DEP_BARRIER, ndeps, dep_list, ndeps_noalias,
                          noalias_dep_list)) {
@@ -623,6 +603,13 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
       return TASK_CURRENT_NOT_QUEUED;
     }
   } else {
+    if (UNLIKELY(KMP_TASKGRAPH_RECORDING(thread))) {
+      // dependences ignored now would be missing from the recorded graph
+      if (ndeps > 0 || ndeps_noalias > 0)
+        __kmp_taskgraph_abandon(thread);
+      else
+        __kmp_taskgraph_record_task(thread, new_task, NULL);
+    }
     KA_TRACE(10, ("__kmpc_omp_task_with_deps(exit): T#%d ignored dependencies "
                   "for task (serialized)"
                   "loc=%p task=%p\n",
@@ -685,6 +672,9 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
   kmp_info_t *thread = __kmp_threads[gtid];
   kmp_taskdata_t *current_task = thread->th.th_current_task;
 
+  if (UNLIKELY(KMP_TASKGRAPH_RECORDING(thread)))
+    __kmp_taskgraph_abandon(thread);
+
 #if OMPT_SUPPORT
   // this function represents a taskwait construct with depend clause
   // We signal 4 events:
@@ -803,3 +793,369 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
   KA_TRACE(10, ("__kmpc_omp_wait_deps(exit): T#%d finished waiting : loc=%p\n",
                 gtid, loc_ref));
 }
+
+// Task graph record-and-replay.
+//
+// A region bracketed by __kmpc_taskgraph_begin/__kmpc_taskgraph_end is
+// executed normally the first time it is encountered for a given graph id,
+// while a copy of every task created by the encountering task and every
+// dependence edge between those tasks is recorded. Later encounters skip the
+// region body and instead allocate the tasks from the recorded copies, link
+// them with the recorded edges and precomputed predecessor counts, and submit
+// the ones without predecessors. Neither dependence hash lookups nor the
+// task-generating code of the region run again.
+//
+// The region must create the same tasks, with the same captured values and
+// dependences, every time it is executed. Both ends of the region behave like
+// a taskwait, so dependences never cross its boundaries. Regions using
+// constructs that cannot be replayed (taskwait, taskgroup, taskloop,
+// undeferred, untied, detachable or mutexinoutset tasks) are not recorded and
+// always execute their body.
+
+#define KMP_TASKGRAPH_INIT_SIZE 64
+
+static kmp_bootstrap_lock_t __kmp_taskgraph_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_taskgraph_lock);
+static kmp_taskgraph_t *__kmp_taskgraphs = NULL; // guarded by the lock above
+
+static void __kmp_taskgraph_free_nodes(kmp_taskgraph_t *tg) {
+  for (kmp_int32 i = 0; i < tg->nnodes; i++) {
+    __kmp_free(tg->nodes[i].td_template);
+    if (tg->nodes[i].successors)
+      __kmp_free(tg->nodes[i].successors);
+  }
+  if (tg->nodes)
+    __kmp_free(tg->nodes);
+  tg->nodes = NULL;
+  tg->nnodes = 0;
+  tg->nodes_size = 0;
+}
+
+// Stop recording: the region used a construct that cannot be replayed.
+void __kmp_taskgraph_abandon(kmp_info_t *thread) {
+  kmp_taskgraph_t *tg = thread->th.th_taskgraph;
+  KMP_DEBUG_ASSERT(tg != NULL);
+  KA_TRACE(20, ("__kmp_taskgraph_abandon: graph %d cannot be replayed\n",
+                tg->graph_id));
+  TCW_4(tg->status, KMP_TASKGRAPH_DISABLED);
+}
+
+// Record a copy of a task created by the owner of the graph being recorded.
+// node is the task's depnode if it has dependences, NULL otherwise.
+void __kmp_taskgraph_record_task(kmp_info_t *thread, kmp_task_t *task,
+                                 kmp_depnode_t *node) {
+  kmp_taskgraph_t *tg = thread->th.th_taskgraph;
+  kmp_taskdata_t *taskdata = KMP_TASK_TO_TASKDATA(task);
+
+  if (tg->status != KMP_TASKGRAPH_RECORDING)
+    return;
+  // The recorded copy is a bitwise snapshot: firstprivates with destructors
+  // would be destroyed once per replay, but constructed only once
+  if (taskdata->td_flags.tiedness == TASK_UNTIED ||
+      taskdata->td_flags.proxy == TASK_PROXY ||
+      taskdata->td_flags.detachable == TASK_DETACHABLE ||
+      taskdata->td_flags.destructors_thunk ||
+      taskdata->td_flags.hidden_helper) {
+    __kmp_taskgraph_abandon(thread);
+    return;
+  }
+
+  if (tg->nnodes == tg->nodes_size) {
+    kmp_int32 new_size =
+        tg->nodes_size ? 2 * tg->nodes_size : KMP_TASKGRAPH_INIT_SIZE;
+    kmp_taskgraph_node_t *new_nodes = (kmp_taskgraph_node_t *)__kmp_allocate(
+        new_size * sizeof(kmp_taskgraph_node_t));
+    if (tg->nodes) {
+      KMP_MEMCPY(new_nodes, tg->nodes,
+                 tg->nnodes * sizeof(kmp_taskgraph_node_t));
+      __kmp_free(tg->nodes);
+    }
+    tg->nodes = new_nodes;
+    tg->nodes_size = new_size;
+  }
+
+  kmp_taskgraph_node_t *tg_node = &tg->nodes[tg->nnodes];
+  size_t size = taskdata->td_size_alloc;
+  tg_node->td_template = (kmp_taskdata_t *)__kmp_allocate(size);
+  KMP_MEMCPY(tg_node->td_template, taskdata, size);
+  if (task->shareds != NULL) {
+    size_t shareds_offset = (char *)task->shareds - (char *)taskdata;
+    tg_node->sizeof_kmp_task_t = shareds_offset - sizeof(kmp_taskdata_t);
+    tg_node->sizeof_shareds = size - shareds_offset;
+  } else {
+    tg_node->sizeof_kmp_task_t = size - sizeof(kmp_taskdata_t);
+    tg_node->sizeof_shareds = 0;
+  }
+  tg_node->npredecessors = 0;
+  tg_node->nsuccessors = 0;
+  tg_node->successors_size = 0;
+  tg_node->successors = NULL;
+
+  if (node)
+    node->dn.tg_id = tg->nnodes;
+  tg->nnodes++;
+}
+
+// Record that sink depends on source. Only the thread generating the graph
+// processes the dependences of its tasks, so no locking is needed.
+static void __kmp_taskgraph_add_edge(kmp_taskgraph_t *tg, kmp_depnode_t *source,
+                                     kmp_depnode_t *sink) {
+  if (source->dn.tg_id < 0 || sink->dn.tg_id < 0 ||
+      tg->status != KMP_TASKGRAPH_RECORDING)
+    return;
+  kmp_taskgraph_node_t *tg_node = &tg->nodes[source->dn.tg_id];
+  if (tg_node->nsuccessors == tg_node->successors_size) {
+    kmp_int32 new_size =
+        tg_node->successors_size ? 2 * tg_node->successors_size : 4;
+    kmp_int32 *new_successors =
+        (kmp_int32 *)__kmp_allocate(new_size * sizeof(kmp_int32));
+    if (tg_node->successors) {
+      KMP_MEMCPY(new_successors, tg_node->successors,
+                 tg_node->nsuccessors * sizeof(kmp_int32));
+      __kmp_free(tg_node->successors);
+    }
+    tg_node->successors = new_successors;
+    tg_node->successors_size = new_size;
+  }
+  tg_node->successors[tg_node->nsuccessors++] = sink->dn.tg_id;
+}
+
+static void __kmp_taskgraph_replay(kmp_int32 gtid, kmp_info_t *thread,
+                                   kmp_taskgraph_t *tg) {
+  kmp_int32 nnodes = tg->nnodes;
+  if (nnodes == 0)
+    return;
+
+  KA_TRACE(10, ("__kmp_taskgraph_replay: T#%d replaying graph %d with %d "
+                "tasks\n",
+                gtid, tg->graph_id, nnodes));
+
+  kmp_depnode_t **nodes = (kmp_depnode_t **)__kmp_thread_malloc(
+      thread, nnodes * sizeof(kmp_depnode_t *));
+
+  // Allocate all tasks first, so that successor lists can be built before any
+  // of them is allowed to run
+  for (kmp_int32 i = 0; i < nnodes; i++) {
+    kmp_taskgraph_node_t *tg_node = &tg->nodes[i];
+    kmp_taskdata_t *td_template = tg_node->td_template;
+    kmp_task_t *task_template = KMP_TASKDATA_TO_TASK(td_template);
+    kmp_tasking_flags_t flags = td_template->td_flags;
+
+    kmp_task_t *task = __kmp_task_alloc(
+        td_template->td_ident, gtid, &flags, tg_node->sizeof_kmp_task_t,
+        tg_node->sizeof_shareds, task_template->routine);
+    // copy privates and shareds, keep the shareds pointer of the new task
+    void *shareds = task->shareds;
+    KMP_MEMCPY(task, task_template,
+               td_template->td_size_alloc - sizeof(kmp_taskdata_t));
+    task->shareds = shareds;
+
+#if USE_FAST_MEMORY
+    kmp_depnode_t *node =
+        (kmp_depnode_t *)__kmp_fast_allocate(thread, sizeof(kmp_depnode_t));
+#else
+    kmp_depnode_t *node =
+        (kmp_depnode_t *)__kmp_thread_malloc(thread, sizeof(kmp_depnode_t));
+#endif
+    __kmp_init_node(node);
+    // one extra predecessor keeps the task from being released until all
+    // successor lists are complete
+    node->dn.npredecessors = tg_node->npredecessors + 1;
+    node->dn.task = task;
+    KMP_TASK_TO_TASKDATA(task)->td_depnode = node;
+    nodes[i] = node;
+  }
+
+  for (kmp_int32 i = 0; i < nnodes; i++) {
+    kmp_taskgraph_node_t *tg_node = &tg->nodes[i];
+    for (kmp_int32 j = 0; j < tg_node->nsuccessors; j++)
+      nodes[i]->dn.successors = __kmp_add_node(
+          thread, nodes[i]->dn.successors, nodes[tg_node->successors[j]]);
+  }
+  KMP_MB();
+
+  // Drop the extra predecessor and submit the tasks that are ready; the others
+  // are submitted by __kmp_release_deps when their last predecessor finishes
+  for (kmp_int32 i = 0; i < nnodes; i++) {
+    kmp_task_t *task = nodes[i]->dn.task;
+    if (KMP_ATOMIC_DEC(&nodes[i]->dn.npredecessors) - 1 == 0)
+      __kmp_omp_task(gtid, task, true);
+  }
+
+  __kmp_thread_free(thread, nodes);
+}
+
+static void __kmp_taskgraph_wait(ident_t *loc_ref, kmp_int32 gtid) {
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  OMPT_STORE_RETURN_ADDRESS(gtid);
+#endif
+  __kmpc_omp_taskwait(loc_ref, gtid);
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref location of the task graph region
+@param gtid Global Thread ID of encountering thread
+@param graph_id identifier of the task graph
+@return 1 if the caller must execute the body of the region, 0 if the
+recorded task graph has been submitted instead
+
+Start a task graph region. The first encounter of graph_id executes and
+records the region; later encounters replay the recorded tasks.
+*/
+kmp_int32 __kmpc_taskgraph_begin(ident_t *loc_ref, kmp_int32 gtid,
+                                 kmp_int32 graph_id) {
+  KA_TRACE(10, ("__kmpc_taskgraph_begin(enter): T#%d loc=%p graph=%d\n", gtid,
+                loc_ref, graph_id));
+  __kmp_assert_valid_gtid(gtid);
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+
+  // Tasks are executed immediately and their dependences are not tracked in
+  // serialized contexts, so there is nothing to record or replay
+  if (current_task->td_flags.team_serial ||
+      current_task->td_flags.tasking_ser || current_task->td_flags.final)
+    return 1;
+
+  // Nested regions are executed as part of the region being recorded. They
+  // must not wait for or forget the tasks recorded so far: a taskwait would
+  // abandon the recording.
+  if (thread->th.th_taskgraph != NULL)
+    return 1;
+
+  // Dependences do not cross the region boundary: finish previous children
+  // and forget about them
+  __kmp_taskgraph_wait(loc_ref, gtid);
+  if (current_task->td_dephash)
+    __kmp_dephash_free_entries(thread, current_task->td_dephash);
+
+  __kmp_acquire_bootstrap_lock(&__kmp_taskgraph_lock);
+  kmp_taskgraph_t *tg;
+  for (tg = __kmp_taskgraphs; tg; tg = tg->next)
+    if (tg->graph_id == graph_id)
+      break;
+
+  if (tg == NULL) {
+    tg = (kmp_taskgraph_t *)__kmp_allocate(sizeof(kmp_taskgraph_t));
+    tg->graph_id = graph_id;
+    tg->status = KMP_TASKGRAPH_RECORDING;
+    tg->owner = current_task;
+    tg->nnodes = 0;
+    tg->nodes_size = 0;
+    tg->nodes = NULL;
+    tg->next = __kmp_taskgraphs;
+    __kmp_taskgraphs = tg;
+    __kmp_release_bootstrap_lock(&__kmp_taskgraph_lock);
+
+    KA_TRACE(10, ("__kmpc_taskgraph_begin(exit): T#%d recording graph %d\n",
+                  gtid, graph_id));
+    thread->th.th_taskgraph = tg;
+    return 1;
+  }
+
+  kmp_taskgraph_status_t status = tg->status;
+  __kmp_release_bootstrap_lock(&__kmp_taskgraph_lock);
+  if (status != KMP_TASKGRAPH_READY) {
+    // still being recorded by another thread, or not replayable
+    return 1;
+  }
+
+  __kmp_taskgraph_replay(gtid, thread, tg);
+  KA_TRACE(10, ("__kmpc_taskgraph_begin(exit): T#%d replayed graph %d\n", gtid,
+                graph_id));
+  return 0;
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref location of the task graph region
+@param gtid Global Thread ID of encountering thread
+@param graph_id identifier of the task graph
+
+End a task graph region started by __kmpc_taskgraph_begin, whether its body
+was executed or not. Waits for all tasks of the region to complete.
+*/
+void __kmpc_taskgraph_end(ident_t *loc_ref, kmp_int32 gtid,
+                          kmp_int32 graph_id) {
+  KA_TRACE(10, ("__kmpc_taskgraph_end(enter): T#%d loc=%p graph=%d\n", gtid,
+                loc_ref, graph_id));
+  __kmp_assert_valid_gtid(gtid);
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+  kmp_taskgraph_t *tg = thread->th.th_taskgraph;
+
+  bool recorded = KMP_TASKGRAPH_RECORDING(thread) && tg->graph_id == graph_id;
+  // The end of a nested region, which __kmpc_taskgraph_begin left alone
+  if (tg != NULL && !recorded)
+    return;
+  if (recorded)
+    thread->th.th_taskgraph = NULL;
+
+  __kmp_taskgraph_wait(loc_ref, gtid);
+  if (current_task->td_dephash)
+    __kmp_dephash_free_entries(thread, current_task->td_dephash);
+
+  if (!recorded)
+    return;
+
+  if (tg->status == KMP_TASKGRAPH_DISABLED) {
+    __kmp_taskgraph_free_nodes(tg);
+    return;
+  }
+
+  // Precompute the number of predecessors of every task
+  for (kmp_int32 i = 0; i < tg->nnodes; i++) {
+    kmp_taskgraph_node_t *tg_node = &tg->nodes[i];
+    for (kmp_int32 j = 0; j < tg_node->nsuccessors; j++)
+      tg->nodes[tg_node->successors[j]].npredecessors++;
+  }
+  tg->owner = NULL;
+
+  __kmp_acquire_bootstrap_lock(&__kmp_taskgraph_lock);
+  TCW_4(tg->status, KMP_TASKGRAPH_READY);
+  __kmp_release_bootstrap_lock(&__kmp_taskgraph_lock);
+
+  KA_TRACE(10, ("__kmpc_taskgraph_end(exit): T#%d recorded graph %d with %d "
+                "tasks\n",
+                gtid, graph_id, tg->nnodes));
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref location of the call
+@param gtid Global Thread ID of encountering thread
+@param graph_id identifier of the task graph
+
+Discard the recording of graph_id, so that its next encounter records it again.
+Must not be called while the graph is being recorded or replayed.
+*/
+void __kmpc_taskgraph_reset(ident_t *loc_ref, kmp_int32 gtid,
+                            kmp_int32 graph_id) {
+  KA_TRACE(10, ("__kmpc_taskgraph_reset: T#%d loc=%p graph=%d\n", gtid,
+                loc_ref, graph_id));
+  __kmp_acquire_bootstrap_lock(&__kmp_taskgraph_lock);
+  for (kmp_taskgraph_t **prev = &__kmp_taskgraphs; *prev;
+       prev = &(*prev)->next) {
+    kmp_taskgraph_t *tg = *prev;
+    if (tg->graph_id == graph_id) {
+      KMP_DEBUG_ASSERT(tg->status != KMP_TASKGRAPH_RECORDING);
+      *prev = tg->next;
+      __kmp_taskgraph_free_nodes(tg);
+      __kmp_free(tg);
+      break;
+    }
+  }
+  __kmp_release_bootstrap_lock(&__kmp_taskgraph_lock);
+}
+
+// Free all recorded task graphs at library shutdown
+void __kmp_taskgraph_cleanup(void) {
+  __kmp_acquire_bootstrap_lock(&__kmp_taskgraph_lock);
+  while (__kmp_taskgraphs) {
+    kmp_taskgraph_t *tg = __kmp_taskgraphs;
+    __kmp_taskgraphs = tg->next;
+    __kmp_taskgraph_free_nodes(tg);
+    __kmp_free(tg);
+  }
+  __kmp_release_bootstrap_lock(&__kmp_taskgraph_lock);
+}
@@ -20,6 +20,14 @@
 #define KMP_ACQUIRE_DEPNODE(gtid, n) __kmp_acquire_lock(&(n)->dn.lock, (gtid))
 #define KMP_RELEASE_DEPNODE(gtid, n) __kmp_release_lock(&(n)->dn.lock, (gtid))
 
+// Values of kmp_dephash_entry_t::last_flag; a zeroed entry is an unused slot
+#define ENTRY_UNUSED 0
+#define ENTRY_LAST_INS 1
+#define ENTRY_LAST_MTXS 2
+
+// Maximum number of ready successors pushed under one deque lock acquisition
+#define KMP_RELEASE_DEPS_BATCH 16
+
 static inline void __kmp_node_deref(kmp_info_t *thread, kmp_depnode_t *node) {
   if (!node)
     return;
@@ -54,26 +62,19 @@ static inline void __kmp_depnode_list_free(kmp_info_t *thread,
 static inline void __kmp_dephash_free_entries(kmp_info_t *thread,
                                               kmp_dephash_t *h) {
   for (size_t i = 0; i < h->size; i++) {
-    if (h->buckets[i]) {
-      kmp_dephash_entry_t *next;
-      for (kmp_dephash_entry_t *entry = h->buckets[i]; entry; entry = next) {
-        next = entry->next_in_bucket;
-        __kmp_depnode_list_free(thread, entry->last_ins);
-        __kmp_depnode_list_free(thread, entry->last_mtxs);
-        __kmp_node_deref(thread, entry->last_out);
-        if (entry->mtx_lock) {
-          __kmp_destroy_lock(entry->mtx_lock);
-          __kmp_free(entry->mtx_lock);
-        }
-#if USE_FAST_MEMORY
-        __kmp_fast_free(thread, entry);
-#else
-        __kmp_thread_free(thread, entry);
-#endif
-      }
-      h->buckets[i] = 0;
+    kmp_dephash_entry_t *entry = &h->entries[i];
+    if (entry->last_flag == ENTRY_UNUSED)
+      continue;
+    __kmp_depnode_list_free(thread, entry->last_ins);
+    __kmp_depnode_list_free(thread, entry->last_mtxs);
+    __kmp_node_deref(thread, entry->last_out);
+    if (entry->mtx_lock) {
+      __kmp_destroy_lock(entry->mtx_lock);
+      __kmp_free(entry->mtx_lock);
     }
+    entry->last_flag = ENTRY_UNUSED;
   }
+  h->nelements = 0;
 }
 
 static inline void __kmp_dephash_free(kmp_info_t *thread, kmp_dephash_t *h) {
@@ -118,6 +119,11 @@ static inline void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
       NULL; // mark this task as finished, so no new dependencies are generated
   KMP_RELEASE_DEPNODE(gtid, node);
 
+  // Successors which became ready are pushed onto this thread's deque in
+  // batches, so that the deque lock is taken once per batch, not per task.
+  kmp_task_t *ready[KMP_RELEASE_DEPS_BATCH];
+  kmp_int32 nready = 0;
+
   kmp_depnode_list_t *next;
   kmp_taskdata_t *next_taskdata;
   for (kmp_depnode_list_t *p = node->dn.successors; p; p = next) {
@@ -148,7 +154,11 @@ static inline void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
             __kmp_omp_task(gtid, successor->dn.task, false);
           }
         } else {
-          __kmp_omp_task(gtid, successor->dn.task, false);
+          ready[nready++] = successor->dn.task;
+          if (nready == KMP_RELEASE_DEPS_BATCH) {
+            __kmp_omp_tasks(gtid, ready, nready);
+            nready = 0;
+          }
         }
       }
     }
@@ -162,6 +172,9 @@ static inline void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
 #endif
   }
 
+  if (nready > 0)
+    __kmp_omp_tasks(gtid, ready, nready);
+
   __kmp_node_deref(thread, node);
 
   KA_TRACE(
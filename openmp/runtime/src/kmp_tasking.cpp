@@ -677,6 +677,8 @@ static void __kmpc_omp_task_begin_if0_ompt(ident_t *loc_ref, kmp_int32 gtid,
 // task: task thunk for the started task.
 void __kmpc_omp_task_begin_if0(ident_t *loc_ref, kmp_int32 gtid,
                                kmp_task_t *task) {
+  if (UNLIKELY(KMP_TASKGRAPH_RECORDING(__kmp_threads[gtid])))
+    __kmp_taskgraph_abandon(__kmp_threads[gtid]);
 #if OMPT_SUPPORT
   if (UNLIKELY(ompt_enabled.enabled)) {
     OMPT_STORE_RETURN_ADDRESS(gtid);
@@ -1744,6 +1746,77 @@ kmp_int32 __kmp_omp_task(kmp_int32 gtid, kmp_task_t *new_task,
   return TASK_CURRENT_NOT_QUEUED;
 }
 
+// __kmp_omp_tasks: Schedule a batch of ready tasks on the deque of the
+// encountering thread, acquiring the deque lock once for the whole batch.
+// Once a task cannot simply be appended (a proxy, hidden helper or serialized
+// task, or any task once the deque is full and may be throttled), it and the
+// rest of the batch are handed to __kmp_omp_task one at a time instead, after
+// the deque lock was released.
+//
+// gtid: Global Thread ID of encountering thread
+// tasks: ready tasks, in the order in which they were released
+// ntasks: number of tasks in the batch
+void __kmp_omp_tasks(kmp_int32 gtid, kmp_task_t **tasks, kmp_int32 ntasks) {
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_task_team_t *task_team = thread->th.th_task_team;
+  kmp_thread_data_t *thread_data = NULL;
+  kmp_int32 i = 0;
+
+  for (; i < ntasks; ++i) {
+    kmp_taskdata_t *taskdata = KMP_TASK_TO_TASKDATA(tasks[i]);
+    if (taskdata->td_flags.proxy == TASK_PROXY ||
+        taskdata->td_flags.hidden_helper || taskdata->td_flags.task_serial)
+      break;
+
+    if (thread_data == NULL) {
+      KMP_DEBUG_ASSERT(__kmp_tasking_mode != tskm_immediate_exec);
+      if (UNLIKELY(!KMP_TASKING_ENABLED(task_team))) {
+        __kmp_enable_tasking(task_team, thread);
+      }
+      thread_data =
+          &task_team->tt.tt_threads_data[__kmp_tid_from_gtid(gtid)];
+      if (UNLIKELY(thread_data->td.td_deque == NULL)) {
+        __kmp_alloc_task_deque(thread, thread_data);
+      }
+      __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+    }
+
+    if (TCR_4(thread_data->td.td_deque_ntasks) >=
+        TASK_DEQUE_SIZE(thread_data->td)) {
+      // Let __kmp_push_task decide whether the rest are executed immediately
+      if (__kmp_enable_task_throttling)
+        break;
+      __kmp_realloc_task_deque(thread, thread_data);
+    }
+
+    if (UNLIKELY(taskdata->td_flags.tiedness == TASK_UNTIED)) {
+      // untied task needs to increment counter so that the task structure is
+      // not freed prematurely
+      KMP_ATOMIC_INC(&taskdata->td_untied_count);
+    }
+    thread_data->td.td_deque[thread_data->td.td_deque_tail] = taskdata;
+    thread_data->td.td_deque_tail =
+        (thread_data->td.td_deque_tail + 1) & TASK_DEQUE_MASK(thread_data->td);
+    TCW_4(thread_data->td.td_deque_ntasks,
+          TCR_4(thread_data->td.td_deque_ntasks) + 1);
+    KMP_FSYNC_RELEASING(taskdata);
+    ANNOTATE_HAPPENS_BEFORE(tasks[i]);
+  }
+
+  if (thread_data != NULL) {
+    KMP_FSYNC_RELEASING(thread->th.th_current_task);
+    KA_TRACE(20, ("__kmp_omp_tasks: T#%d pushed %d of %d tasks: ntasks=%d "
+                  "head=%u tail=%u\n",
+                  gtid, i, ntasks, thread_data->td.td_deque_ntasks,
+                  thread_data->td.td_deque_head,
+                  thread_data->td.td_deque_tail));
+    __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+  }
+
+  for (; i < ntasks; ++i)
+    __kmp_omp_task(gtid, tasks[i], false);
+}
+
 // __kmpc_omp_task: Wrapper around __kmp_omp_task to schedule a
 // non-thread-switchable task from the parent thread only!
 //
@@ -1768,6 +1841,11 @@ kmp_int32 __kmpc_omp_task(ident_t *loc_ref, kmp_int32 gtid,
                 new_taskdata));
   __kmp_assert_valid_gtid(gtid);
 
+  kmp_info_t *thread = __kmp_threads[gtid];
+  if (UNLIKELY(KMP_TASKGRAPH_RECORDING(thread)) &&
+      !KMP_TASK_TO_TASKDATA(new_task)->td_flags.started)
+    __kmp_taskgraph_record_task(thread, new_task, NULL);
+
 #if OMPT_SUPPORT
   kmp_taskdata_t *parent = NULL;
   if (UNLIKELY(ompt_enabled.enabled)) {
@@ -1991,6 +2069,8 @@ static kmp_int32 __kmpc_omp_taskwait_ompt(ident_t *loc_ref, kmp_int32 gtid,
 // __kmpc_omp_taskwait: Wait until all tasks generated by the current task are
 // complete
 kmp_int32 __kmpc_omp_taskwait(ident_t *loc_ref, kmp_int32 gtid) {
+  if (UNLIKELY(KMP_TASKGRAPH_RECORDING(__kmp_threads[gtid])))
+    __kmp_taskgraph_abandon(__kmp_threads[gtid]);
 #if OMPT_SUPPORT && OMPT_OPTIONAL
   if (UNLIKELY(ompt_enabled.enabled)) {
     OMPT_STORE_RETURN_ADDRESS(gtid);
@@ -2489,6 +2569,8 @@ void __kmpc_taskgroup(ident_t *loc, int gtid) {
   __kmp_assert_valid_gtid(gtid);
   kmp_info_t *thread = __kmp_threads[gtid];
   kmp_taskdata_t *taskdata = thread->th.th_current_task;
+  if (UNLIKELY(KMP_TASKGRAPH_RECORDING(thread)))
+    __kmp_taskgraph_abandon(thread);
   kmp_taskgroup_t *tg_new =
       (kmp_taskgroup_t *)__kmp_thread_malloc(thread, sizeof(kmp_taskgroup_t));
   KA_TRACE(10, ("__kmpc_taskgroup: T#%d loc=%p group=%p\n", gtid, loc, tg_new));
@@ -4554,6 +4636,8 @@ static void __kmp_taskloop(ident_t *loc, int gtid, kmp_task_t *task, int if_val,
                            int modifier, void *task_dup) {
   kmp_taskdata_t *taskdata = KMP_TASK_TO_TASKDATA(task);
   KMP_DEBUG_ASSERT(task != NULL);
+  if (UNLIKELY(KMP_TASKGRAPH_RECORDING(__kmp_threads[gtid])))
+    __kmp_taskgraph_abandon(__kmp_threads[gtid]);
   if (nogroup == 0) {
 #if OMPT_SUPPORT && OMPT_OPTIONAL
     OMPT_STORE_RETURN_ADDRESS(gtid);
@@ -0,0 +1,65 @@
+// RUN: %libomp-compile && env OMP_NUM_THREADS='4' %libomp-run
+// RUN: %libomp-compile && env OMP_NUM_THREADS='1' %libomp-run
+
+#include <stdio.h>
+#include <omp.h>
+
+// Task graph record-and-replay: the region body runs once to record the
+// graph, later timesteps replay it and must still honor the dependences.
+
+#define N 64
+#define STEPS 10
+#define GRAPH_ID 1
+
+// OpenMP RTL interfaces
+typedef struct ident {
+  void* dummy; // not used in the library
+} ident_t;
+
+extern int __kmpc_global_thread_num(ident_t *);
+extern int __kmpc_taskgraph_begin(ident_t *, int gtid, int graph_id);
+extern void __kmpc_taskgraph_end(ident_t *, int gtid, int graph_id);
+extern void __kmpc_taskgraph_reset(ident_t *, int gtid, int graph_id);
+
+int x[N], y[N];
+int bodies = 0;
+
+int main() {
+  int i, step;
+  int failed = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    for (step = 0; step < STEPS; step++) {
+      if (__kmpc_taskgraph_begin(NULL, gtid, GRAPH_ID)) {
+        bodies++;
+        for (i = 0; i < N; i++) {
+          #pragma omp task firstprivate(i) depend(inout: x[i])
+          { x[i] += 1; }
+          #pragma omp task firstprivate(i) depend(in: x[i]) depend(out: y[i])
+          { y[i] = 2 * x[i]; }
+          #pragma omp task firstprivate(i) depend(inout: y[i])
+          { y[i] += 1; }
+        }
+      }
+      __kmpc_taskgraph_end(NULL, gtid, GRAPH_ID);
+      for (i = 0; i < N; i++) {
+        if (x[i] != step + 1 || y[i] != 2 * (step + 1) + 1)
+          failed++;
+      }
+    }
+    __kmpc_taskgraph_reset(NULL, gtid, GRAPH_ID);
+  }
+
+  // Serialized teams always execute the body, otherwise it is only recorded
+  // once
+  if (omp_get_max_threads() > 1 && bodies != 1) {
+    printf("body executed %d times\n", bodies);
+    failed++;
+  }
+  if (failed == 0)
+    printf("passed\n");
+  return failed;
+}
@@ -0,0 +1,125 @@
+// RUN: %libomp-cxx-compile && env OMP_NUM_THREADS='4' %libomp-run
+// RUN: %libomp-cxx-compile && env OMP_NUM_THREADS='1' %libomp-run
+
+#include <stdio.h>
+#include <omp.h>
+
+// A firstprivate with a destructor makes a task graph region unreplayable:
+// every copy must be destroyed exactly once, so the body has to run on every
+// encounter instead of replaying a bitwise snapshot of the first one.
+// A nested region must not disturb the recording of the enclosing one.
+
+#define N 16
+#define STEPS 5
+#define GRAPH_ID 1
+#define NESTED_GRAPH_ID 2
+
+// OpenMP RTL interfaces
+typedef struct ident {
+  void* dummy; // not used in the library
+} ident_t;
+
+extern "C" {
+extern int __kmpc_global_thread_num(ident_t *);
+extern int __kmpc_taskgraph_begin(ident_t *, int gtid, int graph_id);
+extern void __kmpc_taskgraph_end(ident_t *, int gtid, int graph_id);
+extern void __kmpc_taskgraph_reset(ident_t *, int gtid, int graph_id);
+}
+
+int live = 0;
+int destroyed_twice = 0;
+
+struct Counted {
+  int value;
+  bool alive;
+  Counted(int v) : value(v), alive(true) {
+    #pragma omp atomic
+    live++;
+  }
+  Counted(const Counted &other) : value(other.value), alive(true) {
+    #pragma omp atomic
+    live++;
+  }
+  ~Counted() {
+    if (!alive) {
+      #pragma omp atomic
+      destroyed_twice++;
+    }
+    alive = false;
+    #pragma omp atomic
+    live--;
+  }
+};
+
+int x[N];
+int bodies = 0;
+int nested_bodies = 0;
+
+int main() {
+  int failed = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    for (int step = 0; step < STEPS; step++) {
+      if (__kmpc_taskgraph_begin(NULL, gtid, GRAPH_ID)) {
+        bodies++;
+        Counted c(1);
+        for (int i = 0; i < N; i++) {
+          #pragma omp task firstprivate(i, c) depend(inout: x[i])
+          { x[i] += c.value; }
+        }
+      }
+      __kmpc_taskgraph_end(NULL, gtid, GRAPH_ID);
+      for (int i = 0; i < N; i++) {
+        if (x[i] != step + 1)
+          failed++;
+      }
+    }
+    __kmpc_taskgraph_reset(NULL, gtid, GRAPH_ID);
+
+    for (int step = 0; step < STEPS; step++) {
+      if (__kmpc_taskgraph_begin(NULL, gtid, GRAPH_ID)) {
+        bodies++;
+        for (int i = 0; i < N; i++) {
+          #pragma omp task firstprivate(i) depend(inout: x[i])
+          { x[i] += 1; }
+        }
+        if (__kmpc_taskgraph_begin(NULL, gtid, NESTED_GRAPH_ID))
+          nested_bodies++;
+        __kmpc_taskgraph_end(NULL, gtid, NESTED_GRAPH_ID);
+        for (int i = 0; i < N; i++) {
+          #pragma omp task firstprivate(i) depend(inout: x[i])
+          { x[i] += 1; }
+        }
+      }
+      __kmpc_taskgraph_end(NULL, gtid, GRAPH_ID);
+      for (int i = 0; i < N; i++) {
+        if (x[i] != STEPS + 2 * (step + 1))
+          failed++;
+      }
+    }
+    __kmpc_taskgraph_reset(NULL, gtid, GRAPH_ID);
+  }
+
+  if (live != 0 || destroyed_twice != 0) {
+    printf("live copies: %d, destroyed twice: %d\n", live, destroyed_twice);
+    failed++;
+  }
+  // The first region is never replayed. The second one is recorded once and
+  // replayed afterwards, unless the team is serialized.
+  int expected = omp_get_max_threads() > 1 ? STEPS + 1 : 2 * STEPS;
+  if (bodies != expected) {
+    printf("body executed %d times, expected %d\n", bodies, expected);
+    failed++;
+  }
+  if (nested_bodies != bodies - STEPS) {
+    printf("nested body executed %d times\n", nested_bodies);
+    failed++;
+  }
+
+  if (failed == 0)
+    printf("passed\n");
+  return failed;
+}
@@ -0,0 +1,46 @@
+// RUN: %libomp-compile-and-run
+
+// Dependences on many distinct addresses, so that the dependence hash of the
+// master's implicit task has to grow well past its initial size while ins and
+// outs on the same address keep being ordered correctly.
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_DEPS 200000
+
+int main() {
+  int *deps = calloc(NUM_DEPS, sizeof(int));
+  int *seen = calloc(NUM_DEPS, sizeof(int));
+  int i;
+  int failed = 0;
+
+  #pragma omp parallel
+  #pragma omp master
+  {
+    for (i = 0; i < NUM_DEPS; i++) {
+      #pragma omp task firstprivate(i) depend(out: deps[i])
+      { deps[i] = 1; }
+      #pragma omp task firstprivate(i) depend(in: deps[i])
+      { seen[i] = deps[i]; }
+    }
+    for (i = 0; i < NUM_DEPS; i++) {
+      #pragma omp task firstprivate(i) depend(inout: deps[i])
+      { deps[i] += seen[i]; }
+    }
+  }
+
+  for (i = 0; i < NUM_DEPS; i++) {
+    if (deps[i] != 2)
+      failed++;
+  }
+  if (failed)
+    printf("failed: %d\n", failed);
+  else
+    printf("passed\n");
+
+  free(deps);
+  free(seen);
+  return failed;
+}
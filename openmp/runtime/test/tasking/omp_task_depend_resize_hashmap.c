@@ -12,7 +12,7 @@
 #include<stdlib.h>
 #include<string.h>
 
-// The first hashtable static size is 997
+// The first hashtable static size is 1024
 #define NUM_DEPS 4000
 
 
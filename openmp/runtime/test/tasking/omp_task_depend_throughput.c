@@ -0,0 +1,65 @@
+// RUN: %libomp-compile-and-run
+
+// Timed driver for dependence-heavy task graphs. Every task of a layer depends
+// on three tasks of the previous layer, so each completed task releases up to
+// three successors and most depend clauses name addresses not seen before.
+// The default size keeps the test short; pass the number of layers and the
+// layer width to measure larger graphs, e.g. "./a.out 2000 1000".
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MOD 1000003
+
+static int step(int a, int b, int c) { return (a + 2 * b + c) % MOD; }
+
+int main(int argc, char **argv) {
+  int layers = argc > 1 ? atoi(argv[1]) : 100;
+  int width = argc > 2 ? atoi(argv[2]) : 200;
+  int *grid = calloc((size_t)layers * width, sizeof(int));
+  int *ref = calloc((size_t)layers * width, sizeof(int));
+  double start, elapsed;
+  int l, i, failed = 0;
+
+  for (i = 0; i < width; i++)
+    grid[i] = ref[i] = i + 1;
+  for (l = 1; l < layers; l++) {
+    int *prev = &ref[(l - 1) * width], *cur = &ref[l * width];
+    for (i = 0; i < width; i++)
+      cur[i] = step(prev[i > 0 ? i - 1 : i], prev[i],
+                    prev[i + 1 < width ? i + 1 : i]);
+  }
+
+  start = omp_get_wtime();
+  #pragma omp parallel private(l, i)
+  #pragma omp single
+  {
+    for (l = 1; l < layers; l++) {
+      int *prev = &grid[(l - 1) * width], *cur = &grid[l * width];
+      for (i = 0; i < width; i++) {
+        int *left = &prev[i > 0 ? i - 1 : i];
+        int *right = &prev[i + 1 < width ? i + 1 : i];
+        #pragma omp task firstprivate(prev, cur, i, left, right) \
+            depend(in: *left, prev[i], *right) depend(out: cur[i])
+        cur[i] = step(*left, prev[i], *right);
+      }
+    }
+  }
+  elapsed = omp_get_wtime() - start;
+
+  for (i = 0; i < layers * width; i++) {
+    if (grid[i] != ref[i])
+      failed++;
+  }
+  fprintf(stderr, "%d tasks in %.3f s, %.0f tasks/s\n", (layers - 1) * width,
+          elapsed, (layers - 1) * width / elapsed);
+  if (failed)
+    printf("failed: %d\n", failed);
+  else
+    printf("passed\n");
+
+  free(grid);
+  free(ref);
+  return failed;
+}